@@ -11,7 +11,7 @@ echo $SLURM_NODELIST
 module load gcc
 module load openmpi
 
-mpicc test/bigSim.c code/materialPar.c code/checkPtPar.c code/simulationPar.c -o obj/bigSim -lm
+mpicc test/bigSim.c code/materialPar.c code/checkPtPar.c code/simulationPar.c code/allocPar.c code/taskPar.c -o obj/bigSim -lm -lpthread
 
 date +”%I:%M %p”
 echo "start loop"
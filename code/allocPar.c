@@ -0,0 +1,210 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "allocPar.h"
+#include <mpi.h>
+
+// the current policy and every array allocated and not yet freed (this rank's)
+static int allocPolicy = ALLOC_ALIGNED;
+static int nArrays = 0;
+static int arraysCapacity = 0;
+static void **arrayPtrs = NULL;
+static size_t *arrayBytes = NULL;
+
+// Choose the policy of the arrays allocated from now on
+int setAllocPolicyLoc(int policy)
+{
+	if ((policy != ALLOC_ALIGNED) && (policy != ALLOC_HUGE))
+	{
+		printf("WARNING: In setAllocPolicyLoc(), %d is not an allocation policy \n", policy);
+		return 1;
+	}
+	allocPolicy = policy;
+	return 0;
+};
+
+// Allocate nBytes, aligned and first touched under the current policy
+void *allocArrayLoc(size_t nBytes)
+{
+	void *ptr = NULL;
+	size_t align = ALLOC_ALIGN;
+	size_t nAlloc = (nBytes > 0) ? nBytes : 1;
+	if ((allocPolicy == ALLOC_HUGE) && (nBytes >= ALLOC_HUGE_PAGE))
+	{
+		// whole huge pages, so the last one isn't shared with anything else
+		align = ALLOC_HUGE_PAGE;
+		nAlloc = ((nBytes + ALLOC_HUGE_PAGE - 1) / ALLOC_HUGE_PAGE) * ALLOC_HUGE_PAGE;
+	}
+	if (posix_memalign(&ptr, align, nAlloc) != 0)
+		return NULL;
+#ifdef MADV_HUGEPAGE
+	if (align == ALLOC_HUGE_PAGE)
+		madvise(ptr, nAlloc, MADV_HUGEPAGE); // only advice: without transparent huge pages it stays on small pages
+#endif
+	memset(ptr, 0, nAlloc);
+
+	if (nArrays == arraysCapacity)
+	{
+		int capacity = (arraysCapacity > 0) ? 2 * arraysCapacity : 32;
+		void **newPtrs = realloc(arrayPtrs, capacity * sizeof(void *));
+		size_t *newBytes = realloc(arrayBytes, capacity * sizeof(size_t));
+		if (newPtrs != NULL)
+			arrayPtrs = newPtrs;
+		if (newBytes != NULL)
+			arrayBytes = newBytes;
+		if ((newPtrs == NULL) || (newBytes == NULL))
+			return ptr; // still a good array, just not reported on
+		arraysCapacity = capacity;
+	}
+	arrayPtrs[nArrays] = ptr;
+	arrayBytes[nArrays] = nAlloc;
+	nArrays = nArrays + 1;
+	return ptr;
+};
+
+// Free an array from allocArrayLoc
+void freeArrayLoc(void *ptr)
+{
+	if (ptr == NULL)
+		return;
+	int i;
+	for (i = 0; i < nArrays; ++i)
+	{
+		if (arrayPtrs[i] == ptr)
+		{
+			nArrays = nArrays - 1;
+			arrayPtrs[i] = arrayPtrs[nArrays];
+			arrayBytes[i] = arrayBytes[nArrays];
+			break;
+		}
+	}
+	if ((nArrays == 0) && (arrayPtrs != NULL))
+	{
+		free(arrayPtrs);
+		arrayPtrs = NULL;
+		free(arrayBytes);
+		arrayBytes = NULL;
+		arraysCapacity = 0;
+	}
+	free(ptr);
+};
+
+// Number of elements to stride by for rows of n elements
+unsigned int paddedStrideLoc(unsigned int n, size_t elemSize)
+{
+	size_t nLines = (n * elemSize + ALLOC_ALIGN - 1) / ALLOC_ALIGN;
+	if (nLines % 2 == 0)
+		nLines = nLines + 1;
+	return (unsigned int)((nLines * ALLOC_ALIGN) / elemSize);
+};
+
+// bytes of the tracked arrays backed by huge pages, from the AnonHugePages of the mappings they're in
+static size_t hugeBytesLoc(void)
+{
+	FILE *smaps = fopen("/proc/self/smaps", "r");
+	if (smaps == NULL)
+		return 0;
+	size_t hugeBytes = 0;
+	int overlaps = 0;
+	char line[256];
+	while (fgets(line, 256, smaps) != NULL)
+	{
+		unsigned long lo, hi, kB;
+		if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2)
+		{
+			// a new mapping: does a tracked array overlap it?
+			overlaps = 0;
+			int i;
+			for (i = 0; i < nArrays; ++i)
+			{
+				unsigned long start = (unsigned long)arrayPtrs[i];
+				if ((start < hi) && (start + arrayBytes[i] > lo))
+					overlaps = 1;
+			}
+		}
+		else if (overlaps && (sscanf(line, "AnonHugePages: %lu kB", &kB) == 1))
+			hugeBytes += kB * 1024;
+	}
+	fclose(smaps);
+	return hugeBytes;
+};
+
+// count the NUMA node each sampled page of the tracked arrays is on (pages not yet touched aren't counted)
+static void nodeCountsLoc(long *nodeCounts)
+{
+	int i, k;
+	for (k = 0; k < ALLOC_MAX_NODES; ++k)
+		nodeCounts[k] = 0;
+	void *pages[ALLOC_NODE_SAMPLES];
+	int status[ALLOC_NODE_SAMPLES];
+	for (i = 0; i < nArrays; ++i)
+	{
+		size_t nPages = (arrayBytes[i] + ALLOC_SMALL_PAGE - 1) / ALLOC_SMALL_PAGE;
+		size_t step = (nPages + ALLOC_NODE_SAMPLES - 1) / ALLOC_NODE_SAMPLES;
+		int nSamples = 0;
+		size_t page;
+		for (page = 0; page < nPages; page += step)
+			pages[nSamples++] = (char *)arrayPtrs[i] + page * ALLOC_SMALL_PAGE;
+		// move_pages with no target nodes only reports where each page is
+		if (syscall(SYS_move_pages, 0, (unsigned long)nSamples, pages, NULL, status, 0) != 0)
+			continue;
+		for (k = 0; k < nSamples; ++k)
+		{
+			if ((status[k] >= 0) && (status[k] < ALLOC_MAX_NODES))
+				nodeCounts[status[k]] += step;
+		}
+	}
+};
+
+// Have rank 0 print every rank's allocation statistics
+int reportAllocLoc(MPI_Comm comm)
+{
+	int rank, size;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+
+	// arrays, bytes, huge page bytes, TLB entries, then pages on each node
+	long mine[4 + ALLOC_MAX_NODES];
+	size_t bytes = 0;
+	int i;
+	for (i = 0; i < nArrays; ++i)
+		bytes += arrayBytes[i];
+	size_t hugeBytes = hugeBytesLoc();
+	if (hugeBytes > bytes)
+		hugeBytes = bytes;
+	mine[0] = nArrays;
+	mine[1] = bytes;
+	mine[2] = hugeBytes;
+	mine[3] = hugeBytes / ALLOC_HUGE_PAGE + (bytes - hugeBytes + ALLOC_SMALL_PAGE - 1) / ALLOC_SMALL_PAGE;
+	nodeCountsLoc(mine + 4);
+	long *all = NULL;
+	if (rank == 0)
+		all = (long *)malloc(size * (4 + ALLOC_MAX_NODES) * sizeof(long));
+	MPI_Gather(mine, 4 + ALLOC_MAX_NODES, MPI_LONG, all, 4 + ALLOC_MAX_NODES, MPI_LONG, 0, comm);
+	if (rank != 0)
+		return 0;
+	if (all == NULL)
+		return 1;
+	printf("rank, arrays, MB, MB on huge pages, TLB entries, pages on NUMA nodes 0, 1, ... \n");
+	int r, k;
+	for (r = 0; r < size; ++r)
+	{
+		long *these = all + r * (4 + ALLOC_MAX_NODES);
+		printf("%d, %ld, %.1f, %.1f, %ld,", r, these[0], these[1] / 1e6, these[2] / 1e6, these[3]);
+		int lastNode = 0;
+		for (k = 0; k < ALLOC_MAX_NODES; ++k)
+		{
+			if (these[4 + k] > 0)
+				lastNode = k;
+		}
+		for (k = 0; k <= lastNode; ++k)
+			printf(" %ld", these[4 + k]);
+		printf(" \n");
+	}
+	free(all);
+	return 0;
+};
@@ -0,0 +1,37 @@
+#ifndef __ALLOCPAR_H__
+#define __ALLOCPAR_H__
+#include <stddef.h>
+#include <mpi.h>
+
+// Allocation of the big state and snapshot arrays of the parallel engines. Every array is aligned to a cache
+// line (so whole vectors load from it), and zero filled by the rank that allocates it, which is the one that
+// uses it, so with ranks pinned to cores the first touch puts its pages on that rank's NUMA node.
+#define ALLOC_ALIGN 64 // bytes every array is aligned to
+#define ALLOC_HUGE_PAGE (2 * 1024 * 1024) // bytes in a huge page
+#define ALLOC_SMALL_PAGE 4096 // bytes in an ordinary page
+#define ALLOC_MAX_NODES 16 // NUMA nodes reportAllocLoc tells apart
+#define ALLOC_NODE_SAMPLES 4096 // most pages of each array reportAllocLoc asks the placement of
+
+// choices of policy set by setAllocPolicyLoc
+#define ALLOC_ALIGNED 0 // cache line aligned
+#define ALLOC_HUGE 1 // arrays of at least a huge page are also aligned to one and advised to be backed by huge pages
+
+// Choose the policy of the arrays allocated from now on (ALLOC_ALIGNED unless this is called)
+int setAllocPolicyLoc(int policy);
+
+// Allocate nBytes, aligned and first touched (zeroed) under the current policy, and keep track of it for
+// reportAllocLoc. Returns NULL if it couldn't.
+void *allocArrayLoc(size_t nBytes);
+
+// Free an array from allocArrayLoc (NULL is fine)
+void freeArrayLoc(void *ptr);
+
+// Number of elements of elemSize bytes to stride by for rows of n elements: a whole number of cache lines, and
+// an odd number of them, so consecutive rows (and planes, in 3D) start in different cache sets rather than
+// all aliasing onto the same few when n is a power of two
+unsigned int paddedStrideLoc(unsigned int n, size_t elemSize);
+
+// Have rank 0 print, for each rank of comm, its tracked arrays and bytes, how much of them are backed by huge
+// pages, the TLB entries needed to map them, and which NUMA nodes their pages are on
+int reportAllocLoc(MPI_Comm comm);
+#endif
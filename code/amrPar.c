@@ -0,0 +1,993 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "amrPar.h"
+#include "simulationPar.h"
+#include "materialPar.h"
+#include "checkPtPar.h"
+#include <mpi.h>
+
+#if defined(HEAT_FP64) || defined(HEAT_BF16) || defined(HEAT_FP16)
+#error "amrPar.c works on the states as float, so it is only built in the fp32 mode of precision.h"
+#endif
+
+// number of rows of [a, b] (global rows) that rank r owns, and the first of them in *first
+static int rowOverlapLoc(amrLoc *thisAmrLoc, int r, int a, int b, int *first)
+{
+	int lo = (a > thisAmrLoc->rowStarts[r]) ? a : thisAmrLoc->rowStarts[r];
+	int last = thisAmrLoc->rowStarts[r] + thisAmrLoc->rowCounts[r] - 1;
+	int hi = (b < last) ? b : last;
+	*first = lo;
+	return (hi >= lo) ? hi - lo + 1 : 0;
+};
+
+// monotonized central slope from the differences on either side
+static inline float limitedSlope(float left, float right)
+{
+	if (left * right <= 0.0)
+		return 0.0;
+	float central = 0.5 * (left + right);
+	float bound = 2.0 * ((fabsf(left) < fabsf(right)) ? fabsf(left) : fabsf(right));
+	if (fabsf(central) < bound)
+		return central;
+	return (central > 0) ? bound : -bound;
+};
+
+// value of the fine cell in quadrant (sx, sy) (each +1 or -1) of box cell (bi, bj), from a limited linear
+// reconstruction of component comp (0 = start of step, 1 = end of step). The 4 quadrants average to the cell.
+static float prolongLoc(const float *box, int boxWidth, int comp, int bi, int bj, int sx, int sy)
+{
+	float c = box[(bj * boxWidth + bi) * 2 + comp];
+	float w = box[(bj * boxWidth + bi - 1) * 2 + comp];
+	float e = box[(bj * boxWidth + bi + 1) * 2 + comp];
+	float s = box[((bj - 1) * boxWidth + bi) * 2 + comp];
+	float n = box[((bj + 1) * boxWidth + bi) * 2 + comp];
+	return c + 0.25 * sx * limitedSlope(c - w, e - c) + 0.25 * sy * limitedSlope(c - s, n - c);
+};
+
+// Send the coarse (oldLoc, newLoc) pairs (unpadded local states) of the box 2 cells around every patch
+// to the patch's owner, which keeps them in boxLoc
+static int gatherBoxesLoc(amrLoc *thisAmrLoc, float *oldLoc, float *newLoc)
+{
+	materialLoc *thisMaterialLoc = (thisAmrLoc->thisSimLoc)->thisMaterialLoc;
+	MPI_Comm comm = thisMaterialLoc->comm;
+	int rank, size;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	int Nx = thisMaterialLoc->Nx;
+	int myStart = thisMaterialLoc->startYId;
+	int *sendCounts = calloc(size, sizeof(int));
+	int *recvCounts = calloc(size, sizeof(int));
+	int *sendDispls = malloc(size * sizeof(int));
+	int *recvDispls = malloc(size * sizeof(int));
+	int p, r, j, bi, first, n;
+
+	// count what goes where (the patch list and row split are known everywhere)
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		int boxWidth = pt->ni + 4;
+		n = rowOverlapLoc(thisAmrLoc, rank, pt->j0 - 2, pt->j0 + pt->nj + 1, &first);
+		sendCounts[pt->owner] += 2 * boxWidth * n;
+		if (pt->owner == rank)
+		{
+			for (r = 0; r < size; ++r)
+				recvCounts[r] += 2 * boxWidth * rowOverlapLoc(thisAmrLoc, r, pt->j0 - 2, pt->j0 + pt->nj + 1, &first);
+		}
+	}
+	int nSend = 0, nRecv = 0;
+	for (r = 0; r < size; ++r)
+	{
+		sendDispls[r] = nSend;
+		recvDispls[r] = nRecv;
+		nSend += sendCounts[r];
+		nRecv += recvCounts[r];
+	}
+	float *sendBuf = malloc((nSend + 1) * sizeof(float));
+	float *recvBuf = malloc((nRecv + 1) * sizeof(float));
+
+	// pack, patch by patch, the rows of each box this rank has
+	int *pos = malloc(size * sizeof(int));
+	for (r = 0; r < size; ++r)
+		pos[r] = sendDispls[r];
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		int boxWidth = pt->ni + 4;
+		n = rowOverlapLoc(thisAmrLoc, rank, pt->j0 - 2, pt->j0 + pt->nj + 1, &first);
+		for (j = first; j < first + n; ++j)
+		{
+			for (bi = 0; bi < boxWidth; ++bi)
+			{
+				int idx = (j - myStart) * Nx + pt->i0 - 2 + bi;
+				sendBuf[pos[pt->owner]++] = oldLoc[idx];
+				sendBuf[pos[pt->owner]++] = newLoc[idx];
+			}
+		}
+	}
+	MPI_Alltoallv(sendBuf, sendCounts, sendDispls, MPI_FLOAT, recvBuf, recvCounts, recvDispls, MPI_FLOAT, comm);
+
+	// unpack into the boxes of the patches this rank owns
+	for (r = 0; r < size; ++r)
+	{
+		int k = recvDispls[r];
+		for (p = 0; p < thisAmrLoc->nPatches; ++p)
+		{
+			amrPatch *pt = &(thisAmrLoc->patches[p]);
+			if (pt->owner != rank)
+				continue;
+			int boxWidth = pt->ni + 4;
+			n = rowOverlapLoc(thisAmrLoc, r, pt->j0 - 2, pt->j0 + pt->nj + 1, &first);
+			for (j = first; j < first + n; ++j)
+			{
+				float *boxRow = thisAmrLoc->boxLoc[p] + 2 * boxWidth * (j - (pt->j0 - 2));
+				for (bi = 0; bi < 2 * boxWidth; ++bi)
+					boxRow[bi] = recvBuf[k++];
+			}
+		}
+	}
+
+	free(pos);
+	free(sendBuf);
+	free(recvBuf);
+	free(sendCounts);
+	free(recvCounts);
+	free(sendDispls);
+	free(recvDispls);
+	return 0;
+};
+
+// Send the corrections in deltaLoc of every patch to the ranks owning those coarse rows, which add
+// them to their priorStateLoc and currentStateLoc
+static int scatterDeltasLoc(amrLoc *thisAmrLoc)
+{
+	simLoc *thisSimLoc = thisAmrLoc->thisSimLoc;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	MPI_Comm comm = thisMaterialLoc->comm;
+	int rank, size;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	int Nx = thisMaterialLoc->Nx;
+	int myStart = thisMaterialLoc->startYId;
+	int nPadPts = thisMaterialLoc->nPadRows * Nx;
+	int *sendCounts = calloc(size, sizeof(int));
+	int *recvCounts = calloc(size, sizeof(int));
+	int *sendDispls = malloc(size * sizeof(int));
+	int *recvDispls = malloc(size * sizeof(int));
+	int p, r, j, di, first, n;
+
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		int deltaWidth = pt->ni + 2;
+		recvCounts[pt->owner] += deltaWidth * rowOverlapLoc(thisAmrLoc, rank, pt->j0 - 1, pt->j0 + pt->nj, &first);
+		if (pt->owner == rank)
+		{
+			for (r = 0; r < size; ++r)
+				sendCounts[r] += deltaWidth * rowOverlapLoc(thisAmrLoc, r, pt->j0 - 1, pt->j0 + pt->nj, &first);
+		}
+	}
+	int nSend = 0, nRecv = 0;
+	for (r = 0; r < size; ++r)
+	{
+		sendDispls[r] = nSend;
+		recvDispls[r] = nRecv;
+		nSend += sendCounts[r];
+		nRecv += recvCounts[r];
+	}
+	float *sendBuf = malloc((nSend + 1) * sizeof(float));
+	float *recvBuf = malloc((nRecv + 1) * sizeof(float));
+
+	// pack, for each destination, the rows it owns of each of this rank's patches
+	for (r = 0; r < size; ++r)
+	{
+		int k = sendDispls[r];
+		for (p = 0; p < thisAmrLoc->nPatches; ++p)
+		{
+			amrPatch *pt = &(thisAmrLoc->patches[p]);
+			if (pt->owner != rank)
+				continue;
+			int deltaWidth = pt->ni + 2;
+			n = rowOverlapLoc(thisAmrLoc, r, pt->j0 - 1, pt->j0 + pt->nj, &first);
+			for (j = first; j < first + n; ++j)
+			{
+				float *deltaRow = thisAmrLoc->deltaLoc[p] + deltaWidth * (j - (pt->j0 - 1));
+				for (di = 0; di < deltaWidth; ++di)
+					sendBuf[k++] = deltaRow[di];
+			}
+		}
+	}
+	MPI_Alltoallv(sendBuf, sendCounts, sendDispls, MPI_FLOAT, recvBuf, recvCounts, recvDispls, MPI_FLOAT, comm);
+
+	// add the corrections (patches never touch, so every coarse cell gets at most one restriction,
+	// and corrections from neighbouring patches simply add up)
+	int *pos = malloc(size * sizeof(int));
+	for (r = 0; r < size; ++r)
+		pos[r] = recvDispls[r];
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		int deltaWidth = pt->ni + 2;
+		n = rowOverlapLoc(thisAmrLoc, rank, pt->j0 - 1, pt->j0 + pt->nj, &first);
+		for (j = first; j < first + n; ++j)
+		{
+			for (di = 0; di < deltaWidth; ++di)
+			{
+				int idx = nPadPts + (j - myStart) * Nx + pt->i0 - 1 + di;
+				float delta = recvBuf[pos[pt->owner]++];
+				thisSimLoc->priorStateLoc[idx] += delta;
+				thisSimLoc->currentStateLoc[idx] = thisSimLoc->priorStateLoc[idx];
+			}
+		}
+	}
+
+	free(pos);
+	free(sendBuf);
+	free(recvBuf);
+	free(sendCounts);
+	free(recvCounts);
+	free(sendDispls);
+	free(recvDispls);
+	return 0;
+};
+
+// Take AMR_SUBSTEPS fine steps on patch p (owned by this rank), then fill in deltaLoc with the
+// restriction of the covered coarse cells and the refluxing corrections of the ring around them
+static void advancePatchLoc(amrLoc *thisAmrLoc, int p)
+{
+	simLoc *thisSimLoc = thisAmrLoc->thisSimLoc;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	amrPatch *pt = &(thisAmrLoc->patches[p]);
+	int ni = pt->ni, nj = pt->nj;
+	int fineWidth = 2 * ni + 2;
+	int boxWidth = ni + 4;
+	int deltaWidth = ni + 2;
+	float alpha = thisMaterialLoc->alpha;
+	float dx = thisMaterialLoc->dx;
+	float dy = thisMaterialLoc->dy;
+	float dt = thisSimLoc->dt;
+	float dxf = dx / AMR_RATIO;
+	float dyf = dy / AMR_RATIO;
+	float dtf = dt / AMR_SUBSTEPS;
+	float *box = thisAmrLoc->boxLoc[p];
+	float *delta = thisAmrLoc->deltaLoc[p];
+	int fi, fj, ci, cj, s;
+	for (fi = 0; fi < deltaWidth * (nj + 2); ++fi)
+		delta[fi] = 0.0;
+
+	for (s = 0; s < AMR_SUBSTEPS; ++s)
+	{
+		float *u = thisAmrLoc->fineLoc[p];
+		float *uNew = thisAmrLoc->fineNewLoc[p];
+		float theta = (float)s / AMR_SUBSTEPS;
+
+		// ghost ring from the coarse cells around the patch, interpolated in time
+		for (fj = 0; fj < 2 * nj; ++fj)
+		{
+			int bj = 2 + fj / 2;
+			int sy = (fj % 2) ? 1 : -1;
+			u[(fj + 1) * fineWidth] = (1 - theta) * prolongLoc(box, boxWidth, 0, 1, bj, 1, sy) + theta * prolongLoc(box, boxWidth, 1, 1, bj, 1, sy);
+			u[(fj + 1) * fineWidth + 2 * ni + 1] = (1 - theta) * prolongLoc(box, boxWidth, 0, ni + 2, bj, -1, sy) + theta * prolongLoc(box, boxWidth, 1, ni + 2, bj, -1, sy);
+		}
+		for (fi = 0; fi < 2 * ni; ++fi)
+		{
+			int bi = 2 + fi / 2;
+			int sx = (fi % 2) ? 1 : -1;
+			u[fi + 1] = (1 - theta) * prolongLoc(box, boxWidth, 0, bi, 1, sx, 1) + theta * prolongLoc(box, boxWidth, 1, bi, 1, sx, 1);
+			u[(2 * nj + 1) * fineWidth + fi + 1] = (1 - theta) * prolongLoc(box, boxWidth, 0, bi, nj + 2, sx, -1) + theta * prolongLoc(box, boxWidth, 1, bi, nj + 2, sx, -1);
+		}
+
+		// heat leaving the patch through its edges in this fine step, per coarse cell next to the edge
+		for (fj = 0; fj < 2 * nj; ++fj)
+		{
+			int row = (fj + 1) * fineWidth;
+			delta[(fj / 2 + 1) * deltaWidth] += 0.5 * dtf * alpha * (u[row + 1] - u[row]) / dxf / dx;
+			delta[(fj / 2 + 1) * deltaWidth + ni + 1] += 0.5 * dtf * alpha * (u[row + 2 * ni] - u[row + 2 * ni + 1]) / dxf / dx;
+		}
+		for (fi = 0; fi < 2 * ni; ++fi)
+		{
+			delta[fi / 2 + 1] += 0.5 * dtf * alpha * (u[fineWidth + fi + 1] - u[fi + 1]) / dyf / dy;
+			delta[(nj + 1) * deltaWidth + fi / 2 + 1] += 0.5 * dtf * alpha * (u[2 * nj * fineWidth + fi + 1] - u[(2 * nj + 1) * fineWidth + fi + 1]) / dyf / dy;
+		}
+
+		// forward Euler on the fine cells
+		for (fj = 1; fj <= 2 * nj; ++fj)
+		{
+			for (fi = 1; fi <= 2 * ni; ++fi)
+			{
+				int idx = fj * fineWidth + fi;
+				float dx2 = (u[idx - 1] - 2 * u[idx] + u[idx + 1]) * alpha / (dxf * dxf);
+				float dy2 = (u[idx - fineWidth] - 2 * u[idx] + u[idx + fineWidth]) * alpha / (dyf * dyf);
+				uNew[idx] = u[idx] + dtf * (dx2 + dy2);
+			}
+		}
+		thisAmrLoc->fineLoc[p] = uNew;
+		thisAmrLoc->fineNewLoc[p] = u;
+		thisAmrLoc->fineCellSteps += 4 * ni * nj;
+	}
+
+	// take out the heat the coarse step moved through the same faces
+	for (cj = 0; cj < nj; ++cj)
+	{
+		int bj = cj + 2;
+		delta[(cj + 1) * deltaWidth] -= dt * alpha * (box[(bj * boxWidth + 2) * 2] - box[(bj * boxWidth + 1) * 2]) / dx / dx;
+		delta[(cj + 1) * deltaWidth + ni + 1] -= dt * alpha * (box[(bj * boxWidth + ni + 1) * 2] - box[(bj * boxWidth + ni + 2) * 2]) / dx / dx;
+	}
+	for (ci = 0; ci < ni; ++ci)
+	{
+		int bi = ci + 2;
+		delta[ci + 1] -= dt * alpha * (box[(2 * boxWidth + bi) * 2] - box[(boxWidth + bi) * 2]) / dy / dy;
+		delta[(nj + 1) * deltaWidth + ci + 1] -= dt * alpha * (box[((nj + 1) * boxWidth + bi) * 2] - box[((nj + 2) * boxWidth + bi) * 2]) / dy / dy;
+	}
+
+	// covered coarse cells become the average of their fine cells
+	float *u = thisAmrLoc->fineLoc[p];
+	for (cj = 0; cj < nj; ++cj)
+	{
+		for (ci = 0; ci < ni; ++ci)
+		{
+			int f = (2 * cj + 1) * fineWidth + 2 * ci + 1;
+			float average = 0.25 * (u[f] + u[f + 1] + u[f + fineWidth] + u[f + fineWidth + 1]);
+			delta[(cj + 1) * deltaWidth + ci + 1] = average - box[((cj + 2) * boxWidth + ci + 2) * 2 + 1];
+		}
+	}
+};
+
+// make room for at least n patches, with the new pointers NULL
+static int growPatchesLoc(amrLoc *thisAmrLoc, int n)
+{
+	if (n <= thisAmrLoc->patchCapacity)
+		return 0;
+	int capacity = (2 * thisAmrLoc->patchCapacity > n) ? 2 * thisAmrLoc->patchCapacity : n;
+	amrPatch *newPatches = realloc(thisAmrLoc->patches, capacity * sizeof(amrPatch));
+	if (newPatches != NULL)
+		thisAmrLoc->patches = newPatches;
+	float ***arrays[4] = {&(thisAmrLoc->fineLoc), &(thisAmrLoc->fineNewLoc), &(thisAmrLoc->boxLoc), &(thisAmrLoc->deltaLoc)};
+	int a, p, fail = (newPatches == NULL);
+	for (a = 0; a < 4; ++a)
+	{
+		float **newArray = realloc(*(arrays[a]), capacity * sizeof(float *));
+		if (newArray == NULL)
+		{
+			fail = 1;
+			continue;
+		}
+		for (p = thisAmrLoc->patchCapacity; p < capacity; ++p)
+			newArray[p] = NULL;
+		*(arrays[a]) = newArray;
+	}
+	if (fail)
+	{
+		printf("WARNING: in growPatchesLoc, issue growing the patch list to %d patches \n", capacity);
+		return 1;
+	}
+	thisAmrLoc->patchCapacity = capacity;
+	return 0;
+};
+
+// add the bounding box of the flags in [iLo, iHi] x [jLo, jHi] (global rows, flags holding this rank's rows
+// from global row firstRow) as a patch, or split it at a row or column without flags and cluster the two halves
+static int clusterLoc(amrLoc *thisAmrLoc, const unsigned char *flagsLoc, int firstRow, int iLo, int jLo, int iHi, int jHi)
+{
+	int Nx = ((thisAmrLoc->thisSimLoc)->thisMaterialLoc)->Nx;
+	const unsigned char *flags = flagsLoc - (long)firstRow * Nx;
+	int i, j;
+
+	// shrink to the flagged cells
+	int bLoI = iHi + 1, bHiI = iLo - 1, bLoJ = jHi + 1, bHiJ = jLo - 1;
+	for (j = jLo; j <= jHi; ++j)
+	{
+		for (i = iLo; i <= iHi; ++i)
+		{
+			if (flags[(long)j * Nx + i])
+			{
+				if (i < bLoI) bLoI = i;
+				if (i > bHiI) bHiI = i;
+				if (j < bLoJ) bLoJ = j;
+				if (j > bHiJ) bHiJ = j;
+			}
+		}
+	}
+	if (bHiI < bLoI)
+		return 0;
+
+	// split at an empty column, then at an empty row
+	for (i = bLoI + 1; i < bHiI; ++i)
+	{
+		int count = 0;
+		for (j = bLoJ; j <= bHiJ; ++j)
+			count += flags[(long)j * Nx + i];
+		if (count == 0)
+			return clusterLoc(thisAmrLoc, flagsLoc, firstRow, bLoI, bLoJ, i - 1, bHiJ) + clusterLoc(thisAmrLoc, flagsLoc, firstRow, i + 1, bLoJ, bHiI, bHiJ);
+	}
+	for (j = bLoJ + 1; j < bHiJ; ++j)
+	{
+		int count = 0;
+		for (i = bLoI; i <= bHiI; ++i)
+			count += flags[(long)j * Nx + i];
+		if (count == 0)
+			return clusterLoc(thisAmrLoc, flagsLoc, firstRow, bLoI, bLoJ, bHiI, j - 1) + clusterLoc(thisAmrLoc, flagsLoc, firstRow, bLoI, j + 1, bHiI, bHiJ);
+	}
+
+	if (growPatchesLoc(thisAmrLoc, thisAmrLoc->nPatches + 1))
+		return 1;
+	amrPatch *pt = &(thisAmrLoc->patches[thisAmrLoc->nPatches]);
+	pt->i0 = bLoI;
+	pt->j0 = bLoJ;
+	pt->ni = bHiI - bLoI + 1;
+	pt->nj = bHiJ - bLoJ + 1;
+	pt->owner = 0;
+	thisAmrLoc->nPatches++;
+	return 0;
+};
+
+// nonzero if boxes a and b overlap or touch (aren't split by at least one row or column)
+static int touchingLoc(const amrPatch *a, const amrPatch *b)
+{
+	int apartI = (a->i0 + a->ni < b->i0) || (b->i0 + b->ni < a->i0);
+	int apartJ = (a->j0 + a->nj < b->j0) || (b->j0 + b->nj < a->j0);
+	return !(apartI || apartJ);
+};
+
+// pack (or unpack, if unpack is nonzero) the fine cells of fineOld (old patch o) that new patch q also
+// covers, into (or out of) buf starting at *pos, row by row
+static void copyOverlapLoc(amrLoc *thisAmrLoc, amrPatch *oldPt, float *fineOld, int q, float *buf, int *pos, int unpack)
+{
+	amrPatch *newPt = &(thisAmrLoc->patches[q]);
+	int iLo = (oldPt->i0 > newPt->i0) ? oldPt->i0 : newPt->i0;
+	int jLo = (oldPt->j0 > newPt->j0) ? oldPt->j0 : newPt->j0;
+	int iHi = ((oldPt->i0 + oldPt->ni) < (newPt->i0 + newPt->ni)) ? oldPt->i0 + oldPt->ni : newPt->i0 + newPt->ni;
+	int jHi = ((oldPt->j0 + oldPt->nj) < (newPt->j0 + newPt->nj)) ? oldPt->j0 + oldPt->nj : newPt->j0 + newPt->nj;
+	int fi, fj;
+	for (fj = 2 * jLo; fj < 2 * jHi; ++fj)
+	{
+		for (fi = 2 * iLo; fi < 2 * iHi; ++fi)
+		{
+			if (unpack)
+				thisAmrLoc->fineLoc[q][(fj - 2 * newPt->j0 + 1) * (2 * newPt->ni + 2) + fi - 2 * newPt->i0 + 1] = buf[(*pos)++];
+			else
+				buf[(*pos)++] = fineOld[(fj - 2 * oldPt->j0 + 1) * (2 * oldPt->ni + 2) + fi - 2 * oldPt->i0 + 1];
+		}
+	}
+};
+
+// number of fine cells old patch oldPt and new patch q both cover
+static int overlapCountLoc(amrLoc *thisAmrLoc, amrPatch *oldPt, int q)
+{
+	amrPatch *newPt = &(thisAmrLoc->patches[q]);
+	int iLo = (oldPt->i0 > newPt->i0) ? oldPt->i0 : newPt->i0;
+	int jLo = (oldPt->j0 > newPt->j0) ? oldPt->j0 : newPt->j0;
+	int iHi = ((oldPt->i0 + oldPt->ni) < (newPt->i0 + newPt->ni)) ? oldPt->i0 + oldPt->ni : newPt->i0 + newPt->ni;
+	int jHi = ((oldPt->j0 + oldPt->nj) < (newPt->j0 + newPt->nj)) ? oldPt->j0 + oldPt->nj : newPt->j0 + newPt->nj;
+	if ((iHi <= iLo) || (jHi <= jLo))
+		return 0;
+	return AMR_RATIO * AMR_RATIO * (iHi - iLo) * (jHi - jLo);
+};
+
+// Move the fine cells of the old patches (held in fineOld by their owners) into the new patches
+// wherever they overlap, so regridding only falls back on the coarse cells for newly refined areas
+static int transferFineLoc(amrLoc *thisAmrLoc, amrPatch *oldPatches, int nOld, float **fineOld)
+{
+	MPI_Comm comm = ((thisAmrLoc->thisSimLoc)->thisMaterialLoc)->comm;
+	int rank, size;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	int *sendCounts = calloc(size, sizeof(int));
+	int *recvCounts = calloc(size, sizeof(int));
+	int *sendDispls = malloc(size * sizeof(int));
+	int *recvDispls = malloc(size * sizeof(int));
+	int o, q, r;
+
+	for (o = 0; o < nOld; ++o)
+	{
+		for (q = 0; q < thisAmrLoc->nPatches; ++q)
+		{
+			int n = overlapCountLoc(thisAmrLoc, &oldPatches[o], q);
+			if (oldPatches[o].owner == rank)
+				sendCounts[thisAmrLoc->patches[q].owner] += n;
+			if (thisAmrLoc->patches[q].owner == rank)
+				recvCounts[oldPatches[o].owner] += n;
+		}
+	}
+	int nSend = 0, nRecv = 0;
+	for (r = 0; r < size; ++r)
+	{
+		sendDispls[r] = nSend;
+		recvDispls[r] = nRecv;
+		nSend += sendCounts[r];
+		nRecv += recvCounts[r];
+	}
+	float *sendBuf = malloc((nSend + 1) * sizeof(float));
+	float *recvBuf = malloc((nRecv + 1) * sizeof(float));
+
+	// both sides walk the (old, new) pairs in the same order
+	for (r = 0; r < size; ++r)
+	{
+		int pos = sendDispls[r];
+		for (o = 0; o < nOld; ++o)
+		{
+			if (oldPatches[o].owner != rank)
+				continue;
+			for (q = 0; q < thisAmrLoc->nPatches; ++q)
+			{
+				if (thisAmrLoc->patches[q].owner == r)
+					copyOverlapLoc(thisAmrLoc, &oldPatches[o], fineOld[o], q, sendBuf, &pos, 0);
+			}
+		}
+	}
+	MPI_Alltoallv(sendBuf, sendCounts, sendDispls, MPI_FLOAT, recvBuf, recvCounts, recvDispls, MPI_FLOAT, comm);
+	for (r = 0; r < size; ++r)
+	{
+		int pos = recvDispls[r];
+		for (o = 0; o < nOld; ++o)
+		{
+			if (oldPatches[o].owner != r)
+				continue;
+			for (q = 0; q < thisAmrLoc->nPatches; ++q)
+			{
+				if (thisAmrLoc->patches[q].owner == rank)
+					copyOverlapLoc(thisAmrLoc, &oldPatches[o], NULL, q, recvBuf, &pos, 1);
+			}
+		}
+	}
+
+	free(sendBuf);
+	free(recvBuf);
+	free(sendCounts);
+	free(recvCounts);
+	free(sendDispls);
+	free(recvDispls);
+	return 0;
+};
+
+// free the arrays of the current patches
+static void freePatchesLoc(amrLoc *thisAmrLoc)
+{
+	int p;
+	for (p = 0; p < thisAmrLoc->patchCapacity; ++p)
+	{
+		free(thisAmrLoc->fineLoc[p]);
+		thisAmrLoc->fineLoc[p] = NULL;
+		free(thisAmrLoc->fineNewLoc[p]);
+		thisAmrLoc->fineNewLoc[p] = NULL;
+		free(thisAmrLoc->boxLoc[p]);
+		thisAmrLoc->boxLoc[p] = NULL;
+		free(thisAmrLoc->deltaLoc[p]);
+		thisAmrLoc->deltaLoc[p] = NULL;
+	}
+};
+
+// Set up refinement for an already initialized local simulation and build the first patches
+int initAmrLoc(amrLoc *thisAmrLoc, simLoc *thisSimLoc, float gradTol, int bufferCells, int regridEvery)
+{
+	if (thisSimLoc->stencilOrder != 2)
+	{
+		printf("WARNING: in initAmrLoc, only the second order stencil is supported \n");
+		return 1;
+	}
+	if (thisSimLoc->lowMemory)
+	{
+		printf("WARNING: in initAmrLoc, the simulation can't be in low memory mode \n");
+		return 1;
+	}
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int size;
+	MPI_Comm_size(thisMaterialLoc->comm, &size);
+	thisAmrLoc->thisSimLoc = thisSimLoc;
+	thisAmrLoc->gradTol = gradTol;
+	thisAmrLoc->bufferCells = bufferCells;
+	thisAmrLoc->regridEvery = (regridEvery > 0) ? regridEvery : 1;
+	thisAmrLoc->nCoarseSteps = 0;
+	thisAmrLoc->nPatches = 0;
+	thisAmrLoc->patchCapacity = 0;
+	thisAmrLoc->patches = NULL;
+	thisAmrLoc->fineLoc = NULL;
+	thisAmrLoc->fineNewLoc = NULL;
+	thisAmrLoc->boxLoc = NULL;
+	thisAmrLoc->deltaLoc = NULL;
+	thisAmrLoc->fineCellSteps = 0;
+	if (thisSimLoc->integrator != INTEGRATOR_EULER)
+		printf("WARNING: in initAmrLoc, the coarse level must use forward Euler \n");
+
+	// row split of every rank, so every rank can work out who holds which coarse rows
+	thisAmrLoc->rowStarts = malloc(size * sizeof(int));
+	thisAmrLoc->rowCounts = malloc(size * sizeof(int));
+	int myStart = thisMaterialLoc->startYId;
+	int myCount = thisMaterialLoc->NyLocal;
+	MPI_Allgather(&myStart, 1, MPI_INT, thisAmrLoc->rowStarts, 1, MPI_INT, thisMaterialLoc->comm);
+	MPI_Allgather(&myCount, 1, MPI_INT, thisAmrLoc->rowCounts, 1, MPI_INT, thisMaterialLoc->comm);
+	thisAmrLoc->oldStateLoc = malloc(thisMaterialLoc->Nx * thisMaterialLoc->NyLocal * sizeof(float));
+	thisAmrLoc->flagsLoc = malloc(thisMaterialLoc->Nx * thisMaterialLoc->NyLocal * sizeof(unsigned char) + 1);
+	if ((thisAmrLoc->rowStarts == NULL) || (thisAmrLoc->rowCounts == NULL) || (thisAmrLoc->oldStateLoc == NULL) || (thisAmrLoc->flagsLoc == NULL) || growPatchesLoc(thisAmrLoc, 16))
+	{
+		printf("WARNING: in initAmrLoc, issue allocating work arrays \n");
+		return 1;
+	}
+	return regridAmrLoc(thisAmrLoc);
+};
+
+// Flag cells and build new patches from the current coarse state
+int regridAmrLoc(amrLoc *thisAmrLoc)
+{
+	int flag = 0;
+	simLoc *thisSimLoc = thisAmrLoc->thisSimLoc;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	MPI_Comm comm = thisMaterialLoc->comm;
+	int rank, size;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	int Nx = thisMaterialLoc->Nx;
+	int NyTotal = thisMaterialLoc->NyTotal;
+	int myStart = thisMaterialLoc->startYId;
+	int nPadPts = thisMaterialLoc->nPadRows * Nx;
+	float *u = thisSimLoc->priorStateLoc + nPadPts;
+	int i, j, p, r;
+
+	// flag this rank's cells (keeping 2 cells away from the boundary, so every patch has coarse cells around it)
+	flag += exchangeGhostRegions(thisSimLoc);
+	unsigned char *flagsLoc = thisAmrLoc->flagsLoc;
+	for (j = 0; j < thisMaterialLoc->NyLocal; ++j)
+	{
+		int globalRow = myStart + j;
+		for (i = 0; i < Nx; ++i)
+		{
+			int idx = j * Nx + i;
+			flagsLoc[idx] = 0;
+			if ((globalRow < 2) || (globalRow > NyTotal - 3) || (i < 2) || (i > Nx - 3))
+				continue;
+			float gx = 0.5 * fabsf(u[idx + 1] - u[idx - 1]);
+			float gy = 0.5 * fabsf(u[idx + Nx] - u[idx - Nx]);
+			flagsLoc[idx] = (gx > thisAmrLoc->gradTol) || (gy > thisAmrLoc->gradTol);
+		}
+	}
+
+	// keep the old patches' fine cells until they have been handed over to the new patches
+	int nOld = thisAmrLoc->nPatches;
+	amrPatch *oldPatches = malloc((nOld + 1) * sizeof(amrPatch));
+	float **fineOld = malloc((nOld + 1) * sizeof(float *));
+	if ((oldPatches == NULL) || (fineOld == NULL))
+	{
+		printf("WARNING: in regridAmrLoc, issue allocating the old patch list \n");
+		free(oldPatches);
+		free(fineOld);
+		return flag + 1;
+	}
+	for (p = 0; p < nOld; ++p)
+	{
+		oldPatches[p] = thisAmrLoc->patches[p];
+		fineOld[p] = thisAmrLoc->fineLoc[p];
+		thisAmrLoc->fineLoc[p] = NULL;
+	}
+	freePatchesLoc(thisAmrLoc);
+
+	// cluster this rank's flags into boxes and grow them by bufferCells
+	thisAmrLoc->nPatches = 0;
+	int b = thisAmrLoc->bufferCells;
+	if (thisMaterialLoc->NyLocal > 0)
+		flag += clusterLoc(thisAmrLoc, flagsLoc, myStart, 0, myStart, Nx - 1, myStart + thisMaterialLoc->NyLocal - 1);
+	int nMine = thisAmrLoc->nPatches;
+	int *mine = malloc((4 * nMine + 1) * sizeof(int));
+	for (p = 0; (p < nMine) && (mine != NULL); ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		int iLo = (pt->i0 - b > 2) ? pt->i0 - b : 2;
+		int jLo = (pt->j0 - b > 2) ? pt->j0 - b : 2;
+		int iHi = (pt->i0 + pt->ni - 1 + b < Nx - 3) ? pt->i0 + pt->ni - 1 + b : Nx - 3;
+		int jHi = (pt->j0 + pt->nj - 1 + b < NyTotal - 3) ? pt->j0 + pt->nj - 1 + b : NyTotal - 3;
+		mine[4 * p] = iLo;
+		mine[4 * p + 1] = jLo;
+		mine[4 * p + 2] = iHi - iLo + 1;
+		mine[4 * p + 3] = jHi - jLo + 1;
+	}
+
+	// gather every rank's boxes (only the boxes, not the flags)
+	int *counts = malloc(size * sizeof(int));
+	int *displs = malloc(size * sizeof(int));
+	int myCount = (mine != NULL) ? 4 * nMine : 0;
+	MPI_Allgather(&myCount, 1, MPI_INT, counts, 1, MPI_INT, comm);
+	int nAll = 0;
+	for (r = 0; r < size; ++r)
+	{
+		displs[r] = nAll;
+		nAll += counts[r];
+	}
+	int *all = malloc((nAll + 1) * sizeof(int));
+	MPI_Allgatherv(mine, myCount, MPI_INT, all, counts, displs, MPI_INT, comm);
+	nAll /= 4;
+	free(mine);
+	free(counts);
+	free(displs);
+
+	// every rank merges boxes that overlap or touch the same way, until all are split by a row or column
+	thisAmrLoc->nPatches = 0;
+	if (growPatchesLoc(thisAmrLoc, nAll))
+		nAll = 0;
+	for (p = 0; p < nAll; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		pt->i0 = all[4 * p];
+		pt->j0 = all[4 * p + 1];
+		pt->ni = all[4 * p + 2];
+		pt->nj = all[4 * p + 3];
+		pt->owner = 0;
+	}
+	free(all);
+	int merged = 1;
+	while (merged)
+	{
+		merged = 0;
+		for (p = 0; p < nAll; ++p)
+		{
+			int q;
+			for (q = p + 1; q < nAll; ++q)
+			{
+				amrPatch *a = &(thisAmrLoc->patches[p]);
+				amrPatch *c = &(thisAmrLoc->patches[q]);
+				if (!touchingLoc(a, c))
+					continue;
+				int iHi = (a->i0 + a->ni > c->i0 + c->ni) ? a->i0 + a->ni : c->i0 + c->ni;
+				int jHi = (a->j0 + a->nj > c->j0 + c->nj) ? a->j0 + a->nj : c->j0 + c->nj;
+				a->i0 = (a->i0 < c->i0) ? a->i0 : c->i0;
+				a->j0 = (a->j0 < c->j0) ? a->j0 : c->j0;
+				a->ni = iHi - a->i0;
+				a->nj = jHi - a->j0;
+				thisAmrLoc->patches[q] = thisAmrLoc->patches[nAll - 1];
+				--nAll;
+				--q;
+				merged = 1;
+			}
+		}
+	}
+	thisAmrLoc->nPatches = nAll;
+
+	// new patches, handed out largest first to the rank with the least work (strip cells + fine cell updates)
+	long *load = malloc(size * sizeof(long));
+	int *assigned = calloc(thisAmrLoc->nPatches + 1, sizeof(int));
+	for (r = 0; r < size; ++r)
+		load[r] = (long)thisAmrLoc->rowCounts[r] * Nx;
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		int best = -1, q;
+		for (q = 0; q < thisAmrLoc->nPatches; ++q)
+		{
+			if (assigned[q])
+				continue;
+			if ((best < 0) || (thisAmrLoc->patches[q].ni * thisAmrLoc->patches[q].nj > thisAmrLoc->patches[best].ni * thisAmrLoc->patches[best].nj))
+				best = q;
+		}
+		int target = 0;
+		for (r = 1; r < size; ++r)
+		{
+			if (load[r] < load[target])
+				target = r;
+		}
+		assigned[best] = 1;
+		thisAmrLoc->patches[best].owner = target;
+		load[target] += (long)AMR_RATIO * AMR_RATIO * AMR_SUBSTEPS * thisAmrLoc->patches[best].ni * thisAmrLoc->patches[best].nj;
+	}
+	free(load);
+	free(assigned);
+
+	// allocate the patches this rank owns and start the fine cells from the coarse ones
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		if (pt->owner != rank)
+			continue;
+		int fineSize = (2 * pt->ni + 2) * (2 * pt->nj + 2);
+		thisAmrLoc->fineLoc[p] = calloc(fineSize, sizeof(float));
+		thisAmrLoc->fineNewLoc[p] = calloc(fineSize, sizeof(float));
+		thisAmrLoc->boxLoc[p] = malloc(2 * (pt->ni + 4) * (pt->nj + 4) * sizeof(float));
+		thisAmrLoc->deltaLoc[p] = malloc((pt->ni + 2) * (pt->nj + 2) * sizeof(float));
+		if ((thisAmrLoc->fineLoc[p] == NULL) || (thisAmrLoc->fineNewLoc[p] == NULL) || (thisAmrLoc->boxLoc[p] == NULL) || (thisAmrLoc->deltaLoc[p] == NULL))
+		{
+			printf("WARNING: in regridAmrLoc, issue allocating patch %d \n", p);
+			flag = 1;
+		}
+	}
+	flag += gatherBoxesLoc(thisAmrLoc, u, u);
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		if (pt->owner != rank)
+			continue;
+		int fineWidth = 2 * pt->ni + 2;
+		int fi, fj;
+		for (fj = 0; fj < 2 * pt->nj; ++fj)
+		{
+			for (fi = 0; fi < 2 * pt->ni; ++fi)
+			{
+				thisAmrLoc->fineLoc[p][(fj + 1) * fineWidth + fi + 1] = prolongLoc(thisAmrLoc->boxLoc[p], pt->ni + 4, 1, 2 + fi / 2, 2 + fj / 2, (fi % 2) ? 1 : -1, (fj % 2) ? 1 : -1);
+			}
+		}
+	}
+
+	// but keep the fine cells of areas that were already refined
+	flag += transferFineLoc(thisAmrLoc, oldPatches, nOld, fineOld);
+	for (p = 0; p < nOld; ++p)
+		free(fineOld[p]);
+	free(fineOld);
+	free(oldPatches);
+	return flag;
+};
+
+// Move the coarse level and all patches forward by one coarse time step
+int oneStepAmrLoc(amrLoc *thisAmrLoc)
+{
+	int flag = 0;
+	simLoc *thisSimLoc = thisAmrLoc->thisSimLoc;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int rank, p, i;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	int nPadPts = thisMaterialLoc->nPadRows * thisMaterialLoc->Nx;
+	int nLocalPts = thisMaterialLoc->NyLocal * thisMaterialLoc->Nx;
+
+	// coarse step everywhere, keeping the state it started from
+	for (i = 0; i < nLocalPts; ++i)
+		thisAmrLoc->oldStateLoc[i] = thisSimLoc->priorStateLoc[nPadPts + i];
+	flag += oneStepLoc(thisSimLoc);
+
+	// fine steps on the patches, then restriction and refluxing on the coarse level
+	if (thisAmrLoc->nPatches > 0)
+	{
+		flag += gatherBoxesLoc(thisAmrLoc, thisAmrLoc->oldStateLoc, thisSimLoc->priorStateLoc + nPadPts);
+		for (p = 0; p < thisAmrLoc->nPatches; ++p)
+		{
+			if (thisAmrLoc->patches[p].owner == rank)
+				advancePatchLoc(thisAmrLoc, p);
+		}
+		flag += scatterDeltasLoc(thisAmrLoc);
+	}
+
+	thisAmrLoc->nCoarseSteps++;
+	if (thisAmrLoc->nCoarseSteps % thisAmrLoc->regridEvery == 0)
+		flag += regridAmrLoc(thisAmrLoc);
+	return flag;
+};
+
+// Same as runSimLoc, but with refinement. Initializes theseTimesLoc.
+int runSimAmrLoc(amrLoc *thisAmrLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc)
+{
+	int flag = 0; // return flag, 0 if no problem, but nonzero if there's a problem
+	simLoc *thisSimLoc = thisAmrLoc->thisSimLoc;
+
+	// do the initialization of the checkpointing struct
+	int nSnaps = calcNSnapsLoc(nSteps, stepsPerCheckPt);
+	int checkPtInitFlag = initCheckPtTimeLoc(theseTimesLoc, thisSimLoc->thisMaterialLoc, thisSimLoc, nSnaps);
+	if (checkPtInitFlag)
+	{
+		printf("WARNING: issue initializing checkpoint in runSimAmrLoc \n");
+		flag = checkPtInitFlag;
+	}
+
+	// check rank
+	int rank;
+	MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
+
+	// run through the steps
+	int step;
+	recordSnapLoc(theseTimesLoc); // always record 0th time step's prior state
+	for (step = 1; step < nSteps; ++step)
+	{
+		int stepFlag = oneStepAmrLoc(thisAmrLoc);
+		if (stepFlag)
+		{
+			printf("WARNING: issue in refined simulation at %d time step on rank %d \n", step, rank);
+			flag = stepFlag;
+		}
+		if (step % stepsPerCheckPt == 0)
+			recordSnapLoc(theseTimesLoc);
+	}
+	return flag;
+};
+
+// Number of fine cells over all patches
+int amrFineCount(amrLoc *thisAmrLoc)
+{
+	int p, count = 0;
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+		count += AMR_RATIO * AMR_RATIO * thisAmrLoc->patches[p].ni * thisAmrLoc->patches[p].nj;
+	return count;
+};
+
+// Collect the fine cells of every patch into fineGlobal on rank 0
+int gatherAmrLoc(amrLoc *thisAmrLoc, float *fineGlobal)
+{
+	MPI_Comm comm = ((thisAmrLoc->thisSimLoc)->thisMaterialLoc)->comm;
+	int rank, p;
+	MPI_Comm_rank(comm, &rank);
+	int offset = 0;
+	for (p = 0; p < thisAmrLoc->nPatches; ++p)
+	{
+		amrPatch *pt = &(thisAmrLoc->patches[p]);
+		int nFine = 4 * pt->ni * pt->nj;
+		int fineWidth = 2 * pt->ni + 2;
+		if (pt->owner == rank)
+		{
+			// copy out the interior of the patch, without its ghost ring
+			float *packed = (rank == 0) ? fineGlobal + offset : malloc(nFine * sizeof(float));
+			int fi, fj;
+			for (fj = 0; fj < 2 * pt->nj; ++fj)
+			{
+				for (fi = 0; fi < 2 * pt->ni; ++fi)
+					packed[fj * 2 * pt->ni + fi] = thisAmrLoc->fineLoc[p][(fj + 1) * fineWidth + fi + 1];
+			}
+			if (rank != 0)
+			{
+				MPI_Send(packed, nFine, MPI_FLOAT, 0, p, comm);
+				free(packed);
+			}
+		}
+		else if (rank == 0)
+		{
+			MPI_Recv(fineGlobal + offset, nFine, MPI_FLOAT, pt->owner, p, comm, MPI_STATUS_IGNORE);
+		}
+		offset += nFine;
+	}
+	return 0;
+};
+
+// Have rank 0 write the patch hierarchy to a file
+int writeAmrLoc(amrLoc *thisAmrLoc, const char *filename)
+{
+	int flag = 0;
+	simLoc *thisSimLoc = thisAmrLoc->thisSimLoc;
+	int rank;
+	MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
+	float *fineGlobal = NULL;
+	if (rank == 0)
+		fineGlobal = malloc((amrFineCount(thisAmrLoc) + 1) * sizeof(float));
+	flag += gatherAmrLoc(thisAmrLoc, fineGlobal);
+	if (rank == 0)
+	{
+		FILE *filePtr = fopen(filename, "w");
+		if (filePtr == NULL)
+		{
+			printf("ERROR in opening file in writeAmrLoc \n");
+			free(fineGlobal);
+			return flag + 1;
+		}
+		fprintf(filePtr, "%d\n", thisAmrLoc->nPatches);
+		fprintf(filePtr, "%f\n", (float)thisSimLoc->currentTimeIdx * thisSimLoc->dt);
+		int p, k, offset = 0;
+		for (p = 0; p < thisAmrLoc->nPatches; ++p)
+		{
+			amrPatch *pt = &(thisAmrLoc->patches[p]);
+			fprintf(filePtr, "%d , %d , %d , %d ,", pt->i0, pt->j0, pt->ni, pt->nj);
+			for (k = 0; k < 4 * pt->ni * pt->nj; ++k)
+				fprintf(filePtr, " %f ,", fineGlobal[offset + k]);
+			fprintf(filePtr, "\n");
+			offset += 4 * pt->ni * pt->nj;
+		}
+		fclose(filePtr);
+		free(fineGlobal);
+	}
+	return flag;
+};
+
+// deallocate the patches and work arrays
+int cleanupAmrLoc(amrLoc *thisAmrLoc)
+{
+	freePatchesLoc(thisAmrLoc);
+	thisAmrLoc->nPatches = 0;
+	free(thisAmrLoc->oldStateLoc);
+	thisAmrLoc->oldStateLoc = NULL;
+	free(thisAmrLoc->flagsLoc);
+	thisAmrLoc->flagsLoc = NULL;
+	free(thisAmrLoc->patches);
+	thisAmrLoc->patches = NULL;
+	free(thisAmrLoc->fineLoc);
+	thisAmrLoc->fineLoc = NULL;
+	free(thisAmrLoc->fineNewLoc);
+	thisAmrLoc->fineNewLoc = NULL;
+	free(thisAmrLoc->boxLoc);
+	thisAmrLoc->boxLoc = NULL;
+	free(thisAmrLoc->deltaLoc);
+	thisAmrLoc->deltaLoc = NULL;
+	thisAmrLoc->patchCapacity = 0;
+	free(thisAmrLoc->rowStarts);
+	thisAmrLoc->rowStarts = NULL;
+	free(thisAmrLoc->rowCounts);
+	thisAmrLoc->rowCounts = NULL;
+	return 0;
+};
@@ -0,0 +1,85 @@
+#ifndef __AMRPAR_H__
+#define __AMRPAR_H__
+#include <mpi.h>
+
+// forward declarations of structs an amrLoc will have pointers to
+typedef struct simLoc_struct simLoc;
+typedef struct checkPtTimeLoc_struct checkPtTimeLoc;
+
+#define AMR_RATIO 2 // fine cells per coarse cell in each direction
+#define AMR_SUBSTEPS 4 // fine time steps per coarse step (the stable step shrinks by AMR_RATIO^2)
+
+// a rectangle of coarse cells that is refined
+typedef struct amrPatch_struct{
+	int i0; // first coarse column covered
+	int j0; // first global coarse row covered
+	int ni; // number of coarse columns covered
+	int nj; // number of coarse rows covered
+	int owner; // rank that holds and advances the fine cells of this patch
+} amrPatch;
+
+typedef struct amrLoc_struct{
+	// One level of refinement on top of the usual row strips. Each grid point is read as the center
+	// of a dx x dy cell; each rank flags its cells where the temperature changes by more than gradTol per
+	// cell and clusters them into boxes (split at rows/columns without flags). Only the boxes, grown by
+	// bufferCells, are gathered, and every rank merges the ones that overlap or touch into patches, so
+	// patches never touch. Each patch is split 2:1 into fine cells and advanced AMR_SUBSTEPS times per coarse
+	// step by its owner. Fine ghost cells come from a limited, conservative linear reconstruction of the
+	// coarse cells, interpolated in time. After the fine steps the covered coarse cells take the average
+	// of their fine cells, and the coarse cells next to a patch get the difference between the fine and
+	// coarse fluxes through their shared faces (refluxing), so no heat is gained or lost at the interface.
+	// The patch list is the same on every rank; patches are given to ranks greedily by work.
+	simLoc *thisSimLoc; // coarse level (an already initialized local simulation using forward Euler)
+	float gradTol; // flag cells where half the difference across them is above this
+	int bufferCells; // flagged region is grown by this many cells in every direction
+	int regridEvery; // build new patches every this many coarse steps
+	int nCoarseSteps; // coarse steps taken so far
+	int nPatches; // number of patches
+	int patchCapacity; // number of patches the arrays below have room for (they grow as needed)
+	amrPatch *patches; // all patches (same on every rank)
+
+	// for the patches this rank owns (NULL for the others)
+	float **fineLoc; // fine cells with a ghost ring ((2 nj + 2) x (2 ni + 2))
+	float **fineNewLoc; // fine cells after a fine step
+	float **boxLoc; // coarse (start of step, end of step) pairs around the patch ((nj + 4) x (ni + 4) x 2)
+	float **deltaLoc; // corrections to the coarse cells of the patch and the ring around it ((nj + 2) x (ni + 2))
+
+	float *oldStateLoc; // unpadded coarse state at the start of the step
+	unsigned char *flagsLoc; // flagged coarse cells of this rank's rows (NyLocal x Nx)
+	int *rowStarts; // first global row of each rank
+	int *rowCounts; // number of rows of each rank
+	long fineCellSteps; // fine cell updates done by this rank
+} amrLoc;
+
+// Set up refinement for an already initialized local simulation and build the first patches
+int initAmrLoc(amrLoc *thisAmrLoc, simLoc *thisSimLoc, float gradTol, int bufferCells, int regridEvery);
+
+// Flag cells and build new patches from the current coarse state. Fine cells already refined are carried
+// over from the old patches; newly refined ones start from the coarse cells.
+int regridAmrLoc(amrLoc *thisAmrLoc);
+
+// Move the coarse level and all patches forward by one coarse time step (regridding when it's due)
+int oneStepAmrLoc(amrLoc *thisAmrLoc);
+
+// Same as runSimLoc, but with refinement. Initializes theseTimesLoc, whose snapshots hold the coarse level
+// (covered cells hold the average of their fine cells).
+int runSimAmrLoc(amrLoc *thisAmrLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc);
+
+// Number of fine cells over all patches
+int amrFineCount(amrLoc *thisAmrLoc);
+
+// Collect the fine cells of every patch, patch after patch, each row by row (2 ni x 2 nj values),
+// into fineGlobal (amrFineCount values) on rank 0
+int gatherAmrLoc(amrLoc *thisAmrLoc, float *fineGlobal);
+
+// Have rank 0 write the patch hierarchy to a file. Data will be in form:
+// nPatches
+// time
+// i0 , j0 , ni , nj , all, fine, cells, of, first, patch, row, by, row
+// i0 , j0 , ni , nj , all, fine, cells, of, second, patch, row, by, row
+// etc...
+int writeAmrLoc(amrLoc *thisAmrLoc, const char *filename);
+
+// deallocate the patches and work arrays
+int cleanupAmrLoc(amrLoc *thisAmrLoc);
+#endif
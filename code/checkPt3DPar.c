@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "checkPt3DPar.h"
+#include "material3DPar.h"
+#include "simulation3DPar.h"
+#include "allocPar.h"
+#include <mpi.h>
+
+// Number of snapshots taken in nSteps time steps (counting the 0th) with one every stepsPerCheckPt steps
+int calcNSnaps3DLoc(int nSteps, int stepsPerCheckPt){
+	if(nSteps % stepsPerCheckPt == 0){
+		return nSteps/stepsPerCheckPt;
+	}
+	else{
+		return 1+(nSteps/stepsPerCheckPt);
+	}
+};
+
+// initialize the space for times and stateSnapshotsLoc
+int initCheckPtTime3DLoc(checkPtTime3DLoc *thisCheckPtLoc, material3DLoc *thisMaterial3DLoc, sim3DLoc *thisSim3DLoc, int nSnaps){
+	thisCheckPtLoc->nSnaps = nSnaps;
+	thisCheckPtLoc->times = (float *)malloc(nSnaps*sizeof(float));
+	thisCheckPtLoc->currentSnapIdx = 0;
+	thisCheckPtLoc->thisMaterial3DLoc = thisMaterial3DLoc;
+	thisCheckPtLoc->thisSim3DLoc = thisSim3DLoc;
+	long nSpacePts = (long)thisMaterial3DLoc->NxLocal * thisMaterial3DLoc->NyLocal * thisMaterial3DLoc->NzLocal;
+	thisCheckPtLoc->stateSnapshotsLoc = (real_t *)allocArrayLoc(nSnaps*nSpacePts*sizeof(real_t));
+
+	int flag = 0;
+	if((thisCheckPtLoc->times == NULL) || (thisCheckPtLoc->stateSnapshotsLoc == NULL)){
+		printf("WARNING: in initCheckPtTime3DLoc, issue initializing local snapshot or time arrays \n");
+		flag = 1;
+	}
+	return flag;
+};
+
+// record the current snapshot of this local block (the unpadded part of the prior state)
+int recordSnap3DLoc(checkPtTime3DLoc *thisCheckPtLoc){
+	if((thisCheckPtLoc->times == NULL) || (thisCheckPtLoc->stateSnapshotsLoc == NULL)){
+		printf("WARNING: recordSnap3DLoc was called on a check point with uninitialized arrays \n");
+		return 1;
+	}
+	material3DLoc *thisMaterial = thisCheckPtLoc->thisMaterial3DLoc;
+	sim3DLoc *thisSim = thisCheckPtLoc->thisSim3DLoc;
+	int currentId = thisCheckPtLoc->currentSnapIdx;
+	thisCheckPtLoc->times[currentId] = (float)(thisSim->currentTimeIdx) * thisSim->dt;
+
+	unsigned int nxl = thisMaterial->NxLocal, nyl = thisMaterial->NyLocal, nzl = thisMaterial->NzLocal;
+	unsigned int nxp = thisMaterial->NxPadded, nyp = thisMaterial->NyPadded, nPad = thisMaterial->nPad;
+	real_t *start = thisCheckPtLoc->stateSnapshotsLoc + (long)nxl*nyl*nzl*currentId;
+	unsigned int x, y, z;
+	for(z=0; z<nzl; ++z){
+		for(y=0; y<nyl; ++y){
+			const real_t *row = thisSim->priorStateLoc + nPad + (long)nxp*((y + nPad) + (long)nyp*(z + nPad));
+			for(x=0; x<nxl; ++x){
+				start[x + (long)nxl*(y + (long)nyl*z)] = row[x];
+			}
+		}
+	}
+	thisCheckPtLoc->currentSnapIdx = currentId + 1;
+	return 0;
+};
+
+// Have rank 0 collect every block and write all snapshots to filename
+int writeToFile3DLoc(checkPtTime3DLoc *thisCheckPtLoc, const char *filename){
+	int flag = 0;
+	int root = 0;
+	material3DLoc *thisMaterial = thisCheckPtLoc->thisMaterial3DLoc;
+	int rank, size;
+	MPI_Comm_rank(thisMaterial->cartComm, &rank);
+	MPI_Comm_size(thisMaterial->cartComm, &size);
+	int nSnaps = thisCheckPtLoc->nSnaps;
+	long nLocalPts = (long)thisMaterial->NxLocal * thisMaterial->NyLocal * thisMaterial->NzLocal;
+
+	// every block's position in the global grid
+	int myBlock[6] = {thisMaterial->NxLocal, thisMaterial->NyLocal, thisMaterial->NzLocal, thisMaterial->startXId, thisMaterial->startYId, thisMaterial->startZId};
+	int *blocks = (int *)malloc(6*size*sizeof(int));
+	MPI_Gather(myBlock, 6, MPI_INT, blocks, 6, MPI_INT, root, thisMaterial->cartComm);
+	int snap;
+	if(rank != root){
+		// one message per snapshot, so the count is a block's points rather than all snapshots' (which can pass INT_MAX)
+		for(snap=0; snap<nSnaps; ++snap){
+			flag += MPI_Send(thisCheckPtLoc->stateSnapshotsLoc + snap*nLocalPts, (int)nLocalPts, MPI_REAL_T, root, 0, thisMaterial->cartComm);
+		}
+		free(blocks);
+		return flag;
+	}
+
+	MPI_Status status;
+	unsigned int Nx = thisMaterial->Nx, Ny = thisMaterial->Ny, Nz = thisMaterial->Nz;
+	long nSpacePts = (long)Nx*Ny*Nz;
+	real_t *totalSnapshots = (real_t *)allocArrayLoc(nSnaps*nSpacePts*sizeof(real_t));
+	if(totalSnapshots == NULL){
+		printf("ERROR in allocating the global snapshots in writeToFile3DLoc \n");
+		free(blocks);
+		return flag + 1;
+	}
+
+	// receive each block into place, a snapshot at a time: a subarray of one global snapshot
+	int sizes[3] = {Nz, Ny, Nx};
+	int r;
+	for(r=1; r<size; ++r){
+		int *blk = &(blocks[6*r]);
+		int subsizes[3] = {blk[2], blk[1], blk[0]};
+		int starts[3] = {blk[5], blk[4], blk[3]};
+		MPI_Datatype blockType;
+		MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_REAL_T, &blockType);
+		MPI_Type_commit(&blockType);
+		for(snap=0; snap<nSnaps; ++snap){
+			flag += MPI_Recv(totalSnapshots + snap*nSpacePts, 1, blockType, r, 0, thisMaterial->cartComm, &status);
+		}
+		MPI_Type_free(&blockType);
+	}
+
+	// root's own block
+	unsigned int x, y, z;
+	for(snap=0; snap<nSnaps; ++snap){
+		for(z=0; z<thisMaterial->NzLocal; ++z){
+			for(y=0; y<thisMaterial->NyLocal; ++y){
+				for(x=0; x<thisMaterial->NxLocal; ++x){
+					long globalIdx = (thisMaterial->startXId + x) + (long)Nx*((thisMaterial->startYId + y) + (long)Ny*(thisMaterial->startZId + z));
+					totalSnapshots[snap*nSpacePts + globalIdx] = thisCheckPtLoc->stateSnapshotsLoc[snap*nLocalPts + x + (long)thisMaterial->NxLocal*(y + (long)thisMaterial->NyLocal*z)];
+				}
+			}
+		}
+	}
+	free(blocks);
+	blocks = NULL;
+
+	FILE *filePtr = fopen(filename, "w");
+	if(filePtr == NULL){
+		printf("ERROR in opening file in writeToFile3DLoc \n");
+		free(totalSnapshots);
+		return flag + 1;
+	}
+	fprintf(filePtr, "%d\n", Nx);
+	fprintf(filePtr, "%d\n", Ny);
+	fprintf(filePtr, "%d\n", Nz);
+	fprintf(filePtr, "%d\n", nSnaps);
+#ifndef REAL_IS_FLOAT
+	fprintf(filePtr, "%s\n", REAL_DTYPE);
+#endif
+	long k;
+	for(snap=0; snap<nSnaps; ++snap){
+		fprintf(filePtr, "%f ,", thisCheckPtLoc->times[snap]);
+		for(k=0; k<nSpacePts; ++k){
+			fprintf(filePtr, REAL_FMT, (double)loadReal(totalSnapshots[k + snap*nSpacePts]));
+		}
+		fprintf(filePtr, "\n");
+	}
+	fclose(filePtr);
+	free(totalSnapshots);
+	totalSnapshots = NULL;
+	return flag;
+};
+
+// cleanup space allocated for times and stateSnapshotsLoc
+int cleanupCheckPtTime3DLoc(checkPtTime3DLoc *thisCheckPtLoc){
+	free(thisCheckPtLoc->times);
+	thisCheckPtLoc->times = NULL;
+	freeArrayLoc(thisCheckPtLoc->stateSnapshotsLoc);
+	thisCheckPtLoc->stateSnapshotsLoc = NULL;
+	return 0;
+};
@@ -0,0 +1,41 @@
+#ifndef __CHECKPT3DPAR_H__
+#define __CHECKPT3DPAR_H__
+#include "precision.h"
+
+// forward declarations of structs a checkPtTime3D will have pointers to
+typedef struct sim3DLoc_struct sim3DLoc;
+typedef struct material3DLoc_struct material3DLoc;
+
+typedef struct checkPtTime3DLoc_struct{
+	material3DLoc *thisMaterial3DLoc; // pointer to an already initialized local block of the 3D material
+	sim3DLoc *thisSim3DLoc; // pointer to an already initialized local block of the 3D simulation
+	int nSnaps; // number of snapshots to record
+	int currentSnapIdx; // index of the current snapshot (within times and stateSnapshotsLoc)
+	float *times; // record times (in seconds) of each snapshot (nSnaps entries)
+	real_t *stateSnapshotsLoc; // local snapshots (nSnaps x NzLocal x NyLocal x NxLocal, x fastest), in the storage type
+} checkPtTime3DLoc;
+
+// Number of snapshots taken in nSteps time steps (counting the 0th) with one every stepsPerCheckPt steps
+int calcNSnaps3DLoc(int nSteps, int stepsPerCheckPt);
+
+// initialize the space for times and stateSnapshotsLoc (note: assumes thisMaterial3DLoc already initialized)
+int initCheckPtTime3DLoc(checkPtTime3DLoc *thisCheckPtLoc, material3DLoc *thisMaterial3DLoc, sim3DLoc *thisSim3DLoc, int nSnaps);
+
+// record the current snapshot of this local block
+int recordSnap3DLoc(checkPtTime3DLoc *thisCheckPtLoc);
+
+// Have rank 0 collect every block (each rank sends all its snapshots in one message, which rank 0 receives
+// straight into place with a subarray datatype) and write all snapshots to filename. Data will be in form:
+// Nx
+// Ny
+// Nz
+// nSnaps
+// 1stSnapTime, all, entries, of, first, snapshot, with, x, fastest, then, y, then, z
+// 2ndSnapTime, all, entries, of, second, snapshot, ...
+// etc...
+// As for writeToFileLoc, a line naming the storage type follows nSnaps unless the engine stores fp32.
+int writeToFile3DLoc(checkPtTime3DLoc *thisCheckPtLoc, const char *filename);
+
+// cleanup space allocated for times and stateSnapshotsLoc
+int cleanupCheckPtTime3DLoc(checkPtTime3DLoc *thisCheckPtLoc);
+#endif
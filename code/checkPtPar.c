@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include "checkPtPar.h"
 #include "materialPar.h"
 #include "simulationPar.h"
+#include "allocPar.h"
 #include <mpi.h>
 
 
@@ -14,7 +17,7 @@ int initCheckPtTimeLoc(checkPtTimeLoc *thisCheckPtLoc, materialLoc *thisMaterial
 	thisCheckPtLoc->currentSnapIdx = 0; // start out on the 0th snapshot
 	thisCheckPtLoc->thisMaterialLoc = thisMaterialLoc; // set a pointer to this material so you can always grab number of points in space
 	int nSpacePts = thisMaterialLoc->Nx * thisMaterialLoc->NyLocal; // number of points in space per local snapshot
-	thisCheckPtLoc->stateSnapshotsLoc = (float *)malloc(nSnaps*nSpacePts*sizeof(float)); 
+	thisCheckPtLoc->stateSnapshotsLoc = (real_t *)allocArrayLoc((size_t)nSnaps*nSpacePts*sizeof(real_t)); 
 	thisCheckPtLoc->thisSimLoc = thisSimLoc; // set a pointer to this local part of simulation os you can always get access to the simulation's current state and time
 
 	int flag = 0;
@@ -53,11 +56,11 @@ int recordSnapLoc(checkPtTimeLoc *thisCheckPtLoc){
 	// --------record the current snapshot of the temperature field---------
 	// get a pointer to the beginning of the part of the local state array for this simulation where you'll start recording (nPadRows * # of columns after start)
 	int nPadEntries = (thisCheckPtLoc->thisMaterialLoc)->Nx * (thisCheckPtLoc->thisMaterialLoc)->nPadRows; // number of entries to ignore at start of local padded state array 
-	float *currentSnapshotLoc = (thisCheckPtLoc->thisSimLoc)->priorStateLoc + nPadEntries; // pointer to the local current state in the simulation
+	real_t *currentSnapshotLoc = (thisCheckPtLoc->thisSimLoc)->priorStateLoc + nPadEntries; // pointer to the local current state in the simulation
     // get a pointer to the beginning of the overall local state snapshots where to record this local snapshot
 	int nSpacePts = (thisCheckPtLoc->thisMaterialLoc)->Nx * (thisCheckPtLoc->thisMaterialLoc)->NyLocal; // number of points in space per local snapshot
 	int startID = nSpacePts * currentId; // current index within stateSnapshots to start
-	float *start = thisCheckPtLoc->stateSnapshotsLoc + startID; // beginning of the current snapshot in thisCheckPt
+	real_t *start = thisCheckPtLoc->stateSnapshotsLoc + startID; // beginning of the current snapshot in thisCheckPt
 	// actually copy entries of the current temperature field form the simulation to the checkPtTime's array
 	int i;
 	for(i=0; i<nSpacePts; ++i){
@@ -70,8 +73,66 @@ int recordSnapLoc(checkPtTimeLoc *thisCheckPtLoc){
 	return flag;
 };
 
-// Have rank 0 write all snapshots to a file at end of simulation (file named as filename). 
-// Data will be in form:
+// write val the way printf("%f") does into out (with no terminating null), returning the number of characters.
+// A float times 1e6 is exact in a double, and llrint rounds half to even as glibc's printf does, so the
+// digits are exactly printf's without going through its general conversion.
+static inline int formatFixedLoc(char *out, float val){
+    double scaled = (double)val * 1e6;
+    if(!(fabs(scaled) < 9.0e18)) return snprintf(out, TEXT_ENTRY_MAX, "%f", val); // infinities, nans and values too big for the integer
+    long long digits = llrint(scaled);
+    unsigned long long mag = (digits < 0) ? -digits : digits;
+    unsigned long long whole = mag / 1000000, frac = mag % 1000000;
+    char *p = out;
+    if(signbit(val)) *p++ = '-'; // printf keeps the sign of negatives that round to 0
+    char rev[24];
+    int k = 0;
+    do{
+        rev[k++] = '0' + (whole % 10);
+        whole /= 10;
+    }while(whole);
+    while(k) *p++ = rev[--k];
+    *p++ = '.';
+    for(k=5; k>=0; --k){
+        p[k] = '0' + (frac % 10);
+        frac /= 10;
+    }
+    return (p + 6) - out;
+};
+
+// write one entry of a snapshot line (REAL_FMT) into out, returning the number of characters
+static inline int formatEntryLoc(char *out, real_t val){
+#if defined(HEAT_FP64)
+    return snprintf(out, TEXT_ENTRY_MAX, REAL_FMT, (double)loadReal(val));
+#else
+    out[0] = ' ';
+    int len = 1 + formatFixedLoc(out + 1, loadReal(val));
+    out[len] = ' ';
+    out[len + 1] = ',';
+    return len + 2;
+#endif
+};
+
+// number of characters formatEntryLoc writes for val, worked out without formatting it
+static inline int entryLenLoc(real_t val){
+#if defined(HEAT_FP64)
+    return snprintf(NULL, 0, REAL_FMT, (double)loadReal(val));
+#else
+    float f = loadReal(val);
+    double scaled = (double)f * 1e6;
+    if(!(fabs(scaled) < 9.0e18)) return 3 + snprintf(NULL, 0, "%f", f);
+    long long digits = llrint(scaled);
+    unsigned long long whole = ((digits < 0) ? -digits : digits) / 1000000;
+    int len = 1 + (signbit(f) ? 1 : 0) + 7 + 2; // leading space, sign, '.' and 6 decimals, " ,"
+    do{
+        ++len;
+        whole /= 10;
+    }while(whole);
+    return len;
+#endif
+};
+
+// Write all snapshots to a file at end of simulation (file named as filename), each rank formatting its own rows
+// and writing them in place. Data will be in form:
 // Nx
 // Ny
 // nSnaps
@@ -80,101 +141,307 @@ int recordSnapLoc(checkPtTimeLoc *thisCheckPtLoc){
 // etc...
 int writeToFileLoc(checkPtTimeLoc *thisCheckPtLoc, const char *filename){
     int flag = 0;
-    int root = 0; // root rank to do the writing
-    // check rank and number of processes
+    materialLoc *thisMaterialLoc = thisCheckPtLoc->thisMaterialLoc;
+    MPI_Comm comm = thisMaterialLoc->comm;
     int rank, size;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int Nx = thisMaterialLoc->Nx;
+    int NyLocal = thisMaterialLoc->NyLocal;
+    int nSnaps = thisCheckPtLoc->nSnaps;
+    long nLocalPts = (long)Nx * NyLocal;
 
-    
-    // create array with all receive counts and starting indices to be used in gatherv calls
+    // the header (rank 0 writes it, everyone needs its length)
+    char header[128];
+#ifndef REAL_IS_FLOAT
+    int headerLen = snprintf(header, 128, "%d\n%d\n%d\n%s\n", Nx, thisMaterialLoc->NyTotal, nSnaps, REAL_DTYPE);
+#else
+    int headerLen = snprintf(header, 128, "%d\n%d\n%d\n", Nx, thisMaterialLoc->NyTotal, nSnaps);
+#endif
+
+    MPI_File fileHandle;
+    if(MPI_File_open(comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fileHandle) != MPI_SUCCESS){
+        printf("ERROR in opening file in writeToFile \n");
+        return 1;
+    }
+    MPI_File_set_size(fileHandle, 0);
+    if(rank == 0) flag += (MPI_File_write_at(fileHandle, 0, header, headerLen, MPI_CHAR, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+
+    // the rows are formatted and written TEXT_BLOCK_PTS entries (whole rows, at least one) at a time, and
+    // every rank takes part in the same number of collective writes
+    int blockRows = (Nx < TEXT_BLOCK_PTS) ? TEXT_BLOCK_PTS / Nx : 1;
+    int myBlocks = (NyLocal + blockRows - 1) / blockRows;
+    if(myBlocks < 1) myBlocks = 1;
+    int nBlocks;
+    MPI_Allreduce(&myBlocks, &nBlocks, 1, MPI_INT, MPI_MAX, comm);
+    char *text = (char *)malloc((long)blockRows * Nx * TEXT_ENTRY_MAX + 3 * TEXT_ENTRY_MAX + 1);
+    long long *lens = (long long *)malloc(size * sizeof(long long));
+    if((text == NULL) || (lens == NULL)){
+        printf("WARNING: in writeToFileLoc, issue allocating the text buffer \n");
+        flag += 1;
+    }
+    int allocFlag;
+    MPI_Allreduce(&flag, &allocFlag, 1, MPI_INT, MPI_MAX, comm);
+    MPI_Offset lineStart = headerLen;
+    int snap, b;
+    long k;
+    for(snap=0; (snap<nSnaps) && (allocFlag == 0); ++snap){
+        // this rank's part of the line: the time first on rank 0, the entries of its rows, and the newline on the last rank
+        char timeText[TEXT_ENTRY_MAX + 2];
+        int timeLen = 0;
+        if(rank == 0){
+            timeLen = formatFixedLoc(timeText, thisCheckPtLoc->times[snap]);
+            timeText[timeLen++] = ' ';
+            timeText[timeLen++] = ',';
+        }
+        const real_t *snapLoc = thisCheckPtLoc->stateSnapshotsLoc + nLocalPts * snap;
+        long long len = timeLen + ((rank == size - 1) ? 1 : 0);
+        for(k=0; k<nLocalPts; ++k){
+            len += entryLenLoc(snapLoc[k]);
+        }
+
+        // every rank's length gives both this rank's offset in the line and where the next line starts
+        MPI_Allgather(&len, 1, MPI_LONG_LONG, lens, 1, MPI_LONG_LONG, comm);
+        MPI_Offset offset = lineStart;
+        int r;
+        for(r=0; r<rank; ++r) offset += lens[r];
+        for(r=0; r<size; ++r) lineStart += lens[r];
+
+        for(b=0; b<nBlocks; ++b){
+            char *p = text;
+            if(b < myBlocks){
+                if(b == 0){
+                    memcpy(p, timeText, timeLen);
+                    p += timeLen;
+                }
+                long first = (long)b * blockRows * Nx;
+                long last = first + (long)blockRows * Nx;
+                if(last > nLocalPts) last = nLocalPts;
+                for(k=first; k<last; ++k){
+                    p += formatEntryLoc(p, snapLoc[k]);
+                }
+                if((b == myBlocks - 1) && (rank == size - 1)) *p++ = '\n';
+            }
+            int blockLen = p - text;
+            flag += (MPI_File_write_at_all(fileHandle, offset, text, blockLen, MPI_CHAR, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+            offset += blockLen;
+        }
+    }
+    MPI_File_close(&fileHandle);
+    free(text);
+    text = NULL;
+    free(lens);
+    lens = NULL;
+    return flag;
+};
+
+
+// Have rank 0 write all snapshots to one file, gathering snapshot k+1 while it writes snapshot k
+int writeToFileRootLoc(checkPtTimeLoc *thisCheckPtLoc, const char *filename){
+    int flag = 0;
+    int root = 0;
+    materialLoc *thisMaterialLoc = thisCheckPtLoc->thisMaterialLoc;
+    MPI_Comm comm = thisMaterialLoc->comm;
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int Nx = thisMaterialLoc->Nx;
+    int NyTotal = thisMaterialLoc->NyTotal;
+    int nSnaps = thisCheckPtLoc->nSnaps;
+    int nLocalPts = Nx * thisMaterialLoc->NyLocal;
+    int nSpacePts = Nx * NyTotal;
+
+    // every rank's rows (asked for rather than assumed, since rebalanceLoc may have moved them)
     int *recvCounts = (int *)malloc(size*sizeof(int));
     int *displacements = (int *)malloc(size*sizeof(int));
-    int r;
-    int NyTotal = (thisCheckPtLoc->thisMaterialLoc)->NyTotal;
-    int Nx = (thisCheckPtLoc->thisMaterialLoc)->Nx;
-    int counter = 0;
-    for(r=0; r < size; ++r){ 
-        displacements[r] = counter; // index of start of where data will be recorded from the r^th process
-        recvCounts[r] = Nx* (NyTotal/size); // number of entries to expect from the r^th process
-        if(r < (NyTotal % size)) recvCounts[r] = Nx * ((NyTotal/size)+1); // extra row if not evenly divisible
-        counter += recvCounts[r]; // add number of entries expected from this process onto the counter of all entries to fill in next displacement spot
-    }
+    int myDispl = Nx * thisMaterialLoc->startYId;
+    MPI_Allgather(&nLocalPts, 1, MPI_INT, recvCounts, 1, MPI_INT, comm);
+    MPI_Allgather(&myDispl, 1, MPI_INT, displacements, 1, MPI_INT, comm);
 
-    
-    if(rank == root){
-        // get total number of space and time points over entire material over all processes (assume same snap times across all processes)
-        int nLocalPts = Nx * (thisCheckPtLoc->thisMaterialLoc)->NyLocal;
-        int nSpacePts = Nx * NyTotal;
-        int nPtsTotal = nSpacePts * thisCheckPtLoc->nSnaps;
-        float *totalSnapshots = (float *)malloc(nPtsTotal*sizeof(float));
-        int snap;
-        int nSnaps = thisCheckPtLoc->nSnaps;
-        // for each snapshot gather (using MPI_Gatherv) the parts of the snapshot on the root rank
+    int snap;
+    if(rank != root){
+        // (nonblocking on every rank, since the root's nonblocking gathers can only match nonblocking ones)
         for(snap=0; snap<nSnaps; ++snap){
-            float *sendPtr = thisCheckPtLoc->stateSnapshotsLoc + (nLocalPts*snap);
-            flag += MPI_Gatherv(sendPtr, nLocalPts, MPI_FLOAT, totalSnapshots+(snap*nSpacePts), recvCounts, displacements, MPI_FLOAT, root, MPI_COMM_WORLD);
+            MPI_Request request;
+            flag += MPI_Igatherv(thisCheckPtLoc->stateSnapshotsLoc + (long)nLocalPts*snap, nLocalPts, MPI_REAL_T, NULL, recvCounts, displacements, MPI_REAL_T, root, comm, &request);
+            flag += MPI_Wait(&request, MPI_STATUS_IGNORE);
         }
-    
-        // open up the file to write into
-	    FILE *filePtr;
-	    filePtr = fopen(filename, "w");
-	    if(filePtr == NULL){
-	       	printf("ERROR in opening file in writeToFile \n");
-	    	flag += 1;
-	    	return flag;
-    	}
-    	// write the first few lines saying the dimensions of the 3D array you're about to put  in the file
-    	int Nx = (thisCheckPtLoc->thisMaterialLoc)->Nx;
-    	fprintf(filePtr, "%d\n",Nx);
-    	int NyTotal = (thisCheckPtLoc->thisMaterialLoc)->NyTotal;
-    	fprintf(filePtr, "%d\n",NyTotal);
-    	fprintf(filePtr, "%d\n",nSnaps);
-    	
-    	// write each snapshot
-    	int k;
-    	for(snap=0; snap<nSnaps; ++snap){
-    		// write the time of the simulation
-		    fprintf(filePtr,"%f ,",thisCheckPtLoc->times[snap]);
-	    	// write the overall state in a flattened array at that time
-	    	for(k=0; k<nSpacePts; ++k){
-	    		fprintf(filePtr," %f ,",totalSnapshots[k+(snap*nSpacePts)]);
-	    	}
-	    	fprintf(filePtr,"\n");
-	    }
-	    fclose(filePtr);
-	    
-	    // cleanup the snapshot array
-	    free(totalSnapshots);
-	    totalSnapshots = NULL;
+        free(recvCounts);
+        free(displacements);
+        return flag;
     }
-    else{ // all other ranks just participate in the gather of local state snapshots into overall state snapshots at each snapshot
-        float *totalSnapshots; // just a placeholder on these ranks
-        int snap;
-        int nSnaps = thisCheckPtLoc->nSnaps;
-        int nLocalPts = (thisCheckPtLoc->thisMaterialLoc)->Nx * (thisCheckPtLoc->thisMaterialLoc)->NyLocal;
-        // for each snapshot gather the local unpadded subarrays into the total snapshot array on the root process using MPI_Gatherv
-        for(snap=0; snap<nSnaps; ++snap){
-            float *sendPtr = thisCheckPtLoc->stateSnapshotsLoc + (nLocalPts*snap);
-            flag += MPI_Gatherv(sendPtr, nLocalPts, MPI_FLOAT, totalSnapshots, recvCounts, displacements, MPI_FLOAT, root, MPI_COMM_WORLD);
+
+    // two snapshots' worth of gather buffers and one row's worth of text
+    real_t *snapBufs[2];
+    snapBufs[0] = (real_t *)malloc((long)nSpacePts*sizeof(real_t));
+    snapBufs[1] = (real_t *)malloc((long)nSpacePts*sizeof(real_t));
+    char *text = (char *)malloc((long)Nx*TEXT_ENTRY_MAX + TEXT_ENTRY_MAX + 1);
+    FILE *filePtr = fopen(filename, "w");
+    if((snapBufs[0] == NULL) || (snapBufs[1] == NULL) || (text == NULL) || (filePtr == NULL)){
+        // still take part in the gathers so the other ranks aren't left waiting
+        printf("ERROR in opening file or allocating buffers in writeToFileRootLoc \n");
+        flag += 1;
+    }
+    if(filePtr != NULL){
+        fprintf(filePtr, "%d\n", Nx);
+        fprintf(filePtr, "%d\n", NyTotal);
+        fprintf(filePtr, "%d\n", nSnaps);
+#ifndef REAL_IS_FLOAT
+        fprintf(filePtr, "%s\n", REAL_DTYPE);
+#endif
+    }
+    MPI_Request requests[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+    if(nSnaps > 0) flag += MPI_Igatherv(thisCheckPtLoc->stateSnapshotsLoc, nLocalPts, MPI_REAL_T, snapBufs[0], recvCounts, displacements, MPI_REAL_T, root, comm, &(requests[0]));
+    for(snap=0; snap<nSnaps; ++snap){
+        int cur = snap % 2;
+        int next = 1 - cur;
+        flag += MPI_Wait(&(requests[cur]), MPI_STATUS_IGNORE);
+        if(snap + 1 < nSnaps) flag += MPI_Igatherv(thisCheckPtLoc->stateSnapshotsLoc + (long)nLocalPts*(snap + 1), nLocalPts, MPI_REAL_T, snapBufs[next], recvCounts, displacements, MPI_REAL_T, root, comm, &(requests[next]));
+        if((filePtr == NULL) || (text == NULL) || (snapBufs[cur] == NULL)) continue;
+
+        // write this snapshot a row at a time, testing the next gather between rows so it keeps moving
+        char *p = text;
+        p += formatFixedLoc(p, thisCheckPtLoc->times[snap]);
+        *p++ = ' ';
+        *p++ = ',';
+        int row, col, done;
+        for(row=0; row<NyTotal; ++row){
+            const real_t *rowVals = snapBufs[cur] + (long)row*Nx;
+            for(col=0; col<Nx; ++col){
+                p += formatEntryLoc(p, rowVals[col]);
+            }
+            if(row == NyTotal - 1) *p++ = '\n';
+            fwrite(text, 1, p - text, filePtr);
+            p = text;
+            MPI_Test(&(requests[next]), &done, MPI_STATUS_IGNORE);
         }
-        
     }
-    
-    // cleanup recvCounts and displacements arrays used for gatherv's
+    if(filePtr != NULL) fclose(filePtr);
+    free(snapBufs[0]);
+    free(snapBufs[1]);
+    free(text);
     free(recvCounts);
-    recvCounts = NULL;
     free(displacements);
-    displacements = NULL;
+    return flag;
+};
+
+// Write all snapshots as one binary subfile per node (or per group of ranksPerSubfile ranks of a node) plus a
+// global index saying which rows are where
+int writeToSubfilesLoc(checkPtTimeLoc *thisCheckPtLoc, const char *prefix, int ranksPerSubfile){
+    int flag = 0;
+    materialLoc *thisMaterialLoc = thisCheckPtLoc->thisMaterialLoc;
+    MPI_Comm comm = thisMaterialLoc->comm;
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int Nx = thisMaterialLoc->Nx;
+    int nSnaps = thisCheckPtLoc->nSnaps;
+    long blockPts = (long)nSnaps * Nx * thisMaterialLoc->NyLocal; // all of this rank's snapshots are contiguous
+
+    // the ranks sharing a node, cut into groups of ranksPerSubfile if asked; the first of each group aggregates
+    MPI_Comm nodeComm, groupComm, aggComm;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+    int nodeRank;
+    MPI_Comm_rank(nodeComm, &nodeRank);
+    MPI_Comm_split(nodeComm, (ranksPerSubfile > 0) ? nodeRank / ranksPerSubfile : 0, nodeRank, &groupComm);
+    MPI_Comm_free(&nodeComm);
+    int groupRank, groupSize;
+    MPI_Comm_rank(groupComm, &groupRank);
+    MPI_Comm_size(groupComm, &groupSize);
+    MPI_Comm_split(comm, (groupRank == 0) ? 0 : MPI_UNDEFINED, rank, &aggComm);
+    int subfileId = 0;
+    if(groupRank == 0) MPI_Comm_rank(aggComm, &subfileId);
+    MPI_Bcast(&subfileId, 1, MPI_INT, 0, groupComm);
 
-	return flag; 
+    // this rank's block goes after those of the group's lower ranks
+    long blockBytes = blockPts * sizeof(real_t), offset = 0;
+    MPI_Exscan(&blockBytes, &offset, 1, MPI_LONG, MPI_SUM, groupComm);
+    if(groupRank == 0) offset = 0;
+
+    // aggregators write their own block, then each member's in group order; members send theirs in chunks
+    // of at most SUBFILE_CHUNK_PTS points
+    char filename[SUBFILE_NAME_LEN];
+    int nameLen = snprintf(filename, SUBFILE_NAME_LEN, "%s.%d.bin", prefix, subfileId);
+    long *memberPts = NULL;
+    if(groupRank == 0) memberPts = (long *)malloc(groupSize * sizeof(long));
+    MPI_Gather(&blockPts, 1, MPI_LONG, memberPts, 1, MPI_LONG, 0, groupComm);
+    FILE *filePtr = NULL;
+    real_t *memberBlock = NULL;
+    int ready = 1;
+    if(groupRank == 0){
+        if(nameLen >= SUBFILE_NAME_LEN){
+            printf("ERROR in writeToSubfilesLoc, subfile name %s... is longer than %d characters \n", filename, SUBFILE_NAME_LEN - 1);
+            ready = 0;
+        }
+        else{
+            filePtr = fopen(filename, "wb");
+            memberBlock = (groupSize > 1) ? (real_t *)malloc(SUBFILE_CHUNK_PTS * sizeof(real_t)) : NULL;
+            if((filePtr == NULL) || (memberPts == NULL) || ((groupSize > 1) && (memberBlock == NULL))){
+                printf("ERROR in opening %s or allocating its buffer in writeToSubfilesLoc \n", filename);
+                ready = 0;
+            }
+        }
+    }
+    MPI_Bcast(&ready, 1, MPI_INT, 0, groupComm); // so members don't send to an aggregator that can't take it
+    flag += !ready;
+    long done;
+    if((groupRank == 0) && ready){
+        int member;
+        fwrite(thisCheckPtLoc->stateSnapshotsLoc, sizeof(real_t), blockPts, filePtr);
+        for(member=1; member<groupSize; ++member){
+            for(done=0; done<memberPts[member]; done+=SUBFILE_CHUNK_PTS){
+                int count = (memberPts[member] - done < SUBFILE_CHUNK_PTS) ? (int)(memberPts[member] - done) : SUBFILE_CHUNK_PTS;
+                flag += MPI_Recv(memberBlock, count, MPI_REAL_T, member, 0, groupComm, MPI_STATUS_IGNORE);
+                fwrite(memberBlock, sizeof(real_t), count, filePtr);
+            }
+        }
+    }
+    else if(ready){
+        for(done=0; done<blockPts; done+=SUBFILE_CHUNK_PTS){
+            int count = (blockPts - done < SUBFILE_CHUNK_PTS) ? (int)(blockPts - done) : SUBFILE_CHUNK_PTS;
+            flag += MPI_Send(thisCheckPtLoc->stateSnapshotsLoc + done, count, MPI_REAL_T, 0, 0, groupComm);
+        }
+    }
+    free(memberPts);
+    if(filePtr != NULL) fclose(filePtr);
+    free(memberBlock);
+
+    // rank 0 writes the index: every rank's rows, which subfile they're in, and where
+    long mySegment[4] = {subfileId, thisMaterialLoc->startYId, thisMaterialLoc->NyLocal, offset};
+    long *segments = NULL;
+    if(rank == 0) segments = (long *)malloc(4 * size * sizeof(long));
+    MPI_Gather(mySegment, 4, MPI_LONG, segments, 4, MPI_LONG, 0, comm);
+    if(rank == 0){
+        char indexName[SUBFILE_NAME_LEN];
+        FILE *indexPtr = NULL;
+        if(snprintf(indexName, SUBFILE_NAME_LEN, "%s.idx", prefix) < SUBFILE_NAME_LEN) indexPtr = fopen(indexName, "w");
+        if((indexPtr == NULL) || (segments == NULL)){
+            printf("ERROR in opening file in writeToSubfilesLoc \n");
+            flag += 1;
+        }
+        else{
+            // subfile names are kept without the directory, so the set can be moved as a whole
+            const char *baseName = strrchr(prefix, '/');
+            baseName = (baseName != NULL) ? baseName + 1 : prefix;
+            fprintf(indexPtr, "%d\n%d\n%d\n%s\n%d\n", Nx, thisMaterialLoc->NyTotal, nSnaps, REAL_DTYPE, size);
+            int snap, r;
+            for(snap=0; snap<nSnaps; ++snap) fprintf(indexPtr, (snap > 0) ? " %.9g" : "%.9g", thisCheckPtLoc->times[snap]);
+            fprintf(indexPtr, "\n");
+            for(r=0; r<size; ++r) fprintf(indexPtr, "%s.%ld.bin %ld %ld %ld\n", baseName, segments[4*r], segments[4*r + 1], segments[4*r + 2], segments[4*r + 3]);
+            fclose(indexPtr);
+        }
+        free(segments);
+    }
+    if(aggComm != MPI_COMM_NULL) MPI_Comm_free(&aggComm);
+    MPI_Comm_free(&groupComm);
+    return flag;
 };
 
 // cleanup space  allocated for times and stateSnapshots in checkPtTime struct
 int cleanupCheckPtTimeLoc(checkPtTimeLoc *thisCheckPtLoc){
 	free(thisCheckPtLoc->times);
 	thisCheckPtLoc->times = NULL;
-	free(thisCheckPtLoc->stateSnapshotsLoc);
+	freeArrayLoc(thisCheckPtLoc->stateSnapshotsLoc);
 	thisCheckPtLoc->stateSnapshotsLoc = NULL;
 	return 0;
 };
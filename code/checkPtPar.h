@@ -1,5 +1,18 @@
 #ifndef __CHECKPTPAR_H__
 #define __CHECKPTPAR_H__
+#include "precision.h"
+
+// most characters one entry of a snapshot line can take (a float written with %f takes at most 50)
+#define TEXT_ENTRY_MAX 64
+
+// most entries writeToFileLoc formats into its text buffer at a time
+#define TEXT_BLOCK_PTS (1 << 16)
+
+// longest subfile or index file name
+#define SUBFILE_NAME_LEN 256
+
+// most points in one message of writeToSubfilesLoc (so counts fit in an int and the aggregator's buffer stays small)
+#define SUBFILE_CHUNK_PTS (1 << 24)
 
 // forward declarations of structs a checkPtTime will have pointers to
 typedef struct simLoc_struct simLoc;
@@ -11,7 +24,7 @@ typedef struct checkPtTimeLoc_struct{
 	int nSnaps; // number of snapshots to record
 	int currentSnapIdx; // index of the current snapshot (within times and stateSnapshots)
 	float *times; // record times (in seconds) of each snapshot (nSnaps entries)	
-	float *stateSnapshotsLoc; // pointer to the local snapshots (nSnaps x thisMaterial.NyLocal x thisMaterial.Nx)
+	real_t *stateSnapshotsLoc; // pointer to the local snapshots (nSnaps x thisMaterial.NyLocal x thisMaterial.Nx), in the storage type
 } checkPtTimeLoc;
 
 // Calculate the number of snapshots you'll make if you start at the
@@ -26,7 +39,10 @@ int initCheckPtTimeLoc(checkPtTimeLoc *thisCheckPtLoc, materialLoc *thisMaterial
 // record the current snapshot for this local subarray
 int recordSnapLoc(checkPtTimeLoc *thisCheckPtLoc);
 
-// Have rank 0 write all snapshots to a file at end of simulation after gathering snapshots (file named as filename). 
+// Write all snapshots to a file at end of simulation (file named as filename). Each rank formats its own rows
+// (with a fixed point formatter giving exactly printf's "%f" digits) and writes them at their offset in the
+// file with MPI-IO, so nothing is gathered on rank 0. The lengths are counted first, then the rows are
+// formatted and written in blocks of TEXT_BLOCK_PTS entries through one fixed-size buffer.
 // Data will be in form:
 // Nx
 // Ny
@@ -34,8 +50,29 @@ int recordSnapLoc(checkPtTimeLoc *thisCheckPtLoc);
 // 1stSnapTime, all, entries, of, first, snapshot, in, order, in, one, row
 // 2ndSnapTime, all, entries, of, second, snapshot, in, order, in, one, row
 // etc...
+// When the engine isn't built for fp32 storage a 4th header line names the storage type (REAL_DTYPE,
+// e.g. float64) after nSnaps, and fp64 values are written with all their digits.
 int writeToFileLoc(checkPtTimeLoc *thisCheckPtLoc, const char *filename);
 
+// Same file as writeToFileLoc, for when it has to be written by rank 0 alone (e.g. no parallel file system).
+// Snapshot k+1 is gathered with MPI_Igatherv into one of two buffers while rank 0 formats and writes snapshot
+// k from the other, so rank 0 holds two snapshots rather than all of them, and the gathers overlap the writes.
+int writeToFileRootLoc(checkPtTimeLoc *thisCheckPtLoc, const char *filename);
+
+// Write all snapshots as subfiles: the ranks sharing a node (an MPI_COMM_TYPE_SHARED split, cut further into
+// groups of ranksPerSubfile ranks if that's > 0) send their rows to the group's first rank, which writes them to
+// one sequential binary file prefix.N.bin. Each rank's block is its nSnaps x NyLocal x Nx snapshots in the
+// storage type, and blocks follow each other in group order. Rank 0 writes the global index prefix.idx:
+// Nx
+// NyTotal
+// nSnaps
+// storage type (REAL_DTYPE)
+// number of blocks
+// time of each snapshot, space separated
+// subfile startRow nRows byteOffset (one line per block)
+// code/subfileRead.h (C) and test/readSubfiles.py (Python) read the set back as one Nx x NyTotal x nSnaps dataset.
+int writeToSubfilesLoc(checkPtTimeLoc *thisCheckPtLoc, const char *prefix, int ranksPerSubfile);
+
 // cleanup space  allocated for times and stateSnapshotsLoc in checkPtTimeLoc struct
 int cleanupCheckPtTimeLoc(checkPtTimeLoc *thisCheckPtLoc);
 #endif
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "dst.h"
+
+// in place iterative radix 2 FFT of length len (a power of two), forward sign exp(-i...)
+static void fftPow2(dstPlan *plan, double *re, double *im, int len)
+{
+	int i, j, bit;
+	// bit reversal permutation
+	for (i = 1, j = 0; i < len; ++i)
+	{
+		for (bit = len >> 1; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j)
+		{
+			double t = re[i];
+			re[i] = re[j];
+			re[j] = t;
+			t = im[i];
+			im[i] = im[j];
+			im[j] = t;
+		}
+	}
+	// butterflies, twiddles are stored for plan->fftLen so step through them accordingly
+	int size;
+	for (size = 2; size <= len; size <<= 1)
+	{
+		int half = size >> 1;
+		int twStep = plan->fftLen / size;
+		int start, k;
+		for (start = 0; start < len; start += size)
+		{
+			for (k = 0; k < half; ++k)
+			{
+				double wr = plan->twRe[k * twStep];
+				double wi = plan->twIm[k * twStep];
+				int a = start + k;
+				int b = a + half;
+				double tr = re[b] * wr - im[b] * wi;
+				double ti = re[b] * wi + im[b] * wr;
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+};
+
+// precompute twiddles and scratch for transforms of length n
+int initDstPlan(dstPlan *plan, int n)
+{
+	plan->n = n;
+	plan->m = 2 * (n + 1);
+	int m = plan->m;
+	plan->bluestein = (m & (m - 1)) != 0;
+	int len = 1;
+	if (plan->bluestein)
+		while (len < 2 * m - 1)
+			len <<= 1;
+	else
+		len = m;
+	plan->fftLen = len;
+
+	plan->twRe = malloc((len / 2) * sizeof(double));
+	plan->twIm = malloc((len / 2) * sizeof(double));
+	plan->workRe = malloc(len * sizeof(double));
+	plan->workIm = malloc(len * sizeof(double));
+	plan->chirpRe = NULL;
+	plan->chirpIm = NULL;
+	plan->kernRe = NULL;
+	plan->kernIm = NULL;
+	if ((plan->twRe == NULL) || (plan->twIm == NULL) || (plan->workRe == NULL) || (plan->workIm == NULL))
+	{
+		printf("WARNING: in initDstPlan, issue allocating arrays \n");
+		return 1;
+	}
+	int k;
+	for (k = 0; k < len / 2; ++k)
+	{
+		plan->twRe[k] = cos(-2.0 * M_PI * k / len);
+		plan->twIm[k] = sin(-2.0 * M_PI * k / len);
+	}
+
+	if (plan->bluestein)
+	{
+		plan->chirpRe = calloc(m, sizeof(double));
+		plan->chirpIm = calloc(m, sizeof(double));
+		plan->kernRe = calloc(len, sizeof(double));
+		plan->kernIm = calloc(len, sizeof(double));
+		if ((plan->chirpRe == NULL) || (plan->chirpIm == NULL) || (plan->kernRe == NULL) || (plan->kernIm == NULL))
+		{
+			printf("WARNING: in initDstPlan, issue allocating Bluestein arrays \n");
+			return 1;
+		}
+		for (k = 0; k < m; ++k)
+		{
+			// reduce k^2 mod 2m first so the angle stays accurate for large k
+			long kSq = ((long)k * k) % (2 * m);
+			double angle = M_PI * kSq / m;
+			plan->chirpRe[k] = cos(angle);
+			plan->chirpIm[k] = -sin(angle);
+		}
+		// kernel is the conjugate chirp, wrapped around for negative indices
+		plan->kernRe[0] = plan->chirpRe[0];
+		plan->kernIm[0] = -plan->chirpIm[0];
+		for (k = 1; k < m; ++k)
+		{
+			plan->kernRe[k] = plan->kernRe[len - k] = plan->chirpRe[k];
+			plan->kernIm[k] = plan->kernIm[len - k] = -plan->chirpIm[k];
+		}
+		fftPow2(plan, plan->kernRe, plan->kernIm, len);
+	}
+	return 0;
+};
+
+// in place DST-I of the n values data[0], data[stride], ..., data[(n-1)*stride]
+void applyDst(dstPlan *plan, double *data, int stride)
+{
+	int n = plan->n;
+	int m = plan->m;
+	int len = plan->fftLen;
+	double *re = plan->workRe;
+	double *im = plan->workIm;
+	int j, k;
+
+	// odd extension y = (0, x_1..x_n, 0, -x_n..-x_1), whose FFT is Y_k = -2i X_k
+	for (j = 0; j < len; ++j)
+	{
+		re[j] = 0.0;
+		im[j] = 0.0;
+	}
+	for (j = 1; j <= n; ++j)
+	{
+		re[j] = data[(j - 1) * stride];
+		re[m - j] = -data[(j - 1) * stride];
+	}
+
+	if (!plan->bluestein)
+	{
+		fftPow2(plan, re, im, len);
+	}
+	else
+	{
+		// X_k = c_k * sum_j (y_j c_j) conj(c_{k-j}) with chirp c_j = exp(-i pi j^2/m), as a circular convolution
+		for (j = 0; j < m; ++j)
+		{
+			double r = re[j] * plan->chirpRe[j] - im[j] * plan->chirpIm[j];
+			double i = re[j] * plan->chirpIm[j] + im[j] * plan->chirpRe[j];
+			re[j] = r;
+			im[j] = i;
+		}
+		fftPow2(plan, re, im, len);
+		for (j = 0; j < len; ++j)
+		{
+			double r = re[j] * plan->kernRe[j] - im[j] * plan->kernIm[j];
+			double i = re[j] * plan->kernIm[j] + im[j] * plan->kernRe[j];
+			// conjugate so the forward FFT below acts as an inverse FFT
+			re[j] = r;
+			im[j] = -i;
+		}
+		fftPow2(plan, re, im, len);
+		for (j = 0; j < m; ++j)
+		{
+			double r = re[j] / len;
+			double i = -im[j] / len;
+			re[j] = r * plan->chirpRe[j] - i * plan->chirpIm[j];
+			im[j] = r * plan->chirpIm[j] + i * plan->chirpRe[j];
+		}
+	}
+
+	for (k = 1; k <= n; ++k)
+		data[(k - 1) * stride] = -0.5 * im[k];
+};
+
+// deallocate the plan's arrays
+int cleanupDstPlan(dstPlan *plan)
+{
+	free(plan->twRe);
+	plan->twRe = NULL;
+	free(plan->twIm);
+	plan->twIm = NULL;
+	free(plan->workRe);
+	plan->workRe = NULL;
+	free(plan->workIm);
+	plan->workIm = NULL;
+	free(plan->chirpRe);
+	plan->chirpRe = NULL;
+	free(plan->chirpIm);
+	plan->chirpIm = NULL;
+	free(plan->kernRe);
+	plan->kernRe = NULL;
+	free(plan->kernIm);
+	plan->kernIm = NULL;
+	return 0;
+};
@@ -0,0 +1,31 @@
+#ifndef __DST_H__
+#define __DST_H__
+// Discrete sine transform (type I) shared by the serial and parallel spectral solvers.
+//   X_k = sum_{j=1}^{n} x_j sin(pi*j*k/(n+1)),  k = 1..n
+// Applying it twice gives back (n+1)/2 times the input. It is computed through a complex FFT of
+// length 2(n+1), using Bluestein's algorithm when that length isn't a power of two.
+
+typedef struct dstPlan_struct{
+	int n; // number of values transformed
+	int m; // length of the odd extension, 2(n+1)
+	int fftLen; // power of two FFT length actually used (m, or >= 2m-1 for Bluestein)
+	int bluestein; // nonzero if m isn't a power of two
+	double *twRe; // FFT twiddle factors (fftLen/2 of them)
+	double *twIm;
+	double *chirpRe; // Bluestein chirp exp(-i*pi*j^2/m) (m entries)
+	double *chirpIm;
+	double *kernRe; // FFT of the Bluestein convolution kernel (fftLen entries)
+	double *kernIm;
+	double *workRe; // scratch (fftLen entries)
+	double *workIm;
+} dstPlan;
+
+// precompute twiddles and scratch for transforms of length n
+int initDstPlan(dstPlan *plan, int n);
+
+// in place DST-I of the n values data[0], data[stride], ..., data[(n-1)*stride]
+void applyDst(dstPlan *plan, double *data, int stride);
+
+// deallocate the plan's arrays
+int cleanupDstPlan(dstPlan *plan);
+#endif
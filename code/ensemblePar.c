@@ -0,0 +1,324 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include "ensemblePar.h"
+#include "materialPar.h"
+#include <mpi.h>
+
+// Fill initGlobal (Nx x NyTotal) with member's initial state, i.e. what the member would pass to initSimLoc
+void fillEnsembleInitGlobal(const ensembleMember *member, float *initGlobal, unsigned int Nx, unsigned int NyTotal)
+{
+	int i, s;
+	for (i = 0; i < Nx * NyTotal; ++i)
+		initGlobal[i] = member->initVal;
+	for (s = 0; s < member->nSources; ++s)
+		initGlobal[member->srcCol[s] + member->srcRow[s] * Nx] = member->srcVal[s];
+};
+
+// Fill the ghost rows of every member of the batch: one message each way per neighbour carries
+// nPadRows rows of all nBatch members. The outer ghost rows of the group get the boundary values.
+static int exchangeBatchLoc(ensembleLoc *thisEnsLoc, real_t *paddedBatch, const acc_t *bdryB, int nBatch)
+{
+	materialLoc *thisMaterialLoc = &(thisEnsLoc->groupMaterialLoc);
+	int rank, size;
+	MPI_Comm_size(thisMaterialLoc->comm, &size);
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	int h = thisMaterialLoc->NyPadded * thisMaterialLoc->Nx * nBatch;
+	int p = thisMaterialLoc->nPadRows * thisMaterialLoc->Nx * nBatch;
+	MPI_Request requests[4];
+	int count = 0;
+	int i;
+	if (rank != 0)
+	{
+		MPI_Irecv(paddedBatch, p, MPI_REAL_T, rank - 1, 1, thisMaterialLoc->comm, &requests[count++]);
+		MPI_Isend(&(paddedBatch[p]), p, MPI_REAL_T, rank - 1, 0, thisMaterialLoc->comm, &requests[count++]);
+	}
+	else
+	{
+		for (i = 0; i < p; ++i)
+			paddedBatch[i] = storeReal(bdryB[i % nBatch]);
+	}
+	if (rank != size - 1)
+	{
+		MPI_Irecv(&(paddedBatch[h - p]), p, MPI_REAL_T, rank + 1, 0, thisMaterialLoc->comm, &requests[count++]);
+		MPI_Isend(&(paddedBatch[h - 2 * p]), p, MPI_REAL_T, rank + 1, 1, thisMaterialLoc->comm, &requests[count++]);
+	}
+	else
+	{
+		for (i = h - p; i < h; ++i)
+			paddedBatch[i] = storeReal(bdryB[i % nBatch]);
+	}
+	MPI_Waitall(count, requests, MPI_STATUSES_IGNORE);
+	return 0;
+};
+
+// Split MPI_COMM_WORLD into nGroups groups (the number of ranks must be a multiple of nGroups),
+// distribute the Nx x NyTotal grid over each group, and keep a copy of the nMembers members
+int initEnsembleLoc(ensembleLoc *thisEnsLoc, int nGroups, int batchSize, int nMembers, const ensembleMember *members, unsigned int Nx, unsigned int NyTotal, float dx, float dy)
+{
+	int flag = 0;
+	int worldRank, worldSize;
+	MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+	if ((nGroups < 1) || (worldSize % nGroups != 0))
+	{
+		if (worldRank == 0)
+			printf("WARNING: in initEnsembleLoc, %d ranks can't be split into %d groups \n", worldSize, nGroups);
+		return 1;
+	}
+	if (batchSize < 1)
+	{
+		if (worldRank == 0)
+			printf("WARNING: in initEnsembleLoc, batch size %d is less than 1 \n", batchSize);
+		return 1;
+	}
+
+	// consecutive world ranks share a group
+	int groupSize = worldSize / nGroups;
+	thisEnsLoc->nGroups = nGroups;
+	thisEnsLoc->groupId = worldRank / groupSize;
+	MPI_Comm_split(MPI_COMM_WORLD, thisEnsLoc->groupId, worldRank, &(thisEnsLoc->groupComm));
+	int nPadRows = 1;
+	flag += initMaterialLocComm(&(thisEnsLoc->groupMaterialLoc), Nx, NyTotal, nPadRows, dx, dy, 1.0, thisEnsLoc->groupComm);
+
+	// keep the members, and warn about any with an unstable time step (same CFL limit as calcMaxTimeStepLoc)
+	thisEnsLoc->nMembers = nMembers;
+	thisEnsLoc->members = malloc(nMembers * sizeof(ensembleMember));
+	float minStepSq = (dy < dx) ? dy * dy : dx * dx;
+	int m, s;
+	for (m = 0; m < nMembers; ++m)
+	{
+		thisEnsLoc->members[m] = members[m];
+		if (members[m].dt >= minStepSq / (4 * members[m].alpha))
+		{
+			if (worldRank == 0)
+				printf("WARNING: in initEnsembleLoc, time step of member %d exceeds stability limit. Unphysical behavior is likely. \n", m);
+			flag = 1;
+		}
+		if ((members[m].nSources < 0) || (members[m].nSources > ENSEMBLE_MAX_SOURCES))
+		{
+			if (worldRank == 0)
+				printf("WARNING: in initEnsembleLoc, member %d has %d sources, at most %d are allowed \n", m, members[m].nSources, ENSEMBLE_MAX_SOURCES);
+			thisEnsLoc->members[m].nSources = 0;
+			flag = 1;
+		}
+		for (s = 0; s < thisEnsLoc->members[m].nSources; ++s)
+		{
+			if ((members[m].srcCol[s] >= Nx) || (members[m].srcRow[s] >= NyTotal))
+			{
+				if (worldRank == 0)
+					printf("WARNING: in initEnsembleLoc, source %d of member %d is off the grid \n", s, m);
+				thisEnsLoc->members[m].nSources = s;
+				flag = 1;
+				break;
+			}
+		}
+	}
+
+	thisEnsLoc->batchSize = batchSize;
+	thisEnsLoc->nBatches = 0;
+	int nBatchPts = Nx * thisEnsLoc->groupMaterialLoc.NyPadded * batchSize;
+	thisEnsLoc->priorBatchLoc = malloc(nBatchPts * sizeof(real_t));
+	thisEnsLoc->currentBatchLoc = malloc(nBatchPts * sizeof(real_t));
+	thisEnsLoc->finalTime = malloc(nMembers * sizeof(float));
+	thisEnsLoc->finalMean = malloc(nMembers * sizeof(double));
+	thisEnsLoc->finalMin = malloc(nMembers * sizeof(float));
+	thisEnsLoc->finalMax = malloc(nMembers * sizeof(float));
+	thisEnsLoc->runTime = 0.0;
+	thisEnsLoc->exchangeTime = 0.0;
+	return flag;
+};
+
+// Take nSteps forward Euler steps of every member of this rank's group, batch by batch, then share
+// the final time, mean, min and max of every member with all ranks
+int runEnsembleLoc(ensembleLoc *thisEnsLoc, int nSteps)
+{
+	double runStart = MPI_Wtime();
+	materialLoc *thisMaterialLoc = &(thisEnsLoc->groupMaterialLoc);
+	int nCols = thisMaterialLoc->Nx;
+	int nRowsGlobal = thisMaterialLoc->NyTotal;
+	int nRowsUnpadded = thisMaterialLoc->NyLocal;
+	int nPadRows = thisMaterialLoc->nPadRows;
+	int startYId = thisMaterialLoc->startYId;
+	acc_t dx = thisMaterialLoc->dx;
+	acc_t dy = thisMaterialLoc->dy;
+	int nMembers = thisEnsLoc->nMembers;
+	int batchSize = thisEnsLoc->batchSize;
+
+	// partial results of this rank (members of other groups stay neutral for the reductions)
+	double *sumLoc = malloc(nMembers * sizeof(double));
+	float *minLoc = malloc(nMembers * sizeof(float));
+	float *maxLoc = malloc(nMembers * sizeof(float));
+	int m;
+	for (m = 0; m < nMembers; ++m)
+	{
+		sumLoc[m] = 0.0;
+		minLoc[m] = FLT_MAX;
+		maxLoc[m] = -FLT_MAX;
+		thisEnsLoc->finalTime[m] = thisEnsLoc->members[m].dt * nSteps;
+	}
+
+	// members of this group, in order
+	int *groupMembers = malloc(nMembers * sizeof(int));
+	int nGroupMembers = 0;
+	for (m = thisEnsLoc->groupId; m < nMembers; m += thisEnsLoc->nGroups)
+		groupMembers[nGroupMembers++] = m;
+
+	acc_t *alphaB = malloc(batchSize * sizeof(acc_t));
+	acc_t *dtB = malloc(batchSize * sizeof(acc_t));
+	acc_t *bdryB = malloc(batchSize * sizeof(acc_t));
+	int first, b, row, col, s, step;
+	thisEnsLoc->nBatches = 0;
+	for (first = 0; first < nGroupMembers; first += batchSize)
+	{
+		int nBatch = (nGroupMembers - first < batchSize) ? nGroupMembers - first : batchSize;
+		real_t *prior = thisEnsLoc->priorBatchLoc;
+		real_t *current = thisEnsLoc->currentBatchLoc;
+		int rowStride = nCols * nBatch;
+
+		// initial states of the batch, with the boundary values on the edges of the whole grid
+		for (b = 0; b < nBatch; ++b)
+		{
+			ensembleMember *member = &(thisEnsLoc->members[groupMembers[first + b]]);
+			alphaB[b] = member->alpha;
+			dtB[b] = member->dt;
+			bdryB[b] = member->bdryVal;
+			for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+			{
+				for (col = 0; col < nCols; ++col)
+					prior[(row * nCols + col) * nBatch + b] = storeReal(member->initVal);
+			}
+			for (s = 0; s < member->nSources; ++s)
+			{
+				int srcRowLoc = (int)member->srcRow[s] - startYId + nPadRows;
+				if ((srcRowLoc >= nPadRows) && (srcRowLoc < nRowsUnpadded + nPadRows))
+					prior[(srcRowLoc * nCols + member->srcCol[s]) * nBatch + b] = storeReal(member->srcVal[s]);
+			}
+			for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+			{
+				int globalRow = startYId + row - nPadRows;
+				for (col = 0; col < nCols; ++col)
+				{
+					if (globalRow == 0 || globalRow == nRowsGlobal - 1 || col == 0 || col == nCols - 1)
+						prior[(row * nCols + col) * nBatch + b] = storeReal(member->bdryVal);
+				}
+			}
+		}
+
+		// step the whole batch: one exchange and one sweep per step, members innermost
+		for (step = 0; step < nSteps; ++step)
+		{
+			double exchangeStart = MPI_Wtime();
+			exchangeBatchLoc(thisEnsLoc, prior, bdryB, nBatch);
+			thisEnsLoc->exchangeTime += MPI_Wtime() - exchangeStart;
+			for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+			{
+				int globalRow = startYId + row - nPadRows;
+				for (col = 0; col < nCols; ++col)
+				{
+					int base = (row * nCols + col) * nBatch;
+					if (globalRow == 0 || globalRow == nRowsGlobal - 1 || col == 0 || col == nCols - 1)
+					{
+						for (b = 0; b < nBatch; ++b)
+							current[base + b] = storeReal(bdryB[b]);
+					}
+					else
+					{
+						// same arithmetic as stencilRateLoc in simulationPar, with each member's alpha and dt
+						for (b = 0; b < nBatch; ++b)
+						{
+							int idx = base + b;
+							acc_t center = loadReal(prior[idx]);
+							acc_t dx2 = (loadReal(prior[idx - nBatch]) - 2 * center + loadReal(prior[idx + nBatch])) * alphaB[b] / (dx * dx);
+							acc_t dy2 = (loadReal(prior[idx - rowStride]) - 2 * center + loadReal(prior[idx + rowStride])) * alphaB[b] / (dy * dy);
+							current[idx] = storeReal(center + dtB[b] * (dx2 + dy2));
+						}
+					}
+				}
+			}
+			// every unpadded point was written, so the new state can simply become the prior one
+			real_t *tmp = prior;
+			prior = current;
+			current = tmp;
+		}
+
+		// results of the batch on this rank's rows
+		for (b = 0; b < nBatch; ++b)
+		{
+			m = groupMembers[first + b];
+			int idx;
+			for (idx = nPadRows * rowStride + b; idx < (nRowsUnpadded + nPadRows) * rowStride; idx += nBatch)
+			{
+				float val = loadReal(prior[idx]);
+				sumLoc[m] += val;
+				if (val < minLoc[m])
+					minLoc[m] = val;
+				if (val > maxLoc[m])
+					maxLoc[m] = val;
+			}
+		}
+		thisEnsLoc->nBatches++;
+	}
+
+	// every rank gets every member's results
+	MPI_Allreduce(sumLoc, thisEnsLoc->finalMean, nMembers, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+	MPI_Allreduce(minLoc, thisEnsLoc->finalMin, nMembers, MPI_FLOAT, MPI_MIN, MPI_COMM_WORLD);
+	MPI_Allreduce(maxLoc, thisEnsLoc->finalMax, nMembers, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+	for (m = 0; m < nMembers; ++m)
+		thisEnsLoc->finalMean[m] /= (double)nCols * nRowsGlobal;
+
+	free(sumLoc);
+	free(minLoc);
+	free(maxLoc);
+	free(groupMembers);
+	free(alphaB);
+	free(dtB);
+	free(bdryB);
+	thisEnsLoc->runTime += MPI_Wtime() - runStart;
+	return 0;
+};
+
+// Write one line of parameters and results per member to filename (rank 0 of MPI_COMM_WORLD writes)
+int writeEnsembleLoc(ensembleLoc *thisEnsLoc, char *filename)
+{
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	if (rank != 0)
+		return 0;
+	FILE *filePtr = fopen(filename, "w");
+	if (filePtr == NULL)
+	{
+		printf("WARNING: in writeEnsembleLoc, could not open %s \n", filename);
+		return 1;
+	}
+	fprintf(filePtr, "member, alpha, bdryVal, dt, nSources, finalTime, mean, min, max \n");
+	int m;
+	for (m = 0; m < thisEnsLoc->nMembers; ++m)
+	{
+		ensembleMember *member = &(thisEnsLoc->members[m]);
+		fprintf(filePtr, "%d, %f, %f, %f, %d, %f, %f, %f, %f \n", m, member->alpha, member->bdryVal, member->dt, member->nSources, thisEnsLoc->finalTime[m], thisEnsLoc->finalMean[m], thisEnsLoc->finalMin[m], thisEnsLoc->finalMax[m]);
+	}
+	fclose(filePtr);
+	return 0;
+};
+
+// deallocate the batch states, results and the group communicator
+int cleanupEnsembleLoc(ensembleLoc *thisEnsLoc)
+{
+	free(thisEnsLoc->members);
+	thisEnsLoc->members = NULL;
+	free(thisEnsLoc->priorBatchLoc);
+	thisEnsLoc->priorBatchLoc = NULL;
+	free(thisEnsLoc->currentBatchLoc);
+	thisEnsLoc->currentBatchLoc = NULL;
+	free(thisEnsLoc->finalTime);
+	thisEnsLoc->finalTime = NULL;
+	free(thisEnsLoc->finalMean);
+	thisEnsLoc->finalMean = NULL;
+	free(thisEnsLoc->finalMin);
+	thisEnsLoc->finalMin = NULL;
+	free(thisEnsLoc->finalMax);
+	thisEnsLoc->finalMax = NULL;
+	MPI_Comm_free(&(thisEnsLoc->groupComm));
+	return 0;
+};
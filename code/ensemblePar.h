@@ -0,0 +1,69 @@
+#ifndef __ENSEMBLEPAR_H__
+#define __ENSEMBLEPAR_H__
+#include <mpi.h>
+#include "materialPar.h"
+#include "precision.h"
+
+#define ENSEMBLE_MAX_SOURCES 4 // most hot spots a member's initial state can have
+
+typedef struct ensembleMember_struct{
+	// one independent simulation of a parameter sweep. All members share the grid (Nx, NyTotal, dx, dy)
+	// and the number of steps, everything else can differ.
+	float alpha; // diffusivity of the medium
+	float bdryVal; // temperature held on the edges
+	float dt; // time step
+	float initVal; // initial temperature everywhere except the sources
+	int nSources; // number of hot spots in the initial state
+	unsigned int srcCol[ENSEMBLE_MAX_SOURCES]; // column of each hot spot
+	unsigned int srcRow[ENSEMBLE_MAX_SOURCES]; // row of each hot spot
+	float srcVal[ENSEMBLE_MAX_SOURCES]; // initial temperature of each hot spot
+} ensembleMember;
+
+typedef struct ensembleLoc_struct{
+	// Ensemble of independent simulations in one job. MPI_COMM_WORLD is split into nGroups groups of
+	// consecutive ranks; member m belongs to group m % nGroups, and each group spreads its rows over its
+	// own groupComm. A group runs its members batchSize at a time: the batch is stored interleaved
+	// (member index fastest), so one stencil sweep updates every member of the batch and one halo
+	// message per neighbour carries all of their ghost rows.
+	int nGroups; // number of groups
+	int groupId; // which group this rank works in
+	MPI_Comm groupComm; // ranks of this group
+	materialLoc groupMaterialLoc; // rows of this rank within its group (alpha is set per member)
+	int nMembers; // number of members in the whole ensemble
+	ensembleMember *members; // copy of every member's parameters
+	int batchSize; // most members stepped together
+	int nBatches; // batches this group ran
+
+	// batched padded states (groupMaterialLoc.Nx x groupMaterialLoc.NyPadded points x batchSize members),
+	// member b of the batch at padded point idx is at [idx*nBatch + b]
+	real_t *priorBatchLoc;
+	real_t *currentBatchLoc;
+
+	// results of every member (the same on all ranks after runEnsembleLoc)
+	float *finalTime; // simulated seconds at the end of the run
+	double *finalMean; // mean temperature of the final state
+	float *finalMin; // lowest temperature of the final state
+	float *finalMax; // highest temperature of the final state
+
+	// timing of this rank's group
+	double runTime; // wall seconds in runEnsembleLoc
+	double exchangeTime; // wall seconds in halo exchanges
+} ensembleLoc;
+
+// Fill initGlobal (Nx x NyTotal) with member's initial state, i.e. what the member would pass to initSimLoc
+void fillEnsembleInitGlobal(const ensembleMember *member, float *initGlobal, unsigned int Nx, unsigned int NyTotal);
+
+// Split MPI_COMM_WORLD into nGroups groups (the number of ranks must be a multiple of nGroups),
+// distribute the Nx x NyTotal grid over each group, and keep a copy of the nMembers members
+int initEnsembleLoc(ensembleLoc *thisEnsLoc, int nGroups, int batchSize, int nMembers, const ensembleMember *members, unsigned int Nx, unsigned int NyTotal, float dx, float dy);
+
+// Take nSteps forward Euler steps of every member of this rank's group, batch by batch, then share
+// the final time, mean, min and max of every member with all ranks
+int runEnsembleLoc(ensembleLoc *thisEnsLoc, int nSteps);
+
+// Write one line of parameters and results per member to filename (rank 0 of MPI_COMM_WORLD writes)
+int writeEnsembleLoc(ensembleLoc *thisEnsLoc, char *filename);
+
+// deallocate the batch states, results and the group communicator
+int cleanupEnsembleLoc(ensembleLoc *thisEnsLoc);
+#endif
@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "implicitPar.h"
+#include "simulationPar.h"
+#include "materialPar.h"
+#include "checkPtPar.h"
+#include <mpi.h>
+
+#if defined(HEAT_FP64) || defined(HEAT_BF16) || defined(HEAT_FP16)
+#error "implicitPar.c works on the states as float, so it is only built in the fp32 mode of precision.h"
+#endif
+
+// sum of a[i]*b[i] over the unpadded part of two padded local arrays, summed over all ranks
+static double dotLoc(implicitLoc *thisImpLoc, float *aLoc, float *bLoc)
+{
+	materialLoc *thisMaterialLoc = (thisImpLoc->thisSimLoc)->thisMaterialLoc;
+	int start = thisMaterialLoc->nPadRows * thisMaterialLoc->Nx;
+	int end = start + thisMaterialLoc->NyLocal * thisMaterialLoc->Nx;
+	double localSum = 0.0;
+	int i;
+	for (i = start; i < end; ++i)
+		localSum += (double)aLoc[i] * (double)bLoc[i];
+	double globalSum;
+	MPI_Allreduce(&localSum, &globalSum, 1, MPI_DOUBLE, MPI_SUM, thisMaterialLoc->comm);
+	return globalSum;
+};
+
+// res.res and res.z over all ranks with a single reduction (dots[0] and dots[1])
+static void dot2Loc(implicitLoc *thisImpLoc, float *resLoc, float *zLoc, double *dots)
+{
+	materialLoc *thisMaterialLoc = (thisImpLoc->thisSimLoc)->thisMaterialLoc;
+	int start = thisMaterialLoc->nPadRows * thisMaterialLoc->Nx;
+	int end = start + thisMaterialLoc->NyLocal * thisMaterialLoc->Nx;
+	double localSums[2] = {0.0, 0.0};
+	int i;
+	for (i = start; i < end; ++i)
+	{
+		localSums[0] += (double)resLoc[i] * (double)resLoc[i];
+		localSums[1] += (double)resLoc[i] * (double)zLoc[i];
+	}
+	MPI_Allreduce(localSums, dots, 2, MPI_DOUBLE, MPI_SUM, thisMaterialLoc->comm);
+};
+
+// Set up the implicit solver for an already initialized local simulation.
+int initImplicitLoc(implicitLoc *thisImpLoc, simLoc *thisSimLoc, float timeStep, int precond, float tol, int maxIters)
+{
+	if (thisSimLoc->stencilOrder != 2)
+	{
+		printf("WARNING: in initImplicitLoc, only the second order stencil is supported \n");
+		return 1;
+	}
+	if (thisSimLoc->lowMemory)
+	{
+		printf("WARNING: in initImplicitLoc, the simulation can't be in low memory mode \n");
+		return 1;
+	}
+	int flag = 0;
+	thisImpLoc->thisSimLoc = thisSimLoc;
+	thisSimLoc->dt = timeStep; // no stability limit on dt for backward Euler
+	thisImpLoc->precond = precond;
+	thisImpLoc->chebDegree = 4;
+	thisImpLoc->tol = tol;
+	thisImpLoc->maxIters = maxIters;
+	thisImpLoc->lastIters = 0;
+	thisImpLoc->totalIters = 0;
+	thisImpLoc->nSolves = 0;
+	thisImpLoc->lastRelRes = 0.0;
+	thisImpLoc->reportIters = 0;
+
+	// the operator is I + dt*alpha*K with K = -L restricted to the interior points, and the eigenvalues
+	// of K are 4/dx^2 sin^2(k pi/(2(Nx-1))) + 4/dy^2 sin^2(l pi/(2(NyTotal-1))) for k = 1..Nx-2, l = 1..NyTotal-2
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	float alpha = thisMaterialLoc->alpha;
+	float dx = thisMaterialLoc->dx;
+	float dy = thisMaterialLoc->dy;
+	double cx = (double)timeStep * alpha / (dx * dx);
+	double cy = (double)timeStep * alpha / (dy * dy);
+	double sx = sin(M_PI / (2.0 * (thisMaterialLoc->Nx - 1)));
+	double sy = sin(M_PI / (2.0 * (thisMaterialLoc->NyTotal - 1)));
+	thisImpLoc->diag = (float)(1.0 + 2.0 * cx + 2.0 * cy);
+	thisImpLoc->lambdaMin = (float)(1.0 + 4.0 * cx * sx * sx + 4.0 * cy * sy * sy);
+	thisImpLoc->lambdaMax = (float)(1.0 + 4.0 * cx * (1.0 - sx * sx) + 4.0 * cy * (1.0 - sy * sy));
+
+	// allocate the padded work vectors, starting with a zero correction
+	int totalPoints = thisMaterialLoc->NyPadded * thisMaterialLoc->Nx;
+	thisImpLoc->deltaLoc = calloc(totalPoints, sizeof(float));
+	thisImpLoc->rhsLoc = calloc(totalPoints, sizeof(float));
+	thisImpLoc->resLoc = calloc(totalPoints, sizeof(float));
+	thisImpLoc->zLoc = calloc(totalPoints, sizeof(float));
+	thisImpLoc->dirLoc = calloc(totalPoints, sizeof(float));
+	thisImpLoc->opDirLoc = calloc(totalPoints, sizeof(float));
+	thisImpLoc->chebResLoc = calloc(totalPoints, sizeof(float));
+	thisImpLoc->chebDirLoc = calloc(totalPoints, sizeof(float));
+	if ((thisImpLoc->deltaLoc == NULL) || (thisImpLoc->rhsLoc == NULL) || (thisImpLoc->resLoc == NULL) || (thisImpLoc->zLoc == NULL) || (thisImpLoc->dirLoc == NULL) || (thisImpLoc->opDirLoc == NULL) || (thisImpLoc->chebResLoc == NULL) || (thisImpLoc->chebDirLoc == NULL))
+	{
+		printf("WARNING: in initImplicitLoc, issue allocating work vectors \n");
+		flag = 1;
+	}
+	return flag;
+};
+
+// Apply the operator (I - dt*alpha*L) to the padded array inLoc and put the result in outLoc.
+// Exchanges the ghost regions of inLoc first. Boundary points of outLoc are set to 0.
+int applyImplicitOpLoc(implicitLoc *thisImpLoc, float *inLoc, float *outLoc)
+{
+	simLoc *thisSimLoc = thisImpLoc->thisSimLoc;
+	int flag = exchangeGhostRegionsArray(thisSimLoc, inLoc);
+
+	// grab the dimensions and material properties
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nRowsUnpadded = (thisSimLoc->thisMaterialLoc)->NyLocal;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	int nRowsGlobal = (thisSimLoc->thisMaterialLoc)->NyTotal;
+	int startYId = (thisSimLoc->thisMaterialLoc)->startYId;
+	float alpha = (thisSimLoc->thisMaterialLoc)->alpha;
+	float dx = (thisSimLoc->thisMaterialLoc)->dx;
+	float dy = (thisSimLoc->thisMaterialLoc)->dy;
+	float cx = thisSimLoc->dt * alpha / (dx * dx);
+	float cy = thisSimLoc->dt * alpha / (dy * dy);
+	float diag = thisImpLoc->diag;
+
+	int row, col;
+	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+	{
+		int globalRow = startYId + row - nPadRows;
+		int rowStart = row * nCols;
+		if (globalRow == 0 || globalRow == nRowsGlobal - 1)
+		{ // whole row is on the boundary, where the correction is always 0
+			for (col = 0; col < nCols; ++col)
+				outLoc[rowStart + col] = 0.0;
+			continue;
+		}
+		outLoc[rowStart] = 0.0;
+		outLoc[rowStart + nCols - 1] = 0.0;
+		for (col = 1; col < nCols - 1; ++col)
+		{
+			int idx = rowStart + col;
+			outLoc[idx] = diag * inLoc[idx] - cx * (inLoc[idx - 1] + inLoc[idx + 1]) - cy * (inLoc[idx - nCols] + inLoc[idx + nCols]);
+		}
+	}
+	return flag;
+};
+
+// Apply the preconditioner to resLoc and put the result in zLoc
+static int applyPrecondLoc(implicitLoc *thisImpLoc, float *resLoc, float *zLoc)
+{
+	materialLoc *thisMaterialLoc = (thisImpLoc->thisSimLoc)->thisMaterialLoc;
+	int start = thisMaterialLoc->nPadRows * thisMaterialLoc->Nx;
+	int end = start + thisMaterialLoc->NyLocal * thisMaterialLoc->Nx;
+	int i, k;
+	int flag = 0;
+
+	if (thisImpLoc->precond == PRECOND_JACOBI)
+	{
+		float invDiag = 1.0 / thisImpLoc->diag;
+		for (i = start; i < end; ++i)
+			zLoc[i] = resLoc[i] * invDiag;
+		return flag;
+	}
+
+	// Chebyshev iteration for A z = res starting from z = 0. With a fixed degree this is a fixed
+	// polynomial in A that is positive on [lambdaMin, lambdaMax], so it is a valid SPD preconditioner.
+	float theta = 0.5 * (thisImpLoc->lambdaMax + thisImpLoc->lambdaMin);
+	float delta = 0.5 * (thisImpLoc->lambdaMax - thisImpLoc->lambdaMin);
+	float sigma = theta / delta;
+	float rho = 1.0 / sigma;
+	float *chebRes = thisImpLoc->chebResLoc;
+	float *chebDir = thisImpLoc->chebDirLoc;
+	float *opDir = thisImpLoc->opDirLoc; // free to use as scratch here (not needed until after preconditioning)
+	for (i = start; i < end; ++i)
+	{
+		chebRes[i] = resLoc[i];
+		chebDir[i] = resLoc[i] / theta;
+		zLoc[i] = 0.0;
+	}
+	for (k = 1; k <= thisImpLoc->chebDegree; ++k)
+	{
+		for (i = start; i < end; ++i)
+			zLoc[i] += chebDir[i];
+		if (k == thisImpLoc->chebDegree)
+			break;
+		flag += applyImplicitOpLoc(thisImpLoc, chebDir, opDir);
+		float rhoNew = 1.0 / (2.0 * sigma - rho);
+		for (i = start; i < end; ++i)
+		{
+			chebRes[i] -= opDir[i];
+			chebDir[i] = rhoNew * rho * chebDir[i] + (2.0 * rhoNew / delta) * chebRes[i];
+		}
+		rho = rhoNew;
+	}
+	return flag;
+};
+
+// Move the simulation forward by one backward Euler time step
+int oneStepImplicitLoc(implicitLoc *thisImpLoc)
+{
+	simLoc *thisSimLoc = thisImpLoc->thisSimLoc;
+	float *priorStateLoc = thisSimLoc->priorStateLoc;
+	if ((priorStateLoc == NULL) || (thisImpLoc->deltaLoc == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStepImplicitLoc() \n");
+		return 1;
+	}
+	int flag = 0;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int nCols = thisMaterialLoc->Nx;
+	int start = thisMaterialLoc->nPadRows * nCols;
+	int end = start + thisMaterialLoc->NyLocal * nCols;
+	float *delta = thisImpLoc->deltaLoc;
+	float *rhs = thisImpLoc->rhsLoc;
+	float *res = thisImpLoc->resLoc;
+	float *z = thisImpLoc->zLoc;
+	float *dir = thisImpLoc->dirLoc;
+	float *opDir = thisImpLoc->opDirLoc;
+	int i;
+
+	// right hand side dt*alpha*L u_prior = u_prior - (I - dt*alpha*L) u_prior at interior points (0 on the boundaries)
+	flag += applyImplicitOpLoc(thisImpLoc, priorStateLoc, rhs);
+	int row, col;
+	for (row = 0; row < (int)thisMaterialLoc->NyLocal; ++row)
+	{
+		int globalRow = thisMaterialLoc->startYId + row;
+		if (globalRow == 0 || globalRow == (int)thisMaterialLoc->NyTotal - 1)
+			continue;
+		for (col = 1; col < nCols - 1; ++col)
+		{
+			i = start + row * nCols + col;
+			rhs[i] = priorStateLoc[i] - rhs[i];
+		}
+	}
+
+	double rhsNorm = sqrt(dotLoc(thisImpLoc, rhs, rhs));
+	int iter = 0;
+	double relRes = 0.0;
+	if (rhsNorm > 0.0)
+	{
+		// residual of the warm start guess (the correction from the last step)
+		flag += applyImplicitOpLoc(thisImpLoc, delta, opDir);
+		for (i = start; i < end; ++i)
+			res[i] = rhs[i] - opDir[i];
+		flag += applyPrecondLoc(thisImpLoc, res, z);
+		for (i = start; i < end; ++i)
+			dir[i] = z[i];
+		double dots[2];
+		dot2Loc(thisImpLoc, res, z, dots);
+		double resZ = dots[1];
+		relRes = sqrt(dots[0]) / rhsNorm;
+		while ((relRes > thisImpLoc->tol) && (iter < thisImpLoc->maxIters))
+		{
+			flag += applyImplicitOpLoc(thisImpLoc, dir, opDir);
+			double stepLen = resZ / dotLoc(thisImpLoc, dir, opDir);
+			for (i = start; i < end; ++i)
+			{
+				delta[i] += stepLen * dir[i];
+				res[i] -= stepLen * opDir[i];
+			}
+			++iter;
+			// precondition before checking convergence so both dot products share one reduction
+			flag += applyPrecondLoc(thisImpLoc, res, z);
+			dot2Loc(thisImpLoc, res, z, dots);
+			relRes = sqrt(dots[0]) / rhsNorm;
+			double beta = dots[1] / resZ;
+			resZ = dots[1];
+			for (i = start; i < end; ++i)
+				dir[i] = z[i] + beta * dir[i];
+		}
+	}
+	else
+	{ // already at equilibrium, nothing changes
+		for (i = start; i < end; ++i)
+			delta[i] = 0.0;
+	}
+	if (relRes > thisImpLoc->tol)
+	{
+		printf("WARNING: in oneStepImplicitLoc, conjugate gradient did not converge in %d iterations (relative residual %g) \n", iter, relRes);
+		flag += 1;
+	}
+
+	// apply the correction (it is 0 on the boundaries), keeping currentStateLoc in sync with priorStateLoc
+	for (i = start; i < end; ++i)
+	{
+		priorStateLoc[i] += delta[i];
+		thisSimLoc->currentStateLoc[i] = priorStateLoc[i];
+	}
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1;
+
+	thisImpLoc->lastIters = iter;
+	thisImpLoc->totalIters += iter;
+	thisImpLoc->nSolves += 1;
+	thisImpLoc->lastRelRes = relRes;
+	return flag;
+};
+
+// Same as runSimLoc, but taking backward Euler steps. Initializes theseTimesLoc.
+int runSimImplicitLoc(implicitLoc *thisImpLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc)
+{
+	int flag = 0; // return flag, 0 if no problem, but nonzero if there's a problem
+	simLoc *thisSimLoc = thisImpLoc->thisSimLoc;
+
+	// do the initialization of the checkpointing struct
+	int nSnaps = calcNSnapsLoc(nSteps, stepsPerCheckPt);
+	int checkPtInitFlag = initCheckPtTimeLoc(theseTimesLoc, thisSimLoc->thisMaterialLoc, thisSimLoc, nSnaps);
+	if (checkPtInitFlag)
+	{
+		printf("WARNING: issue initializing checkpoint in runSimImplicitLoc \n");
+		flag = checkPtInitFlag;
+	}
+
+	// check rank
+	int rank;
+	MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
+
+	// run through the steps
+	int step;
+	recordSnapLoc(theseTimesLoc); // always record 0th time step's prior state
+	for (step = 1; step < nSteps; ++step)
+	{
+		int stepFlag = oneStepImplicitLoc(thisImpLoc);
+		if (stepFlag)
+		{
+			printf("WARNING: issue in implicit simulation at %d time step on rank %d \n", step, rank);
+			flag = stepFlag;
+		}
+		if (thisImpLoc->reportIters && rank == 0)
+			printf("implicit step %d: %d CG iterations, relative residual %g \n", step, thisImpLoc->lastIters, thisImpLoc->lastRelRes);
+		if (step % stepsPerCheckPt == 0)
+			recordSnapLoc(theseTimesLoc);
+	}
+	return flag;
+};
+
+// deallocate the work vectors of the implicit solver
+int cleanupImplicitLoc(implicitLoc *thisImpLoc)
+{
+	free(thisImpLoc->deltaLoc);
+	thisImpLoc->deltaLoc = NULL;
+	free(thisImpLoc->rhsLoc);
+	thisImpLoc->rhsLoc = NULL;
+	free(thisImpLoc->resLoc);
+	thisImpLoc->resLoc = NULL;
+	free(thisImpLoc->zLoc);
+	thisImpLoc->zLoc = NULL;
+	free(thisImpLoc->dirLoc);
+	thisImpLoc->dirLoc = NULL;
+	free(thisImpLoc->opDirLoc);
+	thisImpLoc->opDirLoc = NULL;
+	free(thisImpLoc->chebResLoc);
+	thisImpLoc->chebResLoc = NULL;
+	free(thisImpLoc->chebDirLoc);
+	thisImpLoc->chebDirLoc = NULL;
+	return 0;
+};
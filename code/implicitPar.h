@@ -0,0 +1,61 @@
+#ifndef __IMPLICITPAR_H__
+#define __IMPLICITPAR_H__
+
+// forward declarations of structs an implicitLoc will have pointers to
+typedef struct simLoc_struct simLoc;
+typedef struct checkPtTimeLoc_struct checkPtTimeLoc;
+
+// choices of preconditioner for the conjugate gradient solve
+#define PRECOND_JACOBI 0 // divide by the diagonal of the operator
+#define PRECOND_CHEBYSHEV 1 // fixed degree Chebyshev polynomial in the operator
+
+typedef struct implicitLoc_struct{
+	// Backward Euler: each step solves (I - dt*alpha*L) u_new = u_prior for u_new, where L is the
+	// 5 point Laplacian. We solve for the correction delta = u_new - u_prior (zero on the boundaries),
+	// i.e. (I - dt*alpha*L) delta = dt*alpha*L u_prior, with matrix free preconditioned conjugate gradient.
+
+	simLoc *thisSimLoc; // pointer to an already initialized local subset of the simulation
+	int precond; // PRECOND_JACOBI or PRECOND_CHEBYSHEV
+	int chebDegree; // degree of the Chebyshev polynomial preconditioner (number of operator applications)
+	float tol; // stop once ||residual|| <= tol * ||right hand side||
+	int maxIters; // maximum number of conjugate gradient iterations per step
+	float diag; // diagonal entry of the operator (same for every interior point)
+	float lambdaMin; // smallest eigenvalue of the operator
+	float lambdaMax; // largest eigenvalue of the operator
+
+	// padded work vectors (thisMaterial.Nx x thisMaterial.NyPadded points)
+	float *deltaLoc; // correction from the last step, used as the starting guess for the next one
+	float *rhsLoc; // right hand side dt*alpha*L u_prior
+	float *resLoc; // residual
+	float *zLoc; // preconditioned residual
+	float *dirLoc; // search direction
+	float *opDirLoc; // operator applied to the search direction
+	float *chebResLoc; // residual inside the Chebyshev preconditioner
+	float *chebDirLoc; // update direction inside the Chebyshev preconditioner
+
+	// iteration counts, so the cost of each step can be reported
+	int lastIters; // conjugate gradient iterations used in the last step
+	long totalIters; // conjugate gradient iterations used over all steps so far
+	int nSolves; // number of implicit steps taken so far
+	float lastRelRes; // relative residual reached in the last step
+	int reportIters; // if nonzero, rank 0 prints the iterations used at every step
+} implicitLoc;
+
+// Set up the implicit solver for an already initialized local simulation. The simulation's dt is
+// replaced by timeStep, which may be far above dtMax since backward Euler is unconditionally stable.
+int initImplicitLoc(implicitLoc *thisImpLoc, simLoc *thisSimLoc, float timeStep, int precond, float tol, int maxIters);
+
+// Apply the operator (I - dt*alpha*L) to the padded array inLoc and put the result in outLoc.
+// Exchanges the ghost regions of inLoc first. Boundary points of outLoc are set to 0.
+int applyImplicitOpLoc(implicitLoc *thisImpLoc, float *inLoc, float *outLoc);
+
+// Move the simulation forward by one backward Euler time step
+int oneStepImplicitLoc(implicitLoc *thisImpLoc);
+
+// Same as runSimLoc, but taking backward Euler steps. Initializes theseTimesLoc.
+int runSimImplicitLoc(implicitLoc *thisImpLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc);
+
+// deallocate the work vectors of the implicit solver
+int cleanupImplicitLoc(implicitLoc *thisImpLoc);
+
+#endif
@@ -0,0 +1,76 @@
+#include "material3DPar.h"
+#include "allocPar.h"
+#include "precision.h"
+#include <mpi.h>
+#include <stdio.h>
+
+// split n points over nParts parts as evenly as possible (the first n % nParts parts get one extra),
+// giving the size and starting index of part
+static void splitEvenly3DLoc(unsigned int n, int nParts, int part, unsigned int *nLocal, unsigned int *start)
+{
+    unsigned int extra = n % nParts;
+    *nLocal = n / nParts + ((unsigned int)part < extra ? 1 : 0);
+    *start = part * (n / nParts) + ((unsigned int)part < extra ? part : extra);
+};
+
+// split the grid into blocks over all ranks of MPI_COMM_WORLD
+int initMaterial3DLoc(material3DLoc *aMaterial, unsigned int Nx, unsigned int Ny, unsigned int Nz, unsigned int nPad, float dx, float dy, float dz, float alpha)
+{
+    return initMaterial3DLocComm(aMaterial, Nx, Ny, Nz, nPad, dx, dy, dz, alpha, MPI_COMM_WORLD);
+};
+
+// same as initMaterial3DLoc, but the blocks are split over the ranks of comm
+int initMaterial3DLocComm(material3DLoc *aMaterial, unsigned int Nx, unsigned int Ny, unsigned int Nz, unsigned int nPad, float dx, float dy, float dz, float alpha, MPI_Comm comm)
+{
+    int flag = 0;
+    int nProcs;
+    MPI_Comm_size(comm, &nProcs);
+
+    aMaterial->Nx = Nx;
+    aMaterial->Ny = Ny;
+    aMaterial->Nz = Nz;
+    aMaterial->dx = dx;
+    aMaterial->dy = dy;
+    aMaterial->dz = dz;
+    aMaterial->alpha = alpha;
+
+    // the rank grid (z gets the most ranks, since z planes are the contiguous faces), no periodicity,
+    // and let MPI renumber the ranks to fit the machine
+    int dimsZYX[3] = {0, 0, 0};
+    MPI_Dims_create(nProcs, 3, dimsZYX);
+    aMaterial->dims[0] = dimsZYX[2];
+    aMaterial->dims[1] = dimsZYX[1];
+    aMaterial->dims[2] = dimsZYX[0];
+    int periods[3] = {0, 0, 0};
+    MPI_Cart_create(comm, 3, aMaterial->dims, periods, 1, &(aMaterial->cartComm));
+    int rank;
+    MPI_Comm_rank(aMaterial->cartComm, &rank);
+    MPI_Cart_coords(aMaterial->cartComm, rank, 3, aMaterial->coords);
+    int d;
+    for (d = 0; d < 3; ++d)
+        MPI_Cart_shift(aMaterial->cartComm, d, 1, &(aMaterial->nbrLo[d]), &(aMaterial->nbrHi[d]));
+
+    // this rank's block
+    splitEvenly3DLoc(Nx, aMaterial->dims[0], aMaterial->coords[0], &(aMaterial->NxLocal), &(aMaterial->startXId));
+    splitEvenly3DLoc(Ny, aMaterial->dims[1], aMaterial->coords[1], &(aMaterial->NyLocal), &(aMaterial->startYId));
+    splitEvenly3DLoc(Nz, aMaterial->dims[2], aMaterial->coords[2], &(aMaterial->NzLocal), &(aMaterial->startZId));
+    aMaterial->nPad = nPad;
+    aMaterial->NxPadded = paddedStrideLoc(nPad + aMaterial->NxLocal + nPad, sizeof(real_t)); // (an odd number of cache lines)
+    aMaterial->NyPadded = nPad + aMaterial->NyLocal + nPad;
+    aMaterial->NzPadded = nPad + aMaterial->NzLocal + nPad;
+
+    // check that the padding isn't bigger than the block in any direction
+    if ((nPad > aMaterial->NxLocal) || (nPad > aMaterial->NyLocal) || (nPad > aMaterial->NzLocal))
+    {
+        printf("WARNING: in initMaterial3DLoc, nPad must be <= the block size in every direction \n");
+        flag = 1;
+    }
+    return flag;
+};
+
+// free the Cartesian communicator
+int cleanupMaterial3DLoc(material3DLoc *aMaterial)
+{
+    MPI_Comm_free(&(aMaterial->cartComm));
+    return 0;
+};
@@ -0,0 +1,43 @@
+#ifndef __MATERIAL3DPAR_H__
+#define __MATERIAL3DPAR_H__
+#include <mpi.h>
+typedef struct material3DLoc_struct{
+	// information inherent to the material itself
+	unsigned int Nx; // number of points in the x direction of the global grid
+	unsigned int Ny; // number of points in the y direction of the global grid
+	unsigned int Nz; // number of points in the z direction of the global grid
+	float dx; // spacing (meters) between grid points in the x direction
+	float dy; // spacing (meters) between grid points in the y direction
+	float dz; // spacing (meters) between grid points in the z direction
+	float alpha; // homogeneous diffusivity of the medium
+
+	// 3D block decomposition: the ranks form a dims[0] x dims[1] x dims[2] Cartesian grid, and each holds
+	// one NxLocal x NyLocal x NzLocal block padded by nPad points on every face. Local arrays are stored
+	// with x fastest, then y, then z: point (x, y, z) of the padded block is at x + NxPadded*(y + NyPadded*z).
+	MPI_Comm cartComm; // Cartesian communicator all of this material's communication uses
+	int dims[3]; // number of ranks along x, y and z
+	int coords[3]; // position of this rank in the Cartesian grid
+	int nbrLo[3]; // rank holding the block below this one along x, y and z (MPI_PROC_NULL on the edge)
+	int nbrHi[3]; // rank holding the block above this one along x, y and z (MPI_PROC_NULL on the edge)
+	unsigned int NxLocal; // unpadded points of this block in the x direction
+	unsigned int NyLocal; // unpadded points of this block in the y direction
+	unsigned int NzLocal; // unpadded points of this block in the z direction
+	unsigned int startXId; // global x index of this block's first unpadded point
+	unsigned int startYId; // global y index of this block's first unpadded point
+	unsigned int startZId; // global z index of this block's first unpadded point
+	unsigned int nPad; // points of padding on each face
+	unsigned int NxPadded; // stride of the padded rows: nPad + NxLocal + nPad, rounded up to an odd number of cache lines (paddedStrideLoc)
+	unsigned int NyPadded; // nPad + NyLocal + nPad
+	unsigned int NzPadded; // nPad + NzLocal + nPad
+} material3DLoc;
+
+// split the Nx x Ny x Nz grid into blocks over all ranks of MPI_COMM_WORLD (MPI_Dims_create picks the
+// rank grid, so it's as close to a cube as the number of ranks allows)
+int initMaterial3DLoc(material3DLoc *aMaterial, unsigned int Nx, unsigned int Ny, unsigned int Nz, unsigned int nPad, float dx, float dy, float dz, float alpha);
+
+// same as initMaterial3DLoc, but over the ranks of comm only
+int initMaterial3DLocComm(material3DLoc *aMaterial, unsigned int Nx, unsigned int Ny, unsigned int Nz, unsigned int nPad, float dx, float dy, float dz, float alpha, MPI_Comm comm);
+
+// free the Cartesian communicator
+int cleanupMaterial3DLoc(material3DLoc *aMaterial);
+#endif
@@ -1,15 +1,23 @@
 #include "materialPar.h"
 #include <mpi.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 // initialize the local material (NxLocal x Ny) to have basic data, set alpha value, figure out
 // padding and starting index rows
 int initMaterialLoc(materialLoc *aMaterial, unsigned int Nx, unsigned int NyTotal, unsigned int nPadRows, float dx, float dy, float alpha)
+{
+    return initMaterialLocComm(aMaterial, Nx, NyTotal, nPadRows, dx, dy, alpha, MPI_COMM_WORLD);
+};
+
+// same as initMaterialLoc, but the rows are split over the ranks of comm
+int initMaterialLocComm(materialLoc *aMaterial, unsigned int Nx, unsigned int NyTotal, unsigned int nPadRows, float dx, float dy, float alpha, MPI_Comm comm)
 {
     // check rank and number of processes
     int rank, nProcs;
-    MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(comm, &nProcs);
+    MPI_Comm_rank(comm, &rank);
+    aMaterial->comm = comm;
 
     // information about how many columns and spacing between each column in grid
     aMaterial->Nx = Nx;
@@ -55,3 +63,83 @@ int initMaterialLoc(materialLoc *aMaterial, unsigned int Nx, unsigned int NyTota
 
     return 0;
 };
+
+// lowest rank of comm on this rank's node (an MPI_COMM_TYPE_SHARED split), which stands for the node
+static int nodeLeaderLoc(MPI_Comm comm, int *leader)
+{
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm nodeComm;
+    if (MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm) != MPI_SUCCESS)
+    {
+        printf("WARNING: In nodeLeaderLoc(), issue splitting the ranks by node \n");
+        return 1;
+    }
+    MPI_Allreduce(&rank, leader, 1, MPI_INT, MPI_MIN, nodeComm);
+    MPI_Comm_free(&nodeComm);
+    return 0;
+};
+
+// Make newComm, the ranks of comm in the order the strips should go in
+int reorderCommLoc(MPI_Comm comm, int reorder, MPI_Comm *newComm)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    if (reorder == REORDER_NONE)
+        return MPI_Comm_dup(comm, newComm);
+
+    if (reorder == REORDER_GRAPH)
+    {
+        // the chain: every rank but the ends talks to the ranks before and after it
+        int neighbours[2];
+        int nNeighbours = 0;
+        if (rank > 0)
+            neighbours[nNeighbours++] = rank - 1;
+        if (rank < size - 1)
+            neighbours[nNeighbours++] = rank + 1;
+        // (equal weights rather than MPI_UNWEIGHTED, a sentinel pointer GCC's -Wstringop-overread takes for an empty array)
+        int weights[2] = {1, 1};
+        return MPI_Dist_graph_create_adjacent(comm, nNeighbours, neighbours, weights, nNeighbours, neighbours, weights, MPI_INFO_NULL, 1, newComm);
+    }
+
+    if (reorder != REORDER_HOST)
+    {
+        printf("WARNING: In reorderCommLoc(), %d is not a rank order \n", reorder);
+        return 1;
+    }
+
+    // each node is known by the lowest rank on it; sort by that (MPI_Comm_split breaks ties by rank)
+    int leader;
+    if (nodeLeaderLoc(comm, &leader))
+        return 1;
+    return MPI_Comm_split(comm, 0, leader, newComm);
+};
+
+// Count the halo links within one host and between hosts
+int haloLinksLoc(MPI_Comm comm, int *intraLinks, int *interLinks)
+{
+    int size;
+    MPI_Comm_size(comm, &size);
+    int leader;
+    int *leaders = (int *)malloc(size * sizeof(int));
+    if ((leaders == NULL) || nodeLeaderLoc(comm, &leader))
+    {
+        printf("WARNING: In haloLinksLoc(), issue finding the node of every rank \n");
+        free(leaders);
+        return 1;
+    }
+    MPI_Allgather(&leader, 1, MPI_INT, leaders, 1, MPI_INT, comm);
+    *intraLinks = 0;
+    *interLinks = 0;
+    int r;
+    for (r = 0; r < size - 1; ++r)
+    {
+        if (leaders[r] == leaders[r + 1])
+            *intraLinks = *intraLinks + 1;
+        else
+            *interLinks = *interLinks + 1;
+    }
+    free(leaders);
+    return 0;
+};
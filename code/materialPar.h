@@ -1,5 +1,12 @@
 #ifndef __MATERIALPAR_H__
 #define __MATERIALPAR_H__
+#include <mpi.h>
+
+// choices of rank order for the strips made by reorderCommLoc
+#define REORDER_NONE 0 // keep the order of the communicator given
+#define REORDER_GRAPH 1 // let MPI reorder the ranks for the chain of halo links (a distributed graph communicator)
+#define REORDER_HOST 2 // ranks on the same host next to each other (hosts in order of their lowest rank)
+
 typedef struct materialLoc_struct{
 	// information inherent to the material itself
 	unsigned int Nx; // number of columns in material grid
@@ -11,7 +18,24 @@ typedef struct materialLoc_struct{
 	unsigned int NyPadded; // number of rows in this local padded subset of the material grid
 	float dy; // spacing (meters) between spatial grid points in y direction
 	float alpha; // homogeneous diffusivity of the medium
+	MPI_Comm comm; // the ranks the rows are distributed over (all communication of this material's simulation uses it)
 } materialLoc;
 
+// distribute the rows over all ranks of MPI_COMM_WORLD
 int initMaterialLoc(materialLoc *aMaterial, unsigned int Nx, unsigned int NyTotal, unsigned int nPadRows, float dx, float dy, float alpha);
+
+// distribute the rows over the ranks of comm only (e.g. one time slice of a parallel in time run)
+int initMaterialLocComm(materialLoc *aMaterial, unsigned int Nx, unsigned int NyTotal, unsigned int nPadRows, float dx, float dy, float alpha, MPI_Comm comm);
+
+// Make newComm, the ranks of comm in the order the strips should go in (rank r owns the r-th strip and
+// exchanges halos with r-1 and r+1), for initMaterialLocComm. REORDER_GRAPH builds a distributed graph
+// communicator of that chain with MPI_Dist_graph_create_adjacent and reordering allowed, which is only as
+// good as the MPI library's mapping (many don't reorder at all); REORDER_HOST puts the ranks of each host
+// (an MPI_COMM_TYPE_SHARED split) next to each other, so only one halo link per pair of consecutive hosts
+// crosses the network. Free newComm
+// with MPI_Comm_free once the material is no longer used.
+int reorderCommLoc(MPI_Comm comm, int reorder, MPI_Comm *newComm);
+
+// Count the halo links (between ranks r and r+1 of comm) within one host and between hosts (every rank gets both)
+int haloLinksLoc(MPI_Comm comm, int *intraLinks, int *interLinks);
 #endif
@@ -0,0 +1,554 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "multigridPar.h"
+#include "simulationPar.h"
+#include "materialPar.h"
+#include "checkPtPar.h"
+#include <mpi.h>
+
+// Fill the single padding row on each side of arrLoc with the neighbouring ranks' edge rows
+static void exchangeLevelLoc(mgLevelLoc *lv, float *arrLoc)
+{
+	if (!lv->active)
+		return;
+	int rank, size;
+	MPI_Comm_rank(lv->comm, &rank);
+	MPI_Comm_size(lv->comm, &size);
+	int nx = lv->Nx;
+	int ny = lv->NyLocal;
+	MPI_Request requests[4];
+	int count = 0;
+	if (rank != 0)
+	{
+		MPI_Irecv(arrLoc, nx, MPI_FLOAT, rank - 1, 1, lv->comm, &requests[count++]);
+		MPI_Isend(arrLoc + nx, nx, MPI_FLOAT, rank - 1, 0, lv->comm, &requests[count++]);
+	}
+	if (rank != size - 1)
+	{
+		MPI_Irecv(arrLoc + (ny + 1) * nx, nx, MPI_FLOAT, rank + 1, 0, lv->comm, &requests[count++]);
+		MPI_Isend(arrLoc + ny * nx, nx, MPI_FLOAT, rank + 1, 1, lv->comm, &requests[count++]);
+	}
+	MPI_Waitall(count, requests, MPI_STATUSES_IGNORE);
+};
+
+// sum of squares of the unpadded rows of arrLoc over all ranks taking part in this level
+static double normSqLoc(mgLevelLoc *lv, float *arrLoc)
+{
+	double localSum = 0.0;
+	int i;
+	int start = lv->Nx;
+	int end = start + lv->NyLocal * lv->Nx;
+	for (i = start; i < end; ++i)
+		localSum += (double)arrLoc[i] * (double)arrLoc[i];
+	double globalSum;
+	MPI_Allreduce(&localSum, &globalSum, 1, MPI_DOUBLE, MPI_SUM, lv->comm);
+	return globalSum;
+};
+
+// nSweeps red-black Gauss-Seidel sweeps of -alpha*laplacian(u) = f on interior points. Colours are
+// decided by the global (row + col) parity so the result doesn't depend on the number of ranks.
+static void smoothLoc(mgLevelLoc *lv, float alpha, int nSweeps)
+{
+	int nx = lv->Nx;
+	float cx = alpha / (lv->dx * lv->dx);
+	float cy = alpha / (lv->dy * lv->dy);
+	float invDiag = 1.0 / (2.0 * cx + 2.0 * cy);
+	int sweep, colour, row, col;
+	for (sweep = 0; sweep < nSweeps; ++sweep)
+	{
+		for (colour = 0; colour < 2; ++colour)
+		{
+			exchangeLevelLoc(lv, lv->uLoc);
+			for (row = 1; row <= (int)lv->NyLocal; ++row)
+			{
+				int globalRow = lv->startYId + row - 1;
+				if (globalRow == 0 || globalRow == (int)lv->NyTotal - 1)
+					continue;
+				// first interior column with the right colour
+				int firstCol = 2 - ((globalRow + colour) % 2);
+				for (col = firstCol; col < nx - 1; col += 2)
+				{
+					int idx = row * nx + col;
+					float *u = lv->uLoc;
+					u[idx] = (lv->fLoc[idx] + cx * (u[idx - 1] + u[idx + 1]) + cy * (u[idx - nx] + u[idx + nx])) * invDiag;
+				}
+			}
+		}
+	}
+};
+
+// residual f + alpha*laplacian(u) on interior points (0 on the boundaries)
+static void residualLoc(mgLevelLoc *lv, float alpha)
+{
+	int nx = lv->Nx;
+	float cx = alpha / (lv->dx * lv->dx);
+	float cy = alpha / (lv->dy * lv->dy);
+	float diag = 2.0 * cx + 2.0 * cy;
+	float *u = lv->uLoc;
+	int row, col;
+	exchangeLevelLoc(lv, u);
+	for (row = 1; row <= (int)lv->NyLocal; ++row)
+	{
+		int globalRow = lv->startYId + row - 1;
+		int interiorRow = (globalRow != 0) && (globalRow != (int)lv->NyTotal - 1);
+		for (col = 0; col < nx; ++col)
+		{
+			int idx = row * nx + col;
+			if (interiorRow && (col != 0) && (col != nx - 1))
+				lv->resLoc[idx] = lv->fLoc[idx] - diag * u[idx] + cx * (u[idx - 1] + u[idx + 1]) + cy * (u[idx - nx] + u[idx + nx]);
+			else
+				lv->resLoc[idx] = 0.0;
+		}
+	}
+};
+
+// rows [first, first + count) a level of NyTotal rows split over nRanks ranks gives rank, split like the material
+static void splitRowsLoc(unsigned int NyTotal, int nRanks, int rank, unsigned int *first, unsigned int *count)
+{
+	if (rank >= nRanks)
+	{
+		*first = NyTotal;
+		*count = 0;
+		return;
+	}
+	unsigned int extra = NyTotal % nRanks;
+	*count = NyTotal / nRanks + ((unsigned int)rank < extra);
+	*first = rank * (NyTotal / nRanks) + (((unsigned int)rank < extra) ? rank : extra);
+};
+
+// position of fine point i (of nFine intervals) on a coarse grid of nCoarse intervals over the same length:
+// between coarse points *i0 and *i0 + 1, a fraction *t of the way along
+static inline void coarsePosLoc(unsigned int i, unsigned int nFine, unsigned int nCoarse, unsigned int *i0, float *t)
+{
+	unsigned long scaled = (unsigned long)i * nCoarse;
+	*i0 = scaled / nFine;
+	*t = (float)(scaled % nFine) / nFine;
+};
+
+// restrict the fine residual onto the coarse right hand side: each rank adds its fine rows' residuals
+// into its window with the interpolation weights, then the owner of each coarse row sums the windows
+// holding it (in rank order, so the sum doesn't depend on timing)
+static void restrictLoc(multigridLoc *thisMgLoc, int fineLevel)
+{
+	mgLevelLoc *fine = &(thisMgLoc->levels[fineLevel]);
+	mgLevelLoc *coarse = &(thisMgLoc->levels[fineLevel + 1]);
+	MPI_Comm comm = ((thisMgLoc->thisSimLoc)->thisMaterialLoc)->comm;
+	int nxf = fine->Nx;
+	int nxc = coarse->Nx;
+	float scale = (fine->dx * fine->dy) / (coarse->dx * coarse->dy);
+
+	memset(coarse->winLoc, 0, coarse->winCount * nxc * sizeof(float));
+	int row, col;
+	for (row = 1; row <= (int)fine->NyLocal; ++row)
+	{
+		unsigned int globalRow = fine->startYId + row - 1;
+		if (globalRow == 0 || globalRow == fine->NyTotal - 1)
+			continue; // no residual on the boundary
+		unsigned int J0;
+		float ty;
+		coarsePosLoc(globalRow, fine->NyTotal - 1, coarse->NyTotal - 1, &J0, &ty);
+		float *win0 = coarse->winLoc + (J0 - coarse->winFirst) * nxc;
+		float *win1 = win0 + nxc;
+		for (col = 1; col < nxf - 1; ++col)
+		{
+			unsigned int I0;
+			float tx;
+			coarsePosLoc(col, nxf - 1, nxc - 1, &I0, &tx);
+			float res = scale * fine->resLoc[row * nxf + col];
+			win0[I0] += (1.0 - ty) * (1.0 - tx) * res;
+			if (tx > 0.0)
+				win0[I0 + 1] += (1.0 - ty) * tx * res;
+			if (ty > 0.0)
+			{
+				win1[I0] += ty * (1.0 - tx) * res;
+				if (tx > 0.0)
+					win1[I0 + 1] += ty * tx * res;
+			}
+		}
+	}
+
+	// every window's share of each coarse row goes to its owner
+	int nRequests = coarse->nFromOwners + coarse->nToWindows;
+	MPI_Request *requests = malloc(nRequests * sizeof(MPI_Request));
+	int b, count = 0;
+	float *recvPos = coarse->recvLoc;
+	for (b = 0; b < coarse->nToWindows; ++b)
+	{
+		mgTransfer *blk = &(coarse->toWindows[b]);
+		MPI_Irecv(recvPos, blk->nRows * nxc, MPI_FLOAT, blk->peer, 2 * fineLevel, comm, &requests[count++]);
+		recvPos += blk->nRows * nxc;
+	}
+	for (b = 0; b < coarse->nFromOwners; ++b)
+	{
+		mgTransfer *blk = &(coarse->fromOwners[b]);
+		MPI_Isend(coarse->winLoc + (blk->firstRow - coarse->winFirst) * nxc, blk->nRows * nxc, MPI_FLOAT, blk->peer, 2 * fineLevel, comm, &requests[count++]);
+	}
+	MPI_Waitall(count, requests, MPI_STATUSES_IGNORE);
+	free(requests);
+
+	if (!coarse->active)
+		return;
+	memset(coarse->fLoc, 0, nxc * (coarse->NyLocal + 2) * sizeof(float));
+	recvPos = coarse->recvLoc;
+	for (b = 0; b < coarse->nToWindows; ++b)
+	{
+		mgTransfer *blk = &(coarse->toWindows[b]);
+		float *target = coarse->fLoc + (1 + blk->firstRow - coarse->startYId) * nxc;
+		int i;
+		for (i = 0; i < (int)blk->nRows * nxc; ++i)
+			target[i] += recvPos[i];
+		recvPos += blk->nRows * nxc;
+	}
+	// the correction is 0 on the boundary
+	for (row = 1; row <= (int)coarse->NyLocal; ++row)
+	{
+		unsigned int globalRow = coarse->startYId + row - 1;
+		if (globalRow == 0 || globalRow == coarse->NyTotal - 1)
+			memset(coarse->fLoc + row * nxc, 0, nxc * sizeof(float));
+		coarse->fLoc[row * nxc] = 0.0;
+		coarse->fLoc[row * nxc + nxc - 1] = 0.0;
+	}
+};
+
+// bilinear interpolation of the coarse correction, added onto the fine solution at interior points
+static void prolongAddLoc(multigridLoc *thisMgLoc, int fineLevel)
+{
+	mgLevelLoc *fine = &(thisMgLoc->levels[fineLevel]);
+	mgLevelLoc *coarse = &(thisMgLoc->levels[fineLevel + 1]);
+	MPI_Comm comm = ((thisMgLoc->thisSimLoc)->thisMaterialLoc)->comm;
+	int nxf = fine->Nx;
+	int nxc = coarse->Nx;
+
+	// fill the window from the owners of its rows
+	int nRequests = coarse->nFromOwners + coarse->nToWindows;
+	MPI_Request *requests = malloc(nRequests * sizeof(MPI_Request));
+	int b, count = 0;
+	for (b = 0; b < coarse->nFromOwners; ++b)
+	{
+		mgTransfer *blk = &(coarse->fromOwners[b]);
+		MPI_Irecv(coarse->winLoc + (blk->firstRow - coarse->winFirst) * nxc, blk->nRows * nxc, MPI_FLOAT, blk->peer, 2 * fineLevel + 1, comm, &requests[count++]);
+	}
+	for (b = 0; b < coarse->nToWindows; ++b)
+	{
+		mgTransfer *blk = &(coarse->toWindows[b]);
+		MPI_Isend(coarse->uLoc + (1 + blk->firstRow - coarse->startYId) * nxc, blk->nRows * nxc, MPI_FLOAT, blk->peer, 2 * fineLevel + 1, comm, &requests[count++]);
+	}
+	MPI_Waitall(count, requests, MPI_STATUSES_IGNORE);
+	free(requests);
+
+	int row, col;
+	for (row = 1; row <= (int)fine->NyLocal; ++row)
+	{
+		unsigned int globalRow = fine->startYId + row - 1;
+		if (globalRow == 0 || globalRow == fine->NyTotal - 1)
+			continue;
+		unsigned int J0;
+		float ty;
+		coarsePosLoc(globalRow, fine->NyTotal - 1, coarse->NyTotal - 1, &J0, &ty);
+		float *win0 = coarse->winLoc + (J0 - coarse->winFirst) * nxc;
+		float *win1 = (ty > 0.0) ? win0 + nxc : win0;
+		for (col = 1; col < nxf - 1; ++col)
+		{
+			unsigned int I0;
+			float tx;
+			coarsePosLoc(col, nxf - 1, nxc - 1, &I0, &tx);
+			unsigned int I1 = (tx > 0.0) ? I0 + 1 : I0;
+			float correction = (1.0 - ty) * ((1.0 - tx) * win0[I0] + tx * win0[I1]) + ty * ((1.0 - tx) * win1[I0] + tx * win1[I1]);
+			fine->uLoc[row * nxf + col] += correction;
+		}
+	}
+};
+
+// one V-cycle starting at level l
+static void vCycleLoc(multigridLoc *thisMgLoc, int l)
+{
+	mgLevelLoc *lv = &(thisMgLoc->levels[l]);
+	if (!lv->active)
+		return;
+	float alpha = ((thisMgLoc->thisSimLoc)->thisMaterialLoc)->alpha;
+	if (l == thisMgLoc->nLevels - 1)
+	{
+		smoothLoc(lv, alpha, thisMgLoc->nCoarseSweeps);
+		return;
+	}
+	smoothLoc(lv, alpha, thisMgLoc->nPreSmooth);
+	residualLoc(lv, alpha);
+	restrictLoc(thisMgLoc, l);
+	mgLevelLoc *coarse = &(thisMgLoc->levels[l + 1]);
+	if (coarse->active)
+	{
+		memset(coarse->uLoc, 0, coarse->Nx * (coarse->NyLocal + 2) * sizeof(float));
+		vCycleLoc(thisMgLoc, l + 1);
+	}
+	prolongAddLoc(thisMgLoc, l);
+	smoothLoc(lv, alpha, thisMgLoc->nPostSmooth);
+};
+
+// allocate the padded arrays of one level
+static int allocLevelLoc(mgLevelLoc *lv)
+{
+	lv->uLoc = NULL;
+	lv->fLoc = NULL;
+	lv->resLoc = NULL;
+	if (!lv->active)
+		return 0;
+	int nPts = lv->Nx * (lv->NyLocal + 2);
+	lv->uLoc = calloc(nPts, sizeof(float));
+	lv->fLoc = calloc(nPts, sizeof(float));
+	lv->resLoc = calloc(nPts, sizeof(float));
+	if ((lv->uLoc == NULL) || (lv->fLoc == NULL) || (lv->resLoc == NULL))
+		return 1;
+	return 0;
+};
+
+// work out this rank's window of coarse (the rows its rows of fine interpolate from) and which blocks of
+// rows move between windows and owners, then allocate the buffers for them
+static int planTransfersLoc(mgLevelLoc *fine, mgLevelLoc *coarse, MPI_Comm comm)
+{
+	int rank, size, r;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	unsigned int nFine = fine->NyTotal - 1;
+	unsigned int nCoarse = coarse->NyTotal - 1;
+	coarse->winFirst = 0;
+	coarse->winCount = 0;
+	if (fine->NyLocal > 0)
+	{
+		unsigned int last = fine->startYId + fine->NyLocal - 1;
+		coarse->winFirst = ((unsigned long)fine->startYId * nCoarse) / nFine;
+		coarse->winCount = ((unsigned long)last * nCoarse + nFine - 1) / nFine - coarse->winFirst + 1;
+	}
+
+	// everyone's owned rows and window
+	unsigned int mine[4] = {coarse->active ? coarse->startYId : 0, coarse->active ? coarse->NyLocal : 0, coarse->winFirst, coarse->winCount};
+	unsigned int *all = malloc(4 * size * sizeof(unsigned int));
+	MPI_Allgather(mine, 4, MPI_UNSIGNED, all, 4, MPI_UNSIGNED, comm);
+	coarse->fromOwners = malloc(size * sizeof(mgTransfer));
+	coarse->toWindows = malloc(size * sizeof(mgTransfer));
+	coarse->nFromOwners = 0;
+	coarse->nToWindows = 0;
+	unsigned int nRecvRows = 0;
+	for (r = 0; r < size; ++r)
+	{
+		unsigned int *theirs = all + 4 * r;
+		// my window against their owned rows
+		unsigned int first = (coarse->winFirst > theirs[0]) ? coarse->winFirst : theirs[0];
+		unsigned int end = (coarse->winFirst + coarse->winCount < theirs[0] + theirs[1]) ? coarse->winFirst + coarse->winCount : theirs[0] + theirs[1];
+		if (first < end)
+		{
+			mgTransfer blk = {r, first, end - first};
+			coarse->fromOwners[coarse->nFromOwners++] = blk;
+		}
+		// my owned rows against their window
+		first = (mine[0] > theirs[2]) ? mine[0] : theirs[2];
+		end = (mine[0] + mine[1] < theirs[2] + theirs[3]) ? mine[0] + mine[1] : theirs[2] + theirs[3];
+		if (first < end)
+		{
+			mgTransfer blk = {r, first, end - first};
+			coarse->toWindows[coarse->nToWindows++] = blk;
+			nRecvRows += end - first;
+		}
+	}
+	free(all);
+	coarse->winLoc = malloc((coarse->winCount * coarse->Nx + 1) * sizeof(float));
+	coarse->recvLoc = malloc((nRecvRows * coarse->Nx + 1) * sizeof(float));
+	if ((coarse->fromOwners == NULL) || (coarse->toWindows == NULL) || (coarse->winLoc == NULL) || (coarse->recvLoc == NULL))
+		return 1;
+	return 0;
+};
+
+// Build the multigrid hierarchy for an already initialized local simulation
+int initMultigridLoc(multigridLoc *thisMgLoc, simLoc *thisSimLoc, int nPreSmooth, int nPostSmooth)
+{
+	if (thisSimLoc->stencilOrder != 2)
+	{
+		printf("WARNING: in initMultigridLoc, only the second order stencil is supported \n");
+		return 1;
+	}
+	if (thisSimLoc->lowMemory)
+	{
+		printf("WARNING: in initMultigridLoc, the simulation can't be in low memory mode \n");
+		return 1;
+	}
+	int flag = 0;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int rank, size;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	MPI_Comm_size(thisMaterialLoc->comm, &size);
+	thisMgLoc->thisSimLoc = thisSimLoc;
+	thisMgLoc->nPreSmooth = nPreSmooth;
+	thisMgLoc->nPostSmooth = nPostSmooth;
+	thisMgLoc->nCycles = 0;
+	thisMgLoc->lastRelRes = 0.0;
+	thisMgLoc->reportCycles = 0;
+
+	// level 0 is distributed exactly like the material
+	mgLevelLoc *lv = &(thisMgLoc->levels[0]);
+	lv->active = 1;
+	lv->nRanks = size;
+	lv->comm = thisMaterialLoc->comm;
+	lv->ownsComm = 0;
+	lv->Nx = thisMaterialLoc->Nx;
+	lv->NyTotal = thisMaterialLoc->NyTotal;
+	lv->NyLocal = thisMaterialLoc->NyLocal;
+	lv->startYId = thisMaterialLoc->startYId;
+	lv->dx = thisMaterialLoc->dx;
+	lv->dy = thisMaterialLoc->dy;
+	lv->winLoc = NULL;
+	lv->recvLoc = NULL;
+	lv->fromOwners = NULL;
+	lv->toWindows = NULL;
+	flag += allocLevelLoc(lv);
+
+	int l = 0;
+	while (l + 1 < MG_MAX_LEVELS)
+	{
+		lv = &(thisMgLoc->levels[l]);
+		// halve the intervals of each direction that still has an interior point after it, unless its
+		// spacing is already more than twice the other direction's
+		unsigned int nxf = lv->Nx - 1;
+		unsigned int nyf = lv->NyTotal - 1;
+		int canX = (nxf >= 3);
+		int canY = (nyf >= 3);
+		int coarsenX = canX && (!canY || (lv->dx <= 2.0 * lv->dy));
+		int coarsenY = canY && (!canX || (lv->dy <= 2.0 * lv->dx));
+		if (!coarsenX && !coarsenY)
+			break; // can't coarsen any further
+
+		mgLevelLoc *coarse = &(thisMgLoc->levels[l + 1]);
+		unsigned int nxc = coarsenX ? (nxf + 1) / 2 : nxf;
+		unsigned int nyc = coarsenY ? (nyf + 1) / 2 : nyf;
+		coarse->Nx = nxc + 1;
+		coarse->NyTotal = nyc + 1;
+		coarse->dx = lv->dx * nxf / nxc;
+		coarse->dy = lv->dy * nyf / nyc;
+
+		// as many of the finer level's ranks as can own MG_MIN_ROWS rows each (at least one)
+		coarse->nRanks = coarse->NyTotal / MG_MIN_ROWS;
+		if (coarse->nRanks > lv->nRanks)
+			coarse->nRanks = lv->nRanks;
+		if (coarse->nRanks < 1)
+			coarse->nRanks = 1;
+		coarse->active = (rank < coarse->nRanks);
+		splitRowsLoc(coarse->NyTotal, coarse->nRanks, rank, &(coarse->startYId), &(coarse->NyLocal));
+		if (coarse->nRanks == lv->nRanks)
+		{
+			coarse->comm = lv->comm;
+			coarse->ownsComm = 0;
+		}
+		else
+		{
+			MPI_Comm_split(thisMaterialLoc->comm, coarse->active ? 0 : MPI_UNDEFINED, rank, &(coarse->comm));
+			coarse->ownsComm = coarse->active;
+		}
+		flag += allocLevelLoc(coarse);
+		flag += planTransfersLoc(lv, coarse, thisMaterialLoc->comm);
+		++l;
+	}
+	thisMgLoc->nLevels = l + 1;
+
+	// the coarsest level is solved by plain sweeps, enough for the information to cross it
+	mgLevelLoc *coarsest = &(thisMgLoc->levels[l]);
+	thisMgLoc->nCoarseSweeps = 2 * (coarsest->Nx + coarsest->NyTotal);
+	if (flag)
+		printf("WARNING: in initMultigridLoc, issue allocating levels \n");
+	return flag;
+};
+
+// Solve for the steady state with heat sources sourceLoc until the residual norm drops by a factor
+// of tol or maxCycles V-cycles are used. The solution is left in the simulation's priorStateLoc.
+int solveSteadyStateLoc(multigridLoc *thisMgLoc, float *sourceLoc, float tol, int maxCycles)
+{
+	simLoc *thisSimLoc = thisMgLoc->thisSimLoc;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	mgLevelLoc *top = &(thisMgLoc->levels[0]);
+	float alpha = thisMaterialLoc->alpha;
+	int nx = top->Nx;
+	int nLocalPts = nx * top->NyLocal;
+	int nPadPts = nx * thisMaterialLoc->nPadRows;
+	int i, flag = 0;
+	int rank;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+
+	// start from the current state (which already holds bdryVal on the boundaries)
+	for (i = 0; i < nLocalPts; ++i)
+	{
+		top->uLoc[nx + i] = loadReal(thisSimLoc->priorStateLoc[nPadPts + i]);
+		top->fLoc[nx + i] = (sourceLoc == NULL) ? 0.0 : sourceLoc[i];
+	}
+
+	residualLoc(top, alpha);
+	double startNorm = sqrt(normSqLoc(top, top->resLoc));
+	double relRes = 0.0;
+	int cycle = 0;
+	if (startNorm > 0.0)
+	{
+		relRes = 1.0;
+		while ((relRes > tol) && (cycle < maxCycles))
+		{
+			vCycleLoc(thisMgLoc, 0);
+			residualLoc(top, alpha);
+			relRes = sqrt(normSqLoc(top, top->resLoc)) / startNorm;
+			++cycle;
+			if (thisMgLoc->reportCycles && rank == 0)
+				printf("V-cycle %d: relative residual %g \n", cycle, relRes);
+		}
+	}
+	if (relRes > tol)
+	{
+		printf("WARNING: in solveSteadyStateLoc, no convergence after %d V-cycles (relative residual %g) \n", cycle, relRes);
+		flag = 1;
+	}
+	thisMgLoc->nCycles = cycle;
+	thisMgLoc->lastRelRes = relRes;
+
+	// hand the solution back to the simulation
+	for (i = 0; i < nLocalPts; ++i)
+	{
+		thisSimLoc->priorStateLoc[nPadPts + i] = storeReal(top->uLoc[nx + i]);
+		thisSimLoc->currentStateLoc[nPadPts + i] = storeReal(top->uLoc[nx + i]);
+	}
+	return flag;
+};
+
+// Write the current steady state as a single snapshot file in the same format as writeToFileLoc
+int writeSteadyStateLoc(multigridLoc *thisMgLoc, const char *filename)
+{
+	simLoc *thisSimLoc = thisMgLoc->thisSimLoc;
+	checkPtTimeLoc steadyCheckLoc;
+	int flag = initCheckPtTimeLoc(&steadyCheckLoc, thisSimLoc->thisMaterialLoc, thisSimLoc, 1);
+	flag += recordSnapLoc(&steadyCheckLoc);
+	flag += writeToFileLoc(&steadyCheckLoc, filename);
+	flag += cleanupCheckPtTimeLoc(&steadyCheckLoc);
+	return flag;
+};
+
+// deallocate the arrays of every level
+int cleanupMultigridLoc(multigridLoc *thisMgLoc)
+{
+	int l;
+	for (l = 0; l < thisMgLoc->nLevels; ++l)
+	{
+		mgLevelLoc *lv = &(thisMgLoc->levels[l]);
+		free(lv->uLoc);
+		lv->uLoc = NULL;
+		free(lv->fLoc);
+		lv->fLoc = NULL;
+		free(lv->resLoc);
+		lv->resLoc = NULL;
+		free(lv->winLoc);
+		lv->winLoc = NULL;
+		free(lv->recvLoc);
+		lv->recvLoc = NULL;
+		free(lv->fromOwners);
+		lv->fromOwners = NULL;
+		free(lv->toWindows);
+		lv->toWindows = NULL;
+		if (lv->ownsComm)
+			MPI_Comm_free(&(lv->comm));
+		lv->ownsComm = 0;
+	}
+	return 0;
+};
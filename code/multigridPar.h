@@ -0,0 +1,80 @@
+#ifndef __MULTIGRIDPAR_H__
+#define __MULTIGRIDPAR_H__
+#include <mpi.h>
+
+// forward declarations of structs a multigridLoc will have pointers to
+typedef struct simLoc_struct simLoc;
+
+#define MG_MAX_LEVELS 24 // more than enough levels for any grid that fits in memory
+#define MG_MIN_ROWS 4 // a coarse level is spread over as many ranks as can each own at least this many of its rows
+
+// a block of rows of a coarse level one rank sends to or receives from another when moving between levels
+typedef struct mgTransfer_struct{
+	int peer; // rank in the material's communicator
+	unsigned int firstRow; // global index of the first row of the block
+	unsigned int nRows; // number of rows in the block
+} mgTransfer;
+
+// one level of the multigrid hierarchy, distributed in row strips over the first nRanks ranks like materialLoc
+typedef struct mgLevelLoc_struct{
+	int active; // nonzero if this rank holds part of this level
+	int nRanks; // number of ranks holding part of this level (the first nRanks of the material's communicator)
+	MPI_Comm comm; // those ranks (MPI_COMM_NULL on the others)
+	int ownsComm; // nonzero if comm was split off for this level and must be freed with it
+	unsigned int Nx; // number of columns at this level
+	unsigned int NyTotal; // number of rows at this level over all ranks
+	unsigned int NyLocal; // number of rows owned by this rank at this level
+	unsigned int startYId; // global index of the first row owned by this rank at this level
+	float dx; // spacing between columns at this level
+	float dy; // spacing between rows at this level
+	float *uLoc; // solution (or correction on coarser levels), padded with 1 row on each side
+	float *fLoc; // right hand side, padded with 1 row on each side
+	float *resLoc; // residual, padded with 1 row on each side
+
+	// moving to and from the next finer level (unused on level 0). Each rank of the finer level works on a
+	// window of this level's rows: the ones its fine rows interpolate from, which are also the ones their
+	// residuals restrict onto. Windows of neighbouring ranks overlap, so restricted rows are summed by their owner.
+	unsigned int winFirst; // global index of the first row of this rank's window
+	unsigned int winCount; // number of rows in this rank's window (0 if it holds no rows of the finer level)
+	float *winLoc; // the window's rows
+	int nFromOwners; // number of blocks of the window owned by some rank (this one included)
+	mgTransfer *fromOwners; // those blocks, by increasing peer
+	int nToWindows; // number of blocks of this rank's owned rows in some rank's window (this one included)
+	mgTransfer *toWindows; // those blocks, by increasing peer
+	float *recvLoc; // restricted rows of the toWindows blocks, as they arrive
+} mgLevelLoc;
+
+typedef struct multigridLoc_struct{
+	// Solves the steady state problem -alpha*(d^2u/dx^2 + d^2u/dy^2) = source with u = bdryVal on the
+	// boundary of the material, using V-cycles with red-black Gauss-Seidel smoothing. Each coarser level
+	// has half as many intervals in a direction (rounded up), so grids of any size coarsen down to a few
+	// points; a direction whose spacing is already more than twice the other's waits for it. Corrections
+	// are interpolated bilinearly and residuals restricted with the transpose of that interpolation.
+	// Coarse levels with too few rows for every rank to own MG_MIN_ROWS of them are spread over fewer ranks.
+	simLoc *thisSimLoc; // an already initialized local simulation (material, bdryVal and starting guess)
+	int nLevels; // number of levels in the hierarchy (level 0 is the simulation grid)
+	mgLevelLoc levels[MG_MAX_LEVELS];
+	int nPreSmooth; // red-black sweeps before restricting
+	int nPostSmooth; // red-black sweeps after prolongating
+	int nCoarseSweeps; // red-black sweeps on the coarsest level
+	int nCycles; // number of V-cycles used by the last solve
+	float lastRelRes; // residual norm relative to the starting residual norm after the last solve
+	int reportCycles; // if nonzero, rank 0 prints the residual after every V-cycle
+} multigridLoc;
+
+// Build the multigrid hierarchy for an already initialized local simulation
+int initMultigridLoc(multigridLoc *thisMgLoc, simLoc *thisSimLoc, int nPreSmooth, int nPostSmooth);
+
+// Solve for the steady state with heat sources sourceLoc (thisMaterial.Nx x thisMaterial.NyLocal points
+// of temperature change per second, or NULL for no sources) until the residual norm drops by a factor
+// of tol or maxCycles V-cycles are used. The solution is left in the simulation's priorStateLoc, so
+// it can be recorded with recordSnapLoc like any other state.
+int solveSteadyStateLoc(multigridLoc *thisMgLoc, float *sourceLoc, float tol, int maxCycles);
+
+// Write the current steady state as a single snapshot file in the same format as writeToFileLoc
+int writeSteadyStateLoc(multigridLoc *thisMgLoc, const char *filename);
+
+// deallocate the arrays of every level
+int cleanupMultigridLoc(multigridLoc *thisMgLoc);
+
+#endif
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "pararealPar.h"
+#include "materialPar.h"
+#include "simulationPar.h"
+#include "implicitPar.h"
+#include <mpi.h>
+
+#if defined(HEAT_FP64) || defined(HEAT_BF16) || defined(HEAT_FP16)
+#error "pararealPar.c copies the states as float and uses the implicit solver, so it is only built in the fp32 mode of precision.h"
+#endif
+
+// Start thisSimLoc from the unpadded local state startLoc, take nSteps steps (backward Euler if
+// thisImpLoc is not NULL, oneStepLoc otherwise) and copy the unpadded result into endLoc
+static int propagateLoc(simLoc *thisSimLoc, implicitLoc *thisImpLoc, float *startLoc, float *endLoc, int nSteps)
+{
+	int flag = 0;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int nPadPts = thisMaterialLoc->nPadRows * thisMaterialLoc->Nx;
+	int nLocalPts = thisMaterialLoc->NyLocal * thisMaterialLoc->Nx;
+	int totalPoints = thisMaterialLoc->NyPadded * thisMaterialLoc->Nx;
+	int i, step;
+	for (i = 0; i < nLocalPts; ++i)
+		thisSimLoc->priorStateLoc[nPadPts + i] = startLoc[i];
+	if (thisImpLoc != NULL)
+	{
+		// start every coarse solve from a zero correction so G is the same function every sweep
+		for (i = 0; i < totalPoints; ++i)
+			thisImpLoc->deltaLoc[i] = 0.0;
+	}
+	for (step = 0; step < nSteps; ++step)
+	{
+		if (thisImpLoc != NULL)
+			flag += oneStepImplicitLoc(thisImpLoc);
+		else
+			flag += oneStepLoc(thisSimLoc);
+	}
+	for (i = 0; i < nLocalPts; ++i)
+		endLoc[i] = thisSimLoc->priorStateLoc[nPadPts + i];
+	return flag;
+};
+
+// Split MPI_COMM_WORLD into time slices and set up the fine and coarse propagators of this slice
+int initPararealLoc(pararealLoc *thisParaLoc, int nSlices, unsigned int Nx, unsigned int NyTotal, float dx, float dy, float alpha, float fineDt, int nSteps, int nCoarseSteps, float *valsForInitStateGlobal, float bdryVal)
+{
+	int flag = 0;
+	int worldRank, worldSize;
+	MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+	MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+	if ((nSlices < 1) || (worldSize % nSlices != 0))
+	{
+		if (worldRank == 0)
+			printf("WARNING: in initPararealLoc, %d ranks can't be split into %d time slices \n", worldSize, nSlices);
+		return 1;
+	}
+	if (nSteps % nSlices != 0)
+	{
+		if (worldRank == 0)
+			printf("WARNING: in initPararealLoc, %d steps don't split evenly into %d slices, using %d \n", nSteps, nSlices, (nSteps / nSlices) * nSlices);
+		flag = 1;
+	}
+
+	// consecutive world ranks share a time slice
+	int sliceSize = worldSize / nSlices;
+	thisParaLoc->nSlices = nSlices;
+	thisParaLoc->sliceId = worldRank / sliceSize;
+	MPI_Comm_split(MPI_COMM_WORLD, thisParaLoc->sliceId, worldRank, &(thisParaLoc->spaceComm));
+	MPI_Comm_split(MPI_COMM_WORLD, worldRank % sliceSize, worldRank, &(thisParaLoc->timeComm));
+
+	// every slice holds the whole material, split over its own ranks
+	int nPadRows = 1;
+	flag += initMaterialLocComm(&(thisParaLoc->sliceMaterialLoc), Nx, NyTotal, nPadRows, dx, dy, alpha, thisParaLoc->spaceComm);
+	flag += initSimLoc(&(thisParaLoc->fineSimLoc), fineDt, valsForInitStateGlobal, bdryVal, &(thisParaLoc->sliceMaterialLoc));
+	flag += initSimLoc(&(thisParaLoc->coarseSimLoc), fineDt, valsForInitStateGlobal, bdryVal, &(thisParaLoc->sliceMaterialLoc));
+	thisParaLoc->nFineSteps = nSteps / nSlices;
+	thisParaLoc->nCoarseSteps = nCoarseSteps;
+	thisParaLoc->sliceTime = fineDt * thisParaLoc->nFineSteps;
+	flag += initImplicitLoc(&(thisParaLoc->coarseImpLoc), &(thisParaLoc->coarseSimLoc), thisParaLoc->sliceTime / nCoarseSteps, PRECOND_CHEBYSHEV, 1e-6, 500);
+
+	// slice 0 starts from the initial state, the others get theirs from the coarse sweep
+	int nLocalPts = Nx * thisParaLoc->sliceMaterialLoc.NyLocal;
+	thisParaLoc->startLoc = malloc(nLocalPts * sizeof(float));
+	thisParaLoc->fineEndLoc = malloc(nLocalPts * sizeof(float));
+	thisParaLoc->coarseEndLoc = malloc(nLocalPts * sizeof(float));
+	thisParaLoc->endLoc = malloc(nLocalPts * sizeof(float));
+	if ((thisParaLoc->startLoc == NULL) || (thisParaLoc->fineEndLoc == NULL) || (thisParaLoc->coarseEndLoc == NULL) || (thisParaLoc->endLoc == NULL))
+	{
+		printf("WARNING: in initPararealLoc, issue allocating slice states \n");
+		return 1;
+	}
+	int i;
+	for (i = 0; i < nLocalPts; ++i)
+		thisParaLoc->startLoc[i] = thisParaLoc->fineSimLoc.initStateLoc[i];
+
+	thisParaLoc->nIters = 0;
+	thisParaLoc->corrections = NULL;
+	thisParaLoc->iterTimes = NULL;
+	thisParaLoc->coarseSweepTime = 0.0;
+	thisParaLoc->maxItersAlloc = 0;
+	return flag;
+};
+
+// Run Parareal iterations until the slice start states change by less than tol
+int runPararealLoc(pararealLoc *thisParaLoc, float tol, int maxIters)
+{
+	int flag = 0;
+	int sliceId = thisParaLoc->sliceId;
+	int nSlices = thisParaLoc->nSlices;
+	int nLocalPts = thisParaLoc->sliceMaterialLoc.Nx * thisParaLoc->sliceMaterialLoc.NyLocal;
+	float *startLoc = thisParaLoc->startLoc;
+	float *fineEndLoc = thisParaLoc->fineEndLoc;
+	float *coarseEndLoc = thisParaLoc->coarseEndLoc;
+	float *endLoc = thisParaLoc->endLoc;
+	int i, iter;
+
+	// after nSlices iterations every slice has been corrected from an exact start
+	if (maxIters > nSlices)
+		maxIters = nSlices;
+	free(thisParaLoc->corrections);
+	free(thisParaLoc->iterTimes);
+	thisParaLoc->corrections = malloc(maxIters * sizeof(float));
+	thisParaLoc->iterTimes = malloc(maxIters * sizeof(double));
+	thisParaLoc->maxItersAlloc = maxIters;
+	if ((thisParaLoc->corrections == NULL) || (thisParaLoc->iterTimes == NULL))
+	{
+		printf("WARNING: in runPararealLoc, issue allocating the iteration history \n");
+		return 1;
+	}
+
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+
+	// coarse prediction of every slice's start state, one slice after the other
+	if (sliceId > 0)
+		MPI_Recv(startLoc, nLocalPts, MPI_FLOAT, sliceId - 1, 0, thisParaLoc->timeComm, MPI_STATUS_IGNORE);
+	flag += propagateLoc(&(thisParaLoc->coarseSimLoc), &(thisParaLoc->coarseImpLoc), startLoc, coarseEndLoc, thisParaLoc->nCoarseSteps);
+	for (i = 0; i < nLocalPts; ++i)
+		endLoc[i] = coarseEndLoc[i];
+	if (sliceId < nSlices - 1)
+		MPI_Send(endLoc, nLocalPts, MPI_FLOAT, sliceId + 1, 0, thisParaLoc->timeComm);
+	thisParaLoc->coarseSweepTime = MPI_Wtime() - start;
+
+	thisParaLoc->nIters = 0;
+	for (iter = 0; iter < maxIters; ++iter)
+	{
+		// fine propagation of all slices at once
+		flag += propagateLoc(&(thisParaLoc->fineSimLoc), NULL, startLoc, fineEndLoc, thisParaLoc->nFineSteps);
+
+		// coarse sweep applying the correction, one slice after the other
+		float localChange = 0.0;
+		if (sliceId > 0)
+		{
+			MPI_Recv(endLoc, nLocalPts, MPI_FLOAT, sliceId - 1, 0, thisParaLoc->timeComm, MPI_STATUS_IGNORE);
+			for (i = 0; i < nLocalPts; ++i)
+			{
+				float change = fabs(endLoc[i] - startLoc[i]);
+				if (change > localChange)
+					localChange = change;
+				startLoc[i] = endLoc[i];
+			}
+		}
+		flag += propagateLoc(&(thisParaLoc->coarseSimLoc), &(thisParaLoc->coarseImpLoc), startLoc, endLoc, thisParaLoc->nCoarseSteps);
+		for (i = 0; i < nLocalPts; ++i)
+		{
+			float coarseNew = endLoc[i];
+			endLoc[i] = coarseNew + fineEndLoc[i] - coarseEndLoc[i];
+			coarseEndLoc[i] = coarseNew;
+		}
+		if (sliceId < nSlices - 1)
+			MPI_Send(endLoc, nLocalPts, MPI_FLOAT, sliceId + 1, 0, thisParaLoc->timeComm);
+
+		float change;
+		MPI_Allreduce(&localChange, &change, 1, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+		thisParaLoc->corrections[iter] = change;
+		thisParaLoc->iterTimes[iter] = MPI_Wtime() - start;
+		thisParaLoc->nIters = iter + 1;
+		if (change < tol)
+			break;
+	}
+	return flag;
+};
+
+// Gather the state at the end of the last slice onto rank 0 of MPI_COMM_WORLD
+int gatherPararealEndLoc(pararealLoc *thisParaLoc, float *globalEnd)
+{
+	int worldRank, sliceRank, sliceSize;
+	MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+	MPI_Comm_rank(thisParaLoc->spaceComm, &sliceRank);
+	MPI_Comm_size(thisParaLoc->spaceComm, &sliceSize);
+	materialLoc *thisMaterialLoc = &(thisParaLoc->sliceMaterialLoc);
+	int nGlobalPts = thisMaterialLoc->Nx * thisMaterialLoc->NyTotal;
+	int lastRoot = (thisParaLoc->nSlices - 1) * sliceSize; // world rank of the last slice's rank 0
+
+	if (thisParaLoc->sliceId == thisParaLoc->nSlices - 1)
+	{
+		int nLocalPts = thisMaterialLoc->Nx * thisMaterialLoc->NyLocal;
+		int myDispl = thisMaterialLoc->Nx * thisMaterialLoc->startYId;
+		int *counts = malloc(sliceSize * sizeof(int));
+		int *displs = malloc(sliceSize * sizeof(int));
+		float *recvBuf = (worldRank == 0) ? globalEnd : NULL;
+		if ((sliceRank == 0) && (worldRank != 0))
+			recvBuf = malloc(nGlobalPts * sizeof(float));
+		MPI_Gather(&nLocalPts, 1, MPI_INT, counts, 1, MPI_INT, 0, thisParaLoc->spaceComm);
+		MPI_Gather(&myDispl, 1, MPI_INT, displs, 1, MPI_INT, 0, thisParaLoc->spaceComm);
+		MPI_Gatherv(thisParaLoc->endLoc, nLocalPts, MPI_FLOAT, recvBuf, counts, displs, MPI_FLOAT, 0, thisParaLoc->spaceComm);
+		if ((sliceRank == 0) && (worldRank != 0))
+		{
+			MPI_Send(recvBuf, nGlobalPts, MPI_FLOAT, 0, 0, MPI_COMM_WORLD);
+			free(recvBuf);
+		}
+		free(counts);
+		free(displs);
+	}
+	else if ((worldRank == 0) && (lastRoot != 0))
+	{
+		MPI_Recv(globalEnd, nGlobalPts, MPI_FLOAT, lastRoot, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+	}
+	return 0;
+};
+
+// deallocate the states, propagators and communicators
+int cleanupPararealLoc(pararealLoc *thisParaLoc)
+{
+	free(thisParaLoc->startLoc);
+	thisParaLoc->startLoc = NULL;
+	free(thisParaLoc->fineEndLoc);
+	thisParaLoc->fineEndLoc = NULL;
+	free(thisParaLoc->coarseEndLoc);
+	thisParaLoc->coarseEndLoc = NULL;
+	free(thisParaLoc->endLoc);
+	thisParaLoc->endLoc = NULL;
+	free(thisParaLoc->corrections);
+	thisParaLoc->corrections = NULL;
+	free(thisParaLoc->iterTimes);
+	thisParaLoc->iterTimes = NULL;
+	cleanupImplicitLoc(&(thisParaLoc->coarseImpLoc));
+	cleanupSimLoc(&(thisParaLoc->coarseSimLoc));
+	cleanupSimLoc(&(thisParaLoc->fineSimLoc));
+	MPI_Comm_free(&(thisParaLoc->spaceComm));
+	MPI_Comm_free(&(thisParaLoc->timeComm));
+	return 0;
+};
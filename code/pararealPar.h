@@ -0,0 +1,56 @@
+#ifndef __PARAREALPAR_H__
+#define __PARAREALPAR_H__
+#include <mpi.h>
+#include "materialPar.h"
+#include "simulationPar.h"
+#include "implicitPar.h"
+
+typedef struct pararealLoc_struct{
+	// Parareal: MPI_COMM_WORLD is split into nSlices time slices of equal length, and each slice
+	// spreads its rows over its own spaceComm. Ranks holding the same rows in every slice form a
+	// timeComm, which carries slice start states down the time line. Every iteration all slices
+	// run the fine propagator F (forward Euler oneStepLoc steps) from their start state at once,
+	// then the coarse propagator G (a few backward Euler steps) sweeps down the slices with the
+	// correction U_(k+1) = G(new U_k) + F(old U_k) - G(old U_k).
+	int nSlices; // number of time slices
+	int sliceId; // which time slice this rank works on
+	MPI_Comm spaceComm; // ranks of this time slice
+	MPI_Comm timeComm; // ranks with the same rows in every time slice (rank within it is sliceId)
+	materialLoc sliceMaterialLoc; // rows of this rank within its time slice
+	simLoc fineSimLoc; // fine propagator state
+	simLoc coarseSimLoc; // coarse propagator state
+	implicitLoc coarseImpLoc; // backward Euler solver of the coarse propagator
+	int nFineSteps; // fine time steps per slice
+	int nCoarseSteps; // coarse time steps per slice
+	float sliceTime; // simulated seconds per slice
+
+	// unpadded local states (sliceMaterialLoc.Nx x sliceMaterialLoc.NyLocal points)
+	float *startLoc; // U_k, the state at the start of this slice
+	float *fineEndLoc; // F(U_k)
+	float *coarseEndLoc; // G(U_k) from the latest coarse sweep
+	float *endLoc; // U_(k+1), the state this slice hands to the next one
+
+	// convergence and timing history
+	int nIters; // number of Parareal iterations done
+	float *corrections; // largest change of any slice start state in each iteration
+	double *iterTimes; // wall seconds from the start of runPararealLoc to the end of each iteration
+	double coarseSweepTime; // wall seconds of the initial coarse sweep
+	int maxItersAlloc; // length of corrections and iterTimes
+} pararealLoc;
+
+// Split MPI_COMM_WORLD into nSlices time slices (the number of ranks must be a multiple of nSlices),
+// distribute the material over each slice, and set up the fine propagator (nSteps forward Euler steps
+// of size fineDt in total, nSteps/nSlices per slice) and the coarse one (nCoarseSteps backward Euler
+// steps per slice). valsForInitStateGlobal is the Nx x NyTotal initial state, like for initSimLoc.
+int initPararealLoc(pararealLoc *thisParaLoc, int nSlices, unsigned int Nx, unsigned int NyTotal, float dx, float dy, float alpha, float fineDt, int nSteps, int nCoarseSteps, float *valsForInitStateGlobal, float bdryVal);
+
+// Run Parareal iterations until the slice start states change by less than tol (or maxIters, at most
+// nSlices since the iteration is exact by then). Records the correction and time of every iteration.
+int runPararealLoc(pararealLoc *thisParaLoc, float tol, int maxIters);
+
+// Gather the state at the end of the last slice into globalEnd (Nx x NyTotal) on rank 0 of MPI_COMM_WORLD
+int gatherPararealEndLoc(pararealLoc *thisParaLoc, float *globalEnd);
+
+// deallocate the states, propagators and communicators
+int cleanupPararealLoc(pararealLoc *thisParaLoc);
+#endif
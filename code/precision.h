@@ -0,0 +1,69 @@
+#ifndef __PRECISION_H__
+#define __PRECISION_H__
+#include <stdint.h>
+#include <string.h>
+
+// Storage type of the temperature fields of the parallel explicit engine (simulationPar, checkPtPar):
+// the padded states, halos, RKL2 stages, snapshots and every MPI buffer holding them are real_t, while
+// the stencil arithmetic is done in acc_t. Values go through loadReal/storeReal between the two.
+// Pick the mode at compile time:
+//   (nothing)    fp32 storage, fp32 arithmetic (the original engine, output unchanged)
+//   -DHEAT_FP64  fp64 storage, fp64 arithmetic
+//   -DHEAT_BF16  bfloat16 storage (round to nearest even), fp32 arithmetic
+//   -DHEAT_FP16  IEEE half storage, fp32 arithmetic
+// The multigrid and spectral modules convert through loadReal/storeReal too. The implicit, Parareal
+// and AMR modules use the states as float and stop with #error outside the fp32 mode.
+
+#if defined(HEAT_FP64)
+typedef double real_t;
+typedef double acc_t;
+#define MPI_REAL_T MPI_DOUBLE
+#define REAL_DTYPE "float64"
+#define REAL_FMT " %.17g ,"
+static inline acc_t loadReal(real_t v) { return v; }
+static inline real_t storeReal(acc_t v) { return v; }
+
+#elif defined(HEAT_BF16)
+typedef uint16_t real_t; // upper half of an fp32
+typedef float acc_t;
+#define MPI_REAL_T MPI_UINT16_T
+#define REAL_DTYPE "bfloat16"
+#define REAL_FMT " %f ,"
+static inline acc_t loadReal(real_t v)
+{
+	uint32_t bits = (uint32_t)v << 16;
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+static inline real_t storeReal(acc_t f)
+{
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(bits));
+	if ((bits & 0x7fffffff) > 0x7f800000)
+		return (bits >> 16) | 0x40; // keep NaNs quiet NaNs
+	bits += 0x7fff + ((bits >> 16) & 1);
+	return bits >> 16;
+}
+
+#elif defined(HEAT_FP16)
+typedef _Float16 real_t;
+typedef float acc_t;
+#define MPI_REAL_T MPI_UINT16_T // moved as raw bits
+#define REAL_DTYPE "float16"
+#define REAL_FMT " %f ,"
+static inline acc_t loadReal(real_t v) { return v; }
+static inline real_t storeReal(acc_t v) { return v; }
+
+#else
+typedef float real_t;
+typedef float acc_t;
+#define MPI_REAL_T MPI_FLOAT
+#define REAL_DTYPE "float32"
+#define REAL_FMT " %f ,"
+#define REAL_IS_FLOAT 1 // files keep the original 3 line header
+static inline acc_t loadReal(real_t v) { return v; }
+static inline real_t storeReal(acc_t v) { return v; }
+#endif
+
+#endif
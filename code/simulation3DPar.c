@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "simulation3DPar.h"
+#include "material3DPar.h"
+#include "checkPt3DPar.h"
+#include "allocPar.h"
+#include <mpi.h>
+
+// Calculate the maximum stable time step: dt <= 1/(2*alpha*(1/dx^2 + 1/dy^2 + 1/dz^2))
+float calcMaxTimeStep3DLoc(sim3DLoc *thisSim3DLoc)
+{
+	material3DLoc *thisMaterial = thisSim3DLoc->thisMaterial3DLoc;
+	float invSq = 1.0 / (thisMaterial->dx * thisMaterial->dx) + 1.0 / (thisMaterial->dy * thisMaterial->dy) + 1.0 / (thisMaterial->dz * thisMaterial->dz);
+	return 1.0 / (2 * thisMaterial->alpha * invSq);
+};
+
+// Initialize the local initial state and the padded states, and build the face datatypes
+int initSim3DLoc(sim3DLoc *thisSim3DLoc, float timeStep, float *valsForInitStateGlobal, float bdryVal, material3DLoc *thisMaterial3DLoc)
+{
+	int flag = 0;
+	thisSim3DLoc->thisMaterial3DLoc = thisMaterial3DLoc;
+	thisSim3DLoc->dtMax = calcMaxTimeStep3DLoc(thisSim3DLoc);
+	thisSim3DLoc->dt = timeStep;
+	if (timeStep >= thisSim3DLoc->dtMax)
+	{
+		printf("WARNING: In initSim3DLoc(), requested time step exceeds stability limit. Unphysical behavior is likely. \n");
+		flag = 1;
+	}
+	thisSim3DLoc->currentTimeIdx = 0;
+	thisSim3DLoc->bdryVal = bdryVal;
+	thisSim3DLoc->blockY = SIM3D_BLOCK_Y;
+
+	// this block's part of the global initial state, with the boundary value on the faces of the global grid
+	unsigned int Nx = thisMaterial3DLoc->Nx, Ny = thisMaterial3DLoc->Ny, Nz = thisMaterial3DLoc->Nz;
+	unsigned int nxl = thisMaterial3DLoc->NxLocal, nyl = thisMaterial3DLoc->NyLocal, nzl = thisMaterial3DLoc->NzLocal;
+	unsigned int nxp = thisMaterial3DLoc->NxPadded, nyp = thisMaterial3DLoc->NyPadded, nzp = thisMaterial3DLoc->NzPadded;
+	unsigned int nPad = thisMaterial3DLoc->nPad;
+	long nLocalPts = (long)nxl * nyl * nzl;
+	long nPaddedPts = (long)nxp * nyp * nzp;
+	thisSim3DLoc->initStateLoc = allocArrayLoc(nLocalPts * sizeof(real_t));
+	thisSim3DLoc->priorStateLoc = allocArrayLoc(nPaddedPts * sizeof(real_t));
+	thisSim3DLoc->currentStateLoc = allocArrayLoc(nPaddedPts * sizeof(real_t));
+	if ((thisSim3DLoc->initStateLoc == NULL) || (thisSim3DLoc->priorStateLoc == NULL) || (thisSim3DLoc->currentStateLoc == NULL))
+	{
+		printf("WARNING: In initSim3DLoc(), issue allocating the local states \n");
+		return 1;
+	}
+	unsigned int x, y, z;
+	for (z = 0; z < nzl; ++z)
+	{
+		unsigned int gz = thisMaterial3DLoc->startZId + z;
+		for (y = 0; y < nyl; ++y)
+		{
+			unsigned int gy = thisMaterial3DLoc->startYId + y;
+			for (x = 0; x < nxl; ++x)
+			{
+				unsigned int gx = thisMaterial3DLoc->startXId + x;
+				float val = valsForInitStateGlobal[gx + (long)Nx * (gy + (long)Ny * gz)];
+				if (gx == 0 || gx == Nx - 1 || gy == 0 || gy == Ny - 1 || gz == 0 || gz == Nz - 1)
+					val = bdryVal;
+				thisSim3DLoc->initStateLoc[x + (long)nxl * (y + (long)nyl * z)] = storeReal(val);
+			}
+		}
+	}
+
+	// both padded states start as the initial state surrounded by the boundary value. The sweep never writes
+	// the global faces or the halos outside them, so they keep the boundary value for the whole run.
+	long i;
+	for (i = 0; i < nPaddedPts; ++i)
+	{
+		thisSim3DLoc->priorStateLoc[i] = storeReal(bdryVal);
+		thisSim3DLoc->currentStateLoc[i] = storeReal(bdryVal);
+	}
+	for (z = 0; z < nzl; ++z)
+	{
+		for (y = 0; y < nyl; ++y)
+		{
+			for (x = 0; x < nxl; ++x)
+			{
+				long idx = (x + nPad) + (long)nxp * ((y + nPad) + (long)nyp * (z + nPad));
+				thisSim3DLoc->priorStateLoc[idx] = thisSim3DLoc->initStateLoc[x + (long)nxl * (y + (long)nyl * z)];
+				thisSim3DLoc->currentStateLoc[idx] = thisSim3DLoc->priorStateLoc[idx];
+			}
+		}
+	}
+
+	// face datatypes: nPad points of every (y, z) row for x faces, nPad rows of every z plane for y faces,
+	// and nPad whole planes for z faces
+	MPI_Type_vector(nyp * nzp, nPad, nxp, MPI_REAL_T, &(thisSim3DLoc->faceType[0]));
+	MPI_Type_vector(nzp, nPad * nxp, nxp * nyp, MPI_REAL_T, &(thisSim3DLoc->faceType[1]));
+	MPI_Type_contiguous(nPad * nxp * nyp, MPI_REAL_T, &(thisSim3DLoc->faceType[2]));
+	int d;
+	for (d = 0; d < 3; ++d)
+		MPI_Type_commit(&(thisSim3DLoc->faceType[d]));
+	return flag;
+};
+
+// Choose the number of y rows per cache block of the sweep
+int setBlocking3DLoc(sim3DLoc *thisSim3DLoc, int blockY)
+{
+	if (blockY < 1)
+	{
+		printf("WARNING: In setBlocking3DLoc(), blockY must be at least 1 \n");
+		return 1;
+	}
+	thisSim3DLoc->blockY = blockY;
+	return 0;
+};
+
+// Fill the face halos of priorStateLoc from the 6 neighbouring blocks
+int exchangeFaces3DLoc(sim3DLoc *thisSim3DLoc)
+{
+	material3DLoc *thisMaterial = thisSim3DLoc->thisMaterial3DLoc;
+	real_t *state = thisSim3DLoc->priorStateLoc;
+	long stride[3] = {1, thisMaterial->NxPadded, (long)thisMaterial->NxPadded * thisMaterial->NyPadded};
+	unsigned int nLocal[3] = {thisMaterial->NxLocal, thisMaterial->NyLocal, thisMaterial->NzLocal};
+	long nPad = thisMaterial->nPad;
+	int flag = 0;
+	int d;
+	for (d = 0; d < 3; ++d)
+	{
+		// first interior layers go down, and the ones above come back into the upper halo ...
+		flag += MPI_Sendrecv(&(state[nPad * stride[d]]), 1, thisSim3DLoc->faceType[d], thisMaterial->nbrLo[d], d,
+							 &(state[(nPad + nLocal[d]) * stride[d]]), 1, thisSim3DLoc->faceType[d], thisMaterial->nbrHi[d], d,
+							 thisMaterial->cartComm, MPI_STATUS_IGNORE);
+		// ... and the last interior layers go up, and the ones below come back into the lower halo
+		flag += MPI_Sendrecv(&(state[nLocal[d] * stride[d]]), 1, thisSim3DLoc->faceType[d], thisMaterial->nbrHi[d], 3 + d,
+							 state, 1, thisSim3DLoc->faceType[d], thisMaterial->nbrLo[d], 3 + d,
+							 thisMaterial->cartComm, MPI_STATUS_IGNORE);
+	}
+	return flag;
+};
+
+// Exchange the face halos and move the simulation forward by one time step
+int oneStep3DLoc(sim3DLoc *thisSim3DLoc)
+{
+	int flag = 0;
+	if ((thisSim3DLoc->priorStateLoc == NULL) || (thisSim3DLoc->currentStateLoc == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStep3DLoc() \n");
+		return 1;
+	}
+	flag += exchangeFaces3DLoc(thisSim3DLoc);
+
+	material3DLoc *thisMaterial = thisSim3DLoc->thisMaterial3DLoc;
+	int nPad = thisMaterial->nPad;
+	long sy = thisMaterial->NxPadded;
+	long sz = (long)thisMaterial->NxPadded * thisMaterial->NyPadded;
+	acc_t dt = thisSim3DLoc->dt;
+	acc_t cx = thisMaterial->alpha / (thisMaterial->dx * thisMaterial->dx);
+	acc_t cy = thisMaterial->alpha / (thisMaterial->dy * thisMaterial->dy);
+	acc_t cz = thisMaterial->alpha / (thisMaterial->dz * thisMaterial->dz);
+
+	// range of padded indices to update in each direction: the unpadded block minus any global faces
+	int lo[3], hi[3];
+	unsigned int start[3] = {thisMaterial->startXId, thisMaterial->startYId, thisMaterial->startZId};
+	unsigned int nLocal[3] = {thisMaterial->NxLocal, thisMaterial->NyLocal, thisMaterial->NzLocal};
+	unsigned int nGlobal[3] = {thisMaterial->Nx, thisMaterial->Ny, thisMaterial->Nz};
+	int d;
+	for (d = 0; d < 3; ++d)
+	{
+		lo[d] = nPad + (start[d] == 0 ? 1 : 0);
+		hi[d] = nPad + nLocal[d] - (start[d] + nLocal[d] == nGlobal[d] ? 1 : 0);
+	}
+
+	// blocks of blockY rows, each swept through all z planes, with a branch free unit stride loop over x
+	const real_t *restrict prior = thisSim3DLoc->priorStateLoc;
+	real_t *restrict current = thisSim3DLoc->currentStateLoc;
+	int yBlock, y, z, x;
+	for (yBlock = lo[1]; yBlock < hi[1]; yBlock += thisSim3DLoc->blockY)
+	{
+		int yEnd = (yBlock + thisSim3DLoc->blockY < hi[1]) ? yBlock + thisSim3DLoc->blockY : hi[1];
+		for (z = lo[2]; z < hi[2]; ++z)
+		{
+			for (y = yBlock; y < yEnd; ++y)
+			{
+				long rowStart = y * sy + z * sz;
+				const real_t *restrict mid = &(prior[rowStart]);
+				const real_t *restrict south = &(prior[rowStart - sy]);
+				const real_t *restrict north = &(prior[rowStart + sy]);
+				const real_t *restrict below = &(prior[rowStart - sz]);
+				const real_t *restrict above = &(prior[rowStart + sz]);
+				real_t *restrict out = &(current[rowStart]);
+				for (x = lo[0]; x < hi[0]; ++x)
+				{
+					acc_t center = loadReal(mid[x]);
+					acc_t dx2 = (loadReal(mid[x - 1]) - 2 * center + loadReal(mid[x + 1])) * cx;
+					acc_t dy2 = (loadReal(south[x]) - 2 * center + loadReal(north[x])) * cy;
+					acc_t dz2 = (loadReal(below[x]) - 2 * center + loadReal(above[x])) * cz;
+					out[x] = storeReal(center + dt * (dx2 + dy2 + dz2));
+				}
+			}
+		}
+	}
+
+	// every point that changes was written, so the new state can simply become the prior one
+	real_t *tmp = thisSim3DLoc->priorStateLoc;
+	thisSim3DLoc->priorStateLoc = thisSim3DLoc->currentStateLoc;
+	thisSim3DLoc->currentStateLoc = tmp;
+	thisSim3DLoc->currentTimeIdx = thisSim3DLoc->currentTimeIdx + 1;
+	return flag;
+};
+
+// Simulate nSteps time steps (counting the initial state) and record snapshots every stepsPerCheckPt steps
+int runSim3DLoc(sim3DLoc *thisSim3DLoc, int nSteps, int stepsPerCheckPt, checkPtTime3DLoc *theseTimesLoc)
+{
+	int flag = 0;
+	int nSnaps = calcNSnaps3DLoc(nSteps, stepsPerCheckPt);
+	int checkPtInitFlag = initCheckPtTime3DLoc(theseTimesLoc, thisSim3DLoc->thisMaterial3DLoc, thisSim3DLoc, nSnaps);
+	if (checkPtInitFlag)
+	{
+		printf("WARNING: issue initializing checkpoint in runSim3DLoc \n");
+		flag = checkPtInitFlag;
+	}
+	int rank;
+	MPI_Comm_rank((thisSim3DLoc->thisMaterial3DLoc)->cartComm, &rank);
+
+	int step;
+	recordSnap3DLoc(theseTimesLoc); // always record the initial state
+	for (step = 1; step < nSteps; ++step)
+	{
+		int stepFlag = oneStep3DLoc(thisSim3DLoc);
+		if (stepFlag)
+		{
+			printf("WARNING: issue in 3D simulation at %d time step on rank %d \n", step, rank);
+			flag = stepFlag;
+		}
+		if (step % stepsPerCheckPt == 0)
+			recordSnap3DLoc(theseTimesLoc);
+	}
+	return flag;
+};
+
+// deallocate the states and free the face datatypes
+int cleanupSim3DLoc(sim3DLoc *thisSim3DLoc)
+{
+	freeArrayLoc(thisSim3DLoc->initStateLoc);
+	thisSim3DLoc->initStateLoc = NULL;
+	freeArrayLoc(thisSim3DLoc->priorStateLoc);
+	thisSim3DLoc->priorStateLoc = NULL;
+	freeArrayLoc(thisSim3DLoc->currentStateLoc);
+	thisSim3DLoc->currentStateLoc = NULL;
+	int d;
+	for (d = 0; d < 3; ++d)
+		MPI_Type_free(&(thisSim3DLoc->faceType[d]));
+	return 0;
+};
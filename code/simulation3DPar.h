@@ -0,0 +1,63 @@
+#ifndef __SIMULATION3DPAR_H__
+#define __SIMULATION3DPAR_H__
+#include <mpi.h>
+#include "precision.h"
+
+// forward declarations of structs a 3D sim will have pointers to
+typedef struct material3DLoc_struct material3DLoc;
+typedef struct checkPtTime3DLoc_struct checkPtTime3DLoc;
+
+// default number of y rows per cache block of the 3D sweep
+#define SIM3D_BLOCK_Y 8
+
+typedef struct sim3DLoc_struct{
+	// du/dt = alpha * (d^2u/dx^2 + d^2u/dy^2 + d^2u/dz^2) with the 7 point stencil and forward Euler
+
+	float dtMax; // the maximum stable time step
+	float dt; // the actual time step set by the user
+
+	material3DLoc *thisMaterial3DLoc; // local block of an already initialized 3D material
+
+	// updated at each time step (padded arrays are NxPadded x NyPadded x NzPadded points, x fastest)
+	unsigned int currentTimeIdx; // time step the simulation is on
+	real_t *currentStateLoc; // padded local state being computed
+	real_t *priorStateLoc; // padded local state of the last time step
+
+	// initial conditions and boundary value
+	real_t *initStateLoc; // initial state of this block (NxLocal x NyLocal x NzLocal points)
+	float bdryVal; // temperature held on every face of the global grid
+
+	// face halo exchange: one derived datatype per direction describes a face of the padded block
+	// (nPad layers of points perpendicular to that direction), so faces are sent straight from the state
+	MPI_Datatype faceType[3]; // faces perpendicular to x (strided points), y (strided rows) and z (contiguous)
+
+	// cache blocking: the sweep walks blockY rows of y at a time through all z planes, so the three planes
+	// of rows the stencil touches stay in cache between neighbouring z planes
+	int blockY; // y rows per block (SIM3D_BLOCK_Y unless setBlocking3DLoc is called)
+} sim3DLoc;
+
+// Calculate the maximum stable time step: dt <= 1/(2*alpha*(1/dx^2 + 1/dy^2 + 1/dz^2))
+float calcMaxTimeStep3DLoc(sim3DLoc *thisSim3DLoc);
+
+// Initialize the local initial state (copied from this block's part of valsForInitStateGlobal, which is
+// Nx x Ny x Nz with x fastest) with bdryVal on the faces of the global grid, and the padded states
+int initSim3DLoc(sim3DLoc *thisSim3DLoc, float timeStep, float *valsForInitStateGlobal, float bdryVal, material3DLoc *thisMaterial3DLoc);
+
+// Choose the number of y rows per cache block of the sweep
+int setBlocking3DLoc(sim3DLoc *thisSim3DLoc, int blockY);
+
+// Fill the face halos of priorStateLoc from the 6 neighbouring blocks (boundary value on the global faces).
+// Directions are exchanged one after another with faces spanning the padding, so edges and corners fill too.
+int exchangeFaces3DLoc(sim3DLoc *thisSim3DLoc);
+
+// Exchange the face halos and move the simulation forward by one time step
+int oneStep3DLoc(sim3DLoc *thisSim3DLoc);
+
+// Simulate nSteps time steps (counting the initial state) and record snapshots every stepsPerCheckPt steps,
+// like runSimLoc. Initializes theseTimesLoc.
+int runSim3DLoc(sim3DLoc *thisSim3DLoc, int nSteps, int stepsPerCheckPt, checkPtTime3DLoc *theseTimesLoc);
+
+// deallocate the states and free the face datatypes
+int cleanupSim3DLoc(sim3DLoc *thisSim3DLoc);
+
+#endif
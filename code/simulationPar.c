@@ -1,9 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <time.h>
+#include <stddef.h>
+#include <unistd.h>
 #include "simulationPar.h"
 #include "materialPar.h"
 #include "checkPtPar.h"
+#include "allocPar.h"
+#include "taskPar.h"
 #include <mpi.h>
 
 // Calculate the maximum stable time step allowed following CFL condition
@@ -21,15 +27,106 @@ float calcMaxTimeStepLoc(simLoc *thisSimLoc)
 		minStepSq = dy * dy;
 	float dtMax = minStepSq / (4 * alpha);
 
+	// the fourth order stencil's largest eigenvalue is 16/3 instead of 4 (over h^2)
+	if (thisSimLoc->stencilOrder == 4)
+		dtMax *= 0.75;
+
 	return dtMax;
 };
 
-// Initialize the loccal initial state (temperature matrix at T = 0, copied from valsForInitStateGlobal)
-// and current state of the system (matrix of temperature values).
-// valsForInitStateGlobal will be thisMaterial.Nx x thisMaterial.NyTotal, and only the values relevant
-// to this process's local subset of the material should be copied in.
-// Note: initializing the simulation does not also initialize the material. Do that separately.
-int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal, float bdryVal, materialLoc *thisMaterialLoc)
+// d^2u/dx^2 + d^2u/dy^2 terms (times alpha) of the 5 point stencil at point idx of a padded local state
+static inline acc_t stencilRateLoc(const real_t *stateLoc, int idx, int nCols, acc_t alpha, acc_t dx, acc_t dy)
+{
+	acc_t center = loadReal(stateLoc[idx]);
+	acc_t dx2 = (loadReal(stateLoc[idx - 1]) - 2 * center + loadReal(stateLoc[idx + 1])) * alpha / (dx * dx);
+	acc_t dy2 = (loadReal(stateLoc[idx - nCols]) - 2 * center + loadReal(stateLoc[idx + nCols])) * alpha / (dy * dy);
+	return dx2 + dy2;
+};
+
+// the same stencil at column col of the row mid, with the rows above and below it given separately
+static inline acc_t stencilRateRowsLoc(const real_t *up, const real_t *mid, const real_t *down, int col, acc_t alpha, acc_t dx, acc_t dy)
+{
+	acc_t center = loadReal(mid[col]);
+	acc_t dx2 = (loadReal(mid[col - 1]) - 2 * center + loadReal(mid[col + 1])) * alpha / (dx * dx);
+	acc_t dy2 = (loadReal(up[col]) - 2 * center + loadReal(down[col])) * alpha / (dy * dy);
+	return dx2 + dy2;
+};
+
+// Weights (w0 for i-2 and i+2, w1 for i-1 and i+1, w2 for i) of d^2u/dx^2 times alpha at grid index i of n
+// for the fourth order stencil; the points next to the edges fall back to the second order stencil.
+static inline void wideWeightsLoc(int i, int n, acc_t alpha, acc_t h, acc_t *w0, acc_t *w1, acc_t *w2)
+{
+	if ((i < 2) || (i > n - 3))
+	{
+		*w0 = 0.0;
+		*w1 = alpha / (h * h);
+		*w2 = -2 * alpha / (h * h);
+	}
+	else
+	{
+		*w0 = -alpha / (12 * h * h);
+		*w1 = 16 * alpha / (12 * h * h);
+		*w2 = -30 * alpha / (12 * h * h);
+	}
+};
+
+// d^2u/dx^2 + d^2u/dy^2 terms (times alpha) of the fourth order stencil at interior point idx (global row
+// globalRow, column col) of a padded local state with at least 2 rows of padding
+static inline acc_t wideStencilRateLoc(const real_t *stateLoc, int idx, int nCols, int globalRow, int col, int nRowsGlobal, acc_t alpha, acc_t dx, acc_t dy)
+{
+	acc_t wx0, wx1, wx2, wy0, wy1, wy2;
+	wideWeightsLoc(col, nCols, alpha, dx, &wx0, &wx1, &wx2);
+	wideWeightsLoc(globalRow, nRowsGlobal, alpha, dy, &wy0, &wy1, &wy2);
+	acc_t center = loadReal(stateLoc[idx]);
+	acc_t dx2 = wx0 * (loadReal(stateLoc[idx - 2]) + loadReal(stateLoc[idx + 2])) + wx1 * (loadReal(stateLoc[idx - 1]) + loadReal(stateLoc[idx + 1])) + wx2 * center;
+	acc_t dy2 = wy0 * (loadReal(stateLoc[idx - 2 * nCols]) + loadReal(stateLoc[idx + 2 * nCols])) + wy1 * (loadReal(stateLoc[idx - nCols]) + loadReal(stateLoc[idx + nCols])) + wy2 * center;
+	return dx2 + dy2;
+};
+
+// stencil of the order thisSimLoc was set up with
+static inline acc_t stencilRateOrderLoc(int stencilOrder, const real_t *stateLoc, int idx, int nCols, int globalRow, int col, int nRowsGlobal, acc_t alpha, acc_t dx, acc_t dy)
+{
+	if (stencilOrder == 4)
+		return wideStencilRateLoc(stateLoc, idx, nCols, globalRow, col, nRowsGlobal, alpha, dx, dy);
+	return stencilRateLoc(stateLoc, idx, nCols, alpha, dx, dy);
+};
+
+// CPU seconds used by the calling thread so far. Compute is timed in CPU time rather than wall time so a
+// rank sharing its core (or busy waiting in MPI) isn't mistaken for a slow one. It's the thread's clock, not
+// the process's, so MPI progress threads and spinning task workers aren't counted (task mode times its
+// compute tasks instead, see oneStepTasksLoc).
+static double cpuSecondsLoc(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+};
+
+// start a partial statistics accumulation with no points
+static inline void statsResetLoc(statsPartial *partial)
+{
+	partial->sum = 0.0;
+	partial->min = INFINITY;
+	partial->max = -INFINITY;
+	partial->maxIdx = -1;
+};
+
+// add the temperature val at global index globalIdx (visited in increasing order on each rank)
+static inline void statsAddLoc(statsPartial *partial, acc_t val, long globalIdx)
+{
+	partial->sum += val;
+	if (val < partial->min)
+		partial->min = val;
+	if (val > partial->max)
+	{
+		partial->max = val;
+		partial->maxIdx = globalIdx;
+	}
+};
+
+// Everything initSimLoc does, with this rank's rows of the initial state given directly
+// (valsForInitStateLoc is thisMaterial.Nx x thisMaterial.NyLocal)
+static int initSimLocRows(simLoc *thisSimLoc, float timeStep, const float *valsForInitStateLoc, float bdryVal, materialLoc *thisMaterialLoc)
 {
 	// return flag, 0 if okay, 1 if not
 	int flag = 0;
@@ -38,6 +135,7 @@ int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal
 	thisSimLoc->thisMaterialLoc = thisMaterialLoc;
 
 	// calculate maximum allowed stable time step (CFL condition)
+	thisSimLoc->stencilOrder = 2;
 	thisSimLoc->dtMax = calcMaxTimeStepLoc(thisSimLoc); // maximum stable time step
 	thisSimLoc->dt = timeStep;
 	if (timeStep >= thisSimLoc->dtMax)
@@ -48,28 +146,26 @@ int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal
 
 	// start out at time 0
 	thisSimLoc->currentTimeIdx = 0;
-	// calculate starting index for where to start copying this subarray from the global initial state array
-	int startIdx = (thisSimLoc->thisMaterialLoc)->startYId * (thisSimLoc->thisMaterialLoc)->Nx;
 	// create space for initial state (unpadded size) and fill in values
 	int nx = (thisSimLoc->thisMaterialLoc)->Nx;
 	int ny = (thisSimLoc->thisMaterialLoc)->NyLocal;
 	int nPts = nx * ny;
-	thisSimLoc->initStateLoc = malloc(nPts * sizeof(float));
+	thisSimLoc->initStateLoc = allocArrayLoc(nPts * sizeof(real_t));
 	int i;
 	for (i = 0; i < nPts; ++i)
-		thisSimLoc->initStateLoc[i] = valsForInitStateGlobal[startIdx + i];
+		thisSimLoc->initStateLoc[i] = storeReal(valsForInitStateLoc[i]);
 
 	// check rank and number of processes
 	int rank, nProcs;
-	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
+	MPI_Comm_size((thisSimLoc->thisMaterialLoc)->comm, &nProcs);
 
 	// add boundary conditions on 0th and last columns (just in case valsForInitStateGlobal didn't follow the bdryVal)
 	thisSimLoc->bdryVal = bdryVal;
 	for (i = 0; i < nPts; i += nx)
-		thisSimLoc->initStateLoc[i] = bdryVal; // column 0
+		thisSimLoc->initStateLoc[i] = storeReal(bdryVal); // column 0
 	for (i = nx - 1; i < nPts; i += nx)
-		thisSimLoc->initStateLoc[i] = bdryVal; // column nx-1
+		thisSimLoc->initStateLoc[i] = storeReal(bdryVal); // column nx-1
 	// ===================================BEGIN STUDENT CODE==============================
 	// if 0th or last rank, fill boundary conditions in 0th or last row
 	// row 0 of 0th process
@@ -78,7 +174,7 @@ int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal
 		int i;
 		for (i = 0; i < nx; ++i)
 		{
-			thisSimLoc->initStateLoc[i] = bdryVal;
+			thisSimLoc->initStateLoc[i] = storeReal(bdryVal);
 		}
 	}
 	// last row of last process
@@ -86,7 +182,7 @@ int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal
 	{
 		for (i = nPts - nx; i < nPts; ++i)
 		{
-			thisSimLoc->initStateLoc[i] = bdryVal;
+			thisSimLoc->initStateLoc[i] = storeReal(bdryVal);
 		}
 	}
 
@@ -96,14 +192,112 @@ int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal
 	// total number of points including padding on both sides
 	int totalPoints = thisMaterialLoc->NyPadded * nx;
 	// allocate the prior array
-	thisSimLoc->priorStateLoc = malloc(totalPoints * sizeof(float));
+	thisSimLoc->priorStateLoc = allocArrayLoc(totalPoints * sizeof(real_t));
 	// fill with values
 	for (i = startPad; i < totalPoints - startPad; ++i)
 	{
 		thisSimLoc->priorStateLoc[i] = thisSimLoc->initStateLoc[i - startPad];
 	}
 	// create padded state array for current state
-	thisSimLoc->currentStateLoc = malloc(totalPoints * sizeof(float));
+	thisSimLoc->currentStateLoc = allocArrayLoc(totalPoints * sizeof(real_t));
+
+	// forward Euler until told otherwise
+	thisSimLoc->integrator = INTEGRATOR_EULER;
+	thisSimLoc->nStages = 1;
+	thisSimLoc->rklTauMY0Loc = NULL;
+	thisSimLoc->rklStageALoc = NULL;
+	thisSimLoc->rklStageBLoc = NULL;
+	thisSimLoc->kernelVariant = KERNEL_POINT;
+
+	// no steady state monitor until told otherwise
+	thisSimLoc->monitorNorm = MONITOR_NONE;
+	thisSimLoc->monitorTol = 0.0;
+	thisSimLoc->monitorEvery = 1;
+	thisSimLoc->stepChangeLoc = 0.0;
+	thisSimLoc->stopReason = STOP_NSTEPS;
+	thisSimLoc->stopTimeIdx = 0;
+	thisSimLoc->stopChange = -1.0;
+
+	// every point is updated every step until told otherwise
+	thisSimLoc->tileRows = 0;
+	thisSimLoc->tileCols = 0;
+	thisSimLoc->nTilesY = 0;
+	thisSimLoc->nTilesX = 0;
+	thisSimLoc->tileChanged = NULL;
+	thisSimLoc->tileChangedNext = NULL;
+	thisSimLoc->ghostPrevLoc = NULL;
+	thisSimLoc->activityValid = 0;
+	thisSimLoc->tilesUpdated = 0;
+	thisSimLoc->tilesSkipped = 0;
+
+	// two state buffers until told otherwise
+	thisSimLoc->lowMemory = 0;
+	thisSimLoc->rowBufLoc = NULL;
+
+	// no task mode until told otherwise
+	thisSimLoc->taskPoolLoc = NULL;
+	thisSimLoc->taskRows = 0;
+	thisSimLoc->taskArgsLoc = NULL;
+	thisSimLoc->taskArgsCapacity = 0;
+	thisSimLoc->taskChangeLoc = NULL;
+	thisSimLoc->snapDueLoc = NULL;
+	thisSimLoc->taskTraceFile = NULL;
+	thisSimLoc->taskSteps = 0;
+	thisSimLoc->taskWallLoc = 0.0;
+	thisSimLoc->taskBusyLoc = 0.0;
+	thisSimLoc->taskFlightLoc = 0.0;
+	thisSimLoc->taskOverlapLoc = 0.0;
+
+	// not tuned until told otherwise
+	thisSimLoc->tunedFromCache = -1;
+	thisSimLoc->tunedStepTime = 0.0;
+
+	// no load balancing until told otherwise
+	thisSimLoc->balanceEvery = 0;
+	thisSimLoc->balanceTol = 0.0;
+	thisSimLoc->computeTimeLoc = 0.0;
+	thisSimLoc->nBalanceChecks = 0;
+	thisSimLoc->nRebalances = 0;
+	thisSimLoc->rebalanceTime = 0.0;
+	thisSimLoc->lastImbalance = 1.0;
+	thisSimLoc->predictedImbalance = 1.0;
+
+	// no statistics until told otherwise
+	thisSimLoc->statsEvery = 0;
+	thisSimLoc->statsDue = 0;
+	thisSimLoc->statsFilled = 0;
+	statsResetLoc(&(thisSimLoc->statsPartialLoc));
+	thisSimLoc->nStats = 0;
+	thisSimLoc->statsCapacity = 0;
+	thisSimLoc->statsTimes = NULL;
+	thisSimLoc->statsMin = NULL;
+	thisSimLoc->statsMax = NULL;
+	thisSimLoc->statsMean = NULL;
+	thisSimLoc->statsEnergy = NULL;
+	thisSimLoc->statsHotCol = NULL;
+	thisSimLoc->statsHotRow = NULL;
+	thisSimLoc->statsTypeLoc = MPI_DATATYPE_NULL;
+	thisSimLoc->statsOpLoc = MPI_OP_NULL;
+
+	// no rendering until told otherwise
+	thisSimLoc->renderEvery = 0;
+	thisSimLoc->renderScale = RENDER_SCALE_FIXED;
+	thisSimLoc->renderLogMin = 0.0;
+	thisSimLoc->renderLogMax = 0.0;
+	thisSimLoc->nFrames = 0;
+	thisSimLoc->renderPrefix[0] = '\0';
+
+	// no probes until told otherwise
+	thisSimLoc->nProbes = 0;
+	thisSimLoc->probeCol = NULL;
+	thisSimLoc->probeRow = NULL;
+	thisSimLoc->probeWX = NULL;
+	thisSimLoc->probeWY = NULL;
+	thisSimLoc->probeFlushEvery = 0;
+	thisSimLoc->nProbeSamples = 0;
+	thisSimLoc->probeTimes = NULL;
+	thisSimLoc->probeBufLoc = NULL;
+	thisSimLoc->probeFile = NULL;
 	// ===============================END OF STUDENT CODE==================================
 
 	if ((thisSimLoc->priorStateLoc == NULL) || (thisSimLoc->currentStateLoc == NULL))
@@ -112,19 +306,93 @@ int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal
 	return flag;
 };
 
+// Initialize the loccal initial state (temperature matrix at T = 0, copied from valsForInitStateGlobal)
+// and current state of the system (matrix of temperature values).
+// valsForInitStateGlobal will be thisMaterial.Nx x thisMaterial.NyTotal, and only the values relevant
+// to this process's local subset of the material should be copied in.
+// Note: initializing the simulation does not also initialize the material. Do that separately.
+int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal, float bdryVal, materialLoc *thisMaterialLoc)
+{
+	// calculate starting index for where to start copying this subarray from the global initial state array
+	int startIdx = thisMaterialLoc->startYId * thisMaterialLoc->Nx;
+	return initSimLocRows(thisSimLoc, timeStep, valsForInitStateGlobal + startIdx, bdryVal, thisMaterialLoc);
+};
+
+// Same as initSimLoc, but fillRows fills in this rank's rows of the initial state, so no rank holds the global array
+int initSimLocFill(simLoc *thisSimLoc, float timeStep, initRowsFunc fillRows, void *ctx, float bdryVal, materialLoc *thisMaterialLoc)
+{
+	int nLocalPts = thisMaterialLoc->Nx * thisMaterialLoc->NyLocal;
+	float *valsLoc = malloc(nLocalPts * sizeof(float));
+	if (valsLoc == NULL)
+	{
+		printf("WARNING: In initSimLocFill(), issue allocating the local initial state \n");
+		return 1;
+	}
+	fillRows(valsLoc, thisMaterialLoc->Nx, thisMaterialLoc->startYId, thisMaterialLoc->NyLocal, ctx);
+	int flag = initSimLocRows(thisSimLoc, timeStep, valsLoc, bdryVal, thisMaterialLoc);
+	free(valsLoc);
+	return flag;
+};
+
+// Same as initSimLoc, but every rank reads its own rows of the initial state from a binary file
+int initSimLocFile(simLoc *thisSimLoc, float timeStep, const char *filename, float bdryVal, materialLoc *thisMaterialLoc)
+{
+	int flag = 0;
+	int rank;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	MPI_File fileHandle;
+	if (MPI_File_open(thisMaterialLoc->comm, filename, MPI_MODE_RDONLY, MPI_INFO_NULL, &fileHandle) != MPI_SUCCESS)
+	{
+		if (rank == 0)
+			printf("WARNING: In initSimLocFile(), could not open %s \n", filename);
+		return 1;
+	}
+	MPI_Offset fileSize;
+	MPI_File_get_size(fileHandle, &fileSize);
+	if (fileSize != (MPI_Offset)thisMaterialLoc->Nx * thisMaterialLoc->NyTotal * sizeof(float))
+	{
+		if (rank == 0)
+			printf("WARNING: In initSimLocFile(), %s has %lld bytes, expected %u x %u floats \n", filename, (long long)fileSize, thisMaterialLoc->Nx, thisMaterialLoc->NyTotal);
+		MPI_File_close(&fileHandle);
+		return 1;
+	}
+
+	// each rank's rows are one contiguous slab of the file, read with one collective call
+	int nLocalPts = thisMaterialLoc->Nx * thisMaterialLoc->NyLocal;
+	float *valsLoc = malloc(nLocalPts * sizeof(float));
+	MPI_Offset offset = (MPI_Offset)thisMaterialLoc->startYId * thisMaterialLoc->Nx * sizeof(float);
+	MPI_Status status;
+	if (MPI_File_read_at_all(fileHandle, offset, valsLoc, nLocalPts, MPI_FLOAT, &status) != MPI_SUCCESS)
+	{
+		printf("WARNING: In initSimLocFile(), issue reading rows of %s on rank %d \n", filename, rank);
+		flag = 1;
+	}
+	MPI_File_close(&fileHandle);
+	flag += initSimLocRows(thisSimLoc, timeStep, valsLoc, bdryVal, thisMaterialLoc);
+	free(valsLoc);
+	return flag;
+};
+
 // Share ghost region information (must be done before each step of the simulation). Send first
 // row of unpadded part of local state to previous process (except rank 0), and send last row
 // of unpadded part of local state to next process (except last rank).
 // Need to get these ghost regions filled in into the priorStateLoc (so they can be used for next computation).
 int exchangeGhostRegions(simLoc *thisSimLoc)
+{
+	return exchangeGhostRegionsArray(thisSimLoc, thisSimLoc->priorStateLoc);
+};
+
+// Same ghost region exchange as above, but for any padded array laid out like priorStateLoc
+// (thisMaterial.Nx x thisMaterial.NyPadded points), e.g. the work vectors of the implicit solver.
+int exchangeGhostRegionsArray(simLoc *thisSimLoc, real_t *paddedArr)
 {
 //Lab 8
 	// ====================BEGIN STUDENT CODE===========================================
 
 	// check rank and number of processes
 	int rank, size;
-	MPI_Comm_size(MPI_COMM_WORLD, &size);
-	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size((thisSimLoc->thisMaterialLoc)->comm, &size);
+	MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
 	// calculate previous and next rank
 	// note, will ignore previous for rank == 0
 	// note will ignore next for last rank, size-1
@@ -152,10 +420,10 @@ int exchangeGhostRegions(simLoc *thisSimLoc)
 	// receive from previous (up) rank
 	if (rank != 0)
 	{
-		MPI_Irecv(thisSimLoc->priorStateLoc, p, MPI_FLOAT, prev, 1, MPI_COMM_WORLD, &requests[count]);
+		MPI_Irecv(paddedArr, p, MPI_REAL_T, prev, 1, (thisSimLoc->thisMaterialLoc)->comm, &requests[count]);
 		count++;
 		// send to previous (up) rank
-		MPI_Isend(&(thisSimLoc->priorStateLoc[p]), p, MPI_FLOAT, prev, 0, MPI_COMM_WORLD, &requests[count]);
+		MPI_Isend(&(paddedArr[p]), p, MPI_REAL_T, prev, 0, (thisSimLoc->thisMaterialLoc)->comm, &requests[count]);
 		count++;
 	}
 
@@ -165,17 +433,17 @@ int exchangeGhostRegions(simLoc *thisSimLoc)
 
 		for (i = 0; i < p; ++i)
 		{
-			thisSimLoc->priorStateLoc[i] = thisSimLoc->bdryVal;
+			paddedArr[i] = storeReal(thisSimLoc->bdryVal);
 		}
 	}
 	// interactions with next rank if not the last rank
 	if (rank != size - 1)
 	{
 		// receive from next (down) rank
-		MPI_Irecv(&(thisSimLoc->priorStateLoc[recvNext]), p, MPI_FLOAT, next, 0, MPI_COMM_WORLD, &requests[count]);
+		MPI_Irecv(&(paddedArr[recvNext]), p, MPI_REAL_T, next, 0, (thisSimLoc->thisMaterialLoc)->comm, &requests[count]);
 		count++;
 		// send to next (down)rank
-		MPI_Isend(&(thisSimLoc->priorStateLoc[sendNext]), p, MPI_FLOAT, next, 1, MPI_COMM_WORLD, &requests[count]);
+		MPI_Isend(&(paddedArr[sendNext]), p, MPI_REAL_T, next, 1, (thisSimLoc->thisMaterialLoc)->comm, &requests[count]);
 		count++;
 	}
 
@@ -184,7 +452,7 @@ int exchangeGhostRegions(simLoc *thisSimLoc)
 	//{
 	//for (i = h - p; i < h; ++i)
 	//{
-	//thisSimLoc->priorStateLoc[i] = thisSimLoc->bdryVal;
+	//paddedArr[i] = thisSimLoc->bdryVal;
 	//}
 	//}
 	// make sure all the requests are done
@@ -194,149 +462,2173 @@ int exchangeGhostRegions(simLoc *thisSimLoc)
 	return 0;
 };
 
-// Share ghost regions, then move the simulation forward by one time step
-int oneStepLoc(simLoc *thisSimLoc)
+// Choose the spatial order of the stencil (2 or 4) and recompute dtMax for it
+int setStencilOrderLoc(simLoc *thisSimLoc, int stencilOrder)
+{
+	if ((stencilOrder != 2) && (stencilOrder != 4))
+	{
+		printf("WARNING: In setStencilOrderLoc(), stencil order %d isn't 2 or 4 \n", stencilOrder);
+		return 1;
+	}
+	if ((stencilOrder == 4) && ((thisSimLoc->thisMaterialLoc)->nPadRows < 2))
+	{
+		printf("WARNING: In setStencilOrderLoc(), the fourth order stencil needs nPadRows >= 2 \n");
+		return 1;
+	}
+	if ((stencilOrder == 4) && (thisSimLoc->tileRows > 0))
+	{
+		printf("WARNING: In setStencilOrderLoc(), the fourth order stencil can't be used with tiling \n");
+		return 1;
+	}
+	if ((stencilOrder == 4) && thisSimLoc->lowMemory)
+	{
+		printf("WARNING: In setStencilOrderLoc(), the fourth order stencil doesn't work in low memory mode \n");
+		return 1;
+	}
+	thisSimLoc->stencilOrder = stencilOrder;
+	thisSimLoc->dtMax = calcMaxTimeStepLoc(thisSimLoc);
+	if ((thisSimLoc->integrator == INTEGRATOR_EULER) && (thisSimLoc->dt >= thisSimLoc->dtMax))
+	{
+		printf("WARNING: In setStencilOrderLoc(), time step exceeds stability limit of the new stencil. Unphysical behavior is likely. \n");
+		return 1;
+	}
+	// RKL2's number of stages depends on dtMax
+	if (thisSimLoc->integrator == INTEGRATOR_RKL2)
+		return setIntegratorLoc(thisSimLoc, INTEGRATOR_RKL2, thisSimLoc->dt);
+	return 0;
+};
+
+// Choose the time integrator and time step. For INTEGRATOR_RKL2 the number of stages is the
+// smallest that keeps timeStep stable, so timeStep may be many times dtMax.
+int setIntegratorLoc(simLoc *thisSimLoc, int integrator, float timeStep)
 {
 	int flag = 0;
-	// grab the prior state and current (i.e. to update) state
-	float *newStateLoc = thisSimLoc->currentStateLoc;
-	float *priorStateLoc = thisSimLoc->priorStateLoc;
+	if ((integrator != INTEGRATOR_EULER) && thisSimLoc->lowMemory)
+	{
+		printf("WARNING: In setIntegratorLoc(), RKL2 doesn't work in low memory mode \n");
+		return 1;
+	}
+	thisSimLoc->integrator = integrator;
+	thisSimLoc->dt = timeStep;
+	thisSimLoc->nStages = 1;
+	if (integrator == INTEGRATOR_EULER)
+	{
+		if (timeStep >= thisSimLoc->dtMax)
+		{
+			printf("WARNING: In setIntegratorLoc(), requested time step exceeds stability limit. Unphysical behavior is likely. \n");
+			flag = 1;
+		}
+		return flag;
+	}
 
-	// if you run into problems return a 1
+	// RKL2 with s stages is stable for dt <= dtMax*(s^2+s-2)/4 (and needs at least 2 stages)
+	int s = 2;
+	while (thisSimLoc->dtMax * (s * s + s - 2) / 4.0 < timeStep)
+		++s;
+	thisSimLoc->nStages = s;
+
+	// padded work arrays for the stages (allocated once, zeroed so unused ghost rows stay finite)
+	int totalPoints = (thisSimLoc->thisMaterialLoc)->NyPadded * (thisSimLoc->thisMaterialLoc)->Nx;
+	if (thisSimLoc->rklTauMY0Loc == NULL)
+		thisSimLoc->rklTauMY0Loc = allocArrayLoc(totalPoints * sizeof(real_t));
+	if (thisSimLoc->rklStageALoc == NULL)
+		thisSimLoc->rklStageALoc = allocArrayLoc(totalPoints * sizeof(real_t));
+	if (thisSimLoc->rklStageBLoc == NULL)
+		thisSimLoc->rklStageBLoc = allocArrayLoc(totalPoints * sizeof(real_t));
+	if ((thisSimLoc->rklTauMY0Loc == NULL) || (thisSimLoc->rklStageALoc == NULL) || (thisSimLoc->rklStageBLoc == NULL))
+	{
+		printf("WARNING: In setIntegratorLoc(), issue allocating RKL2 stage arrays \n");
+		flag = 1;
+	}
+	return flag;
+};
+
+// Turn on (or off) the steady state monitor
+int setMonitorLoc(simLoc *thisSimLoc, int monitorNorm, float tol, int monitorEvery)
+{
+	if (monitorEvery < 1)
+	{
+		printf("WARNING: In setMonitorLoc(), monitorEvery must be at least 1 \n");
+		return 1;
+	}
+	thisSimLoc->monitorNorm = monitorNorm;
+	thisSimLoc->monitorTol = tol;
+	thisSimLoc->monitorEvery = monitorEvery;
+	thisSimLoc->stepChangeLoc = 0.0;
+	return 0;
+};
+
+// Cut the local strip into tiles for quiescent tile skipping (tileRows = 0 turns it off)
+int setTilingLoc(simLoc *thisSimLoc, int tileRows, int tileCols)
+{
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	free(thisSimLoc->tileChanged);
+	thisSimLoc->tileChanged = NULL;
+	free(thisSimLoc->tileChangedNext);
+	thisSimLoc->tileChangedNext = NULL;
+	free(thisSimLoc->ghostPrevLoc);
+	thisSimLoc->ghostPrevLoc = NULL;
+	thisSimLoc->tileRows = 0;
+	thisSimLoc->tileCols = 0;
+	thisSimLoc->nTilesY = 0;
+	thisSimLoc->nTilesX = 0;
+	thisSimLoc->activityValid = 0;
+	thisSimLoc->tilesUpdated = 0;
+	thisSimLoc->tilesSkipped = 0;
+	if (tileRows <= 0)
+		return 0;
+	if (thisSimLoc->stencilOrder != 2)
+	{
+		printf("WARNING: In setTilingLoc(), tiling only works with the second order stencil \n");
+		return 1;
+	}
+	if ((thisSimLoc->taskPoolLoc != NULL) || thisSimLoc->lowMemory)
+	{
+		printf("WARNING: In setTilingLoc(), tiling doesn't work in task mode or low memory mode \n");
+		return 1;
+	}
+	if (tileCols <= 0)
+	{
+		printf("WARNING: In setTilingLoc(), tileCols must be positive \n");
+		return 1;
+	}
+
+	thisSimLoc->tileRows = tileRows;
+	thisSimLoc->tileCols = tileCols;
+	thisSimLoc->nTilesY = (thisMaterialLoc->NyLocal + tileRows - 1) / tileRows;
+	thisSimLoc->nTilesX = (thisMaterialLoc->Nx + tileCols - 1) / tileCols;
+	int nTiles = thisSimLoc->nTilesY * thisSimLoc->nTilesX;
+	thisSimLoc->tileChanged = calloc(nTiles, sizeof(unsigned char));
+	thisSimLoc->tileChangedNext = calloc(nTiles, sizeof(unsigned char));
+	thisSimLoc->ghostPrevLoc = calloc(2 * thisMaterialLoc->nPadRows * thisMaterialLoc->Nx, sizeof(real_t));
+	if ((thisSimLoc->tileChanged == NULL) || (thisSimLoc->tileChangedNext == NULL) || (thisSimLoc->ghostPrevLoc == NULL))
+	{
+		printf("WARNING: In setTilingLoc(), issue allocating the activity map \n");
+		return 1;
+	}
+	return 0;
+};
+
+// Mark every tile as changed so the next step updates all of them
+int resetActivityLoc(simLoc *thisSimLoc)
+{
+	thisSimLoc->activityValid = 0;
+	return 0;
+};
+
+// One forward Euler step that only updates tiles where something can change. A tile whose inputs
+// (itself, the tiles left, right, above and below it, and the ghost rows next to it) are the same as
+// in the last step would get exactly the same new values as in the last step, which are its current
+// values, so it's skipped. The updated tiles use exactly the arithmetic of the full sweep.
+static int oneStepTiledLoc(simLoc *thisSimLoc)
+{
+	int flag = 0;
+	real_t *newStateLoc = thisSimLoc->currentStateLoc;
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
 	if ((newStateLoc == NULL) || (priorStateLoc == NULL))
 	{
 		printf("WARNING: null pointer for state encountered in oneStep() \n");
 		return 1;
 	}
-
-	// shuffle around ghost region information into the priorStateLoc padded regions
 	flag += exchangeGhostRegions(thisSimLoc);
+	double sweepStart = cpuSecondsLoc();
 
-	// grab the dimensions and material properties
 	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
-	int nRowsTotal = (thisSimLoc->thisMaterialLoc)->NyPadded;
 	int nRowsUnpadded = (thisSimLoc->thisMaterialLoc)->NyLocal;
 	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
 	int nRowsGlobal = (thisSimLoc->thisMaterialLoc)->NyTotal;
+	int startYId = (thisSimLoc->thisMaterialLoc)->startYId;
 	float dx = (thisSimLoc->thisMaterialLoc)->dx;
 	float dy = (thisSimLoc->thisMaterialLoc)->dy;
 	float alpha = (thisSimLoc->thisMaterialLoc)->alpha;
+	int tileRows = thisSimLoc->tileRows;
+	int tileCols = thisSimLoc->tileCols;
+	int nTilesY = thisSimLoc->nTilesY;
+	int nTilesX = thisSimLoc->nTilesX;
+	unsigned char *changed = thisSimLoc->tileChanged;
+	unsigned char *changedNext = thisSimLoc->tileChangedNext;
+	int valid = thisSimLoc->activityValid;
+	int monitor = thisSimLoc->monitorNorm;
+	acc_t stepChange = 0.0;
+	int i;
 
-	// ============================BEGIN STUDENT CODE==============================
+	// did the ghost rows change since the last step? (and remember them for the next one)
+	int nGhostPts = nPadRows * nCols;
+	int bottomStart = (nPadRows + nRowsUnpadded) * nCols;
+	int topGhostChanged = 0, bottomGhostChanged = 0;
+	for (i = 0; i < nGhostPts; ++i)
+	{
+		if (priorStateLoc[i] != thisSimLoc->ghostPrevLoc[i])
+			topGhostChanged = 1;
+		if (priorStateLoc[bottomStart + i] != thisSimLoc->ghostPrevLoc[nGhostPts + i])
+			bottomGhostChanged = 1;
+		thisSimLoc->ghostPrevLoc[i] = priorStateLoc[i];
+		thisSimLoc->ghostPrevLoc[nGhostPts + i] = priorStateLoc[bottomStart + i];
+	}
 
-	int h = (thisSimLoc->thisMaterialLoc)->NyPadded;
-	int p = (thisSimLoc->thisMaterialLoc)->nPadRows;
-	// go one entry at a time filling in newStateLoc based on the values in priorStateLoc
-	int i;
-	// calculate the row index of this row in the global array
-	// index of current location in padded subarray
-	int row;
-	int col;
-	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+	int ty, tx, row, col;
+	for (ty = 0; ty < nTilesY; ++ty)
 	{
-		for (col = 0; col < nCols; ++col)
+		for (tx = 0; tx < nTilesX; ++tx)
 		{
-			// case for all points not on the boundaries is to use the 5 pt stencil to update
-			//if ((nPadRows < row) && (row < nRowsUnpadded + nPadRows - 1) && (0 < col) && (col < nCols - 1))
-			//{
-
-			if (row == nPadRows || row == nRowsUnpadded + nPadRows - 1 || col == 0 || col == nCols - 1)
+			int tile = ty * nTilesX + tx;
+			int active = !valid || changed[tile];
+			active = active || ((ty > 0) && changed[tile - nTilesX]) || ((ty < nTilesY - 1) && changed[tile + nTilesX]);
+			active = active || ((tx > 0) && changed[tile - 1]) || ((tx < nTilesX - 1) && changed[tile + 1]);
+			active = active || ((ty == 0) && topGhostChanged) || ((ty == nTilesY - 1) && bottomGhostChanged);
+			changedNext[tile] = 0;
+			if (!active)
 			{
-				int idx = (row * nCols) + col;
-				newStateLoc[idx] = thisSimLoc->bdryVal;
+				thisSimLoc->tilesSkipped++;
+				continue;
 			}
-			else
+			thisSimLoc->tilesUpdated++;
+
+			int rowEnd = nPadRows + (ty + 1) * tileRows;
+			if (rowEnd > nPadRows + nRowsUnpadded)
+				rowEnd = nPadRows + nRowsUnpadded;
+			int colEnd = (tx + 1) * tileCols;
+			if (colEnd > nCols)
+				colEnd = nCols;
+			for (row = nPadRows + ty * tileRows; row < rowEnd; ++row)
 			{
-				int idx = (row * nCols) + col; // index of current location
+				int globalRow = startYId + row - nPadRows;
+				for (col = tx * tileCols; col < colEnd; ++col)
+				{
+					int idx = (row * nCols) + col;
+					if (globalRow == 0 || globalRow == nRowsGlobal - 1 || col == 0 || col == nCols - 1)
+						newStateLoc[idx] = storeReal(thisSimLoc->bdryVal);
+					else
+						newStateLoc[idx] = storeReal(loadReal(priorStateLoc[idx]) + thisSimLoc->dt * stencilRateLoc(priorStateLoc, idx, nCols, alpha, dx, dy));
+					if (newStateLoc[idx] != priorStateLoc[idx])
+					{
+						changedNext[tile] = 1;
+						acc_t change = loadReal(newStateLoc[idx]) - loadReal(priorStateLoc[idx]);
+						if (monitor == MONITOR_MAX)
+							stepChange = fmax(stepChange, fabs(change));
+						else if (monitor == MONITOR_L2)
+							stepChange += change * change;
+					}
+				}
+			}
+		}
+	}
 
-				// index of point to left in padded subarray
-				int left = (row * nCols) + (col - 1);
-				// index of point to right in padded subarray
-				int right = (row * nCols) + (col + 1);
-				// calculate d^2/dx^2 term
-				float dx2 = (priorStateLoc[left] - 2 * priorStateLoc[idx] + priorStateLoc[right]) * alpha / (dx * dx);
-				// index of point on row above in padded subarray
-				int above = ((row - 1) * nCols) + col;
-				// index of point on row below in padded subarray
-				int below = ((row + 1) * nCols) + col;
-				// calculate d^2/dy^2 term
-				float dy2 = (priorStateLoc[above] - 2 * priorStateLoc[idx] + priorStateLoc[below]) * alpha / (dy * dy);
-				newStateLoc[idx] = priorStateLoc[idx] + thisSimLoc->dt * (dx2 + dy2);
+	// copy the updated tiles into priorStateLoc (skipped tiles already hold their new state there)
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1;
+	for (ty = 0; ty < nTilesY; ++ty)
+	{
+		int rowEnd = nPadRows + (ty + 1) * tileRows;
+		if (rowEnd > nPadRows + nRowsUnpadded)
+			rowEnd = nPadRows + nRowsUnpadded;
+		for (tx = 0; tx < nTilesX; ++tx)
+		{
+			if (!changedNext[ty * nTilesX + tx])
+				continue;
+			int colEnd = (tx + 1) * tileCols;
+			if (colEnd > nCols)
+				colEnd = nCols;
+			for (row = nPadRows + ty * tileRows; row < rowEnd; ++row)
+			{
+				for (col = tx * tileCols; col < colEnd; ++col)
+					priorStateLoc[row * nCols + col] = newStateLoc[row * nCols + col];
 			}
-			// case for all points on the boundaries is to fill with boundary value
-			//else
-			//{
-			//	int idx = (row * nCols) + col;
-			//	newStateLoc[idx] = thisSimLoc->bdryVal;
-			//}
 		}
 	}
+	thisSimLoc->tileChanged = changedNext;
+	thisSimLoc->tileChangedNext = changed;
+	thisSimLoc->activityValid = 1;
+	thisSimLoc->statsFilled = 0; // skipped tiles weren't visited, so recordStatsLoc makes its own pass
+	thisSimLoc->stepChangeLoc = stepChange;
+	thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
+	return flag;
+};
 
-	// =======================END STUDENT CODE========================================
+// One RKL2 super time step (Meyer, Balsara & Aslam 2014) made of nStages stencil sweeps, each
+// preceded by a ghost region exchange of the stage it reads:
+//   Y_0 = u, Y_1 = Y_0 + mu~_1 tau M(Y_0),
+//   Y_j = mu_j Y_(j-1) + nu_j Y_(j-2) + (1 - mu_j - nu_j) Y_0 + mu~_j tau M(Y_(j-1)) + gamma~_j tau M(Y_0),
+// and the new state is Y_s, where M is alpha times the 5 point Laplacian and tau = dt.
+static int oneStepRKL2Loc(simLoc *thisSimLoc)
+{
+	int flag = 0;
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nRowsUnpadded = (thisSimLoc->thisMaterialLoc)->NyLocal;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	int nRowsGlobal = (thisSimLoc->thisMaterialLoc)->NyTotal;
+	int startYId = (thisSimLoc->thisMaterialLoc)->startYId;
+	float dx = (thisSimLoc->thisMaterialLoc)->dx;
+	float dy = (thisSimLoc->thisMaterialLoc)->dy;
+	float alpha = (thisSimLoc->thisMaterialLoc)->alpha;
+	float tau = thisSimLoc->dt;
+	int s = thisSimLoc->nStages;
+	double w1 = 4.0 / (s * s + s - 2);
+	real_t *y0 = thisSimLoc->priorStateLoc;
+	real_t *tauMY0 = thisSimLoc->rklTauMY0Loc;
+	// rotate the stage states through these three padded arrays
+	real_t *yPrev2 = thisSimLoc->rklStageALoc;
+	real_t *yPrev = thisSimLoc->rklStageBLoc;
+	real_t *yNew = thisSimLoc->currentStateLoc;
+	if ((tauMY0 == NULL) || (yPrev2 == NULL) || (yPrev == NULL) || (yNew == NULL) || (y0 == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStep() \n");
+		return 1;
+	}
+	int row, col, j;
 
-	// Now that the new state is all updated and the prior state is no longer needed,
-	// copy the values in the unpadded part of newState into priorState, and move onto the next time step.
-	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1; // have completed a time step
+	// b_j = (j^2 + j - 2)/(2j(j+1)) for j >= 2 and b_0 = b_1 = 1/3
+	double bPrev2 = 1.0 / 3.0, bPrev = 1.0 / 3.0, b;
+
+	// stage 1
+	flag += exchangeGhostRegions(thisSimLoc);
+	double sweepStart = cpuSecondsLoc();
 	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
 	{
+		int globalRow = startYId + row - nPadRows;
 		for (col = 0; col < nCols; ++col)
 		{
 			int idx = (row * nCols) + col;
-			priorStateLoc[idx] = newStateLoc[idx];
+			if (globalRow == 0 || globalRow == nRowsGlobal - 1 || col == 0 || col == nCols - 1)
+			{
+				tauMY0[idx] = storeReal(0.0);
+				yPrev[idx] = storeReal(thisSimLoc->bdryVal);
+			}
+			else
+			{
+				acc_t tauMY = tau * stencilRateOrderLoc(thisSimLoc->stencilOrder, y0, idx, nCols, globalRow, col, nRowsGlobal, alpha, dx, dy);
+				tauMY0[idx] = storeReal(tauMY);
+				yPrev[idx] = storeReal(loadReal(y0[idx]) + (acc_t)(w1 / 3.0) * tauMY);
+			}
+			yPrev2[idx] = y0[idx];
 		}
 	}
+	thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
 
-	// since no problems were found earlier, return a 0
-	return 0;
-};
-
-// Simulate nSteps time steps and record snapshots of the whole temperature field
-// every stepsPerCheckPt time steps. runSimLoc does do the initialization of the checkPtTimeLoc
-// struct automatically at the beginning of the simulation.
-// Note: running the simulation doesn't also initialize the sim or the material. Do them separately.
-int runSimLoc(simLoc *thisSimLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc)
-{
-	int flag = 0; // return flag, 0 if no problem, but nonzero if there's a problem
-
-	// do the initialization of the checkpointing struct
-	int nSnaps = calcNSnapsLoc(nSteps, stepsPerCheckPt);
-	int checkPtInitFlag = initCheckPtTimeLoc(theseTimesLoc, thisSimLoc->thisMaterialLoc, thisSimLoc, nSnaps);
-	if (checkPtInitFlag)
+	// stages 2..s
+	for (j = 2; j <= s; ++j)
 	{
-		printf("WARNING: issue initializing checkpoint in runSim \n");
-		flag = checkPtInitFlag;
+		b = (j * j + j - 2.0) / (2.0 * j * (j + 1));
+		double mu = (2.0 * j - 1.0) / j * b / bPrev;
+		double nu = -(j - 1.0) / j * b / bPrev2;
+		double muTilde = mu * w1;
+		double gammaTilde = -(1.0 - bPrev) * muTilde;
+		acc_t fMu = mu, fNu = nu, fRest = 1.0 - mu - nu, fMuTilde = muTilde, fGammaTilde = gammaTilde;
+		flag += exchangeGhostRegionsArray(thisSimLoc, yPrev);
+		sweepStart = cpuSecondsLoc();
+		for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+		{
+			int globalRow = startYId + row - nPadRows;
+			for (col = 0; col < nCols; ++col)
+			{
+				int idx = (row * nCols) + col;
+				if (globalRow == 0 || globalRow == nRowsGlobal - 1 || col == 0 || col == nCols - 1)
+				{
+					yNew[idx] = storeReal(thisSimLoc->bdryVal);
+				}
+				else
+				{
+					acc_t tauMY = tau * stencilRateOrderLoc(thisSimLoc->stencilOrder, yPrev, idx, nCols, globalRow, col, nRowsGlobal, alpha, dx, dy);
+					yNew[idx] = storeReal(fMu * loadReal(yPrev[idx]) + fNu * loadReal(yPrev2[idx]) + fRest * loadReal(y0[idx]) + fMuTilde * tauMY + fGammaTilde * loadReal(tauMY0[idx]));
+				}
+			}
+		}
+		thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
+		real_t *tmp = yPrev2;
+		yPrev2 = yPrev;
+		yPrev = yNew;
+		yNew = tmp;
+		bPrev2 = bPrev;
+		bPrev = b;
 	}
 
-	// check rank
-	int rank;
-	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-
-	// run through the steps
-	int step;
-	recordSnapLoc(theseTimesLoc); // always record 0th  time step's prior state
-	for (step = 1; step < nSteps; ++step)
+	// the last stage is the new state
+	sweepStart = cpuSecondsLoc();
+	int monitor = thisSimLoc->monitorNorm;
+	acc_t stepChange = 0.0;
+	int stats = thisSimLoc->statsDue;
+	long globalStart = (long)(startYId - nPadRows) * nCols;
+	if (stats)
+		statsResetLoc(&(thisSimLoc->statsPartialLoc));
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1;
+	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
 	{
-		// share ghost regions and update simulation
-		int stepFlag = oneStepLoc(thisSimLoc);
-		if (stepFlag)
+		for (col = 0; col < nCols; ++col)
 		{
-			printf("WARNING: issue in simulation at %d time step on rank %d \n", step, rank);
-			flag = stepFlag;
+			int idx = (row * nCols) + col;
+			if (stats)
+				statsAddLoc(&(thisSimLoc->statsPartialLoc), loadReal(yPrev[idx]), globalStart + idx);
+			acc_t change = loadReal(yPrev[idx]) - loadReal(y0[idx]);
+			if (monitor == MONITOR_MAX)
+				stepChange = fmax(stepChange, fabs(change));
+			else if (monitor == MONITOR_L2)
+				stepChange += change * change;
+			y0[idx] = yPrev[idx];
+			thisSimLoc->currentStateLoc[idx] = yPrev[idx];
 		}
-		if (step % stepsPerCheckPt == 0)
-			recordSnapLoc(theseTimesLoc); // this checks if a checkpoint needs to be recorded, and records it if needed
 	}
+	thisSimLoc->statsFilled = stats;
+	thisSimLoc->stepChangeLoc = stepChange;
+	thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
 	return flag;
 };
 
-// deallocate memory associated with currentStateLoc, initStateLoc, priorStateLoc
-int cleanupSimLoc(simLoc *thisSimLoc)
+// One forward Euler step with the fourth order stencil. The weights only change on the rows and columns
+// next to the edges, so each row is swept with fixed weights in y, and its inner columns with fixed
+// weights in x: a unit stride loop with no branches, which the compiler can vectorize.
+static int oneStepWideLoc(simLoc *thisSimLoc)
 {
-	free(thisSimLoc->initStateLoc);
-	thisSimLoc->initStateLoc = NULL;
-	free(thisSimLoc->priorStateLoc);
-	thisSimLoc->priorStateLoc = NULL;
-	free(thisSimLoc->currentStateLoc);
+	int flag = 0;
+	real_t *newStateLoc = thisSimLoc->currentStateLoc;
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+	if ((newStateLoc == NULL) || (priorStateLoc == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStep() \n");
+		return 1;
+	}
+	flag += exchangeGhostRegions(thisSimLoc);
+	double sweepStart = cpuSecondsLoc();
+
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nRowsUnpadded = (thisSimLoc->thisMaterialLoc)->NyLocal;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	int nRowsGlobal = (thisSimLoc->thisMaterialLoc)->NyTotal;
+	int startYId = (thisSimLoc->thisMaterialLoc)->startYId;
+	acc_t dx = (thisSimLoc->thisMaterialLoc)->dx;
+	acc_t dy = (thisSimLoc->thisMaterialLoc)->dy;
+	acc_t alpha = (thisSimLoc->thisMaterialLoc)->alpha;
+	acc_t dt = thisSimLoc->dt;
+	acc_t bdry = thisSimLoc->bdryVal;
+	acc_t wx0, wx1, wx2;
+	wideWeightsLoc(2, nCols, alpha, dx, &wx0, &wx1, &wx2);
+	int row, col;
+	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+	{
+		int globalRow = startYId + row - nPadRows;
+		real_t *out = &(newStateLoc[row * nCols]);
+		if (globalRow == 0 || globalRow == nRowsGlobal - 1)
+		{
+			for (col = 0; col < nCols; ++col)
+				out[col] = storeReal(bdry);
+			continue;
+		}
+		const real_t *m2 = &(priorStateLoc[(row - 2) * nCols]);
+		const real_t *m1 = &(priorStateLoc[(row - 1) * nCols]);
+		const real_t *mid = &(priorStateLoc[row * nCols]);
+		const real_t *p1 = &(priorStateLoc[(row + 1) * nCols]);
+		const real_t *p2 = &(priorStateLoc[(row + 2) * nCols]);
+		acc_t wy0, wy1, wy2;
+		wideWeightsLoc(globalRow, nRowsGlobal, alpha, dy, &wy0, &wy1, &wy2);
+		out[0] = storeReal(bdry);
+		out[nCols - 1] = storeReal(bdry);
+		for (col = 2; col < nCols - 2; ++col)
+		{
+			acc_t center = loadReal(mid[col]);
+			acc_t dx2 = wx0 * (loadReal(mid[col - 2]) + loadReal(mid[col + 2])) + wx1 * (loadReal(mid[col - 1]) + loadReal(mid[col + 1])) + wx2 * center;
+			acc_t dy2 = wy0 * (loadReal(m2[col]) + loadReal(p2[col])) + wy1 * (loadReal(m1[col]) + loadReal(p1[col])) + wy2 * center;
+			out[col] = storeReal(center + dt * (dx2 + dy2));
+		}
+		// the columns next to the edges use the second order stencil in x
+		if (nCols > 2)
+		{
+			out[1] = storeReal(loadReal(mid[1]) + dt * wideStencilRateLoc(priorStateLoc, row * nCols + 1, nCols, globalRow, 1, nRowsGlobal, alpha, dx, dy));
+			out[nCols - 2] = storeReal(loadReal(mid[nCols - 2]) + dt * wideStencilRateLoc(priorStateLoc, row * nCols + nCols - 2, nCols, globalRow, nCols - 2, nRowsGlobal, alpha, dx, dy));
+		}
+	}
+
+	// measure the change (in its own pass, so the sweep above stays branch free) and copy the new state over
+	// (and the statistics, if they're due)
+	int monitor = thisSimLoc->monitorNorm;
+	acc_t stepChange = 0.0;
+	int stats = thisSimLoc->statsDue;
+	long globalStart = (long)(startYId - nPadRows) * nCols;
+	if (stats)
+		statsResetLoc(&(thisSimLoc->statsPartialLoc));
+	int idx;
+	for (idx = nPadRows * nCols; idx < (nRowsUnpadded + nPadRows) * nCols; ++idx)
+	{
+		if (stats)
+			statsAddLoc(&(thisSimLoc->statsPartialLoc), loadReal(newStateLoc[idx]), globalStart + idx);
+		if (monitor != MONITOR_NONE)
+		{
+			acc_t change = loadReal(newStateLoc[idx]) - loadReal(priorStateLoc[idx]);
+			if (monitor == MONITOR_MAX)
+				stepChange = fmax(stepChange, fabs(change));
+			else
+				stepChange += change * change;
+		}
+		priorStateLoc[idx] = newStateLoc[idx];
+	}
+	thisSimLoc->stepChangeLoc = stepChange;
+	thisSimLoc->statsFilled = stats;
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1;
+	thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
+	return flag;
+};
+
+// Forward Euler update of padded rows rowStart to rowEnd-1 of the new state, with the boundary rows and columns
+// set apart so the interior of each row is one branch free loop the compiler can vectorize. Each point gets
+// exactly the arithmetic of oneStepLoc's sweep. Returns these rows' share of the steady state monitor.
+static acc_t eulerRowsLoc(simLoc *thisSimLoc, int rowStart, int rowEnd)
+{
+	real_t *newStateLoc = thisSimLoc->currentStateLoc;
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	int nRowsGlobal = (thisSimLoc->thisMaterialLoc)->NyTotal;
+	int startYId = (thisSimLoc->thisMaterialLoc)->startYId;
+	float dx = (thisSimLoc->thisMaterialLoc)->dx;
+	float dy = (thisSimLoc->thisMaterialLoc)->dy;
+	float alpha = (thisSimLoc->thisMaterialLoc)->alpha;
+	float dt = thisSimLoc->dt;
+	real_t bdry = storeReal(thisSimLoc->bdryVal);
+	int monitor = thisSimLoc->monitorNorm;
+	acc_t stepChange = 0.0;
+	int row, col;
+	for (row = rowStart; row < rowEnd; ++row)
+	{
+		int globalRow = startYId + row - nPadRows;
+		real_t *newRow = newStateLoc + row * nCols;
+		if ((globalRow == 0) || (globalRow == nRowsGlobal - 1))
+		{
+			for (col = 0; col < nCols; ++col)
+				newRow[col] = bdry;
+			continue;
+		}
+		newRow[0] = bdry;
+		newRow[nCols - 1] = bdry;
+		for (col = 1; col < nCols - 1; ++col)
+		{
+			int idx = (row * nCols) + col;
+			newStateLoc[idx] = storeReal(loadReal(priorStateLoc[idx]) + dt * stencilRateLoc(priorStateLoc, idx, nCols, alpha, dx, dy));
+		}
+		// the monitor counts the interior points only, as oneStepLoc's sweep does
+		if (monitor != MONITOR_NONE)
+		{
+			const real_t *priorRow = priorStateLoc + row * nCols;
+			for (col = 1; col < nCols - 1; ++col)
+			{
+				acc_t change = loadReal(newRow[col]) - loadReal(priorRow[col]);
+				if (monitor == MONITOR_MAX)
+					stepChange = fmax(stepChange, fabs(change));
+				else
+					stepChange += change * change;
+			}
+		}
+	}
+	return stepChange;
+};
+
+// One forward Euler step swept a row at a time by eulerRowsLoc
+static int oneStepRowsLoc(simLoc *thisSimLoc)
+{
+	real_t *newStateLoc = thisSimLoc->currentStateLoc;
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+	if ((newStateLoc == NULL) || (priorStateLoc == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStepRowsLoc() \n");
+		return 1;
+	}
+	int flag = exchangeGhostRegions(thisSimLoc);
+	double sweepStart = cpuSecondsLoc();
+
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nRowsUnpadded = (thisSimLoc->thisMaterialLoc)->NyLocal;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	int startYId = (thisSimLoc->thisMaterialLoc)->startYId;
+	acc_t stepChange = eulerRowsLoc(thisSimLoc, nPadRows, nRowsUnpadded + nPadRows);
+	thisSimLoc->stepChangeLoc = stepChange;
+
+	// copy the new state over (accumulating the statistics on the way if they're due)
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1;
+	int first = nPadRows * nCols;
+	int last = (nRowsUnpadded + nPadRows) * nCols;
+	int stats = thisSimLoc->statsDue;
+	if (!stats)
+		memcpy(priorStateLoc + first, newStateLoc + first, (last - first) * sizeof(real_t));
+	else
+	{
+		long globalStart = (long)(startYId - nPadRows) * nCols;
+		statsResetLoc(&(thisSimLoc->statsPartialLoc));
+		int idx;
+		for (idx = first; idx < last; ++idx)
+		{
+			priorStateLoc[idx] = newStateLoc[idx];
+			statsAddLoc(&(thisSimLoc->statsPartialLoc), loadReal(newStateLoc[idx]), globalStart + idx);
+		}
+	}
+	thisSimLoc->statsFilled = stats;
+	thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
+	return flag;
+};
+
+// what each task of a step in task mode is run with
+typedef struct stepTaskArg_struct{
+	simLoc *sim;
+	int rowStart; // padded rows of its tile (for the post and poll tasks, unused)
+	int rowEnd;
+	int tile; // its tile (for the poll tasks, which of taskRequests it waits on)
+} stepTaskArg;
+
+// post the halo receives and sends of the prior state (any not needed stay MPI_REQUEST_NULL)
+static int postHaloTaskLoc(void *arg, int worker)
+{
+	simLoc *thisSimLoc = ((stepTaskArg *)arg)->sim;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+	int rank, size;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	MPI_Comm_size(thisMaterialLoc->comm, &size);
+	int p = thisMaterialLoc->nPadRows * thisMaterialLoc->Nx;
+	int h = thisMaterialLoc->NyPadded * thisMaterialLoc->Nx;
+	int i;
+	for (i = 0; i < 4; ++i)
+		thisSimLoc->taskRequests[i] = MPI_REQUEST_NULL;
+	if (rank != 0)
+	{
+		MPI_Irecv(priorStateLoc, p, MPI_REAL_T, rank - 1, 1, thisMaterialLoc->comm, &(thisSimLoc->taskRequests[0]));
+		MPI_Isend(priorStateLoc + p, p, MPI_REAL_T, rank - 1, 0, thisMaterialLoc->comm, &(thisSimLoc->taskRequests[1]));
+	}
+	else
+	{
+		for (i = 0; i < p; ++i)
+			priorStateLoc[i] = storeReal(thisSimLoc->bdryVal);
+	}
+	if (rank != size - 1)
+	{
+		MPI_Irecv(priorStateLoc + h - p, p, MPI_REAL_T, rank + 1, 0, thisMaterialLoc->comm, &(thisSimLoc->taskRequests[2]));
+		MPI_Isend(priorStateLoc + h - 2 * p, p, MPI_REAL_T, rank + 1, 1, thisMaterialLoc->comm, &(thisSimLoc->taskRequests[3]));
+	}
+	return 1;
+};
+
+// nonzero once the halo request this poll task waits on is done
+static int pollHaloTaskLoc(void *arg, int worker)
+{
+	stepTaskArg *thisArg = (stepTaskArg *)arg;
+	int done = 0;
+	MPI_Test(&(thisArg->sim->taskRequests[thisArg->tile]), &done, MPI_STATUS_IGNORE);
+	return done;
+};
+
+// new state of one tile
+static int computeTaskLoc(void *arg, int worker)
+{
+	stepTaskArg *thisArg = (stepTaskArg *)arg;
+	thisArg->sim->taskChangeLoc[thisArg->tile] = eulerRowsLoc(thisArg->sim, thisArg->rowStart, thisArg->rowEnd);
+	return 1;
+};
+
+// copy one tile's new state over its prior state
+static int copyTaskLoc(void *arg, int worker)
+{
+	stepTaskArg *thisArg = (stepTaskArg *)arg;
+	int nCols = (thisArg->sim->thisMaterialLoc)->Nx;
+	int first = thisArg->rowStart * nCols;
+	memcpy(thisArg->sim->priorStateLoc + first, thisArg->sim->currentStateLoc + first, (thisArg->rowEnd - thisArg->rowStart) * nCols * sizeof(real_t));
+	return 1;
+};
+
+// copy one tile's new state into the snapshot due after this step
+static int snapTaskLoc(void *arg, int worker)
+{
+	stepTaskArg *thisArg = (stepTaskArg *)arg;
+	simLoc *thisSimLoc = thisArg->sim;
+	checkPtTimeLoc *theseTimesLoc = thisSimLoc->snapDueLoc;
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	long nSpacePts = (long)nCols * (thisSimLoc->thisMaterialLoc)->NyLocal;
+	real_t *snap = theseTimesLoc->stateSnapshotsLoc + nSpacePts * theseTimesLoc->currentSnapIdx + (long)(thisArg->rowStart - nPadRows) * nCols;
+	memcpy(snap, thisSimLoc->currentStateLoc + thisArg->rowStart * nCols, (thisArg->rowEnd - thisArg->rowStart) * nCols * sizeof(real_t));
+	return 1;
+};
+
+// One forward Euler step as a graph of tasks. The update of each tile waits only on the ghost row it reads (if
+// any), each tile's copy over the prior state waits on the updates that read its prior rows (and, for the edge
+// tiles, on the send of the edge row), and its snapshot copy waits only on its update.
+static int oneStepTasksLoc(simLoc *thisSimLoc)
+{
+	real_t *newStateLoc = thisSimLoc->currentStateLoc;
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+	if ((newStateLoc == NULL) || (priorStateLoc == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStepTasksLoc() \n");
+		return 1;
+	}
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	taskPool *pool = thisSimLoc->taskPoolLoc;
+	int nPadRows = thisMaterialLoc->nPadRows;
+	int nRowsUnpadded = thisMaterialLoc->NyLocal;
+	int taskRows = thisSimLoc->taskRows;
+	int nTiles = (nRowsUnpadded + taskRows - 1) / taskRows;
+	int rank, size;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	MPI_Comm_size(thisMaterialLoc->comm, &size);
+	checkPtTimeLoc *snapLoc = thisSimLoc->snapDueLoc;
+	if ((snapLoc != NULL) && ((snapLoc->stateSnapshotsLoc == NULL) || (snapLoc->times == NULL)))
+		snapLoc = NULL; // leave it to recordSnapLoc, which warns about it
+
+	// room for every tile's arguments and monitor share, plus the post and the 4 polls
+	if (thisSimLoc->taskArgsCapacity < nTiles + 5)
+	{
+		void *newArgs = realloc(thisSimLoc->taskArgsLoc, (nTiles + 5) * sizeof(stepTaskArg));
+		acc_t *newChange = realloc(thisSimLoc->taskChangeLoc, (nTiles + 5) * sizeof(acc_t));
+		if (newArgs != NULL)
+			thisSimLoc->taskArgsLoc = newArgs;
+		if (newChange != NULL)
+			thisSimLoc->taskChangeLoc = newChange;
+		if ((newArgs == NULL) || (newChange == NULL))
+		{
+			printf("WARNING: In oneStepTasksLoc(), issue growing the task arguments \n");
+			return 1;
+		}
+		thisSimLoc->taskArgsCapacity = nTiles + 5;
+	}
+	stepTaskArg *args = (stepTaskArg *)thisSimLoc->taskArgsLoc;
+	int t;
+	for (t = 0; t < nTiles + 5; ++t)
+	{
+		args[t].sim = thisSimLoc;
+		args[t].tile = (t < nTiles) ? t : t - nTiles - 1;
+		args[t].rowStart = nPadRows + t * taskRows;
+		args[t].rowEnd = (t < nTiles - 1) ? args[t].rowStart + taskRows : nPadRows + nRowsUnpadded;
+	}
+
+	// build the graph
+	int flag = clearTasksLoc(pool);
+	int post = addTaskLoc(pool, postHaloTaskLoc, &args[nTiles], TASK_FUNNELED, STEP_TASK_POST);
+	int polls[4] = {-1, -1, -1, -1};
+	int r;
+	for (r = 0; r < 4; ++r)
+	{
+		if (((r < 2) && (rank == 0)) || ((r >= 2) && (rank == size - 1)))
+			continue;
+		polls[r] = addTaskLoc(pool, pollHaloTaskLoc, &args[nTiles + 1 + r], TASK_POLL, (r % 2 == 0) ? STEP_TASK_RECV : STEP_TASK_SEND);
+		flag += addDepLoc(pool, post, polls[r]);
+	}
+	int firstCompute = pool->nTasks;
+	for (t = 0; t < nTiles; ++t)
+		addTaskLoc(pool, computeTaskLoc, &args[t], TASK_RUN, STEP_TASK_COMPUTE);
+	flag += addDepLoc(pool, polls[0], firstCompute);
+	flag += addDepLoc(pool, polls[2], firstCompute + nTiles - 1);
+	for (t = 0; t < nTiles; ++t)
+	{
+		int copy = addTaskLoc(pool, copyTaskLoc, &args[t], TASK_RUN, STEP_TASK_COPY);
+		if (t > 0)
+			flag += addDepLoc(pool, firstCompute + t - 1, copy);
+		flag += addDepLoc(pool, firstCompute + t, copy);
+		if (t < nTiles - 1)
+			flag += addDepLoc(pool, firstCompute + t + 1, copy);
+		if (t == 0)
+			flag += addDepLoc(pool, polls[1], copy);
+		if (t == nTiles - 1)
+			flag += addDepLoc(pool, polls[3], copy);
+		if (snapLoc != NULL)
+			flag += addDepLoc(pool, firstCompute + t, addTaskLoc(pool, snapTaskLoc, &args[t], TASK_RUN, STEP_TASK_SNAP));
+	}
+
+	// run it
+	double wallStart = MPI_Wtime();
+	flag += runTasksLoc(pool);
+	thisSimLoc->taskWallLoc += MPI_Wtime() - wallStart;
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1;
+	thisSimLoc->statsFilled = 0; // the tiles weren't visited in order, so recordStatsLoc makes its own pass
+	if (snapLoc != NULL)
+	{
+		snapLoc->times[snapLoc->currentSnapIdx] = (float)(thisSimLoc->currentTimeIdx) * thisSimLoc->dt;
+		snapLoc->currentSnapIdx = snapLoc->currentSnapIdx + 1;
+		thisSimLoc->snapDueLoc = NULL;
+	}
+
+	// the monitor (tile by tile, in order), and the timing of the tasks (the compute time for rebalanceLoc is
+	// the time spent in the tile tasks, since idle workers spin and would count in any CPU clock)
+	acc_t stepChange = 0.0;
+	for (t = 0; t < nTiles; ++t)
+	{
+		if (thisSimLoc->monitorNorm == MONITOR_MAX)
+			stepChange = fmax(stepChange, thisSimLoc->taskChangeLoc[t]);
+		else
+			stepChange += thisSimLoc->taskChangeLoc[t];
+	}
+	thisSimLoc->stepChangeLoc = stepChange;
+	double postEnd = pool->tasks[post].end;
+	double arrived = postEnd;
+	for (r = 0; r < 4; r += 2)
+	{
+		if ((polls[r] >= 0) && (pool->tasks[polls[r]].end > arrived))
+			arrived = pool->tasks[polls[r]].end;
+	}
+	thisSimLoc->taskFlightLoc += arrived - postEnd;
+	int i;
+	for (i = 0; i < pool->nTasks; ++i)
+	{
+		task *thisTask = &(pool->tasks[i]);
+		int label = thisTask->label;
+		if ((label == STEP_TASK_COMPUTE) || (label == STEP_TASK_COPY) || (label == STEP_TASK_SNAP))
+		{
+			thisSimLoc->taskBusyLoc += thisTask->end - thisTask->start;
+			thisSimLoc->computeTimeLoc += thisTask->end - thisTask->start;
+		}
+		if (label == STEP_TASK_COMPUTE)
+		{
+			double lo = (thisTask->start > postEnd) ? thisTask->start : postEnd;
+			double hi = (thisTask->end < arrived) ? thisTask->end : arrived;
+			if (hi > lo)
+				thisSimLoc->taskOverlapLoc += hi - lo;
+		}
+		if (thisSimLoc->taskTraceFile != NULL)
+		{
+			int tile = ((label == STEP_TASK_COMPUTE) || (label == STEP_TASK_COPY) || (label == STEP_TASK_SNAP)) ? ((stepTaskArg *)thisTask->arg)->tile : -1;
+			fprintf(thisSimLoc->taskTraceFile, "%d, %d, %d, %d, %d, %.9f, %.9f\n", thisSimLoc->currentTimeIdx, label, tile, thisTask->worker, thisTask->stolen, thisTask->start, thisTask->end);
+		}
+	}
+	thisSimLoc->taskSteps = thisSimLoc->taskSteps + 1;
+	return flag;
+};
+
+// One forward Euler step updating priorStateLoc in place. Before a row is overwritten its old values are
+// saved in one row of rowBufLoc, where the next row's update reads them as the row above, so two rows of
+// buffer stand in for currentStateLoc. Each point gets exactly the arithmetic of oneStepLoc's sweep.
+static int oneStepInPlaceLoc(simLoc *thisSimLoc)
+{
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+	if ((priorStateLoc == NULL) || (thisSimLoc->rowBufLoc == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStepInPlaceLoc() \n");
+		return 1;
+	}
+	if ((thisSimLoc->integrator != INTEGRATOR_EULER) || (thisSimLoc->stencilOrder != 2))
+	{
+		printf("WARNING: In oneStepInPlaceLoc(), low memory mode only works for second order forward Euler steps \n");
+		return 1;
+	}
+	int flag = exchangeGhostRegions(thisSimLoc);
+	double sweepStart = cpuSecondsLoc();
+
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nRowsUnpadded = (thisSimLoc->thisMaterialLoc)->NyLocal;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	int nRowsGlobal = (thisSimLoc->thisMaterialLoc)->NyTotal;
+	int startYId = (thisSimLoc->thisMaterialLoc)->startYId;
+	float dx = (thisSimLoc->thisMaterialLoc)->dx;
+	float dy = (thisSimLoc->thisMaterialLoc)->dy;
+	float alpha = (thisSimLoc->thisMaterialLoc)->alpha;
+	float dt = thisSimLoc->dt;
+	real_t bdry = storeReal(thisSimLoc->bdryVal);
+	int monitor = thisSimLoc->monitorNorm;
+	int stats = thisSimLoc->statsDue;
+	long globalStart = (long)(startYId - nPadRows) * nCols;
+	if (stats)
+		statsResetLoc(&(thisSimLoc->statsPartialLoc));
+	acc_t stepChange = 0.0;
+
+	// the old row above starts as the ghost row, which isn't updated
+	const real_t *up = priorStateLoc + (nPadRows - 1) * nCols;
+	real_t *saved = thisSimLoc->rowBufLoc;
+	real_t *spare = thisSimLoc->rowBufLoc + nCols;
+	int row, col;
+	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+	{
+		int globalRow = startYId + row - nPadRows;
+		real_t *mid = priorStateLoc + row * nCols;
+		const real_t *down = mid + nCols; // not updated yet (or the ghost row below)
+		memcpy(saved, mid, nCols * sizeof(real_t));
+		if ((globalRow == 0) || (globalRow == nRowsGlobal - 1))
+		{
+			for (col = 0; col < nCols; ++col)
+				mid[col] = bdry;
+		}
+		else
+		{
+			mid[0] = bdry;
+			mid[nCols - 1] = bdry;
+			for (col = 1; col < nCols - 1; ++col)
+				mid[col] = storeReal(loadReal(saved[col]) + dt * stencilRateRowsLoc(up, saved, down, col, alpha, dx, dy));
+			if (monitor != MONITOR_NONE)
+			{
+				for (col = 1; col < nCols - 1; ++col)
+				{
+					acc_t change = loadReal(mid[col]) - loadReal(saved[col]);
+					if (monitor == MONITOR_MAX)
+						stepChange = fmax(stepChange, fabs(change));
+					else
+						stepChange += change * change;
+				}
+			}
+		}
+		if (stats)
+		{
+			for (col = 0; col < nCols; ++col)
+				statsAddLoc(&(thisSimLoc->statsPartialLoc), loadReal(mid[col]), globalStart + row * nCols + col);
+		}
+
+		// this row's old values are the next row's old row above
+		up = saved;
+		saved = spare;
+		spare = (real_t *)up;
+	}
+	thisSimLoc->stepChangeLoc = stepChange;
+	thisSimLoc->statsFilled = stats;
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1;
+	thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
+	return flag;
+};
+
+// Share ghost regions, then move the simulation forward by one time step
+int oneStepLoc(simLoc *thisSimLoc)
+{
+	if (thisSimLoc->lowMemory)
+		return oneStepInPlaceLoc(thisSimLoc);
+	if (thisSimLoc->integrator == INTEGRATOR_RKL2)
+		return oneStepRKL2Loc(thisSimLoc);
+	if ((thisSimLoc->taskPoolLoc != NULL) && (thisSimLoc->stencilOrder == 2))
+		return oneStepTasksLoc(thisSimLoc);
+	if (thisSimLoc->tileRows > 0)
+		return oneStepTiledLoc(thisSimLoc);
+	if (thisSimLoc->stencilOrder == 4)
+		return oneStepWideLoc(thisSimLoc);
+	if (thisSimLoc->kernelVariant == KERNEL_ROWS)
+		return oneStepRowsLoc(thisSimLoc);
+
+	int flag = 0;
+	// grab the prior state and current (i.e. to update) state
+	real_t *newStateLoc = thisSimLoc->currentStateLoc;
+	real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+
+	// if you run into problems return a 1
+	if ((newStateLoc == NULL) || (priorStateLoc == NULL))
+	{
+		printf("WARNING: null pointer for state encountered in oneStep() \n");
+		return 1;
+	}
+
+	// shuffle around ghost region information into the priorStateLoc padded regions
+	flag += exchangeGhostRegions(thisSimLoc);
+	double sweepStart = cpuSecondsLoc();
+
+	// grab the dimensions and material properties
+	int nCols = (thisSimLoc->thisMaterialLoc)->Nx;
+	int nRowsUnpadded = (thisSimLoc->thisMaterialLoc)->NyLocal;
+	int nPadRows = (thisSimLoc->thisMaterialLoc)->nPadRows;
+	int nRowsGlobal = (thisSimLoc->thisMaterialLoc)->NyTotal;
+	float dx = (thisSimLoc->thisMaterialLoc)->dx;
+	float dy = (thisSimLoc->thisMaterialLoc)->dy;
+	float alpha = (thisSimLoc->thisMaterialLoc)->alpha;
+
+	// ============================BEGIN STUDENT CODE==============================
+
+	// go one entry at a time filling in newStateLoc based on the values in priorStateLoc
+	// (measuring the change from priorStateLoc on the way if the steady state monitor is on)
+	int monitor = thisSimLoc->monitorNorm;
+	acc_t stepChange = 0.0;
+	// calculate the row index of this row in the global array
+	// index of current location in padded subarray
+	int row;
+	int col;
+	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+	{
+		for (col = 0; col < nCols; ++col)
+		{
+			// case for all points not on the boundaries is to use the 5 pt stencil to update
+			//if ((nPadRows < row) && (row < nRowsUnpadded + nPadRows - 1) && (0 < col) && (col < nCols - 1))
+			//{
+
+			// global row index of this row, so only the 0th and last rows of the whole material are boundaries
+			int globalRow = (thisSimLoc->thisMaterialLoc)->startYId + row - nPadRows;
+			if (globalRow == 0 || globalRow == nRowsGlobal - 1 || col == 0 || col == nCols - 1)
+			{
+				int idx = (row * nCols) + col;
+				newStateLoc[idx] = storeReal(thisSimLoc->bdryVal);
+			}
+			else
+			{
+				int idx = (row * nCols) + col; // index of current location
+
+				// d^2/dx^2 and d^2/dy^2 terms from the points left, right, above and below in the padded subarray
+				newStateLoc[idx] = storeReal(loadReal(priorStateLoc[idx]) + thisSimLoc->dt * stencilRateLoc(priorStateLoc, idx, nCols, alpha, dx, dy));
+				acc_t change = loadReal(newStateLoc[idx]) - loadReal(priorStateLoc[idx]);
+				if (monitor == MONITOR_MAX)
+					stepChange = fmax(stepChange, fabs(change));
+				else if (monitor == MONITOR_L2)
+					stepChange += change * change;
+			}
+			// case for all points on the boundaries is to fill with boundary value
+			//else
+			//{
+			//	int idx = (row * nCols) + col;
+			//	newStateLoc[idx] = thisSimLoc->bdryVal;
+			//}
+		}
+	}
+
+	// =======================END STUDENT CODE========================================
+	thisSimLoc->stepChangeLoc = stepChange;
+
+	// Now that the new state is all updated and the prior state is no longer needed,
+	// copy the values in the unpadded part of newState into priorState, and move onto the next time step.
+	// (accumulating the statistics of the new state on the way if they're due)
+	thisSimLoc->currentTimeIdx = thisSimLoc->currentTimeIdx + 1; // have completed a time step
+	int stats = thisSimLoc->statsDue;
+	long globalStart = ((long)(thisSimLoc->thisMaterialLoc)->startYId - nPadRows) * nCols;
+	if (stats)
+		statsResetLoc(&(thisSimLoc->statsPartialLoc));
+	for (row = nPadRows; row < nRowsUnpadded + nPadRows; ++row)
+	{
+		for (col = 0; col < nCols; ++col)
+		{
+			int idx = (row * nCols) + col;
+			priorStateLoc[idx] = newStateLoc[idx];
+			if (stats)
+				statsAddLoc(&(thisSimLoc->statsPartialLoc), loadReal(newStateLoc[idx]), globalStart + idx);
+		}
+	}
+	thisSimLoc->statsFilled = stats;
+	thisSimLoc->computeTimeLoc += cpuSecondsLoc() - sweepStart;
+
+	// since no problems were found earlier, return a 0
+	return 0;
+};
+
+// Choose the sweep of second order forward Euler steps without tiling
+int setKernelLoc(simLoc *thisSimLoc, int kernelVariant)
+{
+	if ((kernelVariant != KERNEL_POINT) && (kernelVariant != KERNEL_ROWS))
+	{
+		printf("WARNING: In setKernelLoc(), unknown kernel variant %d \n", kernelVariant);
+		return 1;
+	}
+	thisSimLoc->kernelVariant = kernelVariant;
+	return 0;
+};
+
+// description of this host type: the CPU model and number of online cores (';' swapped out so it can key the cache)
+static void hostKeyLoc(char *key, int len)
+{
+	char model[AUTOTUNE_KEY_LEN] = "unknown";
+	char line[AUTOTUNE_KEY_LEN];
+	FILE *cpuInfo = fopen("/proc/cpuinfo", "r");
+	if (cpuInfo != NULL)
+	{
+		while (fgets(line, sizeof(line), cpuInfo) != NULL)
+		{
+			char *colon = strchr(line, ':');
+			if ((strncmp(line, "model name", 10) == 0) && (colon != NULL))
+			{
+				colon++;
+				while (*colon == ' ')
+					colon++;
+				snprintf(model, sizeof(model), "%s", colon);
+				model[strcspn(model, "\n")] = '\0';
+				break;
+			}
+		}
+		fclose(cpuInfo);
+	}
+	snprintf(key, len, "%s x%ld", model, sysconf(_SC_NPROCESSORS_ONLN));
+	char *c;
+	for (c = key; *c != '\0'; ++c)
+	{
+		if (*c == ';')
+			*c = ',';
+	}
+}
+
+// Pick the fastest configuration of the forward Euler step for this strip
+int autotuneLoc(simLoc *thisSimLoc, int nTrialSteps, const char *cacheFilename)
+{
+	if ((thisSimLoc->integrator != INTEGRATOR_EULER) || (thisSimLoc->stencilOrder != 2))
+	{
+		printf("WARNING: In autotuneLoc(), only second order forward Euler steps can be tuned \n");
+		return 1;
+	}
+	if ((thisSimLoc->taskPoolLoc != NULL) || thisSimLoc->lowMemory)
+	{
+		printf("WARNING: In autotuneLoc(), tune before turning on task mode or low memory mode \n");
+		return 1;
+	}
+	if (nTrialSteps < 1)
+	{
+		printf("WARNING: In autotuneLoc(), nTrialSteps must be positive \n");
+		return 1;
+	}
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int rank, nProcs;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	MPI_Comm_size(thisMaterialLoc->comm, &nProcs);
+	int nCols = thisMaterialLoc->Nx;
+
+	// look for an earlier choice for this host type, grid and number of ranks: {found, kernel, tileRows, tileCols}
+	char key[AUTOTUNE_KEY_LEN + 48]; // the host, then 3 numbers of up to 11 characters and their separators
+	char host[AUTOTUNE_KEY_LEN];
+	int choice[4] = {0, KERNEL_POINT, 0, 0};
+	int keyFits = 0;
+	if (rank == 0)
+	{
+		hostKeyLoc(host, sizeof(host));
+		FILE *cache = NULL;
+		keyFits = (snprintf(key, sizeof(key), "%s;%u;%u;%d;", host, thisMaterialLoc->Nx, thisMaterialLoc->NyTotal, nProcs) < (int)sizeof(key));
+		if (!keyFits)
+			printf("WARNING: In autotuneLoc(), the cache key is too long, so the cache isn't used \n");
+		else if (cacheFilename != NULL)
+			cache = fopen(cacheFilename, "r");
+		if (cache != NULL)
+		{
+			char line[sizeof(key) + 64];
+			while (fgets(line, sizeof(line), cache) != NULL)
+			{
+				int kernel, tileRows, tileCols;
+				if ((strncmp(line, key, strlen(key)) == 0) && (sscanf(line + strlen(key), "%d;%d;%d", &kernel, &tileRows, &tileCols) == 3))
+				{
+					choice[0] = 1;
+					choice[1] = kernel;
+					choice[2] = tileRows;
+					choice[3] = tileCols;
+				}
+			}
+			fclose(cache);
+		}
+	}
+	MPI_Bcast(choice, 4, MPI_INT, 0, thisMaterialLoc->comm);
+	if (choice[0])
+	{
+		thisSimLoc->tunedFromCache = 1;
+		thisSimLoc->tunedStepTime = 0.0;
+		return setKernelLoc(thisSimLoc, choice[1]) + setTilingLoc(thisSimLoc, choice[2], choice[3]);
+	}
+
+	// keep what the trials will overwrite
+	int nPaddedPts = thisMaterialLoc->NyPadded * nCols;
+	real_t *savedLoc = malloc(nPaddedPts * sizeof(real_t));
+	if (savedLoc == NULL)
+	{
+		printf("WARNING: In autotuneLoc(), issue allocating space to keep the state \n");
+		return 1;
+	}
+	memcpy(savedLoc, thisSimLoc->priorStateLoc, nPaddedPts * sizeof(real_t));
+	int savedTimeIdx = thisSimLoc->currentTimeIdx;
+	double savedComputeTime = thisSimLoc->computeTimeLoc;
+	acc_t savedStepChange = thisSimLoc->stepChangeLoc;
+	int savedStatsDue = thisSimLoc->statsDue;
+	thisSimLoc->statsDue = 0;
+
+	// time each candidate: one untimed step (to warm the caches and fill the activity map), then nTrialSteps
+	int candidates[5][3] = {{KERNEL_POINT, 0, 0}, {KERNEL_ROWS, 0, 0}, {KERNEL_POINT, 16, 64}, {KERNEL_POINT, 32, 256}, {KERNEL_POINT, 64, nCols}};
+	int nCandidates = 5;
+	int best = 0;
+	double bestTime = 0.0;
+	int flag = 0;
+	int c, step;
+	for (c = 0; c < nCandidates; ++c)
+	{
+		memcpy(thisSimLoc->priorStateLoc, savedLoc, nPaddedPts * sizeof(real_t));
+		thisSimLoc->currentTimeIdx = savedTimeIdx;
+		flag += setKernelLoc(thisSimLoc, candidates[c][0]);
+		flag += setTilingLoc(thisSimLoc, candidates[c][1], candidates[c][2]);
+		flag += oneStepLoc(thisSimLoc);
+		MPI_Barrier(thisMaterialLoc->comm);
+		double start = MPI_Wtime();
+		for (step = 0; step < nTrialSteps; ++step)
+			flag += oneStepLoc(thisSimLoc);
+		double mine = (MPI_Wtime() - start) / nTrialSteps, slowest;
+		MPI_Allreduce(&mine, &slowest, 1, MPI_DOUBLE, MPI_MAX, thisMaterialLoc->comm);
+		if ((c == 0) || (slowest < bestTime))
+		{
+			best = c;
+			bestTime = slowest;
+		}
+	}
+
+	// put everything back and take the fastest
+	memcpy(thisSimLoc->priorStateLoc, savedLoc, nPaddedPts * sizeof(real_t));
+	free(savedLoc);
+	thisSimLoc->currentTimeIdx = savedTimeIdx;
+	thisSimLoc->computeTimeLoc = savedComputeTime;
+	thisSimLoc->stepChangeLoc = savedStepChange;
+	thisSimLoc->statsDue = savedStatsDue;
+	thisSimLoc->statsFilled = 0;
+	flag += setKernelLoc(thisSimLoc, candidates[best][0]);
+	flag += setTilingLoc(thisSimLoc, candidates[best][1], candidates[best][2]);
+	thisSimLoc->tunedFromCache = 0;
+	thisSimLoc->tunedStepTime = bestTime;
+
+	if ((rank == 0) && (cacheFilename != NULL) && keyFits)
+	{
+		FILE *cache = fopen(cacheFilename, "a");
+		if (cache == NULL)
+		{
+			printf("WARNING: In autotuneLoc(), issue opening the cache file %s \n", cacheFilename);
+			flag += 1;
+		}
+		else
+		{
+			fprintf(cache, "%s%d;%d;%d\n", key, candidates[best][0], candidates[best][1], candidates[best][2]);
+			fclose(cache);
+		}
+	}
+	return flag;
+};
+
+// stop the threads of task mode and free what it uses
+static void stopTaskModeLoc(simLoc *thisSimLoc)
+{
+	if (thisSimLoc->taskPoolLoc != NULL)
+	{
+		cleanupTaskPoolLoc(thisSimLoc->taskPoolLoc);
+		free(thisSimLoc->taskPoolLoc);
+	}
+	thisSimLoc->taskPoolLoc = NULL;
+	free(thisSimLoc->taskArgsLoc);
+	thisSimLoc->taskArgsLoc = NULL;
+	thisSimLoc->taskArgsCapacity = 0;
+	free(thisSimLoc->taskChangeLoc);
+	thisSimLoc->taskChangeLoc = NULL;
+	if (thisSimLoc->taskTraceFile != NULL)
+		fclose(thisSimLoc->taskTraceFile);
+	thisSimLoc->taskTraceFile = NULL;
+	thisSimLoc->taskRows = 0;
+};
+
+// Turn on (or off) task mode
+int setTaskModeLoc(simLoc *thisSimLoc, int nThreads, int taskRows, const char *tracePrefix)
+{
+	stopTaskModeLoc(thisSimLoc);
+	if (nThreads <= 0)
+		return 0;
+	if ((thisSimLoc->integrator != INTEGRATOR_EULER) || (thisSimLoc->stencilOrder != 2) || (thisSimLoc->tileRows > 0) || thisSimLoc->lowMemory)
+	{
+		printf("WARNING: In setTaskModeLoc(), task mode only works for second order forward Euler steps without tiling or low memory mode \n");
+		return 1;
+	}
+	if (taskRows <= 0)
+	{
+		printf("WARNING: In setTaskModeLoc(), taskRows must be positive \n");
+		return 1;
+	}
+	int provided;
+	MPI_Query_thread(&provided);
+	if (provided < MPI_THREAD_FUNNELED)
+	{
+		printf("WARNING: In setTaskModeLoc(), MPI wasn't initialized with MPI_THREAD_FUNNELED or higher \n");
+		return 1;
+	}
+
+	thisSimLoc->taskPoolLoc = malloc(sizeof(taskPool));
+	if ((thisSimLoc->taskPoolLoc == NULL) || initTaskPoolLoc(thisSimLoc->taskPoolLoc, nThreads))
+	{
+		printf("WARNING: In setTaskModeLoc(), issue starting the threads \n");
+		free(thisSimLoc->taskPoolLoc);
+		thisSimLoc->taskPoolLoc = NULL;
+		return 1;
+	}
+	thisSimLoc->taskRows = taskRows;
+	thisSimLoc->taskSteps = 0;
+	thisSimLoc->taskWallLoc = 0.0;
+	thisSimLoc->taskBusyLoc = 0.0;
+	thisSimLoc->taskFlightLoc = 0.0;
+	thisSimLoc->taskOverlapLoc = 0.0;
+	if (tracePrefix != NULL)
+	{
+		int rank;
+		MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
+		char name[STEP_TASK_NAME_LEN];
+		snprintf(name, STEP_TASK_NAME_LEN, "%s.%d.csv", tracePrefix, rank);
+		thisSimLoc->taskTraceFile = fopen(name, "w");
+		if (thisSimLoc->taskTraceFile == NULL)
+		{
+			printf("WARNING: In setTaskModeLoc(), issue opening the trace file %s \n", name);
+			return 1;
+		}
+		fprintf(thisSimLoc->taskTraceFile, "timeIdx, task, tile, worker, stolen, start, end\n");
+	}
+	return 0;
+};
+
+// Turn on (or off) low memory mode
+int setLowMemoryLoc(simLoc *thisSimLoc, int lowMemory)
+{
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	if (!lowMemory)
+	{
+		if (!thisSimLoc->lowMemory)
+			return 0;
+		freeArrayLoc(thisSimLoc->rowBufLoc);
+		thisSimLoc->rowBufLoc = NULL;
+		thisSimLoc->lowMemory = 0;
+		thisSimLoc->currentStateLoc = allocArrayLoc(thisMaterialLoc->NyPadded * thisMaterialLoc->Nx * sizeof(real_t));
+		if (thisSimLoc->currentStateLoc == NULL)
+		{
+			printf("WARNING: In setLowMemoryLoc(), issue allocating the current state \n");
+			return 1;
+		}
+		return 0;
+	}
+	if ((thisSimLoc->integrator != INTEGRATOR_EULER) || (thisSimLoc->stencilOrder != 2) || (thisSimLoc->tileRows > 0) || (thisSimLoc->taskPoolLoc != NULL) || (thisSimLoc->balanceEvery > 0))
+	{
+		printf("WARNING: In setLowMemoryLoc(), low memory mode only works for second order forward Euler steps without tiling, task mode or load balancing \n");
+		return 1;
+	}
+	if (thisSimLoc->lowMemory)
+		return 0;
+	thisSimLoc->rowBufLoc = allocArrayLoc(2 * thisMaterialLoc->Nx * sizeof(real_t));
+	if (thisSimLoc->rowBufLoc == NULL)
+	{
+		printf("WARNING: In setLowMemoryLoc(), issue allocating the row buffer \n");
+		return 1;
+	}
+	freeArrayLoc(thisSimLoc->currentStateLoc);
+	thisSimLoc->currentStateLoc = NULL;
+	freeArrayLoc(thisSimLoc->initStateLoc);
+	thisSimLoc->initStateLoc = NULL;
+	thisSimLoc->lowMemory = 1;
+	return 0;
+};
+
+// Turn on (or off) dynamic load balancing
+int setBalanceLoc(simLoc *thisSimLoc, int balanceEvery, float tol)
+{
+	if (balanceEvery < 0)
+	{
+		printf("WARNING: In setBalanceLoc(), balanceEvery must not be negative \n");
+		return 1;
+	}
+	if ((balanceEvery > 0) && thisSimLoc->lowMemory)
+	{
+		printf("WARNING: In setBalanceLoc(), load balancing doesn't work in low memory mode \n");
+		return 1;
+	}
+	thisSimLoc->balanceEvery = balanceEvery;
+	thisSimLoc->balanceTol = tol;
+	thisSimLoc->computeTimeLoc = 0.0;
+	return 0;
+};
+
+// Check the balance of the stencil work since the last call, and move rows between ranks if it's off
+int rebalanceLoc(simLoc *thisSimLoc, checkPtTimeLoc *theseTimesLoc)
+{
+	int flag = 0;
+	double wallStart = MPI_Wtime();
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	MPI_Comm comm = thisMaterialLoc->comm;
+	int rank, size, r;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	int Nx = thisMaterialLoc->Nx;
+	int nPadRows = thisMaterialLoc->nPadRows;
+	if (thisSimLoc->lowMemory)
+	{
+		printf("WARNING: In rebalanceLoc(), rows can't be moved in low memory mode \n");
+		return 1;
+	}
+
+	// everyone's compute time and rows
+	double *times = malloc(size * sizeof(double));
+	int *oldStarts = malloc(size * sizeof(int));
+	int *oldCounts = malloc(size * sizeof(int));
+	int *newStarts = malloc((size + 1) * sizeof(int));
+	int myStart = thisMaterialLoc->startYId;
+	int myCount = thisMaterialLoc->NyLocal;
+	MPI_Allgather(&(thisSimLoc->computeTimeLoc), 1, MPI_DOUBLE, times, 1, MPI_DOUBLE, comm);
+	MPI_Allgather(&myStart, 1, MPI_INT, oldStarts, 1, MPI_INT, comm);
+	MPI_Allgather(&myCount, 1, MPI_INT, oldCounts, 1, MPI_INT, comm);
+	thisSimLoc->computeTimeLoc = 0.0;
+	thisSimLoc->nBalanceChecks++;
+	double maxTime = 0.0, totalTime = 0.0;
+	for (r = 0; r < size; ++r)
+	{
+		totalTime += times[r];
+		if (times[r] > maxTime)
+			maxTime = times[r];
+	}
+	thisSimLoc->lastImbalance = (totalTime > 0) ? maxTime * size / totalTime : 1.0;
+	thisSimLoc->predictedImbalance = thisSimLoc->lastImbalance;
+	int tooFast = 0;
+	for (r = 0; r < size; ++r)
+		tooFast = tooFast || (times[r] <= 0.0);
+	if (tooFast || (thisSimLoc->lastImbalance <= 1.0 + thisSimLoc->balanceTol))
+	{
+		free(times);
+		free(oldStarts);
+		free(oldCounts);
+		free(newStarts);
+		thisSimLoc->rebalanceTime += MPI_Wtime() - wallStart;
+		return 0;
+	}
+
+	// split the rows so every rank gets the same measured cost, taking each row to cost what the rows of its
+	// current rank cost on average (so both slow ranks and ranks with busy rows end up with fewer rows)
+	int NyTotal = thisMaterialLoc->NyTotal;
+	int minRows = (nPadRows > 1) ? nPadRows : 1;
+	double cumulative = 0.0;
+	int j, owner = 0, next = 1;
+	newStarts[0] = 0;
+	for (j = 0; (j < NyTotal) && (next < size); ++j)
+	{
+		while (j >= oldStarts[owner] + oldCounts[owner])
+			++owner;
+		double rowCost = times[owner] / oldCounts[owner];
+		while ((next < size) && (cumulative + 0.5 * rowCost >= totalTime * next / size))
+			newStarts[next++] = j;
+		cumulative += rowCost;
+	}
+	while (next < size)
+		newStarts[next++] = NyTotal;
+	newStarts[size] = NyTotal;
+	// only go part of the way there, since the costs are measured on the old rows and the work moves over
+	// time (going all the way makes the split swing back and forth)
+	for (r = 1; r < size; ++r)
+		newStarts[r] = oldStarts[r] + (int)floor(BALANCE_RELAX * (newStarts[r] - oldStarts[r]) + 0.5);
+	for (r = 1; r < size; ++r)
+	{
+		if (newStarts[r] < newStarts[r - 1] + minRows)
+			newStarts[r] = newStarts[r - 1] + minRows;
+	}
+	for (r = size - 1; r > 0; --r)
+	{
+		if (newStarts[r] > newStarts[r + 1] - minRows)
+			newStarts[r] = newStarts[r + 1] - minRows;
+	}
+
+	// predicted cost of every rank's new rows
+	double predictedMax = 0.0, predicted = 0.0;
+	owner = 0;
+	next = 1;
+	for (j = 0; j < NyTotal; ++j)
+	{
+		while (j >= oldStarts[owner] + oldCounts[owner])
+			++owner;
+		if (j == newStarts[next])
+		{
+			predictedMax = (predicted > predictedMax) ? predicted : predictedMax;
+			predicted = 0.0;
+			++next;
+		}
+		predicted += times[owner] / oldCounts[owner];
+	}
+	predictedMax = (predicted > predictedMax) ? predicted : predictedMax;
+	thisSimLoc->predictedImbalance = predictedMax * size / totalTime;
+	int newStart = newStarts[rank];
+	int newCount = newStarts[rank + 1] - newStarts[rank];
+
+	// each row carries its state, its initial state, and its row of every snapshot
+	int nSnaps = (theseTimesLoc != NULL) ? theseTimesLoc->nSnaps : 0;
+	int rowVals = (2 + nSnaps) * Nx;
+	real_t *newPrior = allocArrayLoc((newCount + 2 * nPadRows) * Nx * sizeof(real_t));
+	real_t *newInit = allocArrayLoc(newCount * Nx * sizeof(real_t));
+	real_t *newSnaps = (nSnaps > 0) ? allocArrayLoc(nSnaps * newCount * Nx * sizeof(real_t)) : NULL;
+	real_t **sendBufs = calloc(size, sizeof(real_t *));
+	real_t **recvBufs = calloc(size, sizeof(real_t *));
+	MPI_Request *requests = malloc(4 * size * sizeof(MPI_Request));
+	int nRequests = 0;
+	int s;
+
+	// with tiling, each row also carries whether its tiles changed in the last step, so skipping carries on
+	// right after the move instead of starting over with a full sweep
+	int nTilesX = (thisSimLoc->tileRows > 0) ? thisSimLoc->nTilesX : 0;
+	unsigned char *rowChanged = NULL;
+	unsigned char *newRowChanged = NULL;
+	unsigned char **sendFlags = calloc(size, sizeof(unsigned char *));
+	if (nTilesX > 0)
+	{
+		rowChanged = malloc(myCount * nTilesX + 1);
+		newRowChanged = malloc(newCount * nTilesX + 1);
+		int tx;
+		for (j = 0; j < myCount; ++j)
+		{
+			for (tx = 0; tx < nTilesX; ++tx)
+				rowChanged[j * nTilesX + tx] = !thisSimLoc->activityValid || thisSimLoc->tileChanged[(j / thisSimLoc->tileRows) * nTilesX + tx];
+		}
+	}
+	for (r = 0; r < size; ++r)
+	{
+		// rows of mine that rank r gets, and rows of rank r that I get
+		int outLo = (myStart > newStarts[r]) ? myStart : newStarts[r];
+		int outHi = (myStart + myCount < newStarts[r + 1]) ? myStart + myCount : newStarts[r + 1];
+		int inLo = (oldStarts[r] > newStart) ? oldStarts[r] : newStart;
+		int inHi = (oldStarts[r] + oldCounts[r] < newStart + newCount) ? oldStarts[r] + oldCounts[r] : newStart + newCount;
+		if ((r != rank) && (outHi > outLo))
+		{
+			sendBufs[r] = malloc((outHi - outLo) * rowVals * sizeof(real_t));
+			real_t *pos = sendBufs[r];
+			for (j = outLo; j < outHi; ++j)
+			{
+				int localRow = j - myStart;
+				memcpy(pos, thisSimLoc->priorStateLoc + (localRow + nPadRows) * Nx, Nx * sizeof(real_t));
+				memcpy(pos + Nx, thisSimLoc->initStateLoc + localRow * Nx, Nx * sizeof(real_t));
+				for (s = 0; s < nSnaps; ++s)
+					memcpy(pos + (2 + s) * Nx, theseTimesLoc->stateSnapshotsLoc + (s * myCount + localRow) * Nx, Nx * sizeof(real_t));
+				pos += rowVals;
+			}
+			MPI_Isend(sendBufs[r], (outHi - outLo) * rowVals, MPI_REAL_T, r, 3, comm, &requests[nRequests++]);
+			if (nTilesX > 0)
+			{
+				sendFlags[r] = rowChanged + (outLo - myStart) * nTilesX;
+				MPI_Isend(sendFlags[r], (outHi - outLo) * nTilesX, MPI_UNSIGNED_CHAR, r, 4, comm, &requests[nRequests++]);
+			}
+		}
+		if ((r != rank) && (inHi > inLo))
+		{
+			recvBufs[r] = malloc((inHi - inLo) * rowVals * sizeof(real_t));
+			MPI_Irecv(recvBufs[r], (inHi - inLo) * rowVals, MPI_REAL_T, r, 3, comm, &requests[nRequests++]);
+			if (nTilesX > 0)
+				MPI_Irecv(newRowChanged + (inLo - newStart) * nTilesX, (inHi - inLo) * nTilesX, MPI_UNSIGNED_CHAR, r, 4, comm, &requests[nRequests++]);
+		}
+		if ((r == rank) && (inHi > inLo))
+		{
+			// rows I keep
+			for (j = inLo; j < inHi; ++j)
+			{
+				memcpy(newPrior + (j - newStart + nPadRows) * Nx, thisSimLoc->priorStateLoc + (j - myStart + nPadRows) * Nx, Nx * sizeof(real_t));
+				memcpy(newInit + (j - newStart) * Nx, thisSimLoc->initStateLoc + (j - myStart) * Nx, Nx * sizeof(real_t));
+				for (s = 0; s < nSnaps; ++s)
+					memcpy(newSnaps + (s * newCount + j - newStart) * Nx, theseTimesLoc->stateSnapshotsLoc + (s * myCount + j - myStart) * Nx, Nx * sizeof(real_t));
+				if (nTilesX > 0)
+					memcpy(newRowChanged + (j - newStart) * nTilesX, rowChanged + (j - myStart) * nTilesX, nTilesX);
+			}
+		}
+	}
+	MPI_Waitall(nRequests, requests, MPI_STATUSES_IGNORE);
+	for (r = 0; r < size; ++r)
+	{
+		if (recvBufs[r] == NULL)
+			continue;
+		int inLo = (oldStarts[r] > newStart) ? oldStarts[r] : newStart;
+		int inHi = (oldStarts[r] + oldCounts[r] < newStart + newCount) ? oldStarts[r] + oldCounts[r] : newStart + newCount;
+		real_t *pos = recvBufs[r];
+		for (j = inLo; j < inHi; ++j)
+		{
+			memcpy(newPrior + (j - newStart + nPadRows) * Nx, pos, Nx * sizeof(real_t));
+			memcpy(newInit + (j - newStart) * Nx, pos + Nx, Nx * sizeof(real_t));
+			for (s = 0; s < nSnaps; ++s)
+				memcpy(newSnaps + (s * newCount + j - newStart) * Nx, pos + (2 + s) * Nx, Nx * sizeof(real_t));
+			pos += rowVals;
+		}
+	}
+	for (r = 0; r < size; ++r)
+	{
+		free(sendBufs[r]);
+		free(recvBufs[r]);
+	}
+	free(sendBufs);
+	free(recvBufs);
+	free(sendFlags);
+	free(requests);
+
+	// swap in the new rows
+	thisMaterialLoc->startYId = newStart;
+	thisMaterialLoc->NyLocal = newCount;
+	thisMaterialLoc->NyPadded = newCount + 2 * nPadRows;
+	freeArrayLoc(thisSimLoc->priorStateLoc);
+	thisSimLoc->priorStateLoc = newPrior;
+	freeArrayLoc(thisSimLoc->initStateLoc);
+	thisSimLoc->initStateLoc = newInit;
+	freeArrayLoc(thisSimLoc->currentStateLoc);
+	thisSimLoc->currentStateLoc = allocArrayLoc(thisMaterialLoc->NyPadded * Nx * sizeof(real_t));
+	if (theseTimesLoc != NULL)
+	{
+		freeArrayLoc(theseTimesLoc->stateSnapshotsLoc);
+		theseTimesLoc->stateSnapshotsLoc = newSnaps;
+	}
+	if ((newPrior == NULL) || (newInit == NULL) || (thisSimLoc->currentStateLoc == NULL) || ((nSnaps > 0) && (newSnaps == NULL)))
+	{
+		printf("WARNING: In rebalanceLoc(), issue allocating the new local arrays \n");
+		flag = 1;
+	}
+
+	// work arrays sized by the rows are rebuilt (their contents don't carry over between steps)
+	if (thisSimLoc->integrator == INTEGRATOR_RKL2)
+	{
+		freeArrayLoc(thisSimLoc->rklTauMY0Loc);
+		thisSimLoc->rklTauMY0Loc = NULL;
+		freeArrayLoc(thisSimLoc->rklStageALoc);
+		thisSimLoc->rklStageALoc = NULL;
+		freeArrayLoc(thisSimLoc->rklStageBLoc);
+		thisSimLoc->rklStageBLoc = NULL;
+		flag += setIntegratorLoc(thisSimLoc, INTEGRATOR_RKL2, thisSimLoc->dt);
+	}
+	if (thisSimLoc->tileRows > 0)
+	{
+		long tilesUpdated = thisSimLoc->tilesUpdated;
+		long tilesSkipped = thisSimLoc->tilesSkipped;
+		flag += setTilingLoc(thisSimLoc, thisSimLoc->tileRows, thisSimLoc->tileCols);
+		thisSimLoc->tilesUpdated = tilesUpdated;
+		thisSimLoc->tilesSkipped = tilesSkipped;
+		if (flag == 0)
+		{
+			// a new tile changed if any of its rows did; the new ghost rows count as changed for one step
+			// (NaN never compares equal)
+			int tile, tx;
+			for (tile = 0; tile < thisSimLoc->nTilesY * nTilesX; ++tile)
+				thisSimLoc->tileChanged[tile] = 0;
+			for (j = 0; j < newCount; ++j)
+			{
+				for (tx = 0; tx < nTilesX; ++tx)
+					thisSimLoc->tileChanged[(j / thisSimLoc->tileRows) * nTilesX + tx] |= newRowChanged[j * nTilesX + tx];
+			}
+			for (j = 0; j < 2 * nPadRows * Nx; ++j)
+				thisSimLoc->ghostPrevLoc[j] = storeReal(NAN);
+			thisSimLoc->activityValid = 1;
+		}
+	}
+	free(rowChanged);
+	free(newRowChanged);
+
+	free(times);
+	free(oldStarts);
+	free(oldCounts);
+	free(newStarts);
+	thisSimLoc->nRebalances++;
+	thisSimLoc->rebalanceTime += MPI_Wtime() - wallStart;
+	return flag;
+};
+
+// Turn on (or off) the in situ statistics
+int setStatsLoc(simLoc *thisSimLoc, int statsEvery)
+{
+	if (statsEvery < 0)
+	{
+		printf("WARNING: In setStatsLoc(), statsEvery must not be negative \n");
+		return 1;
+	}
+	thisSimLoc->statsEvery = statsEvery;
+	thisSimLoc->statsDue = 0;
+	thisSimLoc->statsFilled = 0;
+	return 0;
+};
+
+// combine two partial statistics (the user function of the reduction in recordStatsLoc)
+static void statsCombineLoc(void *inVec, void *inOutVec, int *len, MPI_Datatype *datatype)
+{
+	statsPartial *in = (statsPartial *)inVec;
+	statsPartial *inOut = (statsPartial *)inOutVec;
+	int i;
+	for (i = 0; i < *len; ++i)
+	{
+		inOut[i].sum += in[i].sum;
+		if (in[i].min < inOut[i].min)
+			inOut[i].min = in[i].min;
+		if ((in[i].max > inOut[i].max) || ((in[i].max == inOut[i].max) && (in[i].maxIdx < inOut[i].maxIdx)))
+		{
+			inOut[i].max = in[i].max;
+			inOut[i].maxIdx = in[i].maxIdx;
+		}
+	}
+};
+
+// Combine the ranks' partial statistics of the current state with one reduction and append the record on rank 0
+int recordStatsLoc(simLoc *thisSimLoc)
+{
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int nCols = thisMaterialLoc->Nx;
+	int nPadRows = thisMaterialLoc->nPadRows;
+	if (!thisSimLoc->statsFilled)
+	{
+		// no sweep accumulated them, so read the state once
+		long globalStart = ((long)thisMaterialLoc->startYId - nPadRows) * nCols;
+		int idx;
+		statsResetLoc(&(thisSimLoc->statsPartialLoc));
+		for (idx = nPadRows * nCols; idx < (thisMaterialLoc->NyLocal + nPadRows) * nCols; ++idx)
+			statsAddLoc(&(thisSimLoc->statsPartialLoc), loadReal(thisSimLoc->priorStateLoc[idx]), globalStart + idx);
+	}
+	thisSimLoc->statsFilled = 0;
+
+	// one reduction of a {sum, min, max, maxIdx} struct with its own operation
+	if (thisSimLoc->statsOpLoc == MPI_OP_NULL)
+	{
+		int blockLengths[2] = {3, 1};
+		MPI_Aint displacements[2] = {offsetof(statsPartial, sum), offsetof(statsPartial, maxIdx)};
+		MPI_Datatype types[2] = {MPI_DOUBLE, MPI_LONG};
+		MPI_Type_create_struct(2, blockLengths, displacements, types, &(thisSimLoc->statsTypeLoc));
+		MPI_Type_commit(&(thisSimLoc->statsTypeLoc));
+		MPI_Op_create(statsCombineLoc, 1, &(thisSimLoc->statsOpLoc));
+	}
+	statsPartial total;
+	MPI_Reduce(&(thisSimLoc->statsPartialLoc), &total, 1, thisSimLoc->statsTypeLoc, thisSimLoc->statsOpLoc, 0, thisMaterialLoc->comm);
+
+	int rank;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	if (rank != 0)
+		return 0;
+	if (thisSimLoc->nStats == thisSimLoc->statsCapacity)
+	{
+		int capacity = (thisSimLoc->statsCapacity > 0) ? 2 * thisSimLoc->statsCapacity : 64;
+		thisSimLoc->statsTimes = realloc(thisSimLoc->statsTimes, capacity * sizeof(float));
+		thisSimLoc->statsMin = realloc(thisSimLoc->statsMin, capacity * sizeof(float));
+		thisSimLoc->statsMax = realloc(thisSimLoc->statsMax, capacity * sizeof(float));
+		thisSimLoc->statsMean = realloc(thisSimLoc->statsMean, capacity * sizeof(double));
+		thisSimLoc->statsEnergy = realloc(thisSimLoc->statsEnergy, capacity * sizeof(double));
+		thisSimLoc->statsHotCol = realloc(thisSimLoc->statsHotCol, capacity * sizeof(int));
+		thisSimLoc->statsHotRow = realloc(thisSimLoc->statsHotRow, capacity * sizeof(int));
+		if ((thisSimLoc->statsTimes == NULL) || (thisSimLoc->statsMin == NULL) || (thisSimLoc->statsMax == NULL) || (thisSimLoc->statsMean == NULL) || (thisSimLoc->statsEnergy == NULL) || (thisSimLoc->statsHotCol == NULL) || (thisSimLoc->statsHotRow == NULL))
+		{
+			printf("WARNING: In recordStatsLoc(), issue growing the statistics records \n");
+			return 1;
+		}
+		thisSimLoc->statsCapacity = capacity;
+	}
+	int n = thisSimLoc->nStats;
+	thisSimLoc->statsTimes[n] = (float)thisSimLoc->currentTimeIdx * thisSimLoc->dt;
+	thisSimLoc->statsMin[n] = total.min;
+	thisSimLoc->statsMax[n] = total.max;
+	thisSimLoc->statsMean[n] = total.sum / ((double)nCols * thisMaterialLoc->NyTotal);
+	thisSimLoc->statsEnergy[n] = total.sum * thisMaterialLoc->dx * thisMaterialLoc->dy;
+	thisSimLoc->statsHotCol[n] = total.maxIdx % nCols;
+	thisSimLoc->statsHotRow[n] = total.maxIdx / nCols;
+	thisSimLoc->nStats = n + 1;
+	return 0;
+};
+
+// Have rank 0 write the statistics records to filename
+int writeStatsToFileLoc(simLoc *thisSimLoc, const char *filename)
+{
+	int rank;
+	MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
+	if (rank != 0)
+		return 0;
+	FILE *filePtr = fopen(filename, "w");
+	if (filePtr == NULL)
+	{
+		printf("ERROR in opening file in writeStatsToFileLoc \n");
+		return 1;
+	}
+	fprintf(filePtr, "time, min, max, mean, energy, hotCol, hotRow\n");
+	int n;
+	for (n = 0; n < thisSimLoc->nStats; ++n)
+		fprintf(filePtr, "%f, %f, %f, %.9g, %.9g, %d, %d\n", thisSimLoc->statsTimes[n], thisSimLoc->statsMin[n], thisSimLoc->statsMax[n], thisSimLoc->statsMean[n], thisSimLoc->statsEnergy[n], thisSimLoc->statsHotCol[n], thisSimLoc->statsHotRow[n]);
+	fclose(filePtr);
+	return 0;
+};
+
+// range of log10 temperature over every rank's rows of the current state (and the boundary value), from one reduction
+static void renderRangeLoc(simLoc *thisSimLoc, float *logMin, float *logMax)
+{
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int nCols = thisMaterialLoc->Nx;
+	int nPadRows = thisMaterialLoc->nPadRows;
+	float minLoc = thisSimLoc->bdryVal, maxLoc = thisSimLoc->bdryVal;
+	int idx;
+	for (idx = nPadRows * nCols; idx < (thisMaterialLoc->NyLocal + nPadRows) * nCols; ++idx)
+	{
+		float val = loadReal(thisSimLoc->priorStateLoc[idx]);
+		if (val < minLoc)
+			minLoc = val;
+		if (val > maxLoc)
+			maxLoc = val;
+	}
+	// the min rides along as -min, so a single MPI_MAX finds both
+	float ends[2] = {-minLoc, maxLoc}, ends0[2];
+	MPI_Allreduce(ends, ends0, 2, MPI_FLOAT, MPI_MAX, thisMaterialLoc->comm);
+	*logMin = log10f(fmaxf(-ends0[0], RENDER_FLOOR));
+	*logMax = log10f(fmaxf(ends0[1], RENDER_FLOOR));
+};
+
+// inferno colour map sampled at 9 evenly spaced points (matplotlib's, which readPlotSnaps.py uses)
+static const unsigned char renderColours[9][3] = {{0, 0, 4}, {31, 12, 72}, {85, 15, 109}, {136, 34, 106}, {186, 54, 85}, {227, 89, 51}, {249, 140, 10}, {249, 201, 50}, {252, 255, 164}};
+
+// colour of level (clamped to between 0 and 1) on the colour map, linearly interpolated between the samples
+static inline void renderColourLoc(float level, unsigned char *rgb)
+{
+	level = fminf(fmaxf(level, 0.0), 1.0) * 8.0;
+	int lo = (int)level;
+	if (lo > 7)
+		lo = 7;
+	float frac = level - lo;
+	int c;
+	for (c = 0; c < 3; ++c)
+		rgb[c] = (unsigned char)(renderColours[lo][c] + frac * (renderColours[lo + 1][c] - renderColours[lo][c]) + 0.5);
+};
+
+// Turn on (or off) the in situ rendering
+int setRenderLoc(simLoc *thisSimLoc, int renderEvery, const char *prefix, int renderScale)
+{
+	if (renderEvery < 0)
+	{
+		printf("WARNING: In setRenderLoc(), renderEvery must not be negative \n");
+		return 1;
+	}
+	if ((renderScale != RENDER_SCALE_FIXED) && (renderScale != RENDER_SCALE_FRAME))
+	{
+		printf("WARNING: In setRenderLoc(), %d is not a colour map scale \n", renderScale);
+		return 1;
+	}
+	if (strlen(prefix) + 8 > RENDER_NAME_LEN)
+	{
+		printf("WARNING: In setRenderLoc(), the frame file name prefix is too long \n");
+		return 1;
+	}
+	thisSimLoc->renderEvery = renderEvery;
+	thisSimLoc->renderScale = renderScale;
+	thisSimLoc->nFrames = 0;
+	strcpy(thisSimLoc->renderPrefix, prefix);
+	if (renderScale == RENDER_SCALE_FIXED)
+		renderRangeLoc(thisSimLoc, &(thisSimLoc->renderLogMin), &(thisSimLoc->renderLogMax));
+	return 0;
+};
+
+// Colour map this rank's rows of the current state and write them into the next frame
+int renderFrameLoc(simLoc *thisSimLoc)
+{
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int nCols = thisMaterialLoc->Nx;
+	int nPadRows = thisMaterialLoc->nPadRows;
+	int nRowsLoc = thisMaterialLoc->NyLocal;
+	float logMin = thisSimLoc->renderLogMin, logMax = thisSimLoc->renderLogMax;
+	if (thisSimLoc->renderScale == RENDER_SCALE_FRAME)
+		renderRangeLoc(thisSimLoc, &logMin, &logMax);
+	float scale = (logMax > logMin) ? 1.0 / (logMax - logMin) : 0.0;
+
+	// colour this rank's rows
+	unsigned char *rgbLoc = (unsigned char *)malloc((long)3 * nCols * nRowsLoc + 1);
+	if (rgbLoc == NULL)
+	{
+		printf("WARNING: In renderFrameLoc(), issue allocating the local pixels \n");
+		return 1;
+	}
+	const real_t *rowsLoc = thisSimLoc->priorStateLoc + nPadRows * nCols;
+	long idx;
+	for (idx = 0; idx < (long)nCols * nRowsLoc; ++idx)
+		renderColourLoc((log10f(fmaxf(loadReal(rowsLoc[idx]), RENDER_FLOOR)) - logMin) * scale, &(rgbLoc[3 * idx]));
+
+	// every rank knows the header's length, so each writes its rows straight to their place in the file
+	// (room for the longest prefix setRenderLoc takes and any frame number, past 999 too)
+	char filename[RENDER_NAME_LEN + 16];
+	char header[64];
+	if (snprintf(filename, sizeof(filename), "%s%03d.ppm", thisSimLoc->renderPrefix, thisSimLoc->nFrames) >= (int)sizeof(filename))
+	{
+		printf("WARNING: In renderFrameLoc(), the name of frame %d is too long \n", thisSimLoc->nFrames);
+		free(rgbLoc);
+		return 1;
+	}
+	int headerLen = snprintf(header, 64, "P6\n%d %d\n255\n", nCols, thisMaterialLoc->NyTotal);
+	MPI_File fileHandle;
+	if (MPI_File_open(thisMaterialLoc->comm, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fileHandle) != MPI_SUCCESS)
+	{
+		printf("WARNING: In renderFrameLoc(), could not open %s \n", filename);
+		free(rgbLoc);
+		return 1;
+	}
+	int rank;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	int flag = 0;
+	MPI_File_set_size(fileHandle, 0);
+	if (rank == 0)
+		flag += (MPI_File_write_at(fileHandle, 0, header, headerLen, MPI_CHAR, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+	MPI_Offset offset = headerLen + (MPI_Offset)3 * nCols * thisMaterialLoc->startYId;
+	flag += (MPI_File_write_at_all(fileHandle, offset, rgbLoc, 3 * nCols * nRowsLoc, MPI_UNSIGNED_CHAR, MPI_STATUS_IGNORE) != MPI_SUCCESS);
+	MPI_File_close(&fileHandle);
+	free(rgbLoc);
+	if (flag)
+		printf("WARNING: In renderFrameLoc(), issue writing %s \n", filename);
+	thisSimLoc->nFrames = thisSimLoc->nFrames + 1;
+	return flag;
+};
+
+// Turn on point probes
+int setProbesLoc(simLoc *thisSimLoc, int nProbes, const float *probeX, const float *probeY, int interpolate, const char *filename, int flushEvery)
+{
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int Nx = thisMaterialLoc->Nx;
+	int NyTotal = thisMaterialLoc->NyTotal;
+	if ((nProbes < 1) || (flushEvery < 1))
+	{
+		printf("WARNING: In setProbesLoc(), need at least one probe and one sample per flush \n");
+		return 1;
+	}
+	if (thisSimLoc->nProbes > 0)
+	{
+		printf("WARNING: In setProbesLoc(), probes are already set \n");
+		return 1;
+	}
+	int i;
+	for (i = 0; i < nProbes; ++i)
+	{
+		if ((probeX[i] < 0.0) || (probeX[i] > (Nx - 1) * thisMaterialLoc->dx) || (probeY[i] < 0.0) || (probeY[i] > (NyTotal - 1) * thisMaterialLoc->dy))
+		{
+			printf("WARNING: In setProbesLoc(), probe %d at (%f, %f) is outside the material \n", i, probeX[i], probeY[i]);
+			return 1;
+		}
+	}
+
+	thisSimLoc->probeCol = (int *)malloc(nProbes * sizeof(int));
+	thisSimLoc->probeRow = (int *)malloc(nProbes * sizeof(int));
+	thisSimLoc->probeWX = (float *)malloc(nProbes * sizeof(float));
+	thisSimLoc->probeWY = (float *)malloc(nProbes * sizeof(float));
+	thisSimLoc->probeTimes = (float *)malloc(flushEvery * sizeof(float));
+	thisSimLoc->probeBufLoc = (double *)malloc((long)flushEvery * nProbes * sizeof(double));
+	if ((thisSimLoc->probeCol == NULL) || (thisSimLoc->probeRow == NULL) || (thisSimLoc->probeWX == NULL) || (thisSimLoc->probeWY == NULL) || (thisSimLoc->probeTimes == NULL) || (thisSimLoc->probeBufLoc == NULL))
+	{
+		printf("WARNING: In setProbesLoc(), issue allocating the probes \n");
+		return 1;
+	}
+
+	// each probe's lower left grid point and the weights of the next column and row over
+	for (i = 0; i < nProbes; ++i)
+	{
+		float fx = probeX[i] / thisMaterialLoc->dx;
+		float fy = probeY[i] / thisMaterialLoc->dy;
+		if (interpolate)
+		{
+			int col = (fx < Nx - 1) ? (int)fx : Nx - 2;
+			int row = (fy < NyTotal - 1) ? (int)fy : NyTotal - 2;
+			thisSimLoc->probeCol[i] = (col > 0) ? col : 0;
+			thisSimLoc->probeRow[i] = (row > 0) ? row : 0;
+			thisSimLoc->probeWX[i] = (Nx > 1) ? fx - thisSimLoc->probeCol[i] : 0.0;
+			thisSimLoc->probeWY[i] = (NyTotal > 1) ? fy - thisSimLoc->probeRow[i] : 0.0;
+		}
+		else
+		{
+			thisSimLoc->probeCol[i] = (int)(fx + 0.5);
+			thisSimLoc->probeRow[i] = (int)(fy + 0.5);
+			thisSimLoc->probeWX[i] = 0.0;
+			thisSimLoc->probeWY[i] = 0.0;
+		}
+	}
+	thisSimLoc->nProbes = nProbes;
+	thisSimLoc->probeFlushEvery = flushEvery;
+	thisSimLoc->nProbeSamples = 0;
+
+	int rank;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	if (rank != 0)
+		return 0;
+	thisSimLoc->probeFile = fopen(filename, "w");
+	if (thisSimLoc->probeFile == NULL)
+	{
+		printf("ERROR in opening file in setProbesLoc \n");
+		return 1;
+	}
+	fprintf(thisSimLoc->probeFile, "time");
+	for (i = 0; i < nProbes; ++i)
+		fprintf(thisSimLoc->probeFile, ", T(%g %g)", probeX[i], probeY[i]);
+	fprintf(thisSimLoc->probeFile, "\n");
+	return 0;
+};
+
+// Add this rank's share of every probe's value in the current state to the buffer
+int sampleProbesLoc(simLoc *thisSimLoc)
+{
+	int flag = 0;
+	if (thisSimLoc->nProbeSamples == thisSimLoc->probeFlushEvery)
+		flag = flushProbesLoc(thisSimLoc);
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int nCols = thisMaterialLoc->Nx;
+	int startYId = thisMaterialLoc->startYId;
+	int endYId = startYId + thisMaterialLoc->NyLocal;
+	int nPadRows = thisMaterialLoc->nPadRows;
+	const real_t *priorStateLoc = thisSimLoc->priorStateLoc;
+	double *sampleLoc = thisSimLoc->probeBufLoc + (long)thisSimLoc->nProbeSamples * thisSimLoc->nProbes;
+	int i, k;
+	for (i = 0; i < thisSimLoc->nProbes; ++i)
+	{
+		int col = thisSimLoc->probeCol[i];
+		float wx = thisSimLoc->probeWX[i];
+		float wy = thisSimLoc->probeWY[i];
+		double share = 0.0;
+		// only the rows this rank owns (the lower left one, and the one below if it has any weight)
+		for (k = 0; k < 2; ++k)
+		{
+			int row = thisSimLoc->probeRow[i] + k;
+			float wRow = k ? wy : 1.0 - wy;
+			if ((wRow == 0.0) || (row < startYId) || (row >= endYId))
+				continue;
+			int idx = (row - startYId + nPadRows) * nCols + col;
+			acc_t val = loadReal(priorStateLoc[idx]);
+			if (wx != 0.0)
+				val = (1.0 - wx) * val + wx * loadReal(priorStateLoc[idx + 1]);
+			share += wRow * val;
+		}
+		sampleLoc[i] = share;
+	}
+	thisSimLoc->probeTimes[thisSimLoc->nProbeSamples] = (float)thisSimLoc->currentTimeIdx * thisSimLoc->dt;
+	thisSimLoc->nProbeSamples = thisSimLoc->nProbeSamples + 1;
+	return flag;
+};
+
+// Sum the buffered shares onto rank 0 with one reduction, and append them to the probe file
+int flushProbesLoc(simLoc *thisSimLoc)
+{
+	int nSamples = thisSimLoc->nProbeSamples;
+	int nProbes = thisSimLoc->nProbes;
+	if ((nProbes == 0) || (nSamples == 0))
+		return 0;
+	MPI_Comm comm = (thisSimLoc->thisMaterialLoc)->comm;
+	int rank;
+	MPI_Comm_rank(comm, &rank);
+	thisSimLoc->nProbeSamples = 0;
+	if (rank != 0)
+	{
+		MPI_Reduce(thisSimLoc->probeBufLoc, NULL, nSamples * nProbes, MPI_DOUBLE, MPI_SUM, 0, comm);
+		return 0;
+	}
+	MPI_Reduce(MPI_IN_PLACE, thisSimLoc->probeBufLoc, nSamples * nProbes, MPI_DOUBLE, MPI_SUM, 0, comm);
+	if (thisSimLoc->probeFile == NULL)
+		return 1;
+	int n, i;
+	for (n = 0; n < nSamples; ++n)
+	{
+		fprintf(thisSimLoc->probeFile, "%f", thisSimLoc->probeTimes[n]);
+		for (i = 0; i < nProbes; ++i)
+			fprintf(thisSimLoc->probeFile, ", %.9g", thisSimLoc->probeBufLoc[(long)n * nProbes + i]);
+		fprintf(thisSimLoc->probeFile, "\n");
+	}
+	fflush(thisSimLoc->probeFile);
+	return 0;
+};
+
+// Simulate nSteps time steps and record snapshots of the whole temperature field
+// every stepsPerCheckPt time steps. runSimLoc does do the initialization of the checkPtTimeLoc
+// struct automatically at the beginning of the simulation.
+// Note: running the simulation doesn't also initialize the sim or the material. Do them separately.
+int runSimLoc(simLoc *thisSimLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc)
+{
+	int flag = 0; // return flag, 0 if no problem, but nonzero if there's a problem
+
+	// do the initialization of the checkpointing struct
+	int nSnaps = calcNSnapsLoc(nSteps, stepsPerCheckPt);
+	int checkPtInitFlag = initCheckPtTimeLoc(theseTimesLoc, thisSimLoc->thisMaterialLoc, thisSimLoc, nSnaps);
+	if (checkPtInitFlag)
+	{
+		printf("WARNING: issue initializing checkpoint in runSim \n");
+		flag = checkPtInitFlag;
+	}
+
+	// check rank
+	int rank;
+	MPI_Comm_rank((thisSimLoc->thisMaterialLoc)->comm, &rank);
+
+	// steady state monitor: the reduction of the change started at one check is only waited on at the
+	// next one, monitorEvery steps later, so it overlaps with the steps in between
+	int monitor = thisSimLoc->monitorNorm;
+	MPI_Request monitorRequest = MPI_REQUEST_NULL;
+	float monitorSend = 0.0, monitorRecv = 0.0;
+	thisSimLoc->stopReason = STOP_NSTEPS;
+	thisSimLoc->stopChange = -1.0;
+
+	// run through the steps
+	int step;
+	recordSnapLoc(theseTimesLoc); // always record 0th  time step's prior state
+	int stats = thisSimLoc->statsEvery;
+	if (stats > 0)
+		flag += recordStatsLoc(thisSimLoc);
+	int render = thisSimLoc->renderEvery;
+	if (render > 0)
+		flag += renderFrameLoc(thisSimLoc);
+	int probes = thisSimLoc->nProbes;
+	if (probes > 0)
+		flag += sampleProbesLoc(thisSimLoc);
+	for (step = 1; step < nSteps; ++step)
+	{
+		// share ghost regions and update simulation (with the sweep accumulating the statistics if they're due)
+		thisSimLoc->statsDue = (stats > 0) && (step % stats == 0);
+		thisSimLoc->snapDueLoc = (step % stepsPerCheckPt == 0) ? theseTimesLoc : NULL;
+		int stepFlag = oneStepLoc(thisSimLoc);
+		if (thisSimLoc->statsDue)
+			flag += recordStatsLoc(thisSimLoc);
+		thisSimLoc->statsDue = 0;
+		if (stepFlag)
+		{
+			printf("WARNING: issue in simulation at %d time step on rank %d \n", step, rank);
+			flag = stepFlag;
+		}
+		if (thisSimLoc->snapDueLoc != NULL)
+			recordSnapLoc(theseTimesLoc); // a snapshot is due and the step didn't take it itself, so record it now
+		thisSimLoc->snapDueLoc = NULL;
+		if ((render > 0) && (step % render == 0))
+			flag += renderFrameLoc(thisSimLoc);
+		if (probes > 0)
+			flag += sampleProbesLoc(thisSimLoc);
+		if ((thisSimLoc->balanceEvery > 0) && (step % thisSimLoc->balanceEvery == 0))
+			flag += rebalanceLoc(thisSimLoc, theseTimesLoc);
+
+		if ((monitor != MONITOR_NONE) && (step % thisSimLoc->monitorEvery == 0))
+		{
+			if (monitorRequest != MPI_REQUEST_NULL)
+			{
+				MPI_Wait(&monitorRequest, MPI_STATUS_IGNORE);
+				float change = (monitor == MONITOR_L2) ? sqrtf(monitorRecv) : monitorRecv;
+				thisSimLoc->stopChange = change;
+				if (change < thisSimLoc->monitorTol)
+				{
+					thisSimLoc->stopReason = STOP_CONVERGED;
+					break;
+				}
+			}
+			monitorSend = thisSimLoc->stepChangeLoc;
+			MPI_Iallreduce(&monitorSend, &monitorRecv, 1, MPI_FLOAT, (monitor == MONITOR_L2) ? MPI_SUM : MPI_MAX, (thisSimLoc->thisMaterialLoc)->comm, &monitorRequest);
+		}
+	}
+	if (monitorRequest != MPI_REQUEST_NULL)
+		MPI_Wait(&monitorRequest, MPI_STATUS_IGNORE);
+	thisSimLoc->stopTimeIdx = thisSimLoc->currentTimeIdx;
+
+	// stopped early: record the last state (unless it was just recorded) and only keep the snapshots taken
+	if (thisSimLoc->stopReason == STOP_CONVERGED)
+	{
+		if (step % stepsPerCheckPt != 0)
+			recordSnapLoc(theseTimesLoc);
+		theseTimesLoc->nSnaps = theseTimesLoc->currentSnapIdx;
+	}
+	if (probes > 0)
+		flag += flushProbesLoc(thisSimLoc);
+	return flag;
+};
+
+// deallocate memory associated with currentStateLoc, initStateLoc, priorStateLoc
+int cleanupSimLoc(simLoc *thisSimLoc)
+{
+	freeArrayLoc(thisSimLoc->initStateLoc);
+	thisSimLoc->initStateLoc = NULL;
+	freeArrayLoc(thisSimLoc->priorStateLoc);
+	thisSimLoc->priorStateLoc = NULL;
+	freeArrayLoc(thisSimLoc->currentStateLoc);
 	thisSimLoc->currentStateLoc = NULL;
+	freeArrayLoc(thisSimLoc->rowBufLoc);
+	thisSimLoc->rowBufLoc = NULL;
+	freeArrayLoc(thisSimLoc->rklTauMY0Loc);
+	thisSimLoc->rklTauMY0Loc = NULL;
+	freeArrayLoc(thisSimLoc->rklStageALoc);
+	thisSimLoc->rklStageALoc = NULL;
+	freeArrayLoc(thisSimLoc->rklStageBLoc);
+	thisSimLoc->rklStageBLoc = NULL;
+	free(thisSimLoc->tileChanged);
+	thisSimLoc->tileChanged = NULL;
+	free(thisSimLoc->tileChangedNext);
+	thisSimLoc->tileChangedNext = NULL;
+	free(thisSimLoc->ghostPrevLoc);
+	thisSimLoc->ghostPrevLoc = NULL;
+	free(thisSimLoc->statsTimes);
+	thisSimLoc->statsTimes = NULL;
+	free(thisSimLoc->statsMin);
+	thisSimLoc->statsMin = NULL;
+	free(thisSimLoc->statsMax);
+	thisSimLoc->statsMax = NULL;
+	free(thisSimLoc->statsMean);
+	thisSimLoc->statsMean = NULL;
+	free(thisSimLoc->statsEnergy);
+	thisSimLoc->statsEnergy = NULL;
+	free(thisSimLoc->statsHotCol);
+	thisSimLoc->statsHotCol = NULL;
+	free(thisSimLoc->statsHotRow);
+	thisSimLoc->statsHotRow = NULL;
+	if (thisSimLoc->statsOpLoc != MPI_OP_NULL)
+	{
+		MPI_Op_free(&(thisSimLoc->statsOpLoc));
+		MPI_Type_free(&(thisSimLoc->statsTypeLoc));
+	}
+	free(thisSimLoc->probeCol);
+	thisSimLoc->probeCol = NULL;
+	free(thisSimLoc->probeRow);
+	thisSimLoc->probeRow = NULL;
+	free(thisSimLoc->probeWX);
+	thisSimLoc->probeWX = NULL;
+	free(thisSimLoc->probeWY);
+	thisSimLoc->probeWY = NULL;
+	free(thisSimLoc->probeTimes);
+	thisSimLoc->probeTimes = NULL;
+	free(thisSimLoc->probeBufLoc);
+	thisSimLoc->probeBufLoc = NULL;
+	if (thisSimLoc->probeFile != NULL)
+		fclose(thisSimLoc->probeFile);
+	thisSimLoc->probeFile = NULL;
+	thisSimLoc->nProbes = 0;
+	stopTaskModeLoc(thisSimLoc);
 	return 0;
 };
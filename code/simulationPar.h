@@ -1,9 +1,59 @@
 #ifndef __SIMULATIONPAR_H__
 #define __SIMULATIONPAR_H__
+#include <stdio.h>
+#include "precision.h"
+#include <mpi.h>
 
 // forward declarations of structs a sim will have pointers to
 typedef struct materialLoc_struct materialLoc;
 typedef struct checkPtTimeLoc_struct checkPtTimeLoc;
+typedef struct taskPool_struct taskPool;
+
+// choices of time integrator used by oneStepLoc and runSimLoc
+#define INTEGRATOR_EULER 0 // forward Euler, one stencil sweep per step, needs dt < dtMax
+#define INTEGRATOR_RKL2 1 // Runge-Kutta-Legendre (RKL2) super time stepping, s stencil sweeps per step allow dt up to dtMax*(s^2+s-2)/4
+
+// choices of steady state monitor used by runSimLoc
+#define MONITOR_NONE 0 // always take all nSteps steps
+#define MONITOR_MAX 1 // change in one step is the largest |u_new - u_prior| over all points
+#define MONITOR_L2 2 // change in one step is sqrt of the sum of (u_new - u_prior)^2 over all points
+
+// choices of sweep for second order forward Euler without tiling
+#define KERNEL_POINT 0 // one loop over every point, checking each for the boundary
+#define KERNEL_ROWS 1 // boundary rows and columns set apart, so the interior of each row is a branch free loop
+
+// longest host description and line of the autotune cache
+#define AUTOTUNE_KEY_LEN 256
+
+// what each task of a step in task mode does (the label of its timing)
+#define STEP_TASK_POST 0 // post the halo receives and sends
+#define STEP_TASK_RECV 1 // wait for a ghost row to arrive
+#define STEP_TASK_SEND 2 // wait for an edge row to be sent
+#define STEP_TASK_COMPUTE 3 // new state of one tile
+#define STEP_TASK_COPY 4 // copy one tile's new state over its prior state
+#define STEP_TASK_SNAP 5 // copy one tile's new state into the snapshot due after this step
+#define STEP_TASK_NAME_LEN 256 // longest name of a task trace file
+
+// fraction of the way rebalanceLoc moves the row boundaries towards the split that equalizes the measured costs
+#define BALANCE_RELAX 0.5
+
+// why runSimLoc stopped
+#define STOP_NSTEPS 0 // took all nSteps steps
+#define STOP_CONVERGED 1 // the change in one step fell below monitorTol
+
+// how renderFrameLoc picks the log10 temperature range its colour map spans
+#define RENDER_SCALE_FIXED 0 // one range for every frame, taken from the state and boundary when setRenderLoc is called
+#define RENDER_SCALE_FRAME 1 // each frame's own range
+#define RENDER_NAME_LEN 256 // longest frame file name prefix, plus 8 (frame names get up to 16 more characters)
+#define RENDER_FLOOR 1e-30 // temperatures are clamped up to this before taking log10
+
+// one rank's (or, after the reduction, all ranks') part of the in situ statistics of a state
+typedef struct statsPartial_struct{
+	double sum; // sum of the temperatures
+	double min; // lowest temperature
+	double max; // highest temperature
+	long maxIdx; // global index (row * Nx + column) of the hottest point (the lowest one if tied)
+} statsPartial;
 
 typedef struct simLoc_struct{	
 	// We'll always be looking at du/dt = alpha * (d^2u/dx^2 + d^2u/dy^2)
@@ -15,14 +65,131 @@ typedef struct simLoc_struct{
 	materialLoc *thisMaterialLoc; // a pointer to the local subset of a material that already has its parameters filled in
 	
 	// These get updated at each time step of the simulation
+	// (all temperature arrays hold real_t, the storage type chosen in precision.h)
 	unsigned int currentTimeIdx; // integer saying which time step the simulation is on for currentState (start at 0, then 1, then 2, ... and corresponding times in seconds are 0, dt, 2*dt, etc...)
-	float *currentStateLoc; // a pointer to the current local temperature matrix (thisMaterial.Nx x thisMaterial.NyPadded points) 	
-	float *priorStateLoc; // a pointer to the prior local temperature matrix (thisMaterial.Nx x thisMaterial.NyPadded points)
+	real_t *currentStateLoc; // a pointer to the current local temperature matrix (thisMaterial.Nx x thisMaterial.NyPadded points) 	
+	real_t *priorStateLoc; // a pointer to the prior local temperature matrix (thisMaterial.Nx x thisMaterial.NyPadded points)
 
 	// initial conditions and boundary value
-	float *initStateLoc; // initial temperature state in this local region (thisMaterial.Nx x thisMaterial.NyLocal points)
+	real_t *initStateLoc; // initial temperature state in this local region (thisMaterial.Nx x thisMaterial.NyLocal points)
 	float bdryVal; // a single float that will be the constant temperature value around all boundary points (all edges of the global material, and at least the 0th and last columns of this local submaterial)
 
+	// spatial discretization (second order unless setStencilOrderLoc is called)
+	int stencilOrder; // 2 for the 5 point stencil, 4 for the 9 point cross (second order closure next to the edges)
+
+	// time integrator (forward Euler unless setIntegratorLoc is called)
+	int integrator; // INTEGRATOR_EULER or INTEGRATOR_RKL2
+	int nStages; // number of stages (stencil sweeps and ghost exchanges) per time step
+	real_t *rklTauMY0Loc; // dt * alpha * L applied to the state at the start of an RKL2 step (padded like priorStateLoc)
+	real_t *rklStageALoc; // padded RKL2 stage states
+	real_t *rklStageBLoc;
+
+	// low memory mode (off unless setLowMemoryLoc is called): steps update priorStateLoc in place, so
+	// currentStateLoc and initStateLoc are freed
+	int lowMemory; // 1 if on
+	real_t *rowBufLoc; // old values of the last two rows updated (2 x Nx)
+
+	// sweep of second order forward Euler without tiling (KERNEL_POINT unless setKernelLoc or autotuneLoc is called)
+	int kernelVariant; // KERNEL_POINT or KERNEL_ROWS (both give exactly the same states)
+
+	// steady state monitor (off unless setMonitorLoc is called)
+	int monitorNorm; // MONITOR_NONE, MONITOR_MAX or MONITOR_L2
+	float monitorTol; // runSimLoc stops once the change in one step is below this
+	int monitorEvery; // runSimLoc checks the change every this many steps
+	float stepChangeLoc; // this rank's part of the change in the last step (largest change, or sum of squares for MONITOR_L2)
+	int stopReason; // STOP_NSTEPS or STOP_CONVERGED, set by runSimLoc
+	unsigned int stopTimeIdx; // time step runSimLoc stopped at
+	float stopChange; // change in the step the stop was decided on (-1 if never checked)
+
+	// quiescent tile skipping for forward Euler (off unless setTilingLoc is called). The local strip is cut
+	// into tiles, and a tile is only updated if it, a tile next to it, or the ghost rows it touches changed
+	// in the last step; otherwise its new state is exactly its prior state, so nothing is lost by skipping it.
+	int tileRows; // rows per tile (0 if tiling is off)
+	int tileCols; // columns per tile
+	int nTilesY; // number of tiles down the local strip
+	int nTilesX; // number of tiles across
+	unsigned char *tileChanged; // nonzero for tiles that changed in the last step (nTilesY x nTilesX)
+	unsigned char *tileChangedNext; // filled in during a step
+	real_t *ghostPrevLoc; // ghost rows of priorStateLoc in the last step (2 x nPadRows x Nx points)
+	int activityValid; // 0 until a step has filled in tileChanged (until then every tile is updated)
+	long tilesUpdated; // number of tile updates done so far
+	long tilesSkipped; // number of tile updates skipped so far
+
+	// what autotuneLoc chose
+	int tunedFromCache; // 1 if the configuration came from the cache file, 0 if it was timed (-1 if never tuned)
+	double tunedStepTime; // slowest rank's seconds per step of the chosen configuration in the trials (0 if from the cache)
+
+	// dynamic load balancing (off unless setBalanceLoc is called). Each rank's stencil sweeps are timed, and
+	// every balanceEvery steps runSimLoc moves rows between ranks so each one's predicted time is the same.
+	int balanceEvery; // check the balance every this many steps (0 if off)
+	float balanceTol; // only move rows if the slowest rank took more than (1 + balanceTol) times the average
+	double computeTimeLoc; // seconds this rank spent in stencil sweeps since the last check (CPU time, or tile task time in task mode)
+	int nBalanceChecks; // number of times the balance was checked
+	int nRebalances; // number of times rows were moved
+	double rebalanceTime; // wall seconds spent checking the balance and moving rows
+	float lastImbalance; // slowest rank's compute time over the average in the last window checked
+	float predictedImbalance; // the same, predicted for the rows after the last check
+
+	// in situ statistics (off unless setStatsLoc is called). Every statsEvery steps the sweep accumulates this
+	// rank's partial statistics of the new state while it copies it over (tiling does a separate pass since
+	// it skips points), and runSimLoc combines them with one reduction and appends a record on rank 0.
+	int statsEvery; // record the statistics every this many steps (0 if off)
+	int statsDue; // set by runSimLoc when the next step's sweep should accumulate statsPartialLoc
+	int statsFilled; // set by the sweep once statsPartialLoc holds the new state's statistics
+	statsPartial statsPartialLoc; // this rank's partial statistics of the last accumulated state
+	int nStats; // number of records (rank 0 only)
+	int statsCapacity; // length of the record arrays
+	float *statsTimes; // simulated seconds of each record
+	float *statsMin; // lowest temperature of each record
+	float *statsMax; // highest temperature of each record
+	double *statsMean; // mean temperature of each record
+	double *statsEnergy; // thermal energy per unit volumetric heat capacity (sum of temperature * dx * dy)
+	int *statsHotCol; // column of the hottest point of each record
+	int *statsHotRow; // row of the hottest point of each record
+	MPI_Datatype statsTypeLoc; // statsPartial as an MPI type, and the operation combining two of them
+	MPI_Op statsOpLoc; // (both created by the first recordStatsLoc, freed by cleanupSimLoc)
+
+	// in situ rendering (off unless setRenderLoc is called). Every renderEvery steps each rank colour maps the
+	// log10 temperature of its own rows, and the ranks write their rows of one PPM image together.
+	int renderEvery; // render a frame every this many steps (0 if off)
+	int renderScale; // RENDER_SCALE_FIXED or RENDER_SCALE_FRAME
+	float renderLogMin; // log10 temperature at the bottom of the colour map (for RENDER_SCALE_FIXED)
+	float renderLogMax; // log10 temperature at the top of the colour map
+	int nFrames; // number of frames written so far
+	char renderPrefix[RENDER_NAME_LEN]; // frames are written to renderPrefix000.ppm, renderPrefix001.ppm, ...
+
+	// point probes (off unless setProbesLoc is called). Every step each rank adds its rows' share of each
+	// probe's value to a buffer, and every probeFlushEvery samples one reduction sums the shares on rank 0,
+	// which appends them to the probe file. A probe's weights can span two rows on different ranks, so
+	// summing shares needs no ghost rows and keeps working when rebalanceLoc moves rows.
+	int nProbes; // number of probes (0 if off)
+	int *probeCol; // column of each probe's lower left grid point
+	int *probeRow; // global row of each probe's lower left grid point
+	float *probeWX; // weight of the next column over (0 without interpolation)
+	float *probeWY; // weight of the next row down (0 without interpolation)
+	int probeFlushEvery; // samples buffered between flushes
+	int nProbeSamples; // samples in the buffer
+	float *probeTimes; // simulated seconds of each buffered sample
+	double *probeBufLoc; // this rank's share of each buffered sample (probeFlushEvery x nProbes)
+	FILE *probeFile; // probe time series, open on rank 0
+
+	// task mode (off unless setTaskModeLoc is called). Each step is a graph of tasks run by a pool of threads:
+	// the halo exchange, and the update, copy over and snapshot copy of each tile of taskRows rows, so the
+	// tiles that don't need a ghost row go ahead while the halos are in flight.
+	taskPool *taskPoolLoc; // the threads (NULL if off)
+	int taskRows; // rows of each tile
+	void *taskArgsLoc; // what each task of a step is run with (grown as needed)
+	int taskArgsCapacity;
+	acc_t *taskChangeLoc; // each tile's share of the steady state monitor
+	MPI_Request taskRequests[4]; // receive from above, send up, receive from below, send down
+	checkPtTimeLoc *snapDueLoc; // runSimLoc sets it when a snapshot is due after this step; a step that takes it clears it
+	FILE *taskTraceFile; // timing of every task of every step on this rank (NULL if not traced)
+	long taskSteps; // steps taken in task mode
+	double taskWallLoc; // seconds those steps took
+	double taskBusyLoc; // seconds all threads spent in update, copy and snapshot tasks
+	double taskFlightLoc; // seconds from posting the halo exchange until both ghost rows had arrived
+	double taskOverlapLoc; // thread-seconds of update tasks run while a ghost row was in flight (summed over threads)
+
 } simLoc;
 
 // Calculate the maximum stable time step allowed by the CFL condition
@@ -35,21 +202,140 @@ float calcMaxTimeStepLoc(simLoc *thisSimLoc);
 // Note: initializing the simulation does not also initialize the material. Do that separately.
 int initSimLoc(simLoc *thisSimLoc, float timeStep, float *valsForInitStateGlobal, float bdryVal, materialLoc *thisMaterialLoc);
 
+// Fills rows startRow .. startRow+nRows-1 of the global initial state into rowsLoc (nRows x Nx, row major)
+typedef void (*initRowsFunc)(float *rowsLoc, unsigned int Nx, unsigned int startRow, unsigned int nRows, void *ctx);
+
+// Same as initSimLoc, but fillRows is asked for this rank's rows only (ctx is passed through to it),
+// so no rank needs memory or time for the whole Nx x NyTotal initial state.
+int initSimLocFill(simLoc *thisSimLoc, float timeStep, initRowsFunc fillRows, void *ctx, float bdryVal, materialLoc *thisMaterialLoc);
+
+// Same as initSimLoc, but the initial state comes from filename: Nx x NyTotal raw native float32 values,
+// row major with no header. Every rank reads only its own rows, in one collective MPI-IO call.
+int initSimLocFile(simLoc *thisSimLoc, float timeStep, const char *filename, float bdryVal, materialLoc *thisMaterialLoc);
+
 // Share ghost region information (must be done before each step of the simulation). Send first
 // row of unpadded part of local state to previous process (except rank 0), and send last row
 // of unpadded part of local state to next process (except last rank). 
 int exchangeGhostRegions(simLoc *thisSimLoc);
 
+// Same exchange as exchangeGhostRegions, but for any padded array with the layout of priorStateLoc
+// (thisMaterial.Nx x thisMaterial.NyPadded points) instead of priorStateLoc itself.
+int exchangeGhostRegionsArray(simLoc *thisSimLoc, real_t *paddedArr);
+
+// Choose the spatial order of the stencil, 2 (5 point) or 4 (9 point cross: -1 16 -30 16 -1 over 12 h^2
+// in x and y, falling back to the second order stencil on the points next to the edges). Order 4 needs
+// a material with nPadRows >= 2 and can't be combined with tiling; it works with forward Euler and RKL2.
+// dtMax is recomputed (it's 3/4 of the second order one), and with RKL2 so is the number of stages. The
+// implicit, multigrid, spectral and AMR modules only support order 2 and refuse to set up otherwise.
+int setStencilOrderLoc(simLoc *thisSimLoc, int stencilOrder);
+
+// Choose the time integrator and time step. For INTEGRATOR_RKL2 the number of stages is the
+// smallest that keeps timeStep stable, so timeStep may be many times dtMax.
+int setIntegratorLoc(simLoc *thisSimLoc, int integrator, float timeStep);
+
+// Turn on the steady state monitor: every monitorEvery steps runSimLoc starts a nonblocking reduction of
+// the change in that step (measured during the stencil sweep) and checks the one started monitorEvery steps
+// earlier, stopping once it is below tol. monitorNorm = MONITOR_NONE turns the monitor off again.
+int setMonitorLoc(simLoc *thisSimLoc, int monitorNorm, float tol, int monitorEvery);
+
+// Cut the local strip into tileRows x tileCols tiles and skip the forward Euler update of tiles where
+// nothing can change (tileRows = 0 turns tiling off). Results are identical to the full sweep.
+int setTilingLoc(simLoc *thisSimLoc, int tileRows, int tileCols);
+
+// Mark every tile as changed, so the next step updates all of them. Call this after writing
+// priorStateLoc directly (e.g. restarting from another state) while tiling is on.
+int resetActivityLoc(simLoc *thisSimLoc);
+
+// Choose the sweep of second order forward Euler steps without tiling (KERNEL_POINT or KERNEL_ROWS)
+int setKernelLoc(simLoc *thisSimLoc, int kernelVariant);
+
+// Pick the fastest configuration of the forward Euler step for this strip: the kernel variant, or tiling and
+// its tile size. Each candidate runs nTrialSteps timed steps (halo exchanges included) from the current state,
+// which is put back afterwards, and the one whose slowest rank was fastest is chosen, so every rank makes the
+// same choice. If cacheFilename isn't NULL, rank 0 looks for a choice made before for this host type (CPU model
+// and core count), grid and number of ranks, and appends new choices to it, so later runs skip the trials.
+// Every candidate gives exactly the same states. (Only for second order forward Euler.)
+int autotuneLoc(simLoc *thisSimLoc, int nTrialSteps, const char *cacheFilename);
+
+// Turn on task mode for second order forward Euler steps: each step is split into tiles of taskRows rows, and
+// the halo exchange, the update of each tile, its copy over the prior state, and its copy into a snapshot due
+// after the step are tasks run by nThreads threads (the calling one included) that steal work from each other.
+// Only the calling thread makes MPI calls, so MPI must be initialized with at least MPI_THREAD_FUNNELED. If
+// tracePrefix isn't NULL, every rank appends the timing of every task to tracePrefix.rank.csv.
+// (nThreads = 0 turns it off again.) States are exactly those of the other sweeps.
+int setTaskModeLoc(simLoc *thisSimLoc, int nThreads, int taskRows, const char *tracePrefix);
+
+// Turn on (or off) low memory mode for second order forward Euler steps: each step updates priorStateLoc in
+// place, keeping the old values of the rows the stencil still needs in a rolling buffer of two rows, so
+// currentStateLoc and initStateLoc (only used at setup) are freed and the state takes about a third of the
+// memory. States are exactly those of the other sweeps. initStateLoc isn't brought back by turning it off,
+// and tiling, task mode, load balancing and the other integrators and stencils are refused while it's on.
+// The implicit, multigrid, spectral and AMR modules refuse to set up on a simulation in low memory mode,
+// and it mustn't be turned on while one of them is still using the simulation.
+int setLowMemoryLoc(simLoc *thisSimLoc, int lowMemory);
+
+// Turn on dynamic load balancing: every balanceEvery steps runSimLoc calls rebalanceLoc
+// (balanceEvery = 0 turns it off again)
+int setBalanceLoc(simLoc *thisSimLoc, int balanceEvery, float tol);
+
+// Compare the time every rank spent in its stencil sweeps since the last call. If the slowest rank took more
+// than (1 + balanceTol) times the average, give each rank a number of rows proportional to its measured rows
+// per second, and move rows between ranks with point to point messages. The material's startYId, NyLocal and
+// NyPadded, the simulation's arrays, and the snapshots of theseTimesLoc (if not NULL) are all updated in place,
+// so the material must not be shared with another simulation. Works with forward Euler, RKL2 and tiling.
+int rebalanceLoc(simLoc *thisSimLoc, checkPtTimeLoc *theseTimesLoc);
+
+// Turn on in situ statistics every statsEvery steps of runSimLoc (statsEvery = 0 turns them off again). The
+// initial state is always recorded. The full field snapshots can then be turned down to just the first one by
+// running with stepsPerCheckPt >= nSteps.
+int setStatsLoc(simLoc *thisSimLoc, int statsEvery);
+
+// Combine the ranks' partial statistics of the current state (computing them first if the last sweep didn't)
+// with one reduction, and append the record on rank 0
+int recordStatsLoc(simLoc *thisSimLoc);
+
+// Have rank 0 write the statistics records to filename, one line per record:
+// time, min, max, mean, energy, hotCol, hotRow
+int writeStatsToFileLoc(simLoc *thisSimLoc, const char *filename);
+
+// Turn on in situ rendering every renderEvery steps of runSimLoc (renderEvery = 0 turns it off again), of the
+// initial state and then every renderEvery steps, to prefix000.ppm, prefix001.ppm, ... Frames show log10 of the
+// temperature on the inferno colour map with row 0 at the top, like test/readPlotSnaps.py. With
+// RENDER_SCALE_FIXED the colour map spans the current state and boundary value (which, with no sources, bound
+// every later state too); with RENDER_SCALE_FRAME each frame spans its own range.
+int setRenderLoc(simLoc *thisSimLoc, int renderEvery, const char *prefix, int renderScale);
+
+// Colour map this rank's rows of the current state and write them into the next frame (one reduction for the
+// range with RENDER_SCALE_FRAME, then a collective write)
+int renderFrameLoc(simLoc *thisSimLoc);
+
+// Turn on point probes at the nProbes positions (probeX[i], probeY[i]) (in the same units as dx and dy, with
+// grid point (col, row) at (col*dx, row*dy)). With interpolate 0 a probe reads its nearest grid point, otherwise
+// it interpolates bilinearly between the 4 around it. runSimLoc samples every probe at the initial state and
+// after every step, buffering flushEvery samples at a time, and rank 0 writes them to filename, one line per
+// sample:
+// time, value, at, each, probe
+// after a header line naming each probe's position.
+int setProbesLoc(simLoc *thisSimLoc, int nProbes, const float *probeX, const float *probeY, int interpolate, const char *filename, int flushEvery);
+
+// Add this rank's share of every probe's value in the current state to the buffer (flushing it first if it's full)
+int sampleProbesLoc(simLoc *thisSimLoc);
+
+// Sum the buffered shares onto rank 0 with one reduction, and append them to the probe file
+int flushProbesLoc(simLoc *thisSimLoc);
+
 // Update ghost regions and move the simulation forward by one time step in this local region 
 int oneStepLoc(simLoc *thisSimLoc);
 
 // Simulate nSteps time steps and record snapshots of the whole temperature field
 // every stepsPerCheckPt time steps. runSimLoc does do the initialization of the checkPtTimeLoc
-// struct automatically at the beginning of the simulation. 
+// struct automatically at the beginning of the simulation. With the steady state monitor on, the run may
+// stop early: then the last state is recorded as a final snapshot, theseTimesLoc->nSnaps is cut down to
+// the snapshots recorded, and thisSimLoc->stopReason says STOP_CONVERGED.
 // Note: running the simulation doesn't also initialize the sim or the material. Do them separately.
 int runSimLoc(simLoc *thisSimLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc);
 
-// deallocate memory associated with currentStateLoc, initStateLoc, priorStateLoc
+// deallocate memory associated with currentStateLoc, initStateLoc, priorStateLoc, the RKL2 stages and tiling
 int cleanupSimLoc(simLoc *thisSimLoc);
 
 #endif
@@ -21,6 +21,13 @@ float calcMaxTimeStep(sim *thisSim){
 	return dtMax;
 };
 
+// d^2u/dx^2 + d^2u/dy^2 terms (times alpha) of the 5 point stencil at interior point idx of state
+static inline float stencilRate(const float *state, int idx, int nCols, float alpha, float dx, float dy){
+	float dx2Term = (state[idx-1] - 2*state[idx] + state[idx+1]) * alpha / (dx*dx);
+	float dy2Term = (state[idx-nCols] - 2*state[idx] + state[idx+nCols]) * alpha / (dy*dy);
+	return dx2Term + dy2Term;
+};
+
 // Initialize the initial state (temperature matrix at T = 0, copied from valsForInitState) and current state of the system (matrix of temperature values).
 // Note: initializing the simulation does not also initialize the material. Do that separately before calling this, and make sure your alpha matrix is filled in (for max time step calculation).
 int initSim(sim *thisSim, float timeStep, float *valsForInitState, float bdryVal, material *thisMaterial){
@@ -61,13 +68,135 @@ int initSim(sim *thisSim, float timeStep, float *valsForInitState, float bdryVal
 	// create state for current state
 	thisSim->currentState = malloc(nPts*sizeof(float));
 
+	// forward Euler until told otherwise
+	thisSim->integrator = INTEGRATOR_EULER;
+	thisSim->nStages = 1;
+	thisSim->rklTauMY0 = NULL;
+	thisSim->rklStageA = NULL;
+	thisSim->rklStageB = NULL;
+
 	if((thisSim->priorState == NULL) || (thisSim->currentState == NULL)) flag = 1;
 	// return a 0 if all was ok, but a 1 if there were issues
 	return flag;
 };
 
+// Choose the time integrator and time step. For INTEGRATOR_RKL2 the number of stages is the
+// smallest that keeps timeStep stable, so timeStep may be many times dtMax.
+int setIntegrator(sim *thisSim, int integrator, float timeStep){
+	int flag = 0;
+	thisSim->integrator = integrator;
+	thisSim->dt = timeStep;
+	thisSim->nStages = 1;
+	if(integrator == INTEGRATOR_EULER){
+		if(timeStep >= thisSim->dtMax){
+			printf("WARNING: In setIntegrator(), requested time step exceeds stability limit. Unphysical behavior is likely. \n");
+			flag = 1;
+		}
+		return flag;
+	}
+
+	// RKL2 with s stages is stable for dt <= dtMax*(s^2+s-2)/4 (and needs at least 2 stages)
+	int s = 2;
+	while(thisSim->dtMax*(s*s+s-2)/4.0 < timeStep) ++s;
+	thisSim->nStages = s;
+
+	// work arrays for the stages (allocated once)
+	int nPts = (thisSim->thisMaterial)->Nx * (thisSim->thisMaterial)->Ny;
+	if(thisSim->rklTauMY0 == NULL) thisSim->rklTauMY0 = malloc(nPts*sizeof(float));
+	if(thisSim->rklStageA == NULL) thisSim->rklStageA = malloc(nPts*sizeof(float));
+	if(thisSim->rklStageB == NULL) thisSim->rklStageB = malloc(nPts*sizeof(float));
+	if((thisSim->rklTauMY0 == NULL) || (thisSim->rklStageA == NULL) || (thisSim->rklStageB == NULL)){
+		printf("WARNING: In setIntegrator(), issue allocating RKL2 stage arrays \n");
+		flag = 1;
+	}
+	return flag;
+};
+
+// One RKL2 super time step (Meyer, Balsara & Aslam 2014) made of nStages stencil sweeps:
+//   Y_0 = u, Y_1 = Y_0 + mu~_1 tau M(Y_0),
+//   Y_j = mu_j Y_(j-1) + nu_j Y_(j-2) + (1 - mu_j - nu_j) Y_0 + mu~_j tau M(Y_(j-1)) + gamma~_j tau M(Y_0),
+// and the new state is Y_s, where M is alpha times the 5 point Laplacian and tau = dt.
+static int oneStepRKL2(sim *thisSim){
+	int nCols  = (thisSim->thisMaterial)->Nx;
+	int nRows  = (thisSim->thisMaterial)->Ny;
+	float dx = (thisSim->thisMaterial)->dx;
+	float dy = (thisSim->thisMaterial)->dy;
+	float alpha = (thisSim->thisMaterial)->alpha;
+	float tau = thisSim->dt;
+	int s = thisSim->nStages;
+	double w1 = 4.0/(s*s + s - 2);
+	float *y0 = thisSim->priorState;
+	float *tauMY0 = thisSim->rklTauMY0;
+	// rotate the stage states through these three arrays
+	float *yPrev2 = thisSim->rklStageA;
+	float *yPrev = thisSim->rklStageB;
+	float *yNew = thisSim->currentState;
+	if((tauMY0 == NULL) || (yPrev2 == NULL) || (yPrev == NULL) || (yNew == NULL) || (y0 == NULL)){
+		printf("WARNING: null pointer for state encountered in oneStep() \n");
+		return 1;
+	}
+	int row, col, j;
+
+	// b_j = (j^2 + j - 2)/(2j(j+1)) for j >= 2 and b_0 = b_1 = 1/3
+	double bPrev2 = 1.0/3.0, bPrev = 1.0/3.0, b;
+
+	// stage 1
+	for(row=0; row<nRows; ++row){
+		for(col=0; col<nCols; ++col){
+			int idx = (row*nCols) + col;
+			if((0 < row) && (row < nRows-1) && (0 < col) && (col < nCols-1)){
+				tauMY0[idx] = tau * stencilRate(y0, idx, nCols, alpha, dx, dy);
+				yPrev[idx] = y0[idx] + (float)(w1/3.0) * tauMY0[idx];
+			}
+			else{
+				tauMY0[idx] = 0.0;
+				yPrev[idx] = thisSim->bdryVal;
+			}
+			yPrev2[idx] = y0[idx];
+		}
+	}
+
+	// stages 2..s
+	for(j=2; j<=s; ++j){
+		b = (j*j + j - 2.0)/(2.0*j*(j+1));
+		double mu = (2.0*j - 1.0)/j * b/bPrev;
+		double nu = -(j - 1.0)/j * b/bPrev2;
+		double muTilde = mu*w1;
+		double gammaTilde = -(1.0 - bPrev)*muTilde;
+		float fMu = mu, fNu = nu, fRest = 1.0 - mu - nu, fMuTilde = muTilde, fGammaTilde = gammaTilde;
+		for(row=0; row<nRows; ++row){
+			for(col=0; col<nCols; ++col){
+				int idx = (row*nCols) + col;
+				if((0 < row) && (row < nRows-1) && (0 < col) && (col < nCols-1)){
+					float tauMY = tau * stencilRate(yPrev, idx, nCols, alpha, dx, dy);
+					yNew[idx] = fMu*yPrev[idx] + fNu*yPrev2[idx] + fRest*y0[idx] + fMuTilde*tauMY + fGammaTilde*tauMY0[idx];
+				}
+				else{
+					yNew[idx] = thisSim->bdryVal;
+				}
+			}
+		}
+		float *tmp = yPrev2;
+		yPrev2 = yPrev;
+		yPrev = yNew;
+		yNew = tmp;
+		bPrev2 = bPrev;
+		bPrev = b;
+	}
+
+	// the last stage is the new state
+	thisSim->currentTimeIdx = thisSim->currentTimeIdx + 1;
+	for(row=0; row<nRows*nCols; ++row){
+		y0[row] = yPrev[row];
+		thisSim->currentState[row] = yPrev[row];
+	}
+	return 0;
+};
+
 // Move the simulation forward by one time step
 int oneStep(sim *thisSim){
+	if(thisSim->integrator == INTEGRATOR_RKL2) return oneStepRKL2(thisSim);
+
 	// grab the prior state and current (i.e. to update) state
 	float *newState = thisSim->currentState;
 	float *priorState = thisSim->priorState; 
@@ -92,15 +221,8 @@ int oneStep(sim *thisSim){
 			// case for all points not on the boundaries
 			if((0 < row) && (row < nRows-1) && (0 < col) && (col < nCols-1)){
 				int idx = (row*nCols) + col; // index of current location
-				// calculate d^2/dx^2 term
-				int leftIdx = (row*nCols) + (col-1); // index of point to left
-				int rightIdx = (row*nCols) + (col+1); // index of point to right
-				float dx2Term = (priorState[leftIdx] - 2*priorState[idx] + priorState[rightIdx]) * alpha / (dx*dx);
-				// calculate d^2/dy^2 term
-				int aboveIdx = ((row-1)*nCols) + col; // index of point on row above
-				int belowIdx = ((row+1)*nCols) + col; // index of point on row below
-				float dy2Term = (priorState[aboveIdx] - 2*priorState[idx] + priorState[belowIdx]) * alpha / (dy*dy);
-				newState[idx] = priorState[idx] + thisSim->dt * (dx2Term + dy2Term);
+				// d^2/dx^2 and d^2/dy^2 terms from the points left, right, above and below
+				newState[idx] = priorState[idx] + thisSim->dt * stencilRate(priorState, idx, nCols, alpha, dx, dy);
 			}
 			else{ // case for all points on the boundaries
 				int idx = (row*nCols) + col; // index of current location
@@ -162,5 +284,11 @@ int cleanupSim(sim *thisSim){
 	thisSim->priorState = NULL;
 	free(thisSim->currentState);
 	thisSim->currentState = NULL;
+	free(thisSim->rklTauMY0);
+	thisSim->rklTauMY0 = NULL;
+	free(thisSim->rklStageA);
+	thisSim->rklStageA = NULL;
+	free(thisSim->rklStageB);
+	thisSim->rklStageB = NULL;
 	return 0;
 };
@@ -5,6 +5,10 @@
 typedef struct material_struct material;
 typedef struct checkPtTime_struct checkPtTime;
 
+// choices of time integrator used by oneStep and runSim
+#define INTEGRATOR_EULER 0 // forward Euler, one stencil sweep per step, needs dt < dtMax
+#define INTEGRATOR_RKL2 1 // Runge-Kutta-Legendre (RKL2) super time stepping, s stencil sweeps per step allow dt up to dtMax*(s^2+s-2)/4
+
 typedef struct sim_struct{	
 	// We'll always be looking at du/dt = alpha * (d^2u/dx^2 + d^2u/dy^2)
 	// so here are some data specific to the material for that simulation. 
@@ -23,6 +27,13 @@ typedef struct sim_struct{
 	float *initState; // initial temperature state
 	float bdryVal; // a single float that will be the constant temperature value around all boundary points (all edges of the material)
 
+	// time integrator (forward Euler unless setIntegrator is called)
+	int integrator; // INTEGRATOR_EULER or INTEGRATOR_RKL2
+	int nStages; // number of stages (stencil sweeps) per time step
+	float *rklTauMY0; // dt * alpha * L applied to the state at the start of an RKL2 step
+	float *rklStageA; // RKL2 stage states (thisMaterial.Nx x thisMaterial.Ny points each)
+	float *rklStageB;
+
 } sim;
 
 // Calculate the maximum stable time step allowed by the CFL condition
@@ -32,6 +43,10 @@ float calcMaxTimeStep(sim *thisSim);
 // Note: initializing the simulation does not also initialize the material. Do that separately.
 int initSim(sim *thisSim, float timeStep, float *valsForInitState, float bdryVal, material *thisMaterial);
 
+// Choose the time integrator and time step. For INTEGRATOR_RKL2 the number of stages is the
+// smallest that keeps timeStep stable, so timeStep may be many times dtMax.
+int setIntegrator(sim *thisSim, int integrator, float timeStep);
+
 // Move the simulation forward by one time step
 int oneStep(sim *thisSim);
 
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "spectralPar.h"
+#include "simulationPar.h"
+#include "materialPar.h"
+#include "checkPtPar.h"
+#include <mpi.h>
+
+// move this rank's rows (nIntRowsLoc x nxInt) into its x modes with all rows (nModesLoc x nyInt)
+static void rowsToModesLoc(spectralLoc *thisSpectralLoc)
+{
+	MPI_Comm comm = ((thisSpectralLoc->thisSimLoc)->thisMaterialLoc)->comm;
+	int size;
+	MPI_Comm_size(comm, &size);
+	int *sendCounts = malloc(size * sizeof(int));
+	int *sendDispls = malloc(size * sizeof(int));
+	int *recvCounts = malloc(size * sizeof(int));
+	int *recvDispls = malloc(size * sizeof(int));
+	int nxInt = thisSpectralLoc->nxInt;
+	int nyInt = thisSpectralLoc->nyInt;
+	int nRows = thisSpectralLoc->nIntRowsLoc;
+	int nModes = thisSpectralLoc->nModesLoc;
+	int r, j, c, sendCounter = 0, recvCounter = 0;
+	for (r = 0; r < size; ++r)
+	{
+		// block going to rank r is my rows restricted to r's modes, row by row
+		sendCounts[r] = nRows * thisSpectralLoc->modeCounts[r];
+		sendDispls[r] = sendCounter;
+		for (j = 0; j < nRows; ++j)
+			for (c = 0; c < thisSpectralLoc->modeCounts[r]; ++c)
+				thisSpectralLoc->sendBuf[sendCounter + j * thisSpectralLoc->modeCounts[r] + c] = thisSpectralLoc->rowsLoc[j * nxInt + thisSpectralLoc->modeStarts[r] + c];
+		sendCounter += sendCounts[r];
+		recvCounts[r] = thisSpectralLoc->rowCounts[r] * nModes;
+		recvDispls[r] = recvCounter;
+		recvCounter += recvCounts[r];
+	}
+	MPI_Alltoallv(thisSpectralLoc->sendBuf, sendCounts, sendDispls, MPI_DOUBLE, thisSpectralLoc->recvBuf, recvCounts, recvDispls, MPI_DOUBLE, comm);
+	for (r = 0; r < size; ++r)
+		for (j = 0; j < thisSpectralLoc->rowCounts[r]; ++j)
+			for (c = 0; c < nModes; ++c)
+				thisSpectralLoc->modesLoc[c * nyInt + thisSpectralLoc->rowStarts[r] + j] = thisSpectralLoc->recvBuf[recvDispls[r] + j * nModes + c];
+	free(sendCounts);
+	free(sendDispls);
+	free(recvCounts);
+	free(recvDispls);
+};
+
+// inverse of rowsToModesLoc
+static void modesToRowsLoc(spectralLoc *thisSpectralLoc)
+{
+	MPI_Comm comm = ((thisSpectralLoc->thisSimLoc)->thisMaterialLoc)->comm;
+	int size;
+	MPI_Comm_size(comm, &size);
+	int *sendCounts = malloc(size * sizeof(int));
+	int *sendDispls = malloc(size * sizeof(int));
+	int *recvCounts = malloc(size * sizeof(int));
+	int *recvDispls = malloc(size * sizeof(int));
+	int nxInt = thisSpectralLoc->nxInt;
+	int nyInt = thisSpectralLoc->nyInt;
+	int nRows = thisSpectralLoc->nIntRowsLoc;
+	int nModes = thisSpectralLoc->nModesLoc;
+	int r, j, c, sendCounter = 0, recvCounter = 0;
+	for (r = 0; r < size; ++r)
+	{
+		// block going to rank r is my modes restricted to r's rows, row by row
+		sendCounts[r] = thisSpectralLoc->rowCounts[r] * nModes;
+		sendDispls[r] = sendCounter;
+		for (j = 0; j < thisSpectralLoc->rowCounts[r]; ++j)
+			for (c = 0; c < nModes; ++c)
+				thisSpectralLoc->sendBuf[sendCounter + j * nModes + c] = thisSpectralLoc->modesLoc[c * nyInt + thisSpectralLoc->rowStarts[r] + j];
+		sendCounter += sendCounts[r];
+		recvCounts[r] = nRows * thisSpectralLoc->modeCounts[r];
+		recvDispls[r] = recvCounter;
+		recvCounter += recvCounts[r];
+	}
+	MPI_Alltoallv(thisSpectralLoc->sendBuf, sendCounts, sendDispls, MPI_DOUBLE, thisSpectralLoc->recvBuf, recvCounts, recvDispls, MPI_DOUBLE, comm);
+	for (r = 0; r < size; ++r)
+		for (j = 0; j < nRows; ++j)
+			for (c = 0; c < thisSpectralLoc->modeCounts[r]; ++c)
+				thisSpectralLoc->rowsLoc[j * nxInt + thisSpectralLoc->modeStarts[r] + c] = thisSpectralLoc->recvBuf[recvDispls[r] + j * thisSpectralLoc->modeCounts[r] + c];
+	free(sendCounts);
+	free(sendDispls);
+	free(recvCounts);
+	free(recvDispls);
+};
+
+// Transform the simulation's local initial state into this rank's sine coefficients
+int initSpectralLoc(spectralLoc *thisSpectralLoc, simLoc *thisSimLoc, int mode)
+{
+	if (thisSimLoc->stencilOrder != 2)
+	{
+		printf("WARNING: in initSpectralLoc, only the second order stencil is supported \n");
+		return 1;
+	}
+	if (thisSimLoc->lowMemory)
+	{
+		printf("WARNING: in initSpectralLoc, the simulation can't be in low memory mode \n");
+		return 1;
+	}
+	int flag = 0;
+	int rank, size;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	MPI_Comm_size(thisMaterialLoc->comm, &size);
+	thisSpectralLoc->thisSimLoc = thisSimLoc;
+	thisSpectralLoc->mode = mode;
+	int Nx = thisMaterialLoc->Nx;
+	int nxInt = Nx - 2;
+	int nyInt = thisMaterialLoc->NyTotal - 2;
+	thisSpectralLoc->nxInt = nxInt;
+	thisSpectralLoc->nyInt = nyInt;
+
+	// interior rows owned here (global rows 1..NyTotal-2 are interior rows 0..nyInt-1)
+	int firstGlobal = thisMaterialLoc->startYId;
+	int endGlobal = thisMaterialLoc->startYId + thisMaterialLoc->NyLocal;
+	if (firstGlobal < 1)
+		firstGlobal = 1;
+	if (endGlobal > nyInt + 1)
+		endGlobal = nyInt + 1;
+	thisSpectralLoc->firstIntRow = firstGlobal - 1;
+	thisSpectralLoc->nIntRowsLoc = (endGlobal > firstGlobal) ? endGlobal - firstGlobal : 0;
+
+	// x modes owned here after the transpose, split as evenly as possible
+	thisSpectralLoc->rowCounts = malloc(size * sizeof(int));
+	thisSpectralLoc->rowStarts = malloc(size * sizeof(int));
+	thisSpectralLoc->modeCounts = malloc(size * sizeof(int));
+	thisSpectralLoc->modeStarts = malloc(size * sizeof(int));
+	MPI_Allgather(&(thisSpectralLoc->nIntRowsLoc), 1, MPI_INT, thisSpectralLoc->rowCounts, 1, MPI_INT, thisMaterialLoc->comm);
+	MPI_Allgather(&(thisSpectralLoc->firstIntRow), 1, MPI_INT, thisSpectralLoc->rowStarts, 1, MPI_INT, thisMaterialLoc->comm);
+	int r, counter = 0;
+	for (r = 0; r < size; ++r)
+	{
+		thisSpectralLoc->modeCounts[r] = nxInt / size + ((r < nxInt % size) ? 1 : 0);
+		thisSpectralLoc->modeStarts[r] = counter;
+		counter += thisSpectralLoc->modeCounts[r];
+	}
+	thisSpectralLoc->firstMode = thisSpectralLoc->modeStarts[rank];
+	thisSpectralLoc->nModesLoc = thisSpectralLoc->modeCounts[rank];
+
+	int nRowPts = thisSpectralLoc->nIntRowsLoc * nxInt;
+	int nModePts = thisSpectralLoc->nModesLoc * nyInt;
+	int nBufPts = (nRowPts > nModePts) ? nRowPts : nModePts;
+	thisSpectralLoc->rowsLoc = malloc((nRowPts + 1) * sizeof(double));
+	thisSpectralLoc->modesLoc = malloc((nModePts + 1) * sizeof(double));
+	thisSpectralLoc->coeffsLoc = malloc((nModePts + 1) * sizeof(double));
+	thisSpectralLoc->sendBuf = malloc((nBufPts + 1) * sizeof(double));
+	thisSpectralLoc->recvBuf = malloc((nBufPts + 1) * sizeof(double));
+	thisSpectralLoc->lambdaX = malloc(nxInt * sizeof(double));
+	thisSpectralLoc->lambdaY = malloc(nyInt * sizeof(double));
+	if ((thisSpectralLoc->rowsLoc == NULL) || (thisSpectralLoc->modesLoc == NULL) || (thisSpectralLoc->coeffsLoc == NULL) || (thisSpectralLoc->sendBuf == NULL) || (thisSpectralLoc->recvBuf == NULL) || (thisSpectralLoc->lambdaX == NULL) || (thisSpectralLoc->lambdaY == NULL))
+	{
+		printf("WARNING: in initSpectralLoc, issue allocating arrays \n");
+		return 1;
+	}
+	flag += initDstPlan(&(thisSpectralLoc->planX), nxInt);
+	flag += initDstPlan(&(thisSpectralLoc->planY), nyInt);
+
+	// eigenvalues of the 1D second difference with zero boundary values: 4/h^2 sin^2(k pi/(2(n+1)))
+	int k;
+	for (k = 0; k < nxInt; ++k)
+	{
+		double s = sin((k + 1) * M_PI / (2.0 * (nxInt + 1)));
+		thisSpectralLoc->lambdaX[k] = 4.0 * s * s / ((double)thisMaterialLoc->dx * thisMaterialLoc->dx);
+	}
+	for (k = 0; k < nyInt; ++k)
+	{
+		double s = sin((k + 1) * M_PI / (2.0 * (nyInt + 1)));
+		thisSpectralLoc->lambdaY[k] = 4.0 * s * s / ((double)thisMaterialLoc->dy * thisMaterialLoc->dy);
+	}
+
+	// DST along x of this rank's interior rows of initState - bdryVal
+	int j, c;
+	int localRowOffset = thisSpectralLoc->firstIntRow + 1 - thisMaterialLoc->startYId; // unpadded local row of the first interior row
+	for (j = 0; j < thisSpectralLoc->nIntRowsLoc; ++j)
+	{
+		for (c = 0; c < nxInt; ++c)
+			thisSpectralLoc->rowsLoc[j * nxInt + c] = (double)loadReal(thisSimLoc->initStateLoc[(j + localRowOffset) * Nx + c + 1]) - thisSimLoc->bdryVal;
+		applyDst(&(thisSpectralLoc->planX), thisSpectralLoc->rowsLoc + j * nxInt, 1);
+	}
+	// transpose and DST along y
+	rowsToModesLoc(thisSpectralLoc);
+	double scale = (2.0 / (nxInt + 1)) * (2.0 / (nyInt + 1)); // normalization of the inverse transform
+	for (c = 0; c < thisSpectralLoc->nModesLoc; ++c)
+	{
+		applyDst(&(thisSpectralLoc->planY), thisSpectralLoc->modesLoc + c * nyInt, 1);
+		for (k = 0; k < nyInt; ++k)
+			thisSpectralLoc->coeffsLoc[c * nyInt + k] = thisSpectralLoc->modesLoc[c * nyInt + k] * scale;
+	}
+	return flag;
+};
+
+// Set the local priorStateLoc (and currentStateLoc) to the state after timeIdx time steps of size dt
+int spectralStateAtLoc(spectralLoc *thisSpectralLoc, unsigned int timeIdx)
+{
+	simLoc *thisSimLoc = thisSpectralLoc->thisSimLoc;
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	int Nx = thisMaterialLoc->Nx;
+	int nxInt = thisSpectralLoc->nxInt;
+	int nyInt = thisSpectralLoc->nyInt;
+	double alpha = thisMaterialLoc->alpha;
+	double dt = thisSimLoc->dt;
+	int j, c, k;
+
+	// scale each mode by how much it decays over timeIdx steps, then DST along y
+	for (c = 0; c < thisSpectralLoc->nModesLoc; ++c)
+	{
+		double lambdaX = thisSpectralLoc->lambdaX[thisSpectralLoc->firstMode + c];
+		for (k = 0; k < nyInt; ++k)
+		{
+			double lambda = lambdaX + thisSpectralLoc->lambdaY[k];
+			double factor;
+			if (thisSpectralLoc->mode == SPECTRAL_EXPLICIT)
+				factor = pow(1.0 - dt * alpha * lambda, (double)timeIdx);
+			else
+				factor = exp(-alpha * lambda * dt * timeIdx);
+			thisSpectralLoc->modesLoc[c * nyInt + k] = thisSpectralLoc->coeffsLoc[c * nyInt + k] * factor;
+		}
+		applyDst(&(thisSpectralLoc->planY), thisSpectralLoc->modesLoc + c * nyInt, 1);
+	}
+	// transpose back and DST along x
+	modesToRowsLoc(thisSpectralLoc);
+	for (j = 0; j < thisSpectralLoc->nIntRowsLoc; ++j)
+		applyDst(&(thisSpectralLoc->planX), thisSpectralLoc->rowsLoc + j * nxInt, 1);
+
+	// write into the unpadded part of the local state, boundaries included
+	float bdryVal = thisSimLoc->bdryVal;
+	int nPadPts = thisMaterialLoc->nPadRows * Nx;
+	int row, col;
+	for (row = 0; row < (int)thisMaterialLoc->NyLocal; ++row)
+	{
+		int intRow = thisMaterialLoc->startYId + row - 1 - thisSpectralLoc->firstIntRow; // index within rowsLoc
+		int interior = (intRow >= 0) && (intRow < thisSpectralLoc->nIntRowsLoc);
+		for (col = 0; col < Nx; ++col)
+		{
+			int idx = nPadPts + row * Nx + col;
+			if (interior && (0 < col) && (col < Nx - 1))
+				thisSimLoc->priorStateLoc[idx] = storeReal(bdryVal + thisSpectralLoc->rowsLoc[intRow * nxInt + col - 1]);
+			else
+				thisSimLoc->priorStateLoc[idx] = storeReal(bdryVal);
+			thisSimLoc->currentStateLoc[idx] = thisSimLoc->priorStateLoc[idx];
+		}
+	}
+	thisSimLoc->currentTimeIdx = timeIdx;
+	return 0;
+};
+
+// Fill in snapshots every stepsPerCheckPt time steps of an nSteps step simulation by jumping
+// straight to each snapshot time. Initializes theseTimesLoc like runSimLoc does.
+int runSimSpectralLoc(spectralLoc *thisSpectralLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc)
+{
+	int flag = 0;
+	simLoc *thisSimLoc = thisSpectralLoc->thisSimLoc;
+	int nSnaps = calcNSnapsLoc(nSteps, stepsPerCheckPt);
+	int checkPtInitFlag = initCheckPtTimeLoc(theseTimesLoc, thisSimLoc->thisMaterialLoc, thisSimLoc, nSnaps);
+	if (checkPtInitFlag)
+	{
+		printf("WARNING: issue initializing checkpoint in runSimSpectralLoc \n");
+		flag = checkPtInitFlag;
+	}
+	int snap;
+	for (snap = 0; snap < nSnaps; ++snap)
+	{
+		flag += spectralStateAtLoc(thisSpectralLoc, snap * stepsPerCheckPt);
+		recordSnapLoc(theseTimesLoc);
+	}
+	return flag;
+};
+
+// deallocate coefficient, eigenvalue, transpose and transform arrays
+int cleanupSpectralLoc(spectralLoc *thisSpectralLoc)
+{
+	free(thisSpectralLoc->rowCounts);
+	thisSpectralLoc->rowCounts = NULL;
+	free(thisSpectralLoc->rowStarts);
+	thisSpectralLoc->rowStarts = NULL;
+	free(thisSpectralLoc->modeCounts);
+	thisSpectralLoc->modeCounts = NULL;
+	free(thisSpectralLoc->modeStarts);
+	thisSpectralLoc->modeStarts = NULL;
+	free(thisSpectralLoc->coeffsLoc);
+	thisSpectralLoc->coeffsLoc = NULL;
+	free(thisSpectralLoc->lambdaX);
+	thisSpectralLoc->lambdaX = NULL;
+	free(thisSpectralLoc->lambdaY);
+	thisSpectralLoc->lambdaY = NULL;
+	free(thisSpectralLoc->rowsLoc);
+	thisSpectralLoc->rowsLoc = NULL;
+	free(thisSpectralLoc->modesLoc);
+	thisSpectralLoc->modesLoc = NULL;
+	free(thisSpectralLoc->sendBuf);
+	thisSpectralLoc->sendBuf = NULL;
+	free(thisSpectralLoc->recvBuf);
+	thisSpectralLoc->recvBuf = NULL;
+	cleanupDstPlan(&(thisSpectralLoc->planX));
+	cleanupDstPlan(&(thisSpectralLoc->planY));
+	return 0;
+};
@@ -0,0 +1,53 @@
+#ifndef __SPECTRALPAR_H__
+#define __SPECTRALPAR_H__
+#include "dst.h"
+
+// forward declarations of structs a spectralLoc will have pointers to
+typedef struct simLoc_struct simLoc;
+typedef struct checkPtTimeLoc_struct checkPtTimeLoc;
+
+// which time evolution of the sine modes to use (same meaning as in spectralSer.h)
+#define SPECTRAL_SEMIDISCRETE 0 // exact solution of du/dt = alpha*L u (each mode decays as exp(-alpha*lambda*t))
+#define SPECTRAL_EXPLICIT 1 // exactly what n of oneStepLoc's forward Euler steps give ((1 - dt*alpha*lambda)^n)
+
+typedef struct spectralLoc_struct{
+	// Distributed version of spectral: rows are transformed along x where they live, then a transpose
+	// (MPI_Alltoallv) hands every rank a block of x modes with all of their rows, which are transformed
+	// along y. The sine coefficients stay in that transposed layout; evaluating a state runs the same
+	// steps backwards.
+	simLoc *thisSimLoc; // pointer to an already initialized local subset of the simulation
+	int mode; // SPECTRAL_SEMIDISCRETE or SPECTRAL_EXPLICIT
+	int nxInt; // number of interior columns of the global material (Nx - 2)
+	int nyInt; // number of interior rows of the global material (NyTotal - 2)
+	int firstIntRow; // interior row index (global row - 1) of this rank's first interior row
+	int nIntRowsLoc; // number of interior rows this rank owns
+	int firstMode; // first x mode this rank holds after the transpose
+	int nModesLoc; // number of x modes this rank holds after the transpose
+	int *rowCounts; // number of interior rows on each rank
+	int *rowStarts; // first interior row on each rank
+	int *modeCounts; // number of x modes on each rank
+	int *modeStarts; // first x mode on each rank
+	double *coeffsLoc; // sine coefficients of this rank's x modes, scaled for the inverse (nModesLoc x nyInt)
+	double *lambdaX; // eigenvalues of -d^2/dx^2 for each x mode (nxInt)
+	double *lambdaY; // eigenvalues of -d^2/dy^2 for each y mode (nyInt)
+	double *rowsLoc; // this rank's interior rows (nIntRowsLoc x nxInt)
+	double *modesLoc; // this rank's x modes (nModesLoc x nyInt)
+	double *sendBuf; // packed blocks for the transposes
+	double *recvBuf;
+	dstPlan planX; // transforms along rows
+	dstPlan planY; // transforms along columns
+} spectralLoc;
+
+// Transform the simulation's local initial state into this rank's sine coefficients
+int initSpectralLoc(spectralLoc *thisSpectralLoc, simLoc *thisSimLoc, int mode);
+
+// Set the local priorStateLoc (and currentStateLoc) to the state after timeIdx time steps of size dt
+int spectralStateAtLoc(spectralLoc *thisSpectralLoc, unsigned int timeIdx);
+
+// Fill in snapshots every stepsPerCheckPt time steps of an nSteps step simulation by jumping
+// straight to each snapshot time. Initializes theseTimesLoc like runSimLoc does.
+int runSimSpectralLoc(spectralLoc *thisSpectralLoc, int nSteps, int stepsPerCheckPt, checkPtTimeLoc *theseTimesLoc);
+
+// deallocate coefficient, eigenvalue, transpose and transform arrays
+int cleanupSpectralLoc(spectralLoc *thisSpectralLoc);
+#endif
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "spectralSer.h"
+#include "simulationSer.h"
+#include "materialSer.h"
+#include "checkPtSer.h"
+
+// Transform the simulation's initial state into sine coefficients
+int initSpectral(spectral *thisSpectral, sim *thisSim, int mode){
+	int flag = 0;
+	thisSpectral->thisSim = thisSim;
+	thisSpectral->mode = mode;
+	int Nx = (thisSim->thisMaterial)->Nx;
+	int Ny = (thisSim->thisMaterial)->Ny;
+	float dx = (thisSim->thisMaterial)->dx;
+	float dy = (thisSim->thisMaterial)->dy;
+	int nxInt = Nx - 2;
+	int nyInt = Ny - 2;
+	thisSpectral->nxInt = nxInt;
+	thisSpectral->nyInt = nyInt;
+
+	thisSpectral->coeffs = malloc(nxInt*nyInt*sizeof(double));
+	thisSpectral->work = malloc(nxInt*nyInt*sizeof(double));
+	thisSpectral->lambdaX = malloc(nxInt*sizeof(double));
+	thisSpectral->lambdaY = malloc(nyInt*sizeof(double));
+	if((thisSpectral->coeffs == NULL) || (thisSpectral->work == NULL) || (thisSpectral->lambdaX == NULL) || (thisSpectral->lambdaY == NULL)){
+		printf("WARNING: in initSpectral, issue allocating arrays \n");
+		return 1;
+	}
+	flag += initDstPlan(&(thisSpectral->planX), nxInt);
+	flag += initDstPlan(&(thisSpectral->planY), nyInt);
+
+	// eigenvalues of the 1D second difference with zero boundary values: 4/h^2 sin^2(k pi/(2(n+1)))
+	int k;
+	for(k=0; k<nxInt; ++k){
+		double s = sin((k+1)*M_PI/(2.0*(nxInt+1)));
+		thisSpectral->lambdaX[k] = 4.0*s*s/((double)dx*dx);
+	}
+	for(k=0; k<nyInt; ++k){
+		double s = sin((k+1)*M_PI/(2.0*(nyInt+1)));
+		thisSpectral->lambdaY[k] = 4.0*s*s/((double)dy*dy);
+	}
+
+	// 2D DST of the interior of initState - bdryVal
+	int row, col;
+	double *c = thisSpectral->coeffs;
+	for(row=0; row<nyInt; ++row){
+		for(col=0; col<nxInt; ++col){
+			c[col + row*nxInt] = (double)thisSim->initState[(col+1) + (row+1)*Nx] - thisSim->bdryVal;
+		}
+	}
+	for(row=0; row<nyInt; ++row) applyDst(&(thisSpectral->planX), c + row*nxInt, 1);
+	for(col=0; col<nxInt; ++col) applyDst(&(thisSpectral->planY), c + col, nxInt);
+	// fold in the normalization of the inverse transform
+	double scale = (2.0/(nxInt+1)) * (2.0/(nyInt+1));
+	for(k=0; k<nxInt*nyInt; ++k) c[k] *= scale;
+
+	return flag;
+};
+
+// Set the simulation's priorState (and currentState) to the state after timeIdx time steps of size dt
+int spectralStateAt(spectral *thisSpectral, unsigned int timeIdx){
+	sim *thisSim = thisSpectral->thisSim;
+	int Nx = (thisSim->thisMaterial)->Nx;
+	int Ny = (thisSim->thisMaterial)->Ny;
+	int nxInt = thisSpectral->nxInt;
+	int nyInt = thisSpectral->nyInt;
+	double alpha = (thisSim->thisMaterial)->alpha;
+	double dt = thisSim->dt;
+	double *w = thisSpectral->work;
+	int row, col;
+
+	// scale every mode by how much it decays over timeIdx steps
+	for(row=0; row<nyInt; ++row){
+		for(col=0; col<nxInt; ++col){
+			double lambda = thisSpectral->lambdaX[col] + thisSpectral->lambdaY[row];
+			double factor;
+			if(thisSpectral->mode == SPECTRAL_EXPLICIT) factor = pow(1.0 - dt*alpha*lambda, (double)timeIdx);
+			else factor = exp(-alpha*lambda*dt*timeIdx);
+			w[col + row*nxInt] = thisSpectral->coeffs[col + row*nxInt] * factor;
+		}
+	}
+	for(col=0; col<nxInt; ++col) applyDst(&(thisSpectral->planY), w + col, nxInt);
+	for(row=0; row<nyInt; ++row) applyDst(&(thisSpectral->planX), w + row*nxInt, 1);
+
+	// write it back into the simulation, boundaries included
+	float bdryVal = thisSim->bdryVal;
+	for(row=0; row<Ny; ++row){
+		for(col=0; col<Nx; ++col){
+			int idx = col + row*Nx;
+			if((0 < row) && (row < Ny-1) && (0 < col) && (col < Nx-1)) thisSim->priorState[idx] = bdryVal + w[(col-1) + (row-1)*nxInt];
+			else thisSim->priorState[idx] = bdryVal;
+			thisSim->currentState[idx] = thisSim->priorState[idx];
+		}
+	}
+	thisSim->currentTimeIdx = timeIdx;
+	return 0;
+};
+
+// Fill in snapshots every stepsPerCheckPt time steps of an nSteps step simulation by jumping
+// straight to each snapshot time. Initializes theseTimes like runSim does.
+int runSimSpectral(spectral *thisSpectral, int nSteps, int stepsPerCheckPt, checkPtTime *theseTimes){
+	int flag = 0;
+	sim *thisSim = thisSpectral->thisSim;
+	int nSnaps = calcNSnaps(nSteps, stepsPerCheckPt);
+	int checkPtInitFlag = initCheckPtTime(theseTimes, thisSim->thisMaterial, thisSim, nSnaps);
+	if(checkPtInitFlag){
+		printf("WARNING: issue initializing checkpoint in runSimSpectral \n");
+		flag = checkPtInitFlag;
+	}
+	int snap;
+	for(snap=0; snap<nSnaps; ++snap){
+		flag += spectralStateAt(thisSpectral, snap*stepsPerCheckPt);
+		recordSnap(theseTimes);
+	}
+	return flag;
+};
+
+// deallocate coefficient, eigenvalue and transform arrays
+int cleanupSpectral(spectral *thisSpectral){
+	free(thisSpectral->coeffs);
+	thisSpectral->coeffs = NULL;
+	free(thisSpectral->work);
+	thisSpectral->work = NULL;
+	free(thisSpectral->lambdaX);
+	thisSpectral->lambdaX = NULL;
+	free(thisSpectral->lambdaY);
+	thisSpectral->lambdaY = NULL;
+	cleanupDstPlan(&(thisSpectral->planX));
+	cleanupDstPlan(&(thisSpectral->planY));
+	return 0;
+};
@@ -0,0 +1,41 @@
+#ifndef __SPECTRALSER_H__
+#define __SPECTRALSER_H__
+#include "dst.h"
+
+// forward declarations of structs a spectral will have pointers to
+typedef struct sim_struct sim;
+typedef struct checkPtTime_struct checkPtTime;
+
+// which time evolution of the sine modes to use
+#define SPECTRAL_SEMIDISCRETE 0 // exact solution of du/dt = alpha*L u (each mode decays as exp(-alpha*lambda*t))
+#define SPECTRAL_EXPLICIT 1 // exactly what n of oneStep's forward Euler steps give ((1 - dt*alpha*lambda)^n)
+
+typedef struct spectral_struct{
+	// With constant alpha and a single boundary value, u - bdryVal on the interior points is a sum of
+	// sine modes of the 5 point Laplacian L, so the state at any time comes from one 2D DST of the
+	// initial state, a scaling of each mode, and one inverse 2D DST, with no time stepping.
+	sim *thisSim; // pointer to an already initialized simulation
+	int mode; // SPECTRAL_SEMIDISCRETE or SPECTRAL_EXPLICIT
+	int nxInt; // number of interior columns (Nx - 2)
+	int nyInt; // number of interior rows (Ny - 2)
+	double *coeffs; // sine coefficients of initState - bdryVal, scaled for the inverse transform (nyInt x nxInt)
+	double *lambdaX; // eigenvalues of -d^2/dx^2 for each x mode (nxInt)
+	double *lambdaY; // eigenvalues of -d^2/dy^2 for each y mode (nyInt)
+	double *work; // scratch for evaluating a state (nyInt x nxInt)
+	dstPlan planX; // transforms along rows
+	dstPlan planY; // transforms along columns
+} spectral;
+
+// Transform the simulation's initial state into sine coefficients
+int initSpectral(spectral *thisSpectral, sim *thisSim, int mode);
+
+// Set the simulation's priorState (and currentState) to the state after timeIdx time steps of size dt
+int spectralStateAt(spectral *thisSpectral, unsigned int timeIdx);
+
+// Fill in snapshots every stepsPerCheckPt time steps of an nSteps step simulation by jumping
+// straight to each snapshot time. Initializes theseTimes like runSim does.
+int runSimSpectral(spectral *thisSpectral, int nSteps, int stepsPerCheckPt, checkPtTime *theseTimes);
+
+// deallocate coefficient, eigenvalue and transform arrays
+int cleanupSpectral(spectral *thisSpectral);
+#endif
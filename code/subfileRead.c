@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "subfileRead.h"
+
+// one value of storage type dtype (elemSize bytes at raw) as a double
+static double decodeValue(const unsigned char *raw, int elemSize, const char *dtype){
+	if(elemSize == 8){
+		double d;
+		memcpy(&d, raw, 8);
+		return d;
+	}
+	if(elemSize == 4){
+		float f;
+		memcpy(&f, raw, 4);
+		return f;
+	}
+	uint16_t h;
+	memcpy(&h, raw, 2);
+	uint32_t bits;
+	if(strcmp(dtype, "bfloat16") == 0){
+		bits = (uint32_t)h << 16; // the upper half of a float
+	}
+	else{
+		// IEEE half to float: move the exponent over, normalizing subnormals
+		uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+		uint32_t exponent = (h >> 10) & 0x1f;
+		uint32_t mantissa = h & 0x3ff;
+		if(exponent == 0x1f) bits = sign | 0x7f800000 | (mantissa << 13);
+		else if(exponent != 0) bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		else if(mantissa == 0) bits = sign;
+		else{
+			exponent = 113;
+			while((mantissa & 0x400) == 0){
+				mantissa <<= 1;
+				--exponent;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+		}
+	}
+	float f;
+	memcpy(&f, &bits, 4);
+	return f;
+};
+
+// Read the index and open every subfile it names
+int openSubfileSet(subfileSet *thisSet, const char *indexFilename){
+	memset(thisSet, 0, sizeof(subfileSet));
+	FILE *indexPtr = fopen(indexFilename, "r");
+	if(indexPtr == NULL){
+		printf("ERROR in opening %s in openSubfileSet \n", indexFilename);
+		return 1;
+	}
+	int flag = 0;
+	if(fscanf(indexPtr, "%u %u %d %15s %d", &(thisSet->Nx), &(thisSet->NyTotal), &(thisSet->nSnaps), thisSet->dtype, &(thisSet->nBlocks)) != 5){
+		printf("WARNING: in openSubfileSet, could not read the header of %s \n", indexFilename);
+		fclose(indexPtr);
+		return 1;
+	}
+	if(strcmp(thisSet->dtype, "float64") == 0) thisSet->elemSize = 8;
+	else if(strcmp(thisSet->dtype, "float32") == 0) thisSet->elemSize = 4;
+	else thisSet->elemSize = 2;
+	int nSnaps = thisSet->nSnaps, nBlocks = thisSet->nBlocks;
+	thisSet->times = malloc(nSnaps*sizeof(float));
+	thisSet->blockStartRow = malloc(nBlocks*sizeof(unsigned int));
+	thisSet->blockNRows = malloc(nBlocks*sizeof(unsigned int));
+	thisSet->blockOffset = malloc(nBlocks*sizeof(long));
+	thisSet->blockFile = malloc(nBlocks*sizeof(FILE *));
+	thisSet->files = calloc(nBlocks, sizeof(FILE *));
+	thisSet->rowBuf = malloc((size_t)thisSet->Nx*thisSet->elemSize);
+	if((thisSet->times == NULL) || (thisSet->blockStartRow == NULL) || (thisSet->blockNRows == NULL) || (thisSet->blockOffset == NULL) || (thisSet->blockFile == NULL) || (thisSet->files == NULL) || (thisSet->rowBuf == NULL)){
+		printf("WARNING: in openSubfileSet, issue allocating the index \n");
+		fclose(indexPtr);
+		return 1;
+	}
+	int snap, b, f;
+	for(snap=0; snap<nSnaps; ++snap){
+		if(fscanf(indexPtr, "%f", &(thisSet->times[snap])) != 1) flag = 1;
+	}
+
+	// subfiles live next to the index
+	char dir[SUBFILE_PATH_LEN] = "";
+	const char *slash = strrchr(indexFilename, '/');
+	if(slash != NULL){
+		int dirLen = slash - indexFilename + 1;
+		if(dirLen >= SUBFILE_PATH_LEN){
+			printf("WARNING: in openSubfileSet, the directory of %s is longer than %d characters \n", indexFilename, SUBFILE_PATH_LEN - 1);
+			dirLen = 0;
+			flag = 1;
+		}
+		memcpy(dir, indexFilename, dirLen);
+		dir[dirLen] = '\0';
+	}
+	char (*names)[SUBFILE_PATH_LEN] = malloc(nBlocks*sizeof(*names));
+	if(names == NULL) flag = 1;
+	for(b=0; (b<nBlocks) && (names != NULL) && !flag; ++b){
+		char name[SUBFILE_PATH_LEN];
+		if(fscanf(indexPtr, "%255s %u %u %ld", name, &(thisSet->blockStartRow[b]), &(thisSet->blockNRows[b]), &(thisSet->blockOffset[b])) != 4){
+			printf("WARNING: in openSubfileSet, could not read block %d of %s \n", b, indexFilename);
+			flag = 1;
+			break;
+		}
+		if(snprintf(names[b], SUBFILE_PATH_LEN, "%s%s", dir, name) >= SUBFILE_PATH_LEN){
+			printf("WARNING: in openSubfileSet, the path of subfile %s is longer than %d characters \n", name, SUBFILE_PATH_LEN - 1);
+			flag = 1;
+			break;
+		}
+		// share the FILE with an earlier block in the same subfile
+		thisSet->blockFile[b] = NULL;
+		for(f=0; f<b; ++f){
+			if(strcmp(names[f], names[b]) == 0) thisSet->blockFile[b] = thisSet->blockFile[f];
+		}
+		if(thisSet->blockFile[b] == NULL){
+			thisSet->blockFile[b] = fopen(names[b], "rb");
+			if(thisSet->blockFile[b] == NULL){
+				printf("ERROR in opening subfile %s in openSubfileSet \n", names[b]);
+				flag = 1;
+				break;
+			}
+			thisSet->files[thisSet->nFiles] = thisSet->blockFile[b];
+			thisSet->nFiles = thisSet->nFiles + 1;
+		}
+	}
+	free(names);
+	fclose(indexPtr);
+	return flag;
+};
+
+// Read rows startRow to startRow + nRows - 1 of snapshot snap
+int readRowsSubfileSet(subfileSet *thisSet, int snap, unsigned int startRow, unsigned int nRows, double *rows){
+	if((snap < 0) || (snap >= thisSet->nSnaps) || (startRow + nRows > thisSet->NyTotal)){
+		printf("WARNING: in readRowsSubfileSet, snapshot %d rows %u to %u are outside the dataset \n", snap, startRow, startRow + nRows);
+		return 1;
+	}
+	unsigned int Nx = thisSet->Nx;
+	size_t rowBytes = (size_t)Nx*thisSet->elemSize;
+	int b;
+	unsigned int row, col;
+	for(b=0; b<thisSet->nBlocks; ++b){
+		unsigned int lo = thisSet->blockStartRow[b], hi = lo + thisSet->blockNRows[b];
+		if(lo < startRow) lo = startRow;
+		if(hi > startRow + nRows) hi = startRow + nRows;
+		// a block holds nSnaps x its rows, so this snapshot's rows are together
+		for(row=lo; row<hi; ++row){
+			long offset = thisSet->blockOffset[b] + ((long)snap*thisSet->blockNRows[b] + (row - thisSet->blockStartRow[b]))*rowBytes;
+			if((fseek(thisSet->blockFile[b], offset, SEEK_SET) != 0) || (fread(thisSet->rowBuf, 1, rowBytes, thisSet->blockFile[b]) != rowBytes)){
+				printf("WARNING: in readRowsSubfileSet, could not read row %u of snapshot %d \n", row, snap);
+				return 1;
+			}
+			double *out = rows + (size_t)(row - startRow)*Nx;
+			for(col=0; col<Nx; ++col){
+				out[col] = decodeValue(thisSet->rowBuf + (size_t)col*thisSet->elemSize, thisSet->elemSize, thisSet->dtype);
+			}
+		}
+	}
+	return 0;
+};
+
+// Read snapshot snap
+int readSnapSubfileSet(subfileSet *thisSet, int snap, double *snapshot){
+	return readRowsSubfileSet(thisSet, snap, 0, thisSet->NyTotal, snapshot);
+};
+
+// close the subfiles and free the index
+int closeSubfileSet(subfileSet *thisSet){
+	int f;
+	for(f=0; f<thisSet->nFiles; ++f){
+		fclose(thisSet->files[f]);
+	}
+	free(thisSet->files);
+	thisSet->files = NULL;
+	thisSet->nFiles = 0;
+	free(thisSet->blockFile);
+	thisSet->blockFile = NULL;
+	free(thisSet->times);
+	thisSet->times = NULL;
+	free(thisSet->blockStartRow);
+	thisSet->blockStartRow = NULL;
+	free(thisSet->blockNRows);
+	thisSet->blockNRows = NULL;
+	free(thisSet->blockOffset);
+	thisSet->blockOffset = NULL;
+	free(thisSet->rowBuf);
+	thisSet->rowBuf = NULL;
+	return 0;
+};
@@ -0,0 +1,38 @@
+#ifndef __SUBFILEREAD_H__
+#define __SUBFILEREAD_H__
+#include <stdio.h>
+
+// longest subfile path (index directory plus subfile name)
+#define SUBFILE_PATH_LEN 512
+
+// A set of subfiles written by writeToSubfilesLoc, read back (serially, with no MPI) as one Nx x NyTotal x
+// nSnaps dataset whatever the number of ranks and nodes that wrote it
+typedef struct subfileSet_struct{
+	unsigned int Nx; // number of columns
+	unsigned int NyTotal; // number of rows
+	int nSnaps; // number of snapshots
+	char dtype[16]; // storage type of the values (float32, float64, bfloat16 or float16)
+	int elemSize; // bytes per value
+	float *times; // time (in seconds) of each snapshot
+	int nBlocks; // number of blocks (one per writing rank)
+	unsigned int *blockStartRow; // first row of each block
+	unsigned int *blockNRows; // number of rows of each block
+	long *blockOffset; // byte offset of each block within its subfile
+	FILE **blockFile; // subfile each block is in (blocks in the same subfile share the FILE)
+	int nFiles; // number of distinct subfiles open
+	FILE **files; // the open subfiles
+	unsigned char *rowBuf; // one row of raw values
+} subfileSet;
+
+// Read the index indexFilename (prefix.idx) and open every subfile it names (looked for next to the index)
+int openSubfileSet(subfileSet *thisSet, const char *indexFilename);
+
+// Read snapshot snap into snapshot (NyTotal x Nx values, row by row)
+int readSnapSubfileSet(subfileSet *thisSet, int snap, double *snapshot);
+
+// Read rows startRow to startRow + nRows - 1 of snapshot snap into rows (nRows x Nx values)
+int readRowsSubfileSet(subfileSet *thisSet, int snap, unsigned int startRow, unsigned int nRows, double *rows);
+
+// close the subfiles and free the index
+int closeSubfileSet(subfileSet *thisSet);
+#endif
@@ -0,0 +1,400 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include "taskPar.h"
+
+// what each of the other workers is started with
+typedef struct taskWorkerArg_struct{
+	taskPool *pool;
+	int worker;
+} taskWorkerArg;
+
+// seconds on the monotonic clock
+static double nowLoc(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+};
+
+// push a ready task id onto the bottom of a deque (it has room for every task of the graph)
+static void pushBottomLoc(taskDeque *deque, int id)
+{
+	pthread_mutex_lock(&(deque->lock));
+	deque->ids[deque->bottom % deque->capacity] = id;
+	deque->bottom = deque->bottom + 1;
+	pthread_mutex_unlock(&(deque->lock));
+};
+
+// the owner's next task (the newest, whose inputs are most likely still in cache), or -1 if it's empty
+static int popBottomLoc(taskDeque *deque)
+{
+	int id = -1;
+	pthread_mutex_lock(&(deque->lock));
+	if (deque->bottom > deque->top)
+	{
+		deque->bottom = deque->bottom - 1;
+		id = deque->ids[deque->bottom % deque->capacity];
+	}
+	pthread_mutex_unlock(&(deque->lock));
+	return id;
+};
+
+// a thief's next task (the oldest), or -1 if it's empty
+static int stealTopLoc(taskDeque *deque)
+{
+	int id = -1;
+	pthread_mutex_lock(&(deque->lock));
+	if (deque->bottom > deque->top)
+	{
+		id = deque->ids[deque->top % deque->capacity];
+		deque->top = deque->top + 1;
+	}
+	pthread_mutex_unlock(&(deque->lock));
+	return id;
+};
+
+// task id has finished on worker: release the tasks waiting on it that have nothing else left to wait on
+static void finishTaskLoc(taskPool *thisPool, int id, int worker)
+{
+	task *thisTask = &(thisPool->tasks[id]);
+	int s;
+	for (s = 0; s < thisTask->nSucc; ++s)
+	{
+		task *next = &(thisPool->tasks[thisTask->succ[s]]);
+		if (__atomic_sub_fetch(&(next->depsLeft), 1, __ATOMIC_ACQ_REL) != 0)
+			continue;
+		if (next->kind == TASK_RUN)
+			pushBottomLoc(&(thisPool->deques[worker]), thisTask->succ[s]);
+		else
+		{
+			pthread_mutex_lock(&(thisPool->funneledLock));
+			thisPool->funneledIds[thisPool->nFunneled] = thisTask->succ[s];
+			thisPool->nFunneled = thisPool->nFunneled + 1;
+			pthread_mutex_unlock(&(thisPool->funneledLock));
+		}
+	}
+	__atomic_add_fetch(&(thisPool->nRun), 1, __ATOMIC_RELAXED);
+	__atomic_sub_fetch(&(thisPool->remaining), 1, __ATOMIC_ACQ_REL);
+};
+
+// run task id on worker, timing it
+static void runOneLoc(taskPool *thisPool, int id, int worker, int stolen)
+{
+	task *thisTask = &(thisPool->tasks[id]);
+	thisTask->worker = worker;
+	thisTask->stolen = stolen;
+	thisTask->start = nowLoc() - thisPool->runStart;
+	thisTask->func(thisTask->arg, worker);
+	thisTask->end = nowLoc() - thisPool->runStart;
+	thisPool->busyTime[worker] += thisTask->end - thisTask->start;
+	if (stolen)
+		__atomic_add_fetch(&(thisPool->nStolen), 1, __ATOMIC_RELAXED);
+	finishTaskLoc(thisPool, id, worker);
+};
+
+// worker 0's share of a run: the funneled tasks as they become ready, and a poll of each TASK_POLL one
+static void serviceFunneledLoc(taskPool *thisPool)
+{
+	pthread_mutex_lock(&(thisPool->funneledLock));
+	int nTaken = thisPool->nFunneled;
+	memcpy(thisPool->takenIds, thisPool->funneledIds, nTaken * sizeof(int));
+	thisPool->nFunneled = 0;
+	pthread_mutex_unlock(&(thisPool->funneledLock));
+	int i;
+	for (i = 0; i < nTaken; ++i)
+	{
+		int id = thisPool->takenIds[i];
+		task *thisTask = &(thisPool->tasks[id]);
+		if (thisTask->kind == TASK_FUNNELED)
+			runOneLoc(thisPool, id, 0, 0);
+		else
+		{
+			thisTask->start = nowLoc() - thisPool->runStart;
+			thisTask->worker = 0;
+			thisPool->pollIds[thisPool->nPolling] = id;
+			thisPool->nPolling = thisPool->nPolling + 1;
+		}
+	}
+
+	// poll, and drop the finished ones
+	i = 0;
+	while (i < thisPool->nPolling)
+	{
+		int id = thisPool->pollIds[i];
+		task *thisTask = &(thisPool->tasks[id]);
+		if (!thisTask->func(thisTask->arg, 0))
+		{
+			i = i + 1;
+			continue;
+		}
+		thisTask->end = nowLoc() - thisPool->runStart;
+		thisPool->nPolling = thisPool->nPolling - 1;
+		thisPool->pollIds[i] = thisPool->pollIds[thisPool->nPolling];
+		finishTaskLoc(thisPool, id, 0);
+	}
+};
+
+// work on the current run until every task has finished: own deque first, then steal
+static void workLoc(taskPool *thisPool, int worker)
+{
+	int nThreads = thisPool->nThreads;
+	while (__atomic_load_n(&(thisPool->remaining), __ATOMIC_ACQUIRE) > 0)
+	{
+		if (worker == 0)
+			serviceFunneledLoc(thisPool);
+		int stolen = 0;
+		int id = popBottomLoc(&(thisPool->deques[worker]));
+		int k;
+		for (k = 1; (id < 0) && (k < nThreads); ++k)
+		{
+			id = stealTopLoc(&(thisPool->deques[(worker + k) % nThreads]));
+			stolen = (id >= 0);
+		}
+		if (id >= 0)
+			runOneLoc(thisPool, id, worker, stolen);
+		else
+			sched_yield();
+	}
+};
+
+// the other workers: wait for a run, work on it, and wait for the next
+static void *workerMainLoc(void *arg)
+{
+	taskPool *thisPool = ((taskWorkerArg *)arg)->pool;
+	int worker = ((taskWorkerArg *)arg)->worker;
+	int seen = 0;
+	while (1)
+	{
+		pthread_mutex_lock(&(thisPool->runLock));
+		while ((thisPool->generation == seen) && !thisPool->shutdown)
+			pthread_cond_wait(&(thisPool->runCond), &(thisPool->runLock));
+		seen = thisPool->generation;
+		int shutdown = thisPool->shutdown;
+		pthread_mutex_unlock(&(thisPool->runLock));
+		if (shutdown)
+			break;
+		workLoc(thisPool, worker);
+		__atomic_sub_fetch(&(thisPool->nActive), 1, __ATOMIC_ACQ_REL);
+	}
+	return NULL;
+};
+
+// Start a pool of nThreads workers (the caller is one of them), with an empty graph
+int initTaskPoolLoc(taskPool *thisPool, int nThreads)
+{
+	if (nThreads < 1)
+	{
+		printf("WARNING: In initTaskPoolLoc(), nThreads must be positive \n");
+		return 1;
+	}
+	memset(thisPool, 0, sizeof(taskPool));
+	thisPool->nThreads = nThreads;
+	thisPool->deques = calloc(nThreads, sizeof(taskDeque));
+	thisPool->busyTime = calloc(nThreads, sizeof(double));
+	thisPool->threads = calloc(nThreads, sizeof(pthread_t));
+	thisPool->workerArgs = calloc(nThreads, sizeof(taskWorkerArg));
+	if ((thisPool->deques == NULL) || (thisPool->busyTime == NULL) || (thisPool->threads == NULL) || (thisPool->workerArgs == NULL))
+	{
+		printf("WARNING: In initTaskPoolLoc(), issue allocating the pool \n");
+		return 1;
+	}
+	int w;
+	for (w = 0; w < nThreads; ++w)
+		pthread_mutex_init(&(thisPool->deques[w].lock), NULL);
+	pthread_mutex_init(&(thisPool->funneledLock), NULL);
+	pthread_mutex_init(&(thisPool->runLock), NULL);
+	pthread_cond_init(&(thisPool->runCond), NULL);
+
+	taskWorkerArg *args = (taskWorkerArg *)thisPool->workerArgs;
+	for (w = 1; w < nThreads; ++w)
+	{
+		args[w].pool = thisPool;
+		args[w].worker = w;
+		if (pthread_create(&(thisPool->threads[w]), NULL, workerMainLoc, &(args[w])) != 0)
+		{
+			printf("WARNING: In initTaskPoolLoc(), only %d of %d workers could be started \n", w, nThreads);
+			thisPool->nThreads = w;
+			return 1;
+		}
+	}
+	return 0;
+};
+
+// Empty the graph
+int clearTasksLoc(taskPool *thisPool)
+{
+	thisPool->nTasks = 0;
+	return 0;
+};
+
+// Add a task to the graph, returning its id
+int addTaskLoc(taskPool *thisPool, taskFunc func, void *arg, int kind, int label)
+{
+	if (thisPool->nTasks == thisPool->capacity)
+	{
+		int capacity = (thisPool->capacity > 0) ? 2 * thisPool->capacity : 64;
+		task *newTasks = realloc(thisPool->tasks, capacity * sizeof(task));
+		if (newTasks == NULL)
+		{
+			printf("WARNING: In addTaskLoc(), issue growing the graph \n");
+			return -1;
+		}
+		thisPool->tasks = newTasks;
+		thisPool->capacity = capacity;
+	}
+	int id = thisPool->nTasks;
+	task *thisTask = &(thisPool->tasks[id]);
+	memset(thisTask, 0, sizeof(task));
+	thisTask->func = func;
+	thisTask->arg = arg;
+	thisTask->kind = kind;
+	thisTask->label = label;
+	thisTask->worker = -1;
+	thisPool->nTasks = id + 1;
+	return id;
+};
+
+// Make task after wait on task before
+int addDepLoc(taskPool *thisPool, int before, int after)
+{
+	if ((before < 0) || (after < 0))
+		return 0;
+	task *first = &(thisPool->tasks[before]);
+	if (first->nSucc == TASK_MAX_SUCC)
+	{
+		printf("WARNING: In addDepLoc(), task %d already has %d tasks waiting on it \n", before, TASK_MAX_SUCC);
+		return 1;
+	}
+	first->succ[first->nSucc] = after;
+	first->nSucc = first->nSucc + 1;
+	thisPool->tasks[after].nDeps = thisPool->tasks[after].nDeps + 1;
+	return 0;
+};
+
+// Run every task of the graph once, in an order respecting its dependencies
+int runTasksLoc(taskPool *thisPool)
+{
+	int nTasks = thisPool->nTasks;
+	int nThreads = thisPool->nThreads;
+	if (nTasks == 0)
+		return 0;
+
+	// room for every task in every deque and in the funneled list
+	int w, i;
+	for (w = 0; w < nThreads; ++w)
+	{
+		taskDeque *deque = &(thisPool->deques[w]);
+		if (deque->capacity < nTasks)
+		{
+			int *newIds = realloc(deque->ids, thisPool->capacity * sizeof(int));
+			if (newIds == NULL)
+			{
+				printf("WARNING: In runTasksLoc(), issue growing a deque \n");
+				return 1;
+			}
+			deque->ids = newIds;
+			deque->capacity = thisPool->capacity;
+		}
+		deque->top = 0;
+		deque->bottom = 0;
+	}
+	int *newFunneled = realloc(thisPool->funneledIds, thisPool->capacity * sizeof(int));
+	if (newFunneled != NULL)
+		thisPool->funneledIds = newFunneled;
+	int *newTaken = realloc(thisPool->takenIds, thisPool->capacity * sizeof(int));
+	if (newTaken != NULL)
+		thisPool->takenIds = newTaken;
+	int *newPoll = realloc(thisPool->pollIds, thisPool->capacity * sizeof(int));
+	if (newPoll != NULL)
+		thisPool->pollIds = newPoll;
+	if ((newFunneled == NULL) || (newTaken == NULL) || (newPoll == NULL))
+	{
+		printf("WARNING: In runTasksLoc(), issue growing the funneled lists \n");
+		return 1;
+	}
+	thisPool->nFunneled = 0;
+	thisPool->nPolling = 0;
+
+	// the tasks with nothing to wait on are ready: spread them over the deques so every worker starts at once
+	int nextDeque = 0;
+	for (i = 0; i < nTasks; ++i)
+	{
+		task *thisTask = &(thisPool->tasks[i]);
+		thisTask->depsLeft = thisTask->nDeps;
+		thisTask->start = 0.0;
+		thisTask->end = 0.0;
+		thisTask->worker = -1;
+		thisTask->stolen = 0;
+	}
+	for (i = 0; i < nTasks; ++i)
+	{
+		if (thisPool->tasks[i].nDeps > 0)
+			continue;
+		if (thisPool->tasks[i].kind != TASK_RUN)
+			thisPool->funneledIds[thisPool->nFunneled++] = i;
+		else
+		{
+			taskDeque *deque = &(thisPool->deques[nextDeque]);
+			deque->ids[deque->bottom++] = i;
+			nextDeque = (nextDeque + 1) % nThreads;
+		}
+	}
+	thisPool->remaining = nTasks;
+	thisPool->nActive = nThreads - 1;
+	thisPool->runStart = nowLoc();
+
+	// wake the others and join in, then wait for them all to be done with this run
+	pthread_mutex_lock(&(thisPool->runLock));
+	thisPool->generation = thisPool->generation + 1;
+	pthread_cond_broadcast(&(thisPool->runCond));
+	pthread_mutex_unlock(&(thisPool->runLock));
+	workLoc(thisPool, 0);
+	while (__atomic_load_n(&(thisPool->nActive), __ATOMIC_ACQUIRE) > 0)
+		sched_yield();
+	return 0;
+};
+
+// Stop the workers and free everything
+int cleanupTaskPoolLoc(taskPool *thisPool)
+{
+	if (thisPool->deques == NULL)
+		return 0;
+	pthread_mutex_lock(&(thisPool->runLock));
+	thisPool->shutdown = 1;
+	pthread_cond_broadcast(&(thisPool->runCond));
+	pthread_mutex_unlock(&(thisPool->runLock));
+	int w;
+	for (w = 1; w < thisPool->nThreads; ++w)
+		pthread_join(thisPool->threads[w], NULL);
+	for (w = 0; w < thisPool->nThreads; ++w)
+	{
+		pthread_mutex_destroy(&(thisPool->deques[w].lock));
+		free(thisPool->deques[w].ids);
+	}
+	pthread_mutex_destroy(&(thisPool->funneledLock));
+	pthread_mutex_destroy(&(thisPool->runLock));
+	pthread_cond_destroy(&(thisPool->runCond));
+	free(thisPool->deques);
+	thisPool->deques = NULL;
+	free(thisPool->busyTime);
+	thisPool->busyTime = NULL;
+	free(thisPool->threads);
+	thisPool->threads = NULL;
+	free(thisPool->workerArgs);
+	thisPool->workerArgs = NULL;
+	free(thisPool->funneledIds);
+	thisPool->funneledIds = NULL;
+	free(thisPool->takenIds);
+	thisPool->takenIds = NULL;
+	free(thisPool->pollIds);
+	thisPool->pollIds = NULL;
+	free(thisPool->tasks);
+	thisPool->tasks = NULL;
+	thisPool->nTasks = 0;
+	thisPool->capacity = 0;
+	return 0;
+};
@@ -0,0 +1,96 @@
+#ifndef __TASKPAR_H__
+#define __TASKPAR_H__
+#include <pthread.h>
+
+// A small task runtime for the work inside one rank: a graph of tasks with explicit dependencies, run by a
+// pool of threads that each keep a deque of ready tasks and steal from the others' when theirs runs dry.
+// The thread that calls runTasksLoc is worker 0 and the only one that runs funneled tasks, so tasks making
+// MPI calls only need MPI_THREAD_FUNNELED.
+#define TASK_MAX_SUCC 8 // most tasks one task can release
+
+// kinds of task
+#define TASK_RUN 0 // runs once its dependencies are done, on any worker
+#define TASK_FUNNELED 1 // same, but only on worker 0
+#define TASK_POLL 2 // once its dependencies are done, worker 0 calls it between other tasks until it returns nonzero
+
+// what a task runs: arg is what it was added with, worker is the worker running it (0 to nThreads-1).
+// TASK_POLL tasks return nonzero once finished; the return value of the others is ignored.
+typedef int (*taskFunc)(void *arg, int worker);
+
+typedef struct task_struct{
+	taskFunc func; // what it runs
+	void *arg; // passed to func
+	int kind; // TASK_RUN, TASK_FUNNELED or TASK_POLL
+	int label; // the caller's label for it, e.g. what it does (only used for the timing)
+	int nDeps; // number of tasks that must finish before it can start
+	int depsLeft; // of those, the ones not yet finished in this run (updated atomically)
+	int nSucc; // number of tasks waiting on it
+	int succ[TASK_MAX_SUCC]; // ids of the tasks waiting on it
+	double start; // seconds after the run started it began (for TASK_POLL, when it was first polled)
+	double end; // seconds after the run started it finished
+	int worker; // worker that ran it
+	int stolen; // 1 if it was stolen from another worker's deque
+} task;
+
+// one worker's deque of ready task ids: the owner pushes and pops at the bottom, thieves take from the top
+typedef struct taskDeque_struct{
+	pthread_mutex_t lock;
+	int *ids; // ring buffer of capacity ids
+	int capacity;
+	int top; // next id thieves take (counts up forever, index modulo capacity)
+	int bottom; // one past the owner's next id
+} taskDeque;
+
+typedef struct taskPool_struct{
+	int nThreads; // workers, counting the one calling runTasksLoc
+	pthread_t *threads; // the other nThreads-1 workers
+	void *workerArgs; // what each of them was started with
+
+	// the graph
+	int nTasks;
+	int capacity;
+	task *tasks;
+
+	// the current run
+	taskDeque *deques; // one per worker
+	int *funneledIds; // ready TASK_FUNNELED and TASK_POLL tasks worker 0 hasn't taken yet
+	int nFunneled;
+	pthread_mutex_t funneledLock; // any worker can add to funneledIds when it releases one
+	int *takenIds; // worker 0's copy of the ones it took
+	int *pollIds; // TASK_POLL tasks worker 0 is polling
+	int nPolling;
+	int remaining; // tasks not yet finished (updated atomically)
+	int nActive; // other workers still in this run (updated atomically)
+	double runStart; // monotonic clock seconds when the run started
+
+	// waking the workers for a run, and shutting them down
+	pthread_mutex_t runLock;
+	pthread_cond_t runCond;
+	int generation; // counts runs, so a worker knows a new one started
+	int shutdown;
+
+	// totals over every run
+	long nRun; // tasks run
+	long nStolen; // of those, stolen ones
+	double *busyTime; // seconds each worker spent in tasks (TASK_POLL ones excluded)
+} taskPool;
+
+// Start a pool of nThreads workers (the caller is one of them), with an empty graph
+int initTaskPoolLoc(taskPool *thisPool, int nThreads);
+
+// Empty the graph (e.g. to build the next step's)
+int clearTasksLoc(taskPool *thisPool);
+
+// Add a task to the graph, returning its id (or -1 if there wasn't space for it)
+int addTaskLoc(taskPool *thisPool, taskFunc func, void *arg, int kind, int label);
+
+// Make task after wait on task before (ids from addTaskLoc; negative ids are ignored, so optional tasks
+// can be passed straight through)
+int addDepLoc(taskPool *thisPool, int before, int after);
+
+// Run every task of the graph once, in an order respecting its dependencies, and return once all are done
+int runTasksLoc(taskPool *thisPool);
+
+// Stop the workers and free everything
+int cleanupTaskPoolLoc(taskPool *thisPool);
+#endif
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/allocPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/allocSimPar Nx NyTotal nSteps stepsPerCheckPt
+// Runs the bigSim setup twice, first with the state and snapshot arrays on cache line aligned ordinary pages
+// (ALLOC_ALIGNED) and then on huge pages (ALLOC_HUGE). Reports the run time of each and, while the arrays are
+// still allocated, every rank's allocation statistics (huge page backing, TLB entries, NUMA placement).
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 2048;
+	unsigned int NyTotal = 2048;
+	int nSteps = 200;
+	int stepsPerCheckPt = 50;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+	}
+
+	// setup the material like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+
+	int policies[2] = {ALLOC_ALIGNED, ALLOC_HUGE};
+	const char *names[2] = {"Aligned ordinary pages", "Huge pages"};
+	long nSnapPts = (long)calcNSnapsLoc(nSteps, stepsPerCheckPt) * Nx * thisMaterialLoc.NyLocal;
+	real_t *firstSnaps = malloc((nSnapPts + 1)*sizeof(real_t)); // the first policy's snapshots, which the second must match
+	int p;
+	for(p=0; p<2; ++p){
+		flag = setAllocPolicyLoc(policies[p]);
+		simLoc thisSimLoc;
+		flag += initSimLoc(&thisSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+		checkPtTimeLoc checkLoc;
+		MPI_Barrier(MPI_COMM_WORLD);
+		double start = MPI_Wtime();
+		flag += runSimLoc(&thisSimLoc, nSteps, stepsPerCheckPt, &checkLoc);
+		MPI_Barrier(MPI_COMM_WORLD);
+		double runTime = MPI_Wtime() - start;
+		if(flag){
+			printf("WARNING: issue in the run \n");
+			failed = 1;
+		}
+		if(rank == 0) printf("%s: %u x %u points on %d ranks, %d steps in %f seconds \n", names[p], Nx, NyTotal, nProcs, nSteps, runTime);
+		reportAllocLoc(MPI_COMM_WORLD);
+		if(p == 0) memcpy(firstSnaps, checkLoc.stateSnapshotsLoc, nSnapPts*sizeof(real_t));
+		else if(memcmp(firstSnaps, checkLoc.stateSnapshotsLoc, nSnapPts*sizeof(real_t)) != 0){
+			printf("ERROR: rank %d's snapshots differ between the allocation policies \n", rank);
+			failed = 1;
+		}
+		cleanupSimLoc(&thisSimLoc);
+		cleanupCheckPtTimeLoc(&checkLoc);
+	}
+	free(firstSnaps);
+	free(initTemp);
+	initTemp = NULL;
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/amrPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/amrSimPar Nx NyTotal nSteps gradTol bufferCells regridEvery
+// Runs two spreading Gaussian hot spots on an Nx x NyTotal grid with refined patches around them,
+// on the same grid without refinement, and on a uniform grid with half the spacing everywhere.
+// Reports the number of cell updates and the largest error against the exact solution for each,
+// and writes the final patches to results/amrPatches.txt.
+
+// exact temperature at (x, y) at time t of two Gaussian hot spots spreading in a Lx x Ly box
+// (0.1 in the background; the spots are far enough from the edges to ignore them)
+float exactTemp(float x, float y, float t, float Lx, float Ly, float alpha){
+	float sigma2 = 9.0 + 2*alpha*t;
+	float r1 = (x - 0.4*Lx)*(x - 0.4*Lx) + (y - 0.35*Ly)*(y - 0.35*Ly);
+	float r2 = (x - 0.65*Lx)*(x - 0.65*Lx) + (y - 0.7*Ly)*(y - 0.7*Ly);
+	return 0.1 + (9.0/sigma2)*(100.0*exp(-r1/(2*sigma2)) + 50.0*exp(-r2/(2*sigma2)));
+}
+
+// fill in the hot spots at time 0, with the grid point spacing h
+void fillInitTemp(float *initTemp, unsigned int Nx, unsigned int NyTotal, float h, float Lx, float Ly, float alpha){
+	int row,col;
+	for(row=0; row<NyTotal; ++row){
+		for(col=0; col<Nx; ++col){
+			initTemp[col+(row*Nx)] = exactTemp(col*h, row*h, 0.0, Lx, Ly, alpha);
+		}
+	}
+}
+
+// gather the unpadded local states into global (Nx x NyTotal) on rank 0
+void gatherState(materialLoc *thisMaterialLoc, simLoc *thisSimLoc, float *global){
+	int nProcs;
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int *counts = malloc(nProcs*sizeof(int));
+	int *displs = malloc(nProcs*sizeof(int));
+	int myCount = thisMaterialLoc->Nx * thisMaterialLoc->NyLocal;
+	int myDispl = thisMaterialLoc->Nx * thisMaterialLoc->startYId;
+	MPI_Allgather(&myCount, 1, MPI_INT, counts, 1, MPI_INT, MPI_COMM_WORLD);
+	MPI_Allgather(&myDispl, 1, MPI_INT, displs, 1, MPI_INT, MPI_COMM_WORLD);
+	MPI_Gatherv(thisSimLoc->priorStateLoc + thisMaterialLoc->Nx*thisMaterialLoc->nPadRows, myCount, MPI_FLOAT, global, counts, displs, MPI_FLOAT, 0, MPI_COMM_WORLD);
+	free(counts);
+	free(displs);
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 128;
+	unsigned int NyTotal = 128;
+	int nSteps = 200;
+	float gradTol = 1.0;
+	int bufferCells = 3;
+	int regridEvery = 10;
+	if(argc > 6){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		gradTol = atof(argv[4]);
+		bufferCells = atoi(argv[5]);
+		regridEvery = atoi(argv[6]);
+	}
+
+	// setup the coarse and fine materials
+	float alpha = 1.0;
+	float h = 1.0;
+	float dt = 0.2;
+	int nPadRows = 1;
+	float boundary = 0.1;
+	unsigned int NxFine = 2*Nx - 1;
+	unsigned int NyFine = 2*NyTotal - 1;
+	materialLoc thisMaterialLoc;
+	materialLoc fineMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, h, h, alpha);
+	flag += initMaterialLoc(&fineMaterialLoc, NxFine, NyFine, nPadRows, h/2, h/2, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	float *initFine = malloc(NxFine*NyFine*sizeof(float));
+	float Lx = (Nx-1)*h;
+	float Ly = (NyTotal-1)*h;
+	fillInitTemp(initTemp, Nx, NyTotal, h, Lx, Ly, alpha);
+	fillInitTemp(initFine, NxFine, NyFine, h/2, Lx, Ly, alpha);
+
+	// coarse grid with refined patches
+	simLoc amrSimLoc;
+	amrLoc thisAmrLoc;
+	flag = initSimLoc(&amrSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += initAmrLoc(&thisAmrLoc, &amrSimLoc, gradTol, bufferCells, regridEvery);
+	if(flag){
+		printf("WARNING: issue setting up refinement \n");
+		failed = 1;
+	}
+	int startPatches = thisAmrLoc.nPatches;
+	checkPtTimeLoc amrCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimAmrLoc(&thisAmrLoc, nSteps + 1, nSteps, &amrCheckLoc);
+	double amrTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running refined simulation \n");
+		failed = 1;
+	}
+
+	// coarse grid only
+	simLoc coarseSimLoc;
+	flag = initSimLoc(&coarseSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	checkPtTimeLoc coarseCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag += runSimLoc(&coarseSimLoc, nSteps + 1, nSteps, &coarseCheckLoc);
+	double coarseTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running coarse simulation \n");
+		failed = 1;
+	}
+
+	// fine grid everywhere as the reference
+	simLoc fineSimLoc;
+	flag = initSimLoc(&fineSimLoc, dt/AMR_SUBSTEPS, initFine, boundary, &fineMaterialLoc);
+	checkPtTimeLoc fineCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag += runSimLoc(&fineSimLoc, AMR_SUBSTEPS*nSteps + 1, AMR_SUBSTEPS*nSteps, &fineCheckLoc);
+	double fineTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running fine simulation \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+	free(initFine);
+	initFine = NULL;
+
+	// collect everything on rank 0
+	float *amrEnd = NULL;
+	float *coarseEnd = NULL;
+	float *fineEnd = NULL;
+	float *patchEnd = NULL;
+	if(rank == 0){
+		amrEnd = malloc(Nx*NyTotal*sizeof(float));
+		coarseEnd = malloc(Nx*NyTotal*sizeof(float));
+		fineEnd = malloc(NxFine*NyFine*sizeof(float));
+		patchEnd = malloc((amrFineCount(&thisAmrLoc) + 1)*sizeof(float));
+	}
+	gatherState(&thisMaterialLoc, &amrSimLoc, amrEnd);
+	gatherState(&thisMaterialLoc, &coarseSimLoc, coarseEnd);
+	gatherState(&fineMaterialLoc, &fineSimLoc, fineEnd);
+	gatherAmrLoc(&thisAmrLoc, patchEnd);
+	long localFineSteps = thisAmrLoc.fineCellSteps;
+	long fineSteps;
+	MPI_Reduce(&localFineSteps, &fineSteps, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+	flag = writeAmrLoc(&thisAmrLoc, "results/amrPatches.txt");
+	if(flag){
+		printf("WARNING: issue writing patches \n");
+		failed = 1;
+	}
+
+	if(rank == 0){
+		float t = nSteps*dt;
+		float amrErr = 0.0;
+		float coarseErr = 0.0;
+		float fineErr = 0.0;
+		int i, j, p;
+		for(j=0; j<NyTotal; ++j){
+			for(i=0; i<Nx; ++i){
+				float exact = exactTemp(i*h, j*h, t, Lx, Ly, alpha);
+				coarseErr = fmaxf(coarseErr, fabsf(coarseEnd[i + j*Nx] - exact));
+				int covered = 0;
+				for(p=0; p<thisAmrLoc.nPatches; ++p){
+					amrPatch *pt = &(thisAmrLoc.patches[p]);
+					if((i >= pt->i0) && (i < pt->i0 + pt->ni) && (j >= pt->j0) && (j < pt->j0 + pt->nj)) covered = 1;
+				}
+				if(!covered) amrErr = fmaxf(amrErr, fabsf(amrEnd[i + j*Nx] - exact));
+			}
+		}
+		for(j=0; j<NyFine; ++j){
+			for(i=0; i<NxFine; ++i){
+				fineErr = fmaxf(fineErr, fabsf(fineEnd[i + j*NxFine] - exactTemp(i*h/2, j*h/2, t, Lx, Ly, alpha)));
+			}
+		}
+		// fine cell fi of a patch is centered a quarter of a cell from coarse grid point i0 + fi/2
+		int offset = 0;
+		for(p=0; p<thisAmrLoc.nPatches; ++p){
+			amrPatch *pt = &(thisAmrLoc.patches[p]);
+			int fi, fj;
+			for(fj=0; fj<2*pt->nj; ++fj){
+				for(fi=0; fi<2*pt->ni; ++fi){
+					float x = (2*pt->i0 + fi - 0.5)*h/2;
+					float y = (2*pt->j0 + fj - 0.5)*h/2;
+					amrErr = fmaxf(amrErr, fabsf(patchEnd[offset + fj*2*pt->ni + fi] - exactTemp(x, y, t, Lx, Ly, alpha)));
+				}
+			}
+			offset += 4*pt->ni*pt->nj;
+		}
+		long coarseCellSteps = (long)Nx*NyTotal*nSteps;
+		long fineCellSteps = (long)NxFine*NyFine*AMR_SUBSTEPS*nSteps;
+		printf("%d coarse steps of %f on %u x %u points, refining where the change per cell is above %f \n", nSteps, dt, Nx, NyTotal, gradTol);
+		printf("Patches: %d at the start, %d at the end covering %d fine cells \n", startPatches, thisAmrLoc.nPatches, amrFineCount(&thisAmrLoc));
+		printf("Coarse only: %ld cell updates, %f seconds wall, max error %f \n", coarseCellSteps, coarseTime, coarseErr);
+		printf("Refined: %ld cell updates, %f seconds wall, max error %f \n", coarseCellSteps + fineSteps, amrTime, amrErr);
+		printf("Fine everywhere: %ld cell updates, %f seconds wall, max error %f \n", fineCellSteps, fineTime, fineErr);
+		// the patches sit where the coarse error is, so refining should get close to the fine grid's error
+		if((amrErr >= coarseErr) || (amrErr > 1.5*fineErr)){
+			printf("ERROR: refinement doesn't bring the error down near the fine grid's \n");
+			failed = 1;
+		}
+		free(amrEnd);
+		free(coarseEnd);
+		free(fineEnd);
+		free(patchEnd);
+	}
+
+	// cleanup
+	cleanupAmrLoc(&thisAmrLoc);
+	cleanupSimLoc(&amrSimLoc);
+	cleanupSimLoc(&coarseSimLoc);
+	cleanupSimLoc(&fineSimLoc);
+	cleanupCheckPtTimeLoc(&amrCheckLoc);
+	cleanupCheckPtTimeLoc(&coarseCheckLoc);
+	cleanupCheckPtTimeLoc(&fineCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/autotuneSimPar Nx NyTotal nSteps nTrialSteps
+// Runs the bigSim setup for nSteps steps with the default step and with the configuration autotuneLoc
+// picks (trials of nTrialSteps steps, cached in results/autotune.cache, which is started afresh), then
+// tunes a second simulation to show it comes from the cache. Reports timings, the choice, and whether
+// the final states are identical.
+
+// number of points of this rank's rows that differ between two simulations, summed on rank 0
+int countMismatches(simLoc *simA, simLoc *simB, materialLoc *thisMaterialLoc){
+	int nPad = thisMaterialLoc->Nx * thisMaterialLoc->nPadRows;
+	int nLocal = thisMaterialLoc->Nx * thisMaterialLoc->NyLocal;
+	int localMismatches = 0, mismatches = 0;
+	int i;
+	for(i=nPad; i<nPad+nLocal; ++i){
+		if(simA->priorStateLoc[i] != simB->priorStateLoc[i]) localMismatches++;
+	}
+	MPI_Reduce(&localMismatches, &mismatches, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+	return mismatches;
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 200;
+	int nTrialSteps = 5;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		nTrialSteps = atoi(argv[4]);
+	}
+	const char *cacheFilename = "results/autotune.cache";
+	if(rank == 0) remove(cacheFilename);
+
+	// setup the material
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	float boundary = 0.1;
+
+	// the default step
+	simLoc defaultSimLoc;
+	flag = initSimLoc(&defaultSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	checkPtTimeLoc defaultCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag += runSimLoc(&defaultSimLoc, nSteps + 1, nSteps, &defaultCheckLoc);
+	double defaultTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running the default simulation \n");
+		failed = 1;
+	}
+
+	// tuned by trials (the tuning is timed along with the run)
+	simLoc tunedSimLoc;
+	flag = initSimLoc(&tunedSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	checkPtTimeLoc tunedCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag += autotuneLoc(&tunedSimLoc, nTrialSteps, cacheFilename);
+	double tuneTime = MPI_Wtime() - start;
+	flag += runSimLoc(&tunedSimLoc, nSteps + 1, nSteps, &tunedCheckLoc);
+	double tunedTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running the tuned simulation \n");
+		failed = 1;
+	}
+
+	// tuned again, which should come from the cache
+	simLoc cachedSimLoc;
+	flag = initSimLoc(&cachedSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	checkPtTimeLoc cachedCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag += autotuneLoc(&cachedSimLoc, nTrialSteps, cacheFilename);
+	double cacheTime = MPI_Wtime() - start;
+	flag += runSimLoc(&cachedSimLoc, nSteps + 1, nSteps, &cachedCheckLoc);
+	if(flag){
+		printf("WARNING: issue in running the cached simulation \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	int mismatches = countMismatches(&defaultSimLoc, &tunedSimLoc, &thisMaterialLoc);
+	mismatches += countMismatches(&defaultSimLoc, &cachedSimLoc, &thisMaterialLoc);
+	if(rank == 0){
+		printf("%d steps on %u x %u points, %d trial steps per candidate \n", nSteps, Nx, NyTotal, nTrialSteps);
+		printf("Chose kernel %s, tiles %d x %d (%f seconds per step in the trials) \n", (tunedSimLoc.kernelVariant == KERNEL_ROWS) ? "rows" : "point", tunedSimLoc.tileRows, tunedSimLoc.tileCols, tunedSimLoc.tunedStepTime);
+		printf("Default: %f seconds wall \n", defaultTime);
+		printf("Tuned:   %f seconds wall, %f of them tuning \n", tunedTime, tuneTime);
+		if(cachedSimLoc.tunedFromCache && (cachedSimLoc.kernelVariant == tunedSimLoc.kernelVariant) && (cachedSimLoc.tileRows == tunedSimLoc.tileRows) && (cachedSimLoc.tileCols == tunedSimLoc.tileCols)) printf("Second tuning came from the cache in %f seconds \n", cacheTime);
+		else{
+			printf("ERROR: second tuning didn't come from the cache \n");
+			failed = 1;
+		}
+		if(mismatches == 0) printf("Final states are identical \n");
+		else{
+			printf("ERROR: %d points differ from the default final state \n", mismatches);
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	cleanupSimLoc(&defaultSimLoc);
+	cleanupSimLoc(&tunedSimLoc);
+	cleanupSimLoc(&cachedSimLoc);
+	cleanupCheckPtTimeLoc(&defaultCheckLoc);
+	cleanupCheckPtTimeLoc(&tunedCheckLoc);
+	cleanupCheckPtTimeLoc(&cachedCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/balanceSimPar Nx NyTotal nSteps stepsPerCheckPt balanceEvery tol
+// Runs the bigSim setup with quiescent tile skipping (so ranks far from the sources have little to
+// do) once with the even row split and once with dynamic load balancing, then reports the imbalance,
+// the rebalancing cost, the final rows of every rank, and whether both runs wrote the same snapshots.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 400;
+	int stepsPerCheckPt = 100;
+	int balanceEvery = 20;
+	float tol = 0.1;
+	if(argc > 6){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+		balanceEvery = atoi(argv[5]);
+		tol = atof(argv[6]);
+	}
+
+	// setup (each run gets its own material, since balancing moves its rows)
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc evenMaterialLoc, balancedMaterialLoc;
+	int flag = initMaterialLoc(&evenMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	flag += initMaterialLoc(&balancedMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+
+	// even split
+	simLoc evenSimLoc;
+	flag = initSimLoc(&evenSimLoc, dt, initTemp, boundary, &evenMaterialLoc);
+	flag += setTilingLoc(&evenSimLoc, 16, 64);
+	checkPtTimeLoc evenCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag += runSimLoc(&evenSimLoc, nSteps + 1, stepsPerCheckPt, &evenCheckLoc);
+	double evenTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running the evenly split simulation \n");
+		failed = 1;
+	}
+	// measure its imbalance over the whole run (no rows move since the tolerance is huge)
+	evenSimLoc.balanceTol = 1e30;
+	rebalanceLoc(&evenSimLoc, NULL);
+
+	// balanced
+	simLoc balancedSimLoc;
+	flag = initSimLoc(&balancedSimLoc, dt, initTemp, boundary, &balancedMaterialLoc);
+	flag += setTilingLoc(&balancedSimLoc, 16, 64);
+	flag += setBalanceLoc(&balancedSimLoc, balanceEvery, tol);
+	checkPtTimeLoc balancedCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag += runSimLoc(&balancedSimLoc, nSteps + 1, stepsPerCheckPt, &balancedCheckLoc);
+	double balancedTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running the balanced simulation \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	// write both, and compare
+	flag = writeToFileLoc(&evenCheckLoc, "results/balanceEven.txt");
+	flag += writeToFileLoc(&balancedCheckLoc, "results/balanceDynamic.txt");
+	if(flag){
+		printf("WARNING: issue writing checkpoint files \n");
+		failed = 1;
+	}
+	int *rows = malloc(nProcs*sizeof(int));
+	int myRows = balancedMaterialLoc.NyLocal;
+	MPI_Gather(&myRows, 1, MPI_INT, rows, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	if(rank == 0){
+		printf("%d steps on %u x %u points with tile skipping \n", nSteps, Nx, NyTotal);
+		printf("Even split: %f seconds wall, slowest rank's compute is %.2f times the average \n", evenTime, evenSimLoc.lastImbalance);
+		printf("Balanced every %d steps: %f seconds wall, %d of %d checks moved rows, %f seconds spent balancing \n", balanceEvery, balancedTime, balancedSimLoc.nRebalances, balancedSimLoc.nBalanceChecks, balancedSimLoc.rebalanceTime);
+		printf("Imbalance in the last window: %.2f (predicted after the last move %.2f) \n", balancedSimLoc.lastImbalance, balancedSimLoc.predictedImbalance);
+		printf("Final rows per rank:");
+		int r;
+		for(r=0; r<nProcs; ++r) printf(" %d", rows[r]);
+		printf("\n");
+		if(sameFile("results/balanceEven.txt", "results/balanceDynamic.txt")) printf("Snapshots are identical \n");
+		else{
+			printf("ERROR: snapshots differ between the even and balanced runs \n");
+			failed = 1;
+		}
+	}
+	free(rows);
+
+	// cleanup
+	cleanupSimLoc(&evenSimLoc);
+	cleanupSimLoc(&balancedSimLoc);
+	cleanupCheckPtTimeLoc(&evenCheckLoc);
+	cleanupCheckPtTimeLoc(&balancedCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/material3DPar.h"
+#include "../code/checkPt3DPar.h"
+#include "../code/simulation3DPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/bigSim3D Nx Ny Nz stepsPerCheckPt [nSteps] [writeFile] [blockY]
+// The 3D counterpart of bigSim: 0.1 everywhere with 3 hot sources, boundary held at 0.1, 100 steps
+// unless nSteps is given, snapshots written to results/bigSim3D.txt unless writeFile is 0 (for timing
+// runs, where the text file would take longer than the simulation).
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	double starttime = MPI_Wtime(); // start timer of simulation
+
+	unsigned int Nx = 64;
+	unsigned int Ny = 64;
+	unsigned int Nz = 64;
+	int stepsPerCheckPt = 25;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		Ny = atoi(argv[2]);
+		Nz = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+	}
+	int timeSteps = 100;
+	if(argc > 5) timeSteps = atoi(argv[5]);
+	int writeFile = 1;
+	if(argc > 6) writeFile = atoi(argv[6]);
+
+	// setup the material (same spacing as bigSim, with dz = dy)
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	float dz = 1.0;
+	int nPad = 1;
+	material3DLoc thisMaterialLoc;
+	int flag = initMaterial3DLoc(&thisMaterialLoc, Nx, Ny, Nz, nPad, dx, dy, dz, alpha);
+	if(flag) printf("WARNING: error in initMaterial3DLoc \n");
+
+	// setup the initial temperature field globally over the whole region
+	long nPts = (long)Nx*Ny*Nz;
+	float *initTemp = malloc(nPts*sizeof(float));
+	float boundary = 0.1;
+	long i;
+	for(i=0; i<nPts; ++i) initTemp[i] = 0.1;
+	initTemp[(Nx/2) + (long)Nx*((Ny/3) + (long)Ny*(Nz/2))] = 100.0;
+	initTemp[(3*Nx/4) + (long)Nx*((Ny/4) + (long)Ny*(Nz/3))] = 10.0;
+	initTemp[(Nx/3) + (long)Nx*((2*Ny/3) + (long)Ny*(2*Nz/3))] = 150.0;
+
+	// setup the simulation
+	float dt = 0.1;
+	sim3DLoc thisSimLoc;
+	flag = initSim3DLoc(&thisSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	if(argc > 7) flag += setBlocking3DLoc(&thisSimLoc, atoi(argv[7]));
+	if(flag) printf("WARNING: issue initializing 3D simulation local blocks \n");
+	free(initTemp);
+	initTemp = NULL;
+
+	// run
+	checkPtTime3DLoc checkLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double runStart = MPI_Wtime();
+	flag = runSim3DLoc(&thisSimLoc, timeSteps, stepsPerCheckPt, &checkLoc);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double runTime = MPI_Wtime() - runStart;
+	if(flag) printf("WARNING: issue in running 3D simulation \n");
+
+	if(writeFile){
+		flag = writeToFile3DLoc(&checkLoc, "results/bigSim3D.txt");
+		if(flag) printf("WARNING: issue writing checkpoint file \n");
+	}
+	if(rank == 0){
+		printf("%d ranks as %d x %d x %d blocks of about %u x %u x %u points \n", nProcs, thisMaterialLoc.dims[0], thisMaterialLoc.dims[1], thisMaterialLoc.dims[2], thisMaterialLoc.NxLocal, thisMaterialLoc.NyLocal, thisMaterialLoc.NzLocal);
+		printf("%d steps on %u x %u x %u points: %f seconds, %f million point updates per second \n", timeSteps - 1, Nx, Ny, Nz, runTime, (double)nPts*(timeSteps - 1)/runTime/1e6);
+	}
+
+	// cleanup
+	flag = cleanupSim3DLoc(&thisSimLoc);
+	flag += cleanupCheckPtTime3DLoc(&checkLoc);
+	flag += cleanupMaterial3DLoc(&thisMaterialLoc);
+	if(flag) printf("WARNING: issue cleaning up \n");
+
+	double endtime = MPI_Wtime();
+	printf("Timing on rank %d: %f seconds\n",rank,endtime-starttime);
+
+	MPI_Finalize();
+	return 0;
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/simulationPar.h"
+#include "../code/ensemblePar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/ensemblePar Nx NyTotal nSteps nGroups batchSize
+// Runs a 32 member parameter sweep (4 diffusivities x 2 boundary values x 2 source placements x 2 time
+// steps) as one ensemble: nGroups groups of ranks, each stepping batchSize members at a time. Then runs
+// every member on its own over all ranks, like separate jobs would, compares the results and times,
+// and writes the ensemble's results to results/ensemble.txt.
+
+// the bigSim hot spots, or one hot spot in the middle
+void placeSources(ensembleMember *member, int placement, unsigned int Nx, unsigned int NyTotal){
+	if(placement == 0){
+		member->nSources = 3;
+		member->srcCol[0] = Nx/2; member->srcRow[0] = NyTotal/3; member->srcVal[0] = 100.0;
+		member->srcCol[1] = 3*Nx/4; member->srcRow[1] = NyTotal/4; member->srcVal[1] = 10.0;
+		member->srcCol[2] = Nx/3; member->srcRow[2] = 2*NyTotal/3; member->srcVal[2] = 150.0;
+	}
+	else{
+		member->nSources = 1;
+		member->srcCol[0] = Nx/2; member->srcRow[0] = NyTotal/2; member->srcVal[0] = 150.0;
+	}
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 100;
+	unsigned int NyTotal = 200;
+	int nSteps = 200;
+	int nGroups = 2;
+	int batchSize = 8;
+	if(argc > 5){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		nGroups = atoi(argv[4]);
+		batchSize = atoi(argv[5]);
+	}
+
+	// the sweep
+	float dx = 1.5;
+	float dy = 1.0;
+	float alphas[4] = {1.0, 2.0, 3.0, 4.0};
+	float bdryVals[2] = {0.1, 1.0};
+	float dtFractions[2] = {0.4, 0.8}; // of each member's stability limit
+	int nMembers = 32;
+	ensembleMember *members = malloc(nMembers*sizeof(ensembleMember));
+	int a, bd, placement, d, m = 0;
+	for(a=0; a<4; ++a){
+		for(bd=0; bd<2; ++bd){
+			for(placement=0; placement<2; ++placement){
+				for(d=0; d<2; ++d){
+					members[m].alpha = alphas[a];
+					members[m].bdryVal = bdryVals[bd];
+					members[m].initVal = bdryVals[bd];
+					members[m].dt = dtFractions[d] * dy*dy/(4*alphas[a]);
+					placeSources(&members[m], placement, Nx, NyTotal);
+					m++;
+				}
+			}
+		}
+	}
+
+	// ensemble run
+	ensembleLoc thisEnsLoc;
+	int flag = initEnsembleLoc(&thisEnsLoc, nGroups, batchSize, nMembers, members, Nx, NyTotal, dx, dy);
+	if(flag){
+		printf("WARNING: issue initializing the ensemble \n");
+		failed = 1;
+	}
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runEnsembleLoc(&thisEnsLoc, nSteps);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double ensembleTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running the ensemble \n");
+		failed = 1;
+	}
+	flag = writeEnsembleLoc(&thisEnsLoc, "results/ensemble.txt");
+	if(flag){
+		printf("WARNING: issue writing results/ensemble.txt \n");
+		failed = 1;
+	}
+
+	// every member on its own over all ranks
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	int nMismatch = 0;
+	double maxMeanErr = 0.0;
+	double separateTime = 0.0;
+	for(m=0; m<nMembers; ++m){
+		materialLoc thisMaterialLoc;
+		flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, 1, dx, dy, members[m].alpha);
+		fillEnsembleInitGlobal(&members[m], initTemp, Nx, NyTotal);
+		simLoc thisSimLoc;
+		flag += initSimLoc(&thisSimLoc, members[m].dt, initTemp, members[m].bdryVal, &thisMaterialLoc);
+		if(flag) printf("WARNING: issue initializing member %d on its own \n", m);
+		MPI_Barrier(MPI_COMM_WORLD);
+		start = MPI_Wtime();
+		int step;
+		for(step=0; step<nSteps; ++step) oneStepLoc(&thisSimLoc);
+		MPI_Barrier(MPI_COMM_WORLD);
+		separateTime += MPI_Wtime() - start;
+
+		// same results as runEnsembleLoc reports
+		int nLocal = Nx*thisMaterialLoc.NyLocal;
+		real_t *stateLoc = &(thisSimLoc.priorStateLoc[Nx*thisMaterialLoc.nPadRows]);
+		double sumLoc = 0.0, sum;
+		float minLoc = stateLoc[0], maxLoc = stateLoc[0], minVal, maxVal;
+		int i;
+		for(i=0; i<nLocal; ++i){
+			float val = loadReal(stateLoc[i]);
+			sumLoc += val;
+			if(val < minLoc) minLoc = val;
+			if(val > maxLoc) maxLoc = val;
+		}
+		MPI_Allreduce(&sumLoc, &sum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+		MPI_Allreduce(&minLoc, &minVal, 1, MPI_FLOAT, MPI_MIN, MPI_COMM_WORLD);
+		MPI_Allreduce(&maxLoc, &maxVal, 1, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+		double meanErr = fabs(sum/((double)Nx*NyTotal) - thisEnsLoc.finalMean[m]);
+		if(meanErr > maxMeanErr) maxMeanErr = meanErr;
+		// the extremes don't depend on the summation order, so they must match exactly
+		if((minVal != thisEnsLoc.finalMin[m]) || (maxVal != thisEnsLoc.finalMax[m]) || (meanErr > 1e-6*fabs(thisEnsLoc.finalMean[m]))) nMismatch++;
+		cleanupSimLoc(&thisSimLoc);
+	}
+	free(initTemp);
+
+	// report
+	double groupExchangeTime = thisEnsLoc.exchangeTime;
+	double maxExchangeTime;
+	MPI_Reduce(&groupExchangeTime, &maxExchangeTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+	if(rank == 0){
+		printf("%d members, %d steps each on %u x %u points \n", nMembers, nSteps, Nx, NyTotal);
+		printf("Ensemble of %d groups of %d ranks, batches of %d: %f seconds wall (at most %f seconds in halo exchanges), %d batches in group 0 \n", nGroups, nProcs/nGroups, batchSize, ensembleTime, maxExchangeTime, thisEnsLoc.nBatches);
+		printf("Members one after another over all %d ranks: %f seconds wall \n", nProcs, separateTime);
+		printf("Largest difference in a mean temperature: %e \n", maxMeanErr);
+		if(nMismatch == 0) printf("Every member matches its separate run \n");
+		else{
+			printf("ERROR: %d members differ from their separate runs \n", nMismatch);
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	free(members);
+	cleanupEnsembleLoc(&thisEnsLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/implicitPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/implicitSimPar Nx NyTotal dtRatio nImplicitSteps precond
+// where dtRatio is the implicit time step in units of dtMax and precond is 0 (Jacobi) or 1 (Chebyshev).
+// Runs the bigSim setup to the same final time with the explicit scheme and with backward Euler,
+// then reports CG iterations per step, timings per simulated second, and the difference between them.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 100;
+	unsigned int NyTotal = 400;
+	int dtRatio = 20;
+	int nImplicitSteps = 10;
+	int precond = PRECOND_CHEBYSHEV;
+	if(argc > 5){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		dtRatio = atoi(argv[3]);
+		nImplicitSteps = atoi(argv[4]);
+		precond = atoi(argv[5]);
+	}
+
+	// setup the material
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	float boundary = 0.1;
+
+	// explicit run with a stable step, dtRatio explicit steps per implicit step
+	simLoc explicitSimLoc;
+	flag = initSimLoc(&explicitSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	float dtImplicit = explicitSimLoc.dtMax * dtRatio;
+	explicitSimLoc.dt = dtImplicit / (dtRatio + 1); // just under dtMax
+	int nExplicitSteps = nImplicitSteps * (dtRatio + 1);
+	checkPtTimeLoc explicitCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimLoc(&explicitSimLoc, nExplicitSteps + 1, nExplicitSteps, &explicitCheckLoc);
+	double explicitTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running explicit simulation \n");
+		failed = 1;
+	}
+
+	// implicit run to the same final time
+	simLoc implicitSimLoc;
+	flag = initSimLoc(&implicitSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	implicitLoc thisImpLoc;
+	flag = initImplicitLoc(&thisImpLoc, &implicitSimLoc, dtImplicit, precond, 1e-5, 500);
+	if(flag){
+		printf("WARNING: issue initializing implicit solver \n");
+		failed = 1;
+	}
+	checkPtTimeLoc implicitCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag = runSimImplicitLoc(&thisImpLoc, nImplicitSteps + 1, nImplicitSteps, &implicitCheckLoc);
+	double implicitTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running implicit simulation \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	// compare the final states
+	int nPad = Nx * nPadRows;
+	int nLocal = Nx * thisMaterialLoc.NyLocal;
+	float localMaxDiff = 0.0;
+	int i;
+	for(i=nPad; i<nPad+nLocal; ++i){
+		float diff = fabs(explicitSimLoc.priorStateLoc[i] - implicitSimLoc.priorStateLoc[i]);
+		if(diff > localMaxDiff) localMaxDiff = diff;
+	}
+	float maxDiff;
+	MPI_Reduce(&localMaxDiff, &maxDiff, 1, MPI_FLOAT, MPI_MAX, 0, MPI_COMM_WORLD);
+	if(rank == 0){
+		float simTime = nImplicitSteps * dtImplicit;
+		printf("Simulated %f seconds, implicit dt = %d x dtMax \n", simTime, dtRatio);
+		printf("Explicit: %d steps, %f seconds wall, %g wall seconds per simulated second \n", nExplicitSteps, explicitTime, explicitTime/simTime);
+		printf("Implicit: %d steps, %f CG iterations per step, %f seconds wall, %g wall seconds per simulated second \n", nImplicitSteps, (float)thisImpLoc.totalIters/thisImpLoc.nSolves, implicitTime, implicitTime/simTime);
+		printf("Max difference between explicit and implicit final states: %f \n", maxDiff);
+		// backward Euler is only first order, so allow a difference in proportion to its step (about 0.002 per dtMax here)
+		if(maxDiff > 0.005*dtRatio){
+			printf("ERROR: backward Euler strays from the explicit run \n");
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	cleanupImplicitLoc(&thisImpLoc);
+	cleanupSimLoc(&explicitSimLoc);
+	cleanupSimLoc(&implicitSimLoc);
+	cleanupCheckPtTimeLoc(&explicitCheckLoc);
+	cleanupCheckPtTimeLoc(&implicitCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/initSetupPar Nx NyTotal nSteps
+// Sets up the bigSim initial state three ways: from a global array every rank fills (initSimLoc), from a
+// callback that fills only this rank's rows (initSimLocFill), and from a binary file every rank reads its
+// own rows of (initSimLocFile, the file is written in parallel from the callback's rows first). Reports
+// the setup time and initial state memory per rank of each, runs all three, and checks the snapshots agree.
+
+// the same field, one block of rows at a time (ctx points to NyTotal)
+void fillInitRows(float *rowsLoc, unsigned int Nx, unsigned int startRow, unsigned int nRows, void *ctx){
+	unsigned int NyTotal = *(unsigned int *)ctx;
+	unsigned int i;
+	for(i=0; i<Nx*nRows; ++i) rowsLoc[i] = 0.1;
+	unsigned int srcCol[3] = {Nx/2, 3*Nx/4, Nx/3};
+	unsigned int srcRow[3] = {NyTotal/3, NyTotal/4, 2*NyTotal/3};
+	float srcVal[3] = {100.0, 10.0, 150.0};
+	for(i=0; i<3; ++i){
+		if((srcRow[i] >= startRow) && (srcRow[i] < startRow + nRows)) rowsLoc[srcCol[i] + (srcRow[i] - startRow)*Nx] = srcVal[i];
+	}
+}
+
+// largest time any rank spent since start
+double slowestSince(double start){
+	double mine = MPI_Wtime() - start, slowest;
+	MPI_Allreduce(&mine, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+	return slowest;
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 50;
+	if(argc > 3){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+	}
+
+	// setup the material like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	double globalBytes = (double)Nx*NyTotal*sizeof(float);
+	double localBytes = (double)Nx*thisMaterialLoc.NyLocal*sizeof(float);
+
+	// global array on every rank
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	simLoc globalSimLoc;
+	flag = initSimLoc(&globalSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	free(initTemp);
+	initTemp = NULL;
+	double globalTime = slowestSince(start);
+	if(flag){
+		printf("WARNING: issue initializing from the global array \n");
+		failed = 1;
+	}
+
+	// callback for this rank's rows
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	simLoc fillSimLoc;
+	flag = initSimLocFill(&fillSimLoc, dt, fillInitRows, &NyTotal, boundary, &thisMaterialLoc);
+	double fillTime = slowestSince(start);
+	if(flag){
+		printf("WARNING: issue initializing from the callback \n");
+		failed = 1;
+	}
+
+	// write the initial state file in parallel (each rank its own rows), then read it back the same way
+	float *rowsLoc = malloc(Nx*thisMaterialLoc.NyLocal*sizeof(float));
+	fillInitRows(rowsLoc, Nx, thisMaterialLoc.startYId, thisMaterialLoc.NyLocal, &NyTotal);
+	MPI_File fileHandle;
+	MPI_File_open(MPI_COMM_WORLD, "results/initTemp.bin", MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fileHandle);
+	MPI_File_set_size(fileHandle, 0);
+	MPI_File_write_at_all(fileHandle, (MPI_Offset)thisMaterialLoc.startYId*Nx*sizeof(float), rowsLoc, Nx*thisMaterialLoc.NyLocal, MPI_FLOAT, MPI_STATUS_IGNORE);
+	MPI_File_close(&fileHandle);
+	free(rowsLoc);
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	simLoc fileSimLoc;
+	flag = initSimLocFile(&fileSimLoc, dt, "results/initTemp.bin", boundary, &thisMaterialLoc);
+	double fileTime = slowestSince(start);
+	if(flag){
+		printf("WARNING: issue initializing from the file \n");
+		failed = 1;
+	}
+
+	// run all three and write their snapshots
+	checkPtTimeLoc globalCheckLoc, fillCheckLoc, fileCheckLoc;
+	flag = runSimLoc(&globalSimLoc, nSteps + 1, nSteps, &globalCheckLoc);
+	flag += runSimLoc(&fillSimLoc, nSteps + 1, nSteps, &fillCheckLoc);
+	flag += runSimLoc(&fileSimLoc, nSteps + 1, nSteps, &fileCheckLoc);
+	if(flag){
+		printf("WARNING: issue in running the simulations \n");
+		failed = 1;
+	}
+	flag = writeToFileLoc(&globalCheckLoc, "results/initGlobal.txt");
+	flag += writeToFileLoc(&fillCheckLoc, "results/initFill.txt");
+	flag += writeToFileLoc(&fileCheckLoc, "results/initFile.txt");
+	if(flag){
+		printf("WARNING: issue writing checkpoint files \n");
+		failed = 1;
+	}
+
+	if(rank == 0){
+		printf("%u x %u points on %d ranks \n", Nx, NyTotal, nProcs);
+		printf("Global array:  %f seconds setup, %.1f MB of initial state per rank \n", globalTime, globalBytes/1e6);
+		printf("Row callback:  %f seconds setup, %.1f MB of initial state per rank \n", fillTime, localBytes/1e6);
+		printf("Parallel read: %f seconds setup, %.1f MB of initial state per rank \n", fileTime, localBytes/1e6);
+		if(sameFile("results/initGlobal.txt", "results/initFill.txt") && sameFile("results/initGlobal.txt", "results/initFile.txt")) printf("Snapshots are identical \n");
+		else{
+			printf("ERROR: snapshots differ between the setups \n");
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	cleanupSimLoc(&globalSimLoc);
+	cleanupSimLoc(&fillSimLoc);
+	cleanupSimLoc(&fileSimLoc);
+	cleanupCheckPtTimeLoc(&globalCheckLoc);
+	cleanupCheckPtTimeLoc(&fillCheckLoc);
+	cleanupCheckPtTimeLoc(&fileCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
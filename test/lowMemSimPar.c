@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/lowMemSimPar Nx NyTotal nSteps stepsPerCheckPt
+// Runs the bigSim setup with the usual two state buffers and again in low memory mode (one state buffer
+// updated in place with a two row rolling buffer), with the steady state monitor and statistics on in both.
+// Reports the state memory per rank and time per step of each and checks the snapshots, statistics and
+// the change in the last step agree.
+
+// bytes of state arrays this rank holds
+double stateBytes(simLoc *thisSimLoc){
+	materialLoc *thisMaterialLoc = thisSimLoc->thisMaterialLoc;
+	double padded = (double)thisMaterialLoc->NyPadded*thisMaterialLoc->Nx*sizeof(real_t);
+	double bytes = padded;
+	if(thisSimLoc->currentStateLoc != NULL) bytes += padded;
+	if(thisSimLoc->initStateLoc != NULL) bytes += (double)thisMaterialLoc->NyLocal*thisMaterialLoc->Nx*sizeof(real_t);
+	if(thisSimLoc->rowBufLoc != NULL) bytes += 2.0*thisMaterialLoc->Nx*sizeof(real_t);
+	return bytes;
+}
+
+// run the bigSim setup (in low memory mode if lowMemory), write its snapshots and statistics to filename
+// and statsFilename, and report the state memory and time per step
+int runOne(materialLoc *thisMaterialLoc, int lowMemory, int nSteps, int stepsPerCheckPt, const char *filename, const char *statsFilename, double *bytes, double *stepTime, float *lastChange){
+	float dt = 0.1;
+	float boundary = 0.1;
+	unsigned int Nx = thisMaterialLoc->Nx, NyTotal = thisMaterialLoc->NyTotal;
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	simLoc thisSimLoc;
+	int flag = initSimLoc(&thisSimLoc, dt, initTemp, boundary, thisMaterialLoc);
+	free(initTemp);
+	flag += setMonitorLoc(&thisSimLoc, MONITOR_MAX, 0.0, 1);
+	flag += setStatsLoc(&thisSimLoc, stepsPerCheckPt);
+	if(lowMemory) flag += setLowMemoryLoc(&thisSimLoc, 1);
+	if(flag) printf("WARNING: issue setting up the simulation \n");
+	*bytes = stateBytes(&thisSimLoc);
+
+	checkPtTimeLoc theseTimesLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag += runSimLoc(&thisSimLoc, nSteps, stepsPerCheckPt, &theseTimesLoc);
+	double mine = (MPI_Wtime() - start)/nSteps;
+	MPI_Allreduce(&mine, stepTime, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+	MPI_Allreduce(&(thisSimLoc.stepChangeLoc), lastChange, 1, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+	flag += writeToFileLoc(&theseTimesLoc, filename);
+	flag += writeStatsToFileLoc(&thisSimLoc, statsFilename);
+	cleanupSimLoc(&thisSimLoc);
+	cleanupCheckPtTimeLoc(&theseTimesLoc);
+	return flag;
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 100;
+	int stepsPerCheckPt = 25;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+	}
+
+	// setup the material like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+
+	double twoBytes, lowBytes, twoTime, lowTime;
+	float twoChange, lowChange;
+	flag = runOne(&thisMaterialLoc, 0, nSteps, stepsPerCheckPt, "results/lowMemTwo.txt", "results/lowMemTwoStats.csv", &twoBytes, &twoTime, &twoChange);
+	flag += runOne(&thisMaterialLoc, 1, nSteps, stepsPerCheckPt, "results/lowMemOne.txt", "results/lowMemOneStats.csv", &lowBytes, &lowTime, &lowChange);
+	if(flag){
+		printf("WARNING: issue in running the simulations \n");
+		failed = 1;
+	}
+
+	if(rank == 0){
+		printf("%u x %u points on %d ranks \n", Nx, NyTotal, nProcs);
+		printf("Two buffers: %.2f MB of state on rank 0, %f seconds per step \n", twoBytes/1e6, twoTime);
+		printf("Low memory:  %.2f MB of state on rank 0, %f seconds per step \n", lowBytes/1e6, lowTime);
+		if(sameFile("results/lowMemTwo.txt", "results/lowMemOne.txt") && sameFile("results/lowMemTwoStats.csv", "results/lowMemOneStats.csv") && (twoChange == lowChange)) printf("Snapshots, statistics and last step change are identical \n");
+		else{
+			printf("ERROR: low memory mode differs from two buffers \n");
+			failed = 1;
+		}
+	}
+
+	MPI_Finalize();
+	return failed;
+}
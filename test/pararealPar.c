@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/pararealPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/pararealPar Nx NyTotal nSlices nSteps nCoarseSteps tol
+// where #procs must be a multiple of nSlices, nSteps is the total number of forward Euler steps and
+// nCoarseSteps is the number of backward Euler steps per slice in the coarse propagator.
+// Runs the bigSim setup with Parareal and with plain spatial decomposition over all ranks, then
+// reports the correction, wall time and speedup after every Parareal iteration.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 100;
+	unsigned int NyTotal = 400;
+	int nSlices = 2;
+	int nSteps = 2000;
+	int nCoarseSteps = 4;
+	float tol = 1e-3;
+	if(argc > 6){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSlices = atoi(argv[3]);
+		nSteps = atoi(argv[4]);
+		nCoarseSteps = atoi(argv[5]);
+		tol = atof(argv[6]);
+	}
+
+	// material and step size of the reference run over all ranks
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	float boundary = 0.1;
+	simLoc refSimLoc;
+	flag = initSimLoc(&refSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	float dt = 0.9 * refSimLoc.dtMax;
+	refSimLoc.dt = dt;
+
+	// reference: all nSteps one after the other
+	checkPtTimeLoc refCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimLoc(&refSimLoc, nSteps + 1, nSteps, &refCheckLoc);
+	double refTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running reference simulation \n");
+		failed = 1;
+	}
+
+	// Parareal
+	pararealLoc thisParaLoc;
+	flag = initPararealLoc(&thisParaLoc, nSlices, Nx, NyTotal, dx, dy, alpha, dt, nSteps, nCoarseSteps, initTemp, boundary);
+	if(flag){
+		printf("WARNING: issue initializing Parareal \n");
+		failed = 1;
+	}
+	flag = runPararealLoc(&thisParaLoc, tol, nSlices);
+	if(flag){
+		printf("WARNING: issue in running Parareal \n");
+		failed = 1;
+	}
+
+	// compare final states on rank 0
+	float *refEnd = NULL;
+	float *paraEnd = NULL;
+	int *counts = NULL;
+	int *displs = NULL;
+	if(rank == 0){
+		refEnd = malloc(Nx*NyTotal*sizeof(float));
+		paraEnd = malloc(Nx*NyTotal*sizeof(float));
+		counts = malloc(nProcs*sizeof(int));
+		displs = malloc(nProcs*sizeof(int));
+	}
+	int myCount = Nx * thisMaterialLoc.NyLocal;
+	int myDispl = Nx * thisMaterialLoc.startYId;
+	MPI_Gather(&myCount, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	MPI_Gather(&myDispl, 1, MPI_INT, displs, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	MPI_Gatherv(refSimLoc.priorStateLoc + Nx*nPadRows, myCount, MPI_FLOAT, refEnd, counts, displs, MPI_FLOAT, 0, MPI_COMM_WORLD);
+	gatherPararealEndLoc(&thisParaLoc, paraEnd);
+	if(rank == 0){
+		float maxDiff = 0.0;
+		int i;
+		for(i=0; i<Nx*NyTotal; ++i){
+			float diff = fabs(refEnd[i] - paraEnd[i]);
+			if(diff > maxDiff) maxDiff = diff;
+		}
+		printf("Simulated %f seconds in %d steps, %d time slices of %d ranks \n", nSteps*dt, nSteps, nSlices, nProcs/nSlices);
+		printf("Spatial decomposition over all %d ranks: %f seconds wall \n", nProcs, refTime);
+		printf("Parareal coarse prediction: %f seconds wall \n", thisParaLoc.coarseSweepTime);
+		int iter;
+		for(iter=0; iter<thisParaLoc.nIters; ++iter){
+			printf("Parareal iteration %d: correction %g, %f seconds wall, speedup %f \n", iter+1, thisParaLoc.corrections[iter], thisParaLoc.iterTimes[iter], refTime/thisParaLoc.iterTimes[iter]);
+		}
+		printf("Max difference between reference and Parareal final states: %f \n", maxDiff);
+		if(maxDiff > tol){
+			printf("ERROR: Parareal stopped more than %g from the reference \n", tol);
+			failed = 1;
+		}
+		free(refEnd);
+		free(paraEnd);
+		free(counts);
+		free(displs);
+	}
+
+	// cleanup
+	free(initTemp);
+	initTemp = NULL;
+	cleanupPararealLoc(&thisParaLoc);
+	cleanupSimLoc(&refSimLoc);
+	cleanupCheckPtTimeLoc(&refCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
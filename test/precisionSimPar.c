@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/precisionSimPar<mode> Nx NyTotal nSteps
+// Runs the bigSim setup in the storage type this binary was built for (see code/precision.h), reports
+// the throughput, and writes the final state as doubles to results/precisionEnd_<dtype>.bin. Every mode
+// other than fp64 also reports its error against results/precisionEnd_float64.bin if it's there, so run
+// the fp64 binary first.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 100;
+	if(argc > 3){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+	}
+
+	// setup the material and simulation like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	float boundary = 0.1;
+	float dt = 0.1;
+	simLoc thisSimLoc;
+	flag = initSimLoc(&thisSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	if(flag){
+		printf("WARNING: issue initializing simulation local subarrays \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	// run (snapshots only at the start and end)
+	checkPtTimeLoc checkLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimLoc(&thisSimLoc, nSteps + 1, nSteps, &checkLoc);
+	double runTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running simulation \n");
+		failed = 1;
+	}
+
+	// gather the final state as doubles on rank 0
+	int nLocal = Nx * thisMaterialLoc.NyLocal;
+	double *endLoc = malloc(nLocal*sizeof(double));
+	int i;
+	for(i=0; i<nLocal; ++i) endLoc[i] = loadReal(thisSimLoc.priorStateLoc[Nx*nPadRows + i]);
+	int *counts = malloc(nProcs*sizeof(int));
+	int *displs = malloc(nProcs*sizeof(int));
+	int myDispl = Nx * thisMaterialLoc.startYId;
+	MPI_Gather(&nLocal, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	MPI_Gather(&myDispl, 1, MPI_INT, displs, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	double *endGlobal = NULL;
+	if(rank == 0) endGlobal = malloc(Nx*NyTotal*sizeof(double));
+	MPI_Gatherv(endLoc, nLocal, MPI_DOUBLE, endGlobal, counts, displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+	if(rank == 0){
+		long nPts = (long)Nx*NyTotal;
+		printf("%s storage: %d steps on %u x %u points, %f seconds wall, %f million point updates per second, %d bytes per value \n", REAL_DTYPE, nSteps, Nx, NyTotal, runTime, nPts*nSteps/runTime/1e6, (int)sizeof(real_t));
+
+		// write the final state, and compare with the fp64 one
+		char filename[100];
+		sprintf(filename, "results/precisionEnd_%s.bin", REAL_DTYPE);
+		FILE *filePtr = fopen(filename, "wb");
+		if(filePtr == NULL){
+			printf("ERROR in opening %s \n", filename);
+			failed = 1;
+		}
+		else{
+			fwrite(endGlobal, sizeof(double), nPts, filePtr);
+			fclose(filePtr);
+		}
+		double *refGlobal = malloc(nPts*sizeof(double));
+		filePtr = fopen("results/precisionEnd_float64.bin", "rb");
+		if((sizeof(real_t) != sizeof(double)) && (filePtr != NULL) && (fread(refGlobal, sizeof(double), nPts, filePtr) == nPts)){
+			double maxErr = 0.0, maxRelErr = 0.0, heat = 0.0, refHeat = 0.0;
+			for(i=0; i<nPts; ++i){
+				double err = fabs(endGlobal[i] - refGlobal[i]);
+				if(err > maxErr) maxErr = err;
+				if(err/fabs(refGlobal[i]) > maxRelErr) maxRelErr = err/fabs(refGlobal[i]);
+				heat += endGlobal[i];
+				refHeat += refGlobal[i];
+			}
+			printf("Against fp64: max error %e, max relative error %e, relative error in total heat %e \n", maxErr, maxRelErr, fabs(heat - refHeat)/refHeat);
+			// even bfloat16's 8 bit mantissa keeps every point within 10% and the total heat within 1%
+			if((maxRelErr > 0.1) || (fabs(heat - refHeat)/refHeat > 0.01)){
+				printf("ERROR: %s storage strays too far from fp64 \n", REAL_DTYPE);
+				failed = 1;
+			}
+		}
+		if(filePtr != NULL) fclose(filePtr);
+		free(refGlobal);
+		free(endGlobal);
+	}
+
+	// cleanup
+	free(endLoc);
+	free(counts);
+	free(displs);
+	cleanupSimLoc(&thisSimLoc);
+	cleanupCheckPtTimeLoc(&checkLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/probeSimPar Nx NyTotal nSteps
+// Runs the bigSim setup with 8 point probes (4 on grid points near the sources and the strip edges, read
+// directly, and 4 between grid points, interpolated) sampled every step to results/probeSim.csv. Checks
+// them against the full field snapshots taken every step (stepsPerCheckPt = 1), then times runs with and
+// without the probes (and no snapshots) to show their overhead.
+
+#define N_PROBES 8
+
+// this rank's share of the bilinear interpolation at (fx, fy) (in grid points) of one local snapshot
+double snapShare(const real_t *snapLoc, materialLoc *thisMaterialLoc, double fx, double fy){
+	int Nx = thisMaterialLoc->Nx;
+	int col = (fx < Nx - 1) ? (int)fx : Nx - 2;
+	int row = (fy < thisMaterialLoc->NyTotal - 1) ? (int)fy : thisMaterialLoc->NyTotal - 2;
+	double wx = fx - col, wy = fy - row, share = 0.0;
+	int k;
+	for(k=0; k<2; ++k){
+		int r = row + k - thisMaterialLoc->startYId;
+		if((r < 0) || (r >= thisMaterialLoc->NyLocal)) continue;
+		double val = (1.0 - wx)*loadReal(snapLoc[r*Nx + col]) + wx*loadReal(snapLoc[r*Nx + col + 1]);
+		share += (k ? wy : 1.0 - wy)*val;
+	}
+	return share;
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 400;
+	unsigned int NyTotal = 800;
+	int nSteps = 200;
+	if(argc > 3){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+	}
+
+	// setup the material like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+
+	// probes in grid points: next to the sources, on the first row of rank 1's strip (or the middle row) and
+	// halfway between grid points around the sources and across the middle
+	double gridX[N_PROBES] = {Nx/2 + 1, 3*Nx/4, Nx/3 - 2, Nx/2, Nx/2 + 0.5, 3*Nx/4 + 0.25, Nx/3 + 1.75, Nx/2 + 0.5};
+	double gridY[N_PROBES] = {NyTotal/3, NyTotal/4 + 1, 2*NyTotal/3, NyTotal/2, NyTotal/3 + 0.5, NyTotal/4 - 0.5, 2*NyTotal/3 + 0.25, NyTotal/2 - 0.5};
+	int firstRows[2] = {thisMaterialLoc.startYId, NyTotal/2};
+	MPI_Bcast(firstRows, 2, MPI_INT, (nProcs > 1) ? 1 : 0, MPI_COMM_WORLD);
+	gridY[3] = (nProcs > 1) ? firstRows[0] : firstRows[1];
+	gridY[7] = gridY[3] - 0.5;
+	float probeX[N_PROBES], probeY[N_PROBES];
+	int i;
+	for(i=0; i<N_PROBES; ++i){
+		probeX[i] = gridX[i]*dx;
+		probeY[i] = gridY[i]*dy;
+	}
+
+	// direct probes and interpolated probes, with snapshots every step to check them against
+	simLoc checkSimLoc, interpSimLoc;
+	flag = initSimLoc(&checkSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += initSimLoc(&interpSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += setProbesLoc(&checkSimLoc, N_PROBES/2, probeX, probeY, 0, "results/probeSimDirect.csv", 64);
+	flag += setProbesLoc(&interpSimLoc, N_PROBES/2, probeX + N_PROBES/2, probeY + N_PROBES/2, 1, "results/probeSimInterp.csv", 64);
+	checkPtTimeLoc checkLoc, interpCheckLoc;
+	flag += runSimLoc(&checkSimLoc, nSteps, 1, &checkLoc);
+	flag += runSimLoc(&interpSimLoc, nSteps, nSteps + 1, &interpCheckLoc);
+	cleanupSimLoc(&checkSimLoc);
+	cleanupSimLoc(&interpSimLoc);
+	if(flag){
+		printf("WARNING: issue in the checked runs \n");
+		failed = 1;
+	}
+
+	// each snapshot's values at the probes
+	double *shareLoc = malloc((long)nSteps*N_PROBES*sizeof(double));
+	double *expected = malloc((long)nSteps*N_PROBES*sizeof(double));
+	long nLocal = (long)Nx*thisMaterialLoc.NyLocal;
+	int snap;
+	for(snap=0; snap<nSteps; ++snap){
+		for(i=0; i<N_PROBES; ++i){
+			shareLoc[snap*N_PROBES + i] = snapShare(checkLoc.stateSnapshotsLoc + snap*nLocal, &thisMaterialLoc, gridX[i], gridY[i]);
+		}
+	}
+	MPI_Reduce(shareLoc, expected, nSteps*N_PROBES, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+	cleanupCheckPtTimeLoc(&checkLoc);
+	cleanupCheckPtTimeLoc(&interpCheckLoc);
+
+	// compare with the probe files
+	int nBad = 0;
+	if(rank == 0){
+		FILE *direct = fopen("results/probeSimDirect.csv", "r");
+		FILE *interp = fopen("results/probeSimInterp.csv", "r");
+		fscanf(direct, "%*[^\n]\n");
+		fscanf(interp, "%*[^\n]\n");
+		for(snap=0; snap<nSteps; ++snap){
+			float t;
+			double val;
+			int nRead = fscanf(direct, "%f", &t);
+			for(i=0; i<N_PROBES/2; ++i){
+				nRead += fscanf(direct, ", %lf", &val);
+				// 9 significant digits give the float back exactly
+				if((float)val != (float)expected[snap*N_PROBES + i]) ++nBad;
+			}
+			nRead += fscanf(interp, "%f", &t);
+			for(i=N_PROBES/2; i<N_PROBES; ++i){
+				nRead += fscanf(interp, ", %lf", &val);
+				if(fabs(val - expected[snap*N_PROBES + i]) > 1e-5*fabs(expected[snap*N_PROBES + i])) ++nBad;
+			}
+			if(nRead != N_PROBES + 2) ++nBad;
+		}
+		fclose(direct);
+		fclose(interp);
+	}
+	free(shareLoc);
+	free(expected);
+
+	// overhead: the same run with and without probes, keeping only the initial snapshot
+	double runTime[2];
+	int withProbes;
+	for(withProbes=0; withProbes<2; ++withProbes){
+		simLoc timeSimLoc;
+		checkPtTimeLoc timeCheckLoc;
+		flag = initSimLoc(&timeSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+		if(withProbes) flag += setProbesLoc(&timeSimLoc, N_PROBES, probeX, probeY, 1, "results/probeSim.csv", 256);
+		MPI_Barrier(MPI_COMM_WORLD);
+		double start = MPI_Wtime();
+		flag += runSimLoc(&timeSimLoc, nSteps, nSteps + 1, &timeCheckLoc);
+		MPI_Barrier(MPI_COMM_WORLD);
+		runTime[withProbes] = MPI_Wtime() - start;
+		if(flag){
+			printf("WARNING: issue in the timed run \n");
+			failed = 1;
+		}
+		cleanupSimLoc(&timeSimLoc);
+		cleanupCheckPtTimeLoc(&timeCheckLoc);
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	if(rank == 0){
+		printf("%u x %u points on %d ranks, %d steps, %d probes \n", Nx, NyTotal, nProcs, nSteps, N_PROBES);
+		if(nBad == 0) printf("Probe values match the full field snapshots \n");
+		else{
+			printf("ERROR: %d probe values differ from the full field snapshots \n", nBad);
+			failed = 1;
+		}
+		printf("Without probes: %f seconds \n", runTime[0]);
+		printf("With probes:    %f seconds (%+.2f%%) \n", runTime[1], 100.0*(runTime[1] - runTime[0])/runTime[0]);
+	}
+
+	MPI_Finalize();
+	return failed;
+}
@@ -11,12 +11,17 @@ f = open(checkPtFilename,'r')
 Nx = int((f.readline()).strip()) # read 1st line, strip off white space and newlines, cast to integer
 Ny = int((f.readline()).strip()) # do same for 2nd line
 NSnaps = int((f.readline()).strip()) # do same for 3rd line
+# files written by the parallel engine built for a storage type other than fp32 name it on a 4th line
+nHeader = 3
+dtypeLine = (f.readline()).strip()
+if dtypeLine[:1].isalpha():
+	nHeader = 4
 f.close()
 # may find it helpful to make sure dimensions are interpreted right by uncommenting next line
 #print("Nx = "+str(Nx)+" , Ny = "+str(Ny)+" , NSnaps = "+str(NSnaps))
 
 # read data and times from file
-flatData = np.genfromtxt(checkPtFilename, delimiter=',',skip_header=3)
+flatData = np.genfromtxt(checkPtFilename, delimiter=',',skip_header=nHeader)
 times = flatData[:,0] # first entry of each row is the time
 snapshotsFlat = flatData[:,1:-1] # last entry of each row is just a comma (shows up as nan)
 snapshots = np.reshape(snapshotsFlat,(NSnaps,Ny,Nx))
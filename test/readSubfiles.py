@@ -0,0 +1,49 @@
+import sys
+import os
+import numpy as np
+
+# read a set of subfiles written by writeToSubfilesLoc (prefix.idx and prefix.N.bin) as one
+# (nSnaps, NyTotal, Nx) array, whatever the number of ranks and nodes that wrote it
+def readSubfiles(indexFilename):
+	f = open(indexFilename,'r')
+	Nx = int((f.readline()).strip())
+	NyTotal = int((f.readline()).strip())
+	NSnaps = int((f.readline()).strip())
+	dtypeName = (f.readline()).strip()
+	NBlocks = int((f.readline()).strip())
+	times = np.array([float(t) for t in (f.readline()).split()])
+	blocks = [(f.readline()).split() for b in range(NBlocks)]
+	f.close()
+
+	# bfloat16 is the upper half of a float32, so widen its bits; the others numpy reads directly
+	rawType = {'float32':np.float32, 'float64':np.float64, 'float16':np.float16, 'bfloat16':np.uint16}[dtypeName]
+	snapshots = np.empty((NSnaps,NyTotal,Nx))
+	indexDir = os.path.dirname(indexFilename)
+	for name, startRow, nRows, offset in blocks:
+		startRow = int(startRow)
+		nRows = int(nRows)
+		# each block is its writer's nSnaps x nRows x Nx values
+		raw = np.fromfile(os.path.join(indexDir,name), dtype=rawType, count=NSnaps*nRows*Nx, offset=int(offset))
+		if dtypeName == 'bfloat16':
+			raw = (raw.astype(np.uint32) << 16).view(np.float32)
+		snapshots[:,startRow:startRow+nRows,:] = np.reshape(raw,(NSnaps,nRows,Nx))
+	return times, snapshots
+
+if __name__ == '__main__':
+	# get the index filename from the command line call of this, and optionally a text checkpoint file of
+	# the same run (as written by writeToFileLoc) to check the subfiles against
+	times, snapshots = readSubfiles(sys.argv[1])
+	NSnaps, NyTotal, Nx = snapshots.shape
+	print("Nx = "+str(Nx)+" , Ny = "+str(NyTotal)+" , NSnaps = "+str(NSnaps))
+	if len(sys.argv) > 2:
+		f = open(sys.argv[2],'r')
+		nHeader = 3
+		for i in range(3):
+			f.readline()
+		if ((f.readline()).strip())[:1].isalpha():
+			nHeader = 4
+		f.close()
+		flatData = np.genfromtxt(sys.argv[2], delimiter=',',skip_header=nHeader)
+		textSnapshots = np.reshape(flatData[:,1:-1],(NSnaps,NyTotal,Nx))
+		print("Largest difference from the text file: "+str(np.max(np.abs(textSnapshots-snapshots))))
+		print("Largest difference in times: "+str(np.max(np.abs(flatData[:,0]-times))))
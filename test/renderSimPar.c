@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/renderSimPar Nx NyTotal nSteps renderEvery [scale]
+// Runs the bigSim setup rendering log10 temperature frames in situ every renderEvery steps to
+// results/renderSim000.ppm, results/renderSim001.ppm, ... (scale 0 for one colour range for all frames,
+// like test/readPlotSnaps.py, or 1 for each frame's own range). Then times it against the same run gathering
+// and writing the full field at the same steps, which readPlotSnaps.py would need to draw the frames.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 200;
+	int renderEvery = 20;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		renderEvery = atoi(argv[4]);
+	}
+	int scale = RENDER_SCALE_FIXED;
+	if(argc > 5) scale = atoi(argv[5]);
+
+	// setup the material like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+
+	// frames rendered in situ (keeping only the initial snapshot)
+	simLoc renderSimLoc;
+	flag = initSimLoc(&renderSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += setRenderLoc(&renderSimLoc, renderEvery, "results/renderSim", scale);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	checkPtTimeLoc renderCheckLoc;
+	flag += runSimLoc(&renderSimLoc, nSteps, nSteps + 1, &renderCheckLoc);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double renderTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in the rendering run \n");
+		failed = 1;
+	}
+
+	// full field output at the same steps
+	simLoc fieldSimLoc;
+	flag = initSimLoc(&fieldSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	checkPtTimeLoc fieldCheckLoc;
+	flag += runSimLoc(&fieldSimLoc, nSteps, renderEvery, &fieldCheckLoc);
+	flag += writeToFileLoc(&fieldCheckLoc, "results/renderSimField.txt");
+	MPI_Barrier(MPI_COMM_WORLD);
+	double fieldTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in the full field run \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	if(rank == 0){
+		printf("%u x %u points on %d ranks, %d steps \n", Nx, NyTotal, nProcs, nSteps);
+		printf("In situ rendering: %d frames in %f seconds \n", renderSimLoc.nFrames, renderTime);
+		printf("Full field output: %d snapshots in %f seconds \n", fieldCheckLoc.nSnaps, fieldTime);
+
+		// a frame per snapshot, the last one a whole P6 image
+		char name[64], header[64];
+		snprintf(name, sizeof(name), "results/renderSim%03d.ppm", renderSimLoc.nFrames - 1);
+		long expected = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", Nx, NyTotal) + 3L*Nx*NyTotal;
+		long size = -1;
+		FILE *filePtr = fopen(name, "rb");
+		if(filePtr != NULL){
+			fseek(filePtr, 0, SEEK_END);
+			size = ftell(filePtr);
+			fclose(filePtr);
+		}
+		if((renderSimLoc.nFrames != fieldCheckLoc.nSnaps) || (size != expected)){
+			printf("ERROR: %d frames for %d snapshots, %s has %ld bytes rather than %ld \n", renderSimLoc.nFrames, fieldCheckLoc.nSnaps, name, size, expected);
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	cleanupSimLoc(&renderSimLoc);
+	cleanupSimLoc(&fieldSimLoc);
+	cleanupCheckPtTimeLoc(&renderCheckLoc);
+	cleanupCheckPtTimeLoc(&fieldCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/reorderSimPar Nx NyTotal nSteps reorder
+// Runs the bigSim setup with the strips in MPI_COMM_WORLD's order and in the order reorderCommLoc makes
+// (reorder is 0 for none, 1 for MPI's distributed graph reordering, 2 for grouping by host), then reports
+// how many halo links stay within a host before and after, the timings, and whether the snapshots agree.
+// (Launch with a cyclic mapping over several hosts, e.g. mpirun --map-by node, to see the difference.)
+
+// run the bigSim setup with the strips in comm's order, write its snapshots to filename, and return the slowest rank's time
+// (failed is set if any step reports a problem)
+double runBigSim(MPI_Comm comm, unsigned int Nx, unsigned int NyTotal, int nSteps, const char *filename, int *failed){
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLocComm(&thisMaterialLoc, Nx, NyTotal, 1, 1.5, 1.0, 2.0, comm);
+	if(flag){
+		printf("WARNING: error in initMaterialLocComm \n");
+		*failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	simLoc thisSimLoc;
+	flag = initSimLoc(&thisSimLoc, 0.1, initTemp, 0.1, &thisMaterialLoc);
+	free(initTemp);
+	checkPtTimeLoc thisCheckLoc;
+	MPI_Barrier(comm);
+	double start = MPI_Wtime();
+	flag += runSimLoc(&thisSimLoc, nSteps + 1, nSteps, &thisCheckLoc);
+	double mine = MPI_Wtime() - start, slowest;
+	MPI_Allreduce(&mine, &slowest, 1, MPI_DOUBLE, MPI_MAX, comm);
+	flag += writeToFileLoc(&thisCheckLoc, filename);
+	if(flag){
+		printf("WARNING: issue in running the simulation \n");
+		*failed = 1;
+	}
+	cleanupSimLoc(&thisSimLoc);
+	cleanupCheckPtTimeLoc(&thisCheckLoc);
+	return slowest;
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 100;
+	int reorder = REORDER_HOST;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		reorder = atoi(argv[4]);
+	}
+
+	// halo links before and after reordering
+	MPI_Comm stripComm;
+	int flag = reorderCommLoc(MPI_COMM_WORLD, reorder, &stripComm);
+	if(flag){
+		printf("WARNING: issue reordering the ranks \n");
+		failed = 1;
+	}
+	int intraBefore, interBefore, intraAfter, interAfter;
+	flag = haloLinksLoc(MPI_COMM_WORLD, &intraBefore, &interBefore);
+	flag += haloLinksLoc(stripComm, &intraAfter, &interAfter);
+	if(flag){
+		printf("WARNING: issue counting the halo links \n");
+		failed = 1;
+	}
+	int newRank;
+	MPI_Comm_rank(stripComm, &newRank);
+	int *newRanks = malloc(nProcs*sizeof(int));
+	MPI_Gather(&newRank, 1, MPI_INT, newRanks, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+	double worldTime = runBigSim(MPI_COMM_WORLD, Nx, NyTotal, nSteps, "results/reorderWorld.txt", &failed);
+	double stripTime = runBigSim(stripComm, Nx, NyTotal, nSteps, "results/reorderStrip.txt", &failed);
+
+	if(rank == 0){
+		printf("%d steps on %u x %u points, %d ranks, reorder %d \n", nSteps, Nx, NyTotal, nProcs, reorder);
+		printf("Strip of each world rank:");
+		int r;
+		for(r=0; r<nProcs; ++r) printf(" %d", newRanks[r]);
+		printf(" \n");
+		printf("World order:     %d halo links within a host, %d between hosts, %f seconds \n", intraBefore, interBefore, worldTime);
+		printf("Reordered:       %d halo links within a host, %d between hosts, %f seconds \n", intraAfter, interAfter, stripTime);
+		if(sameFile("results/reorderWorld.txt", "results/reorderStrip.txt")) printf("Snapshots are identical \n");
+		else{
+			printf("ERROR: snapshots differ between the orders \n");
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	free(newRanks);
+	MPI_Comm_free(&stripComm);
+
+	MPI_Finalize();
+	return failed;
+}
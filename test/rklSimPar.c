@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/rklSimPar Nx NyTotal dtRatio nSuperSteps
+// where dtRatio is the RKL2 super time step in units of dtMax.
+// Runs the bigSim setup to the same final time with forward Euler and with RKL2 super time stepping,
+// then reports stages per super step, timings per simulated second, and the difference between them.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 100;
+	unsigned int NyTotal = 400;
+	int dtRatio = 20;
+	int nSuperSteps = 40;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		dtRatio = atoi(argv[3]);
+		nSuperSteps = atoi(argv[4]);
+	}
+
+	// setup the material
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	float boundary = 0.1;
+
+	// forward Euler run with a stable step, dtRatio + 1 Euler steps per super step
+	simLoc eulerSimLoc;
+	flag = initSimLoc(&eulerSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	float dtSuper = eulerSimLoc.dtMax * dtRatio;
+	eulerSimLoc.dt = dtSuper / (dtRatio + 1); // just under dtMax
+	int nEulerSteps = nSuperSteps * (dtRatio + 1);
+	checkPtTimeLoc eulerCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimLoc(&eulerSimLoc, nEulerSteps + 1, nEulerSteps, &eulerCheckLoc);
+	double eulerTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running forward Euler simulation \n");
+		failed = 1;
+	}
+
+	// RKL2 run to the same final time
+	simLoc rklSimLoc;
+	flag = initSimLoc(&rklSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	flag = setIntegratorLoc(&rklSimLoc, INTEGRATOR_RKL2, dtSuper);
+	if(flag){
+		printf("WARNING: issue setting the RKL2 integrator \n");
+		failed = 1;
+	}
+	checkPtTimeLoc rklCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag = runSimLoc(&rklSimLoc, nSuperSteps + 1, nSuperSteps, &rklCheckLoc);
+	double rklTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running RKL2 simulation \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	// compare the final states
+	int nPad = Nx * nPadRows;
+	int nLocal = Nx * thisMaterialLoc.NyLocal;
+	float localMaxDiff = 0.0;
+	int i;
+	for(i=nPad; i<nPad+nLocal; ++i){
+		float diff = fabs(eulerSimLoc.priorStateLoc[i] - rklSimLoc.priorStateLoc[i]);
+		if(diff > localMaxDiff) localMaxDiff = diff;
+	}
+	float maxDiff;
+	MPI_Reduce(&localMaxDiff, &maxDiff, 1, MPI_FLOAT, MPI_MAX, 0, MPI_COMM_WORLD);
+	if(rank == 0){
+		float simTime = nSuperSteps * dtSuper;
+		printf("Simulated %f seconds, RKL2 dt = %d x dtMax \n", simTime, dtRatio);
+		printf("Forward Euler: %d steps, %f seconds wall, %g wall seconds per simulated second \n", nEulerSteps, eulerTime, eulerTime/simTime);
+		printf("RKL2: %d super steps of %d stages, %f seconds wall, %g wall seconds per simulated second \n", nSuperSteps, rklSimLoc.nStages, rklTime, rklTime/simTime);
+		printf("Max difference between forward Euler and RKL2 final states: %f \n", maxDiff);
+		// both are accurate to well under this in time, with sources starting at up to 150
+		if(maxDiff > 0.01){
+			printf("ERROR: RKL2 strays from forward Euler \n");
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	cleanupSimLoc(&eulerSimLoc);
+	cleanupSimLoc(&rklSimLoc);
+	cleanupCheckPtTimeLoc(&eulerCheckLoc);
+	cleanupCheckPtTimeLoc(&rklCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
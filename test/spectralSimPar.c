@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/spectralPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/spectralSimPar Nx NyTotal nSteps stepsPerCheckPt
+// Runs the bigSim setup with oneStepLoc time stepping and with the spectral propagator (in the mode
+// that reproduces forward Euler exactly), reports both timings and the largest difference between
+// their snapshots, and writes the spectral snapshots to results/spectralSim.txt.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 100;
+	unsigned int NyTotal = 400;
+	int nSteps = 1000;
+	int stepsPerCheckPt = 250;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+	}
+
+	// setup the material
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+
+	// same initial temperature field as bigSim
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	float boundary = 0.1;
+	fillInitTemp(initTemp, Nx, NyTotal);
+
+	float dt = 0.1;
+	simLoc stepSimLoc, spectralSimLoc;
+	flag = initSimLoc(&stepSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += initSimLoc(&spectralSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	if(flag){
+		printf("WARNING: issue initializing simulation local subarrays \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	// time stepping
+	checkPtTimeLoc stepCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimLoc(&stepSimLoc, nSteps, stepsPerCheckPt, &stepCheckLoc);
+	double stepTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running simulation \n");
+		failed = 1;
+	}
+
+	// spectral jumps to each snapshot
+	spectralLoc thisSpectralLoc;
+	checkPtTimeLoc spectralCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag = initSpectralLoc(&thisSpectralLoc, &spectralSimLoc, SPECTRAL_EXPLICIT);
+	flag += runSimSpectralLoc(&thisSpectralLoc, nSteps, stepsPerCheckPt, &spectralCheckLoc);
+	double spectralTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running spectral simulation \n");
+		failed = 1;
+	}
+
+	// compare all snapshots
+	int nPts = stepCheckLoc.nSnaps * Nx * thisMaterialLoc.NyLocal;
+	int i;
+	float localMaxDiff = 0.0;
+	for(i=0; i<nPts; ++i){
+		float diff = fabs(stepCheckLoc.stateSnapshotsLoc[i] - spectralCheckLoc.stateSnapshotsLoc[i]);
+		if(diff > localMaxDiff) localMaxDiff = diff;
+	}
+	float maxDiff;
+	MPI_Reduce(&localMaxDiff, &maxDiff, 1, MPI_FLOAT, MPI_MAX, 0, MPI_COMM_WORLD);
+	if(rank == 0){
+		printf("Time stepping: %f seconds, spectral: %f seconds for %d snapshots \n", stepTime, spectralTime, stepCheckLoc.nSnaps);
+		printf("Max difference between stepped and spectral snapshots: %g \n", maxDiff);
+		// SPECTRAL_EXPLICIT reproduces the stepped scheme, so only rounding separates them
+		if(maxDiff > 1e-4){
+			printf("ERROR: spectral snapshots differ from the stepped ones \n");
+			failed = 1;
+		}
+	}
+
+	flag = writeToFileLoc(&spectralCheckLoc, "results/spectralSim.txt");
+	if(flag){
+		printf("WARNING: issue writing checkpoint file \n");
+		failed = 1;
+	}
+
+	// cleanup
+	cleanupSpectralLoc(&thisSpectralLoc);
+	cleanupSimLoc(&stepSimLoc);
+	cleanupSimLoc(&spectralSimLoc);
+	cleanupCheckPtTimeLoc(&stepCheckLoc);
+	cleanupCheckPtTimeLoc(&spectralCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
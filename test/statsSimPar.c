@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/statsSimPar Nx NyTotal nSteps statsEvery
+// Runs the bigSim setup with in situ statistics (min, max, mean, energy and hottest point every statsEvery
+// steps, accumulated inside the stencil sweep) and checks them against the same statistics computed from full
+// field snapshots taken at the same steps. Then times a run that only keeps the statistics against one that
+// gathers and writes the full field, and writes the time series to results/statsSim.csv.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 200;
+	int statsEvery = 10;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		statsEvery = atoi(argv[4]);
+	}
+
+	// setup the material like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+
+	// statistics with snapshots at the same steps, to check them against
+	simLoc checkSimLoc;
+	flag = initSimLoc(&checkSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += setStatsLoc(&checkSimLoc, statsEvery);
+	checkPtTimeLoc checkLoc;
+	flag += runSimLoc(&checkSimLoc, nSteps, statsEvery, &checkLoc);
+	if(flag){
+		printf("WARNING: issue in the checked run \n");
+		failed = 1;
+	}
+	long nLocal = (long)Nx*thisMaterialLoc.NyLocal;
+	int snap, nBad = 0;
+	for(snap=0; snap<checkLoc.nSnaps; ++snap){
+		double sumLoc = 0.0, minLoc = INFINITY;
+		struct {double val; int idx;} hotLoc = {-INFINITY, 0}, hot;
+		long i;
+		for(i=0; i<nLocal; ++i){
+			double val = loadReal(checkLoc.stateSnapshotsLoc[snap*nLocal + i]);
+			sumLoc += val;
+			if(val < minLoc) minLoc = val;
+			if(val > hotLoc.val){
+				// the first hottest point, by global index
+				hotLoc.val = val;
+				hotLoc.idx = thisMaterialLoc.startYId*Nx + i;
+			}
+		}
+		double sum, min;
+		MPI_Reduce(&sumLoc, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&minLoc, &min, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&hotLoc, &hot, 1, MPI_DOUBLE_INT, MPI_MAXLOC, 0, MPI_COMM_WORLD);
+		if(rank == 0){
+			double mean = sum/((double)Nx*NyTotal);
+			int hotCol = hot.idx % Nx, hotRow = hot.idx / Nx;
+			if((snap >= checkSimLoc.nStats) || (checkSimLoc.statsTimes[snap] != checkLoc.times[snap]) || (checkSimLoc.statsMin[snap] != (float)min) || (checkSimLoc.statsMax[snap] != (float)hot.val) || (fabs(checkSimLoc.statsMean[snap] - mean) > 1e-9*fabs(mean))){
+				printf("ERROR: statistics differ from the snapshot at time %f \n", checkLoc.times[snap]);
+				++nBad;
+			}
+			else if((checkSimLoc.statsHotCol[snap] != hotCol) || (checkSimLoc.statsHotRow[snap] != hotRow)){
+				printf("ERROR: hottest point (%d, %d) at time %f, the snapshot has it at (%d, %d) \n", checkSimLoc.statsHotCol[snap], checkSimLoc.statsHotRow[snap], checkLoc.times[snap], hotCol, hotRow);
+				++nBad;
+			}
+		}
+	}
+	if((rank == 0) && (checkSimLoc.nStats != checkLoc.nSnaps)){
+		printf("ERROR: %d statistics records for %d snapshots \n", checkSimLoc.nStats, checkLoc.nSnaps);
+		++nBad;
+	}
+	cleanupSimLoc(&checkSimLoc);
+	cleanupCheckPtTimeLoc(&checkLoc);
+
+	// statistics only (a single snapshot, of the initial state)
+	simLoc statsSimLoc;
+	flag = initSimLoc(&statsSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += setStatsLoc(&statsSimLoc, statsEvery);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	checkPtTimeLoc statsCheckLoc;
+	flag += runSimLoc(&statsSimLoc, nSteps, nSteps + 1, &statsCheckLoc);
+	flag += writeStatsToFileLoc(&statsSimLoc, "results/statsSim.csv");
+	MPI_Barrier(MPI_COMM_WORLD);
+	double statsTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in the statistics only run \n");
+		failed = 1;
+	}
+
+	// full field output at the same steps
+	simLoc fieldSimLoc;
+	flag = initSimLoc(&fieldSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	checkPtTimeLoc fieldCheckLoc;
+	flag += runSimLoc(&fieldSimLoc, nSteps, statsEvery, &fieldCheckLoc);
+	flag += writeToFileLoc(&fieldCheckLoc, "results/statsSimField.txt");
+	MPI_Barrier(MPI_COMM_WORLD);
+	double fieldTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in the full field run \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	if(rank == 0){
+		int last = statsSimLoc.nStats - 1;
+		printf("%u x %u points on %d ranks, %d steps, statistics every %d \n", Nx, NyTotal, nProcs, nSteps, statsEvery);
+		if(nBad == 0) printf("In situ statistics match the full field snapshots \n");
+		else failed = 1;
+		printf("Final: min %f, max %f at (%d, %d), mean %f, energy %f \n", statsSimLoc.statsMin[last], statsSimLoc.statsMax[last], statsSimLoc.statsHotCol[last], statsSimLoc.statsHotRow[last], statsSimLoc.statsMean[last], statsSimLoc.statsEnergy[last]);
+		printf("Statistics only: %f seconds \n", statsTime);
+		printf("Full field:      %f seconds \n", fieldTime);
+	}
+
+	// cleanup
+	cleanupSimLoc(&statsSimLoc);
+	cleanupSimLoc(&fieldSimLoc);
+	cleanupCheckPtTimeLoc(&statsCheckLoc);
+	cleanupCheckPtTimeLoc(&fieldCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
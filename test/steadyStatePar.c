@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/multigridPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/steadyStatePar Nx NyTotal tol
+// Solves for the equilibrium temperature of the bigSim material with its 3 hot spots turned into
+// constant heat sources, and writes the single resulting snapshot to results/steadyState.txt.
+// Grids of any size coarsen down to a few points (e.g. 100 x 400 in 9 levels).
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 129;
+	unsigned int NyTotal = 513;
+	float tol = 1e-5;
+	if(argc > 3){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		tol = atof(argv[3]);
+	}
+
+	// setup the material
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+
+	// the starting guess is just the boundary value everywhere
+	float boundary = 0.1;
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	int i;
+	for(i=0; i<Nx*NyTotal; ++i) initTemp[i] = boundary;
+	simLoc thisSimLoc;
+	flag = initSimLoc(&thisSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	if(flag){
+		printf("WARNING: issue initializing simulation local subarrays \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	// heat sources (temperature change per second) at the 3 bigSim hot spots, in this rank's rows
+	float *sourceLoc = calloc(Nx*thisMaterialLoc.NyLocal, sizeof(float));
+	int sourceRows[3] = {NyTotal/3, NyTotal/4, 2*NyTotal/3};
+	int sourceCols[3] = {Nx/2, 3*Nx/4, Nx/3};
+	float sourceVals[3] = {100.0, 10.0, 150.0};
+	for(i=0; i<3; ++i){
+		int localRow = sourceRows[i] - (int)thisMaterialLoc.startYId;
+		if((localRow >= 0) && (localRow < (int)thisMaterialLoc.NyLocal))
+			sourceLoc[sourceCols[i] + localRow*Nx] = sourceVals[i];
+	}
+
+	multigridLoc thisMgLoc;
+	flag = initMultigridLoc(&thisMgLoc, &thisSimLoc, 2, 2);
+	if(flag){
+		printf("WARNING: issue initializing multigrid \n");
+		failed = 1;
+	}
+	thisMgLoc.reportCycles = 1;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = solveSteadyStateLoc(&thisMgLoc, sourceLoc, tol, 100);
+	double solveTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue solving for steady state \n");
+		failed = 1;
+	}
+	if(rank == 0){
+		printf("%d levels (coarsest %d x %d), %d V-cycles, relative residual %g, %f seconds \n", thisMgLoc.nLevels, thisMgLoc.levels[thisMgLoc.nLevels-1].Nx, thisMgLoc.levels[thisMgLoc.nLevels-1].NyTotal, thisMgLoc.nCycles, thisMgLoc.lastRelRes, solveTime);
+	}
+
+	flag = writeSteadyStateLoc(&thisMgLoc, "results/steadyState.txt");
+	if(flag){
+		printf("WARNING: issue writing steady state file \n");
+		failed = 1;
+	}
+
+	// cleanup
+	free(sourceLoc);
+	cleanupMultigridLoc(&thisMgLoc);
+	cleanupSimLoc(&thisSimLoc);
+
+	MPI_Finalize();
+	return failed;
+}
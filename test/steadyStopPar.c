@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/steadyStopPar Nx NyTotal nSteps stepsPerCheckPt monitorEvery tol
+// Runs the bigSim setup for up to nSteps steps with the steady state monitor (largest change of any
+// point in one step, checked every monitorEvery steps) and reports when and why it stopped.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 50;
+	unsigned int NyTotal = 100;
+	int nSteps = 1000000;
+	int stepsPerCheckPt = 5000;
+	int monitorEvery = 50;
+	float tol = 1e-6;
+	if(argc > 6){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+		monitorEvery = atoi(argv[5]);
+		tol = atof(argv[6]);
+	}
+
+	// setup the material
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+
+	// bigSim initial temperature field (0.1 everywhere with 3 hot sources)
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	float boundary = 0.1;
+
+	// setup the simulation with the monitor on
+	simLoc thisSimLoc;
+	flag = initSimLoc(&thisSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	if(flag){
+		printf("WARNING: issue initializing simulation local subarrays \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+	flag = setMonitorLoc(&thisSimLoc, MONITOR_MAX, tol, monitorEvery);
+	if(flag){
+		printf("WARNING: issue setting the steady state monitor \n");
+		failed = 1;
+	}
+
+	// run until steady (or nSteps)
+	checkPtTimeLoc checkLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimLoc(&thisSimLoc, nSteps, stepsPerCheckPt, &checkLoc);
+	double runTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running simulation \n");
+		failed = 1;
+	}
+	flag = writeToFileLoc(&checkLoc, "results/steadyStop.txt");
+	if(flag){
+		printf("WARNING: issue writing checkpoint file \n");
+		failed = 1;
+	}
+
+	if(rank == 0){
+		if(thisSimLoc.stopReason == STOP_CONVERGED) printf("Stopped at step %u of %d: change %g per step is below %g \n", thisSimLoc.stopTimeIdx, nSteps, thisSimLoc.stopChange, tol);
+		else{
+			printf("ERROR: took all %d steps without converging, last change checked %g per step \n", nSteps, thisSimLoc.stopChange);
+			failed = 1;
+		}
+		printf("%d snapshots written, %f seconds wall \n", checkLoc.nSnaps, runTime);
+	}
+
+	// cleanup
+	cleanupSimLoc(&thisSimLoc);
+	cleanupCheckPtTimeLoc(&checkLoc);
+
+	MPI_Finalize();
+	return failed;
+}
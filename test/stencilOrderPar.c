@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/simulationPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/stencilOrderPar Nmin nLevels targetErr
+// Convergence study of the second and fourth order stencils on the unit square (N x N points, N = Nmin,
+// 2*Nmin-1, 4*Nmin-3, ...) against the exact solution
+//   u = 0.1 + sin(pi x) sin(pi y) exp(-2 pi^2 alpha t) + sin(2 pi x) sin(3 pi y) exp(-13 pi^2 alpha t).
+// Forward Euler's time error is O(dt) = O(h^2), which would hide the spatial order, so every grid is run
+// with dt and dt/2 and the two are combined (2 u_(dt/2) - u_dt) to cancel it. What's left is the spatial
+// error plus O(dt^2) = O(h^4). Then reports the grid each order needs for targetErr. The Makefile builds
+// this with fp64 storage: in fp32 the fourth order errors hit the round off floor (about 1e-5) by 65 x 65.
+
+#define PI 3.14159265358979323846
+
+double exactTemp(double x, double y, double alpha, double t){
+	return 0.1 + sin(PI*x)*sin(PI*y)*exp(-2*PI*PI*alpha*t) + sin(2*PI*x)*sin(3*PI*y)*exp(-13*PI*PI*alpha*t);
+}
+
+// run nSteps forward Euler steps of size dt to the final time and copy the unpadded local result into endLoc
+// returns nonzero if the simulation couldn't be set up
+int runToEnd(materialLoc *thisMaterialLoc, float *initTemp, int order, int nSteps, float dt, double *endLoc, double *updatesPerSec){
+	simLoc thisSimLoc;
+	int flag = initSimLoc(&thisSimLoc, dt, initTemp, 0.1, thisMaterialLoc);
+	flag += setStencilOrderLoc(&thisSimLoc, order);
+	if(flag) printf("WARNING: issue initializing the order %d simulation \n", order);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	int step;
+	for(step=0; step<nSteps; ++step) oneStepLoc(&thisSimLoc);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double runTime = MPI_Wtime() - start;
+	*updatesPerSec = (double)thisMaterialLoc->Nx * thisMaterialLoc->NyTotal * nSteps / runTime;
+	int nLocal = thisMaterialLoc->Nx * thisMaterialLoc->NyLocal;
+	int i;
+	for(i=0; i<nLocal; ++i) endLoc[i] = loadReal(thisSimLoc.priorStateLoc[thisMaterialLoc->Nx*thisMaterialLoc->nPadRows + i]);
+	cleanupSimLoc(&thisSimLoc);
+	return flag;
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	int Nmin = 9;
+	int nLevels = 4;
+	double targetErr = 1e-5;
+	if(argc > 3){
+		Nmin = atoi(argv[1]);
+		nLevels = atoi(argv[2]);
+		targetErr = atof(argv[3]);
+	}
+
+	float alpha = 1.0;
+	double finalTime = 0.02;
+	int nPadRows = 2;
+	double *errs = malloc(2*nLevels*sizeof(double));
+	int *sizes = malloc(nLevels*sizeof(int));
+	int level, o;
+	if(rank == 0) printf("order      N   steps   max error   observed order   million updates/s \n");
+	for(o=0; o<2; ++o){
+		int order = 2 + 2*o;
+		int N = Nmin;
+		for(level=0; level<nLevels; ++level){
+			sizes[level] = N;
+			float h = 1.0/(N-1);
+			materialLoc thisMaterialLoc;
+			int flag = initMaterialLoc(&thisMaterialLoc, N, N, nPadRows, h, h, alpha);
+			if(flag){
+				printf("WARNING: error in initMaterialLoc \n");
+				failed = 1;
+			}
+			float *initTemp = malloc(N*N*sizeof(float));
+			int row, col, i;
+			for(row=0; row<N; ++row){
+				for(col=0; col<N; ++col) initTemp[col + row*N] = exactTemp(col*h, row*h, alpha, 0.0);
+			}
+
+			// half the stability limit of the fourth order stencil, rounded so the steps end at finalTime
+			int nSteps = (int)ceil(finalTime / (0.5*0.75*h*h/(4*alpha)));
+			float dt = finalTime / nSteps;
+			int nLocal = N*thisMaterialLoc.NyLocal;
+			double *coarseLoc = malloc(nLocal*sizeof(double));
+			double *fineLoc = malloc(nLocal*sizeof(double));
+			double rate;
+			flag = runToEnd(&thisMaterialLoc, initTemp, order, nSteps, dt, coarseLoc, &rate);
+			flag += runToEnd(&thisMaterialLoc, initTemp, order, 2*nSteps, dt/2, fineLoc, &rate);
+			if(flag) failed = 1;
+
+			// error of the time extrapolated state
+			double errLoc = 0.0;
+			for(i=0; i<nLocal; ++i){
+				int globalRow = thisMaterialLoc.startYId + i/N;
+				double err = fabs(2*fineLoc[i] - coarseLoc[i] - exactTemp((i%N)*h, globalRow*h, alpha, finalTime));
+				if(err > errLoc) errLoc = err;
+			}
+			MPI_Allreduce(&errLoc, &errs[o*nLevels + level], 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+			if(rank == 0){
+				printf("%5d %6d %7d %11.3e", order, N, nSteps, errs[o*nLevels + level]);
+				double observed = (level > 0) ? log(errs[o*nLevels + level - 1]/errs[o*nLevels + level])/log((N-1.0)/(sizes[level-1]-1.0)) : 0.0;
+				if(level > 0) printf(" %16.2f", observed);
+				else printf(" %16s", "");
+				printf(" %19.1f \n", rate/1e6);
+				// past the coarsest grids the error has to fall at (about) the stencil's order
+				if((level >= 2) && (observed < order - 0.5)){
+					printf("ERROR: order %d stencil only converges at order %.2f \n", order, observed);
+					failed = 1;
+				}
+			}
+			free(initTemp);
+			free(coarseLoc);
+			free(fineLoc);
+			N = 2*N - 1;
+		}
+	}
+
+	// grid each order needs for the target error, from err = C h^p fit to its two finest grids
+	if(rank == 0){
+		double needed[2];
+		for(o=0; o<2; ++o){
+			double e1 = errs[o*nLevels + nLevels - 2], e2 = errs[o*nLevels + nLevels - 1];
+			double h1 = 1.0/(sizes[nLevels-2]-1), h2 = 1.0/(sizes[nLevels-1]-1);
+			double p = log(e1/e2)/log(h1/h2);
+			double h = h2*pow(targetErr/e2, 1.0/p);
+			needed[o] = 1.0/h + 1;
+			printf("Order %d needs about %.0f x %.0f points for a max error of %.1e \n", 2 + 2*o, needed[o], needed[o], targetErr);
+		}
+		printf("The fourth order stencil needs %.1f times fewer cells \n", (needed[0]*needed[0])/(needed[1]*needed[1]));
+	}
+
+	free(errs);
+	free(sizes);
+	MPI_Finalize();
+	return failed;
+}
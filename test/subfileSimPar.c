@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/subfileRead.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/subfileSimPar Nx NyTotal nSteps stepsPerCheckPt [ranksPerSubfile]
+// Runs the bigSim setup and writes its snapshots both as one shared text file (writeToFileLoc, to
+// results/subfileSim.txt) and as subfiles (writeToSubfilesLoc, to results/subfileSim.idx and
+// results/subfileSim.N.bin, one per node or per ranksPerSubfile ranks of a node). Times both, then every rank
+// reads the subfile set back through code/subfileRead.h and checks its own rows of every snapshot.
+// test/readSubfiles.py results/subfileSim.idx results/subfileSim.txt checks them from Python.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 100;
+	int stepsPerCheckPt = 25;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+	}
+	int ranksPerSubfile = 0;
+	if(argc > 5) ranksPerSubfile = atoi(argv[5]);
+
+	// setup and run like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	simLoc thisSimLoc;
+	flag = initSimLoc(&thisSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	free(initTemp);
+	initTemp = NULL;
+	checkPtTimeLoc checkLoc;
+	flag += runSimLoc(&thisSimLoc, nSteps, stepsPerCheckPt, &checkLoc);
+	if(flag){
+		printf("WARNING: issue in running the simulation \n");
+		failed = 1;
+	}
+
+	// shared text file and subfiles
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = writeToFileLoc(&checkLoc, "results/subfileSim.txt");
+	MPI_Barrier(MPI_COMM_WORLD);
+	double textTime = MPI_Wtime() - start;
+	start = MPI_Wtime();
+	flag += writeToSubfilesLoc(&checkLoc, "results/subfileSim", ranksPerSubfile);
+	MPI_Barrier(MPI_COMM_WORLD);
+	double subfileTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue writing the snapshots \n");
+		failed = 1;
+	}
+
+	// read this rank's rows back from the set
+	subfileSet thisSet;
+	int nBad = openSubfileSet(&thisSet, "results/subfileSim.idx");
+	int nRowsLoc = thisMaterialLoc.NyLocal;
+	long nLocalPts = (long)Nx*nRowsLoc;
+	double *rows = malloc(nLocalPts*sizeof(double) + 1);
+	int snap;
+	long k;
+	for(snap=0; (snap<checkLoc.nSnaps) && (nBad == 0); ++snap){
+		nBad += readRowsSubfileSet(&thisSet, snap, thisMaterialLoc.startYId, nRowsLoc, rows);
+		if(thisSet.times[snap] != checkLoc.times[snap]) ++nBad;
+		for(k=0; k<nLocalPts; ++k){
+			if(rows[k] != (double)loadReal(checkLoc.stateSnapshotsLoc[snap*nLocalPts + k])) ++nBad;
+		}
+	}
+	int nFiles = thisSet.nFiles;
+	closeSubfileSet(&thisSet);
+	free(rows);
+	int nBadTotal;
+	MPI_Reduce(&nBad, &nBadTotal, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+	if(rank == 0){
+		printf("%d snapshots of %u x %u points on %d ranks in %d subfiles \n", checkLoc.nSnaps, Nx, NyTotal, nProcs, nFiles);
+		if(nBadTotal == 0) printf("Subfile set reads back as the snapshots \n");
+		else{
+			printf("ERROR: %d values differ when the subfile set is read back \n", nBadTotal);
+			failed = 1;
+		}
+		printf("Shared text file: %f seconds \n", textTime);
+		printf("Subfiles:         %f seconds \n", subfileTime);
+	}
+
+	// cleanup
+	cleanupSimLoc(&thisSimLoc);
+	cleanupCheckPtTimeLoc(&checkLoc);
+
+	MPI_Finalize();
+	return failed;
+}
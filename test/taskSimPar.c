@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "../code/taskPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/taskSimPar Nx NyTotal nSteps stepsPerCheckPt nThreads taskRows
+// Runs the bigSim setup with the usual step and in task mode (nThreads threads per rank, tiles of taskRows
+// rows, task timing traced to results/taskTrace.rank.csv), then reports timings, how much tile updating went
+// on while the ghost rows were in flight, work stealing, and whether the snapshots agree.
+
+int main(int argc, char** argv){
+	// initialize MPI (only the main thread makes MPI calls)
+	int provided;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 100;
+	int stepsPerCheckPt = 25;
+	int nThreads = 2;
+	int taskRows = 64;
+	if(argc > 6){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+		nThreads = atoi(argv[5]);
+		taskRows = atoi(argv[6]);
+	}
+
+	// setup the material like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+
+	// the usual step
+	simLoc plainSimLoc;
+	flag = initSimLoc(&plainSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	checkPtTimeLoc plainCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag += runSimLoc(&plainSimLoc, nSteps + 1, stepsPerCheckPt, &plainCheckLoc);
+	double plainTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running the usual simulation \n");
+		failed = 1;
+	}
+
+	// task mode
+	simLoc taskSimLoc;
+	flag = initSimLoc(&taskSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	flag += setTaskModeLoc(&taskSimLoc, nThreads, taskRows, "results/taskTrace");
+	if(flag){
+		printf("WARNING: issue setting up task mode \n");
+		failed = 1;
+	}
+	checkPtTimeLoc taskCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag = runSimLoc(&taskSimLoc, nSteps + 1, stepsPerCheckPt, &taskCheckLoc);
+	double taskTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running the task mode simulation \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	flag = writeToFileLoc(&plainCheckLoc, "results/taskPlain.txt");
+	flag += writeToFileLoc(&taskCheckLoc, "results/taskSim.txt");
+	if(flag){
+		printf("WARNING: issue writing checkpoint files \n");
+		failed = 1;
+	}
+
+	// sum the task timing over the ranks
+	double local[6] = {taskSimLoc.taskWallLoc, taskSimLoc.taskBusyLoc, taskSimLoc.taskFlightLoc, taskSimLoc.taskOverlapLoc, (double)taskSimLoc.taskPoolLoc->nRun, (double)taskSimLoc.taskPoolLoc->nStolen};
+	double total[6];
+	MPI_Reduce(local, total, 6, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+	if(rank == 0){
+		printf("%d steps on %u x %u points, %d ranks x %d threads, tiles of %d rows \n", nSteps, Nx, NyTotal, nProcs, nThreads, taskRows);
+		printf("Usual step: %f seconds \n", plainTime);
+		printf("Task mode:  %f seconds \n", taskTime);
+		printf("Threads busy %.1f%% of the task mode steps, %.0f tasks run, %.0f of them stolen \n", 100.0*total[1]/(total[0]*nThreads), total[4], total[5]);
+		printf("Ghost rows in flight %f seconds per rank, with %f thread-seconds of tile updates run meanwhile \n", total[2]/nProcs, total[3]/nProcs);
+		if(sameFile("results/taskPlain.txt", "results/taskSim.txt")) printf("Snapshots are identical \n");
+		else{
+			printf("ERROR: snapshots differ between the usual step and task mode \n");
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	cleanupSimLoc(&plainSimLoc);
+	cleanupSimLoc(&taskSimLoc);
+	cleanupCheckPtTimeLoc(&plainCheckLoc);
+	cleanupCheckPtTimeLoc(&taskCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
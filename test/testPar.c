@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include "testPar.h"
+
+// fill in the bigSim initial temperature field (0.1 everywhere with 3 hot sources)
+void fillInitTemp(float *initTemp, unsigned int Nx, unsigned int NyTotal){
+	int row,col;
+	for(row=0; row<NyTotal; ++row){
+		for(col=0; col<Nx; ++col){
+			initTemp[col+(row*Nx)] = 0.1;
+		}
+	}
+	initTemp[(Nx/2) + (NyTotal/3)*Nx] = 100.0;
+	initTemp[(3*Nx/4) + (NyTotal/4)*Nx] = 10.0;
+	initTemp[(Nx/3) + (2*NyTotal/3)*Nx] = 150.0;
+}
+
+// 1 if the two files have the same contents
+int sameFile(const char *name1, const char *name2){
+	FILE *f1 = fopen(name1, "r");
+	FILE *f2 = fopen(name2, "r");
+	int same = (f1 != NULL) && (f2 != NULL);
+	while(same){
+		int c1 = fgetc(f1);
+		int c2 = fgetc(f2);
+		if(c1 != c2) same = 0;
+		if(c1 == EOF) break;
+	}
+	if(f1 != NULL) fclose(f1);
+	if(f2 != NULL) fclose(f2);
+	return same;
+}
@@ -0,0 +1,11 @@
+#ifndef __TESTPAR_H__
+#define __TESTPAR_H__
+
+// Setup and checks shared by the parallel test drivers (build test/testPar.c with them)
+
+// fill in the bigSim initial temperature field (0.1 everywhere with 3 hot sources)
+void fillInitTemp(float *initTemp, unsigned int Nx, unsigned int NyTotal);
+
+// 1 if the two files have the same contents
+int sameFile(const char *name1, const char *name2);
+#endif
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/textExportPar Nx NyTotal nSteps stepsPerCheckPt
+// Runs the bigSim setup, then writes its snapshots in the text format three ways: with writeToFileLoc (every
+// rank formats its own rows and writes them in place), with writeToFileRootLoc (rank 0 writes one snapshot
+// while the next is gathered) and the way it used to be done (gather every snapshot on rank 0, which writes one
+// fprintf per value). Checks the files are byte for byte the same and times them.
+
+// the gather on rank 0 and fprintf per value text writer
+int writeToFileGather(checkPtTimeLoc *thisCheckPtLoc, const char *filename){
+	materialLoc *thisMaterialLoc = thisCheckPtLoc->thisMaterialLoc;
+	int rank, size;
+	MPI_Comm_rank(thisMaterialLoc->comm, &rank);
+	MPI_Comm_size(thisMaterialLoc->comm, &size);
+	int Nx = thisMaterialLoc->Nx;
+	int NyTotal = thisMaterialLoc->NyTotal;
+	int nSnaps = thisCheckPtLoc->nSnaps;
+	int nLocalPts = Nx*thisMaterialLoc->NyLocal;
+	int nSpacePts = Nx*NyTotal;
+	int *recvCounts = malloc(size*sizeof(int));
+	int *displacements = malloc(size*sizeof(int));
+	int myDispl = Nx*thisMaterialLoc->startYId;
+	MPI_Allgather(&nLocalPts, 1, MPI_INT, recvCounts, 1, MPI_INT, thisMaterialLoc->comm);
+	MPI_Allgather(&myDispl, 1, MPI_INT, displacements, 1, MPI_INT, thisMaterialLoc->comm);
+	real_t *totalSnapshots = NULL;
+	if(rank == 0) totalSnapshots = malloc((long)nSnaps*nSpacePts*sizeof(real_t));
+	int snap, k;
+	for(snap=0; snap<nSnaps; ++snap){
+		MPI_Gatherv(thisCheckPtLoc->stateSnapshotsLoc + (long)nLocalPts*snap, nLocalPts, MPI_REAL_T, (rank == 0) ? totalSnapshots + (long)snap*nSpacePts : NULL, recvCounts, displacements, MPI_REAL_T, 0, thisMaterialLoc->comm);
+	}
+	free(recvCounts);
+	free(displacements);
+	if(rank != 0) return 0;
+	FILE *filePtr = fopen(filename, "w");
+	if(filePtr == NULL){
+		free(totalSnapshots);
+		return 1;
+	}
+	fprintf(filePtr, "%d\n", Nx);
+	fprintf(filePtr, "%d\n", NyTotal);
+	fprintf(filePtr, "%d\n", nSnaps);
+#ifndef REAL_IS_FLOAT
+	fprintf(filePtr, "%s\n", REAL_DTYPE);
+#endif
+	for(snap=0; snap<nSnaps; ++snap){
+		fprintf(filePtr, "%f ,", thisCheckPtLoc->times[snap]);
+		for(k=0; k<nSpacePts; ++k){
+			fprintf(filePtr, REAL_FMT, (double)loadReal(totalSnapshots[k + (long)snap*nSpacePts]));
+		}
+		fprintf(filePtr, "\n");
+	}
+	fclose(filePtr);
+	free(totalSnapshots);
+	return 0;
+}
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank, nProcs;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 100;
+	int stepsPerCheckPt = 25;
+	if(argc > 4){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		stepsPerCheckPt = atoi(argv[4]);
+	}
+
+	// setup and run like bigSim
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	float dt = 0.1;
+	float boundary = 0.1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	simLoc thisSimLoc;
+	flag = initSimLoc(&thisSimLoc, dt, initTemp, boundary, &thisMaterialLoc);
+	free(initTemp);
+	initTemp = NULL;
+	checkPtTimeLoc checkLoc;
+	flag += runSimLoc(&thisSimLoc, nSteps, stepsPerCheckPt, &checkLoc);
+	if(flag){
+		printf("WARNING: issue in running the simulation \n");
+		failed = 1;
+	}
+
+	// the two text writers
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = writeToFileLoc(&checkLoc, "results/textExport.txt");
+	MPI_Barrier(MPI_COMM_WORLD);
+	double newTime = MPI_Wtime() - start;
+	start = MPI_Wtime();
+	flag += writeToFileGather(&checkLoc, "results/textExportGather.txt");
+	MPI_Barrier(MPI_COMM_WORLD);
+	double oldTime = MPI_Wtime() - start;
+	start = MPI_Wtime();
+	flag += writeToFileRootLoc(&checkLoc, "results/textExportRoot.txt");
+	MPI_Barrier(MPI_COMM_WORLD);
+	double rootTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue writing the text files \n");
+		failed = 1;
+	}
+
+	if(rank == 0){
+		double nValues = (double)Nx*NyTotal*checkLoc.nSnaps;
+		printf("%d snapshots of %u x %u points on %d ranks \n", checkLoc.nSnaps, Nx, NyTotal, nProcs);
+		double snapMB = (double)Nx*NyTotal*sizeof(real_t)/1e6;
+		if(sameFile("results/textExport.txt", "results/textExportGather.txt") && sameFile("results/textExportRoot.txt", "results/textExportGather.txt")) printf("Text files are identical \n");
+		else{
+			printf("ERROR: text files differ \n");
+			failed = 1;
+		}
+		printf("Gather and fprintf:         %f seconds, %.1f million values per second, %.1f MB of snapshots on rank 0 \n", oldTime, nValues/oldTime/1e6, snapMB*checkLoc.nSnaps);
+		printf("Pipelined rank 0 writer:    %f seconds, %.1f million values per second, %.1f MB of snapshots on rank 0 (%.1fx) \n", rootTime, nValues/rootTime/1e6, 2*snapMB, oldTime/rootTime);
+		printf("Parallel format and write:  %f seconds, %.1f million values per second (%.1fx) \n", newTime, nValues/newTime/1e6, oldTime/newTime);
+	}
+
+	// cleanup
+	cleanupSimLoc(&thisSimLoc);
+	cleanupCheckPtTimeLoc(&checkLoc);
+
+	MPI_Finalize();
+	return failed;
+}
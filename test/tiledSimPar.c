@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialPar.h"
+#include "../code/checkPtPar.h"
+#include "../code/simulationPar.h"
+#include "testPar.h"
+#include <mpi.h>
+
+// Call this as:
+// mpirun -np #procs ./obj/tiledSimPar Nx NyTotal nSteps tileRows tileCols
+// Runs the bigSim setup for nSteps steps with every point updated every step and with quiescent
+// tile skipping, then reports the fraction of tile updates skipped, timings, and whether the
+// final states are identical.
+
+int main(int argc, char** argv){
+	// initialize MPI
+	MPI_Init(&argc, &argv);
+	int rank;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	int failed = 0; // exit status: nonzero if a step reported a problem or a check failed
+
+	unsigned int Nx = 1000;
+	unsigned int NyTotal = 2000;
+	int nSteps = 200;
+	int tileRows = 16;
+	int tileCols = 64;
+	if(argc > 5){
+		Nx = atoi(argv[1]);
+		NyTotal = atoi(argv[2]);
+		nSteps = atoi(argv[3]);
+		tileRows = atoi(argv[4]);
+		tileCols = atoi(argv[5]);
+	}
+
+	// setup the material
+	float alpha = 2.0;
+	float dx = 1.5;
+	float dy = 1.0;
+	int nPadRows = 1;
+	materialLoc thisMaterialLoc;
+	int flag = initMaterialLoc(&thisMaterialLoc, Nx, NyTotal, nPadRows, dx, dy, alpha);
+	if(flag){
+		printf("WARNING: error in initMaterialLoc \n");
+		failed = 1;
+	}
+	float *initTemp = malloc(Nx*NyTotal*sizeof(float));
+	fillInitTemp(initTemp, Nx, NyTotal);
+	float boundary = 0.1;
+
+	// every point every step
+	simLoc fullSimLoc;
+	flag = initSimLoc(&fullSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	checkPtTimeLoc fullCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	double start = MPI_Wtime();
+	flag = runSimLoc(&fullSimLoc, nSteps + 1, nSteps, &fullCheckLoc);
+	double fullTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running full simulation \n");
+		failed = 1;
+	}
+
+	// only tiles where heat is moving
+	simLoc tiledSimLoc;
+	flag = initSimLoc(&tiledSimLoc, 0.1, initTemp, boundary, &thisMaterialLoc);
+	flag += setTilingLoc(&tiledSimLoc, tileRows, tileCols);
+	if(flag){
+		printf("WARNING: issue setting up tiling \n");
+		failed = 1;
+	}
+	checkPtTimeLoc tiledCheckLoc;
+	MPI_Barrier(MPI_COMM_WORLD);
+	start = MPI_Wtime();
+	flag = runSimLoc(&tiledSimLoc, nSteps + 1, nSteps, &tiledCheckLoc);
+	double tiledTime = MPI_Wtime() - start;
+	if(flag){
+		printf("WARNING: issue in running tiled simulation \n");
+		failed = 1;
+	}
+	free(initTemp);
+	initTemp = NULL;
+
+	// compare the final states bit for bit
+	int nPad = Nx * nPadRows;
+	int nLocal = Nx * thisMaterialLoc.NyLocal;
+	int localMismatches = 0;
+	int i;
+	for(i=nPad; i<nPad+nLocal; ++i){
+		if(fullSimLoc.priorStateLoc[i] != tiledSimLoc.priorStateLoc[i]) localMismatches++;
+	}
+	int mismatches;
+	MPI_Reduce(&localMismatches, &mismatches, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+	long localTiles[2] = {tiledSimLoc.tilesUpdated, tiledSimLoc.tilesSkipped};
+	long tiles[2];
+	MPI_Reduce(localTiles, tiles, 2, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+	if(rank == 0){
+		printf("%d steps on %u x %u points, %d x %d tiles \n", nSteps, Nx, NyTotal, tileRows, tileCols);
+		printf("Every point: %f seconds wall \n", fullTime);
+		printf("Tiled: %f seconds wall, %.1f%% of tile updates skipped \n", tiledTime, 100.0*tiles[1]/(tiles[0]+tiles[1]));
+		if(mismatches == 0) printf("Final states are identical \n");
+		else{
+			printf("ERROR: %d points differ between the full and tiled final states \n", mismatches);
+			failed = 1;
+		}
+	}
+
+	// cleanup
+	cleanupSimLoc(&fullSimLoc);
+	cleanupSimLoc(&tiledSimLoc);
+	cleanupCheckPtTimeLoc(&fullCheckLoc);
+	cleanupCheckPtTimeLoc(&tiledCheckLoc);
+
+	MPI_Finalize();
+	return failed;
+}
@@ -179,8 +179,88 @@ int testIntStep(int testID){
 	return 0;
 };
 
+// test that RKL2 picks the smallest stable number of stages
+int testRklStages(int testID){
+	material thisMaterial;
+	sim thisSim;
+	int flag = setup(&thisMaterial, &thisSim);
+	flag += setIntegrator(&thisSim, INTEGRATOR_RKL2, 9*thisSim.dtMax);
+	if(flag != 0){ 
+		printf("ERROR in test %d ,  initialization issue \n",testID);
+		return 1;
+	}
+	// need (s^2+s-2)/4 >= 9, so s = 6
+	if(thisSim.nStages != 6){
+		printf("ERROR in test %d , wrong number of RKL2 stages \n",testID);
+		return 2;
+	}
+	cleanupSim(&thisSim);
+	printf("Test %d passed.\n",testID);
+	return 0;
+};
 
+// test that RKL2 never grows the deviation from the boundary value and decays to it with a step 20 times dtMax
+int testRklStable(int testID){
+	material thisMaterial;
+	sim thisSim;
+	int flag = setup(&thisMaterial, &thisSim);
+	flag += setIntegrator(&thisSim, INTEGRATOR_RKL2, 20*thisSim.dtMax);
+	if(flag != 0){ 
+		printf("ERROR in test %d ,  initialization issue \n",testID);
+		return 1;
+	}
+	int n, i;
+	for(n=0; n<200; ++n){
+		flag += oneStep(&thisSim);
+		for(i=0; i<8*10; ++i){
+			if(!(fabs(thisSim.priorState[i] - 1.0) <= 1.0)){
+				printf("ERROR in test %d , RKL2 step %d is unstable \n",testID,n);
+				return 2;
+			}
+		}
+	}
+	if((flag != 0) || (fabs(thisSim.priorState[8*5 + 4] - 1.0) > 1e-3)){
+		printf("ERROR in test %d , RKL2 didn't decay to the boundary value \n",testID);
+		return 3;
+	}
+	cleanupSim(&thisSim);
+	printf("Test %d passed.\n",testID);
+	return 0;
+};
 
+// test that a few RKL2 super steps match many small forward Euler steps on a smooth field
+// (the setup's jump at the boundary is mostly high frequency modes, which RKL2 damps less exactly)
+int testRklAccuracy(int testID){
+	material thisMaterial;
+	sim eulerSim, rklSim;
+	int flag = setup(&thisMaterial, &eulerSim);
+	flag += setup(&thisMaterial, &rklSim);
+	flag += setIntegrator(&eulerSim, INTEGRATOR_EULER, 0.018);
+	flag += setIntegrator(&rklSim, INTEGRATOR_RKL2, 0.9);
+	if(flag != 0){ 
+		printf("ERROR in test %d ,  initialization issue \n",testID);
+		return 1;
+	}
+	int n, i, j, k;
+	for(j=0; j<10; ++j){
+		for(k=0; k<8; ++k){
+			eulerSim.priorState[k + j*8] = 1 + sin(M_PI*k/7.0)*sin(M_PI*j/9.0);
+			rklSim.priorState[k + j*8] = eulerSim.priorState[k + j*8];
+		}
+	}
+	for(n=0; n<100; ++n) flag += oneStep(&eulerSim);
+	for(n=0; n<2; ++n) flag += oneStep(&rklSim);
+	for(i=0; i<8*10; ++i){
+		if(fabs(eulerSim.priorState[i] - rklSim.priorState[i]) > 0.01){
+			printf("ERROR in test %d , RKL2 solution far from small step solution \n",testID);
+			return 2;
+		}
+	}
+	cleanupSim(&eulerSim);
+	cleanupSim(&rklSim);
+	printf("Test %d passed.\n",testID);
+	return 0;
+};
 
 // The actual main function that runs all tests
 int main(){
@@ -206,6 +286,15 @@ int main(){
 	flag = testIntStep(testID);
 	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
 
+	flag = testRklStages(testID);
+	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
+
+	flag = testRklStable(testID);
+	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
+
+	flag = testRklAccuracy(testID);
+	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
+
 	printf("----SIMULATION UNIT TESTS----\n");
 	printf("----------SUMMARY----------\n");
 	printf("Tests passed: %d \n",nTestsPassed);
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../code/materialSer.h"
+#include "../code/simulationSer.h"
+#include "../code/checkPtSer.h"
+#include "../code/spectralSer.h"
+#include "../code/dst.h"
+
+// keeps track of tests passed, failed, and current test index
+void incrementTestCtr(int flag, int *nTestsPassed, int *nTestsFailed, int *testID){
+	if(flag == 0){
+		*nTestsPassed = *nTestsPassed + 1;
+	}
+	else{
+		*nTestsFailed = *nTestsFailed + 1;
+	}
+	*testID = *testID + 1;
+	return;
+};
+
+// we'll reuse the same setup for multiple tests (Nx = 12 and Ny = 9 so one direction needs Bluestein)
+int setup(material *aMaterial, sim *aSim){
+	int Nx = 12;
+	int Ny = 9;
+	float dx = 0.7;
+	float dy = 0.6;
+	float alpha = 0.5;
+	int flag = initMaterial(aMaterial,Nx,Ny,dx,dy,alpha);
+
+	float dt = 0.15;
+	float boundary = 1;
+	float *initTemp = malloc(Nx*Ny*sizeof(float));
+	int j,k;
+	for(j=0; j<Ny; ++j){
+		for(k=0; k<Nx; ++k){
+			initTemp[k + j*Nx] = 2 + ((k*7 + j*3) % 5); // an uneven interior field
+		}
+	}
+	initTemp[5 + 4*Nx] = 50; // and a hot spot
+	flag += initSim(aSim, dt, initTemp, boundary, aMaterial);
+	free(initTemp);
+	initTemp = NULL;
+	return flag;
+};
+
+// test the DST against the direct sum for a power of two and a Bluestein length
+int testDst(int testID){
+	int lengths[2] = {7, 10}; // 2(n+1) = 16 and 22
+	int t;
+	for(t=0; t<2; ++t){
+		int n = lengths[t];
+		dstPlan plan;
+		initDstPlan(&plan, n);
+		double x[10], X[10];
+		int j,k;
+		for(j=0; j<n; ++j) x[j] = X[j] = sin(1.3*j) + 0.1*j;
+		applyDst(&plan, X, 1);
+		for(k=1; k<=n; ++k){
+			double direct = 0.0;
+			for(j=1; j<=n; ++j) direct += x[j-1]*sin(M_PI*j*k/(n+1));
+			if(fabs(direct - X[k-1]) > 1e-10){
+				printf("ERROR in test %d , DST of length %d differs from direct sum \n",testID,n);
+				cleanupDstPlan(&plan);
+				return 1;
+			}
+		}
+		cleanupDstPlan(&plan);
+	}
+	printf("Test %d passed.\n",testID);
+	return 0;
+};
+
+// test that time index 0 gives back the initial state
+int testInitState(int testID){
+	material thisMaterial;
+	sim thisSim;
+	int flag = setup(&thisMaterial, &thisSim);
+	spectral thisSpectral;
+	flag += initSpectral(&thisSpectral, &thisSim, SPECTRAL_EXPLICIT);
+	flag += spectralStateAt(&thisSpectral, 0);
+	if(flag != 0){
+		printf("ERROR in test %d ,  initialization issue \n",testID);
+		return 1;
+	}
+	int i;
+	for(i=0; i<12*9; ++i){
+		if(fabs(thisSim.priorState[i] - thisSim.initState[i]) > 1e-4){
+			printf("ERROR in test %d , state at time 0 isn't the initial state \n",testID);
+			return 2;
+		}
+	}
+	cleanupSpectral(&thisSpectral);
+	cleanupSim(&thisSim);
+	printf("Test %d passed.\n",testID);
+	return 0;
+};
+
+// test that the explicit mode matches runSim's forward Euler steps
+int testMatchesOneStep(int testID){
+	material thisMaterial;
+	sim stepSim, spectralSim;
+	int flag = setup(&thisMaterial, &stepSim);
+	flag += setup(&thisMaterial, &spectralSim);
+	checkPtTime stepCheck, spectralCheck;
+	flag += runSim(&stepSim, 41, 10, &stepCheck);
+	spectral thisSpectral;
+	flag += initSpectral(&thisSpectral, &spectralSim, SPECTRAL_EXPLICIT);
+	flag += runSimSpectral(&thisSpectral, 41, 10, &spectralCheck);
+	if(flag != 0){
+		printf("ERROR in test %d ,  initialization issue \n",testID);
+		return 1;
+	}
+	int i;
+	for(i=0; i<stepCheck.nSnaps*12*9; ++i){
+		if(fabs(stepCheck.stateSnapshots[i] - spectralCheck.stateSnapshots[i]) > 1e-3){
+			printf("ERROR in test %d , spectral snapshot differs from stepped snapshot \n",testID);
+			return 2;
+		}
+	}
+	if(fabs(stepCheck.times[4] - spectralCheck.times[4]) > 1e-6){
+		printf("ERROR in test %d , snapshot times differ \n",testID);
+		return 3;
+	}
+	cleanupSpectral(&thisSpectral);
+	cleanupSim(&stepSim);
+	cleanupSim(&spectralSim);
+	cleanupCheckPtTime(&stepCheck);
+	cleanupCheckPtTime(&spectralCheck);
+	printf("Test %d passed.\n",testID);
+	return 0;
+};
+
+// test that the semi-discrete solution is close to forward Euler with a small time step
+int testSemiDiscrete(int testID){
+	material thisMaterial;
+	sim stepSim, spectralSim;
+	int flag = setup(&thisMaterial, &stepSim);
+	flag += setup(&thisMaterial, &spectralSim);
+	stepSim.dt = 0.0015; // 100 times smaller than the setup step
+	spectralSim.dt = 0.0015;
+	int n;
+	for(n=0; n<500; ++n) flag += oneStep(&stepSim);
+	spectral thisSpectral;
+	flag += initSpectral(&thisSpectral, &spectralSim, SPECTRAL_SEMIDISCRETE);
+	flag += spectralStateAt(&thisSpectral, 500);
+	if(flag != 0){
+		printf("ERROR in test %d ,  initialization issue \n",testID);
+		return 1;
+	}
+	int i;
+	for(i=0; i<12*9; ++i){
+		if(fabs(stepSim.priorState[i] - spectralSim.priorState[i]) > 0.05){
+			printf("ERROR in test %d , semi-discrete solution far from small step solution \n",testID);
+			return 2;
+		}
+	}
+	cleanupSpectral(&thisSpectral);
+	cleanupSim(&stepSim);
+	cleanupSim(&spectralSim);
+	printf("Test %d passed.\n",testID);
+	return 0;
+};
+
+// The actual main function that runs all tests
+int main(){
+	int nTestsPassed = 0;
+	int nTestsFailed = 0;
+	int testID = 0;
+	int flag; // each test will return a 0 if passed and a 1 if failed
+
+	flag = testDst(testID);
+	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
+
+	flag = testInitState(testID);
+	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
+
+	flag = testMatchesOneStep(testID);
+	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
+
+	flag = testSemiDiscrete(testID);
+	incrementTestCtr(flag, &nTestsPassed, &nTestsFailed, &testID);
+
+	printf("----SPECTRAL UNIT TESTS----\n");
+	printf("----------SUMMARY----------\n");
+	printf("Tests passed: %d \n",nTestsPassed);
+	printf("Tests failed: %d \n",nTestsFailed);
+
+	return 0;
+}
@@ -0,0 +1,32 @@
+#!/bin/sh
+#SBATCH -t 1:00:00
+#SBATCH -N 32 
+#SBATCH -A cmda3634alloc
+#SBATCH -p normal_q
+
+echo "Running 3D weak scaling test"
+echo "Job ran on nodes: "
+echo $SLURM_NODELIST
+
+module load gcc
+module load openmpi
+
+mpicc -O3 test/bigSim3D.c code/material3DPar.c code/checkPt3DPar.c code/simulation3DPar.c code/allocPar.c -o obj/bigSim3D -lm
+
+date
+date +%s
+echo "start loop"
+# 256 x 256 x 64 points per process (the same 4 million points per process as the 2D weak scaling test),
+# 100 steps, no snapshot file so the timing is the simulation's
+for i in 1 2 4 8 16 32;
+do
+    echo "---------------------"
+    echo "Running bigSim3D with $i processes"
+
+    z=$(($i * 64))
+    mpirun -np $i ./obj/bigSim3D 256 256 $z 25 100 0
+    echo "---------------------"
+    date
+    date +%s
+    echo "end loop"
+done